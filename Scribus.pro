@@ -57,6 +57,7 @@ HEADERS += scribus/actionmanager.h \
            scribus/canvasmode_objimport.h \
            scribus/canvasmode_panning.h \
            scribus/canvasmode_rotate.h \
+           scribus/canvastilecache.h \
            scribus/cellarea.h \
            scribus/chartablemodel.h \
            scribus/chartableview.h \
@@ -92,8 +93,12 @@ HEADERS += scribus/actionmanager.h \
            scribus/guidesmodel.h \
            scribus/guidesview.h \
            scribus/hyphenator.h \
+           scribus/hyphenwordcache.h \
            scribus/iconmanager.h \
+           scribus/imagebandwriter.h \
+           scribus/imageloadqueue.h \
            scribus/ioapi.h \
+           scribus/itemrastercache.h \
            scribus/KarbonCurveFit.h \
            scribus/langdef.h \
            scribus/langmgr.h \
@@ -128,9 +133,12 @@ HEADERS += scribus/actionmanager.h \
            scribus/pageitem_symbol.h \
            scribus/pageitem_table.h \
            scribus/pageitem_textframe.h \
+           scribus/pageitemindex.h \
            scribus/pageitemiterator.h \
+           scribus/pageitemnameindex.h \
            scribus/pageitempointer.h \
            scribus/pageitempreview.h \
+           scribus/pagerenderer.h \
            scribus/pagesize.h \
            scribus/pagestructs.h \
            scribus/pdf_analyzer.h \
@@ -156,11 +164,13 @@ HEADERS += scribus/actionmanager.h \
            scribus/rc4.h \
            scribus/resourcecollection.h \
            scribus/sampleitem.h \
+           scribus/scblobstore.h \
            scribus/scclocale.h \
            scribus/sccolor.h \
            scribus/sccolorengine.h \
            scribus/sccolorshade.h \
            scribus/sccolorstructs.h \
+           scribus/sccontentstream.h \
            scribus/scconfig.h \
            scribus/scdebug.h \
            scribus/scdocoutput.h \
@@ -176,6 +186,7 @@ HEADERS += scribus/actionmanager.h \
            scribus/scimagecachemanager.h \
            scribus/scimagecacheproxy.h \
            scribus/scimagecachewriteaction.h \
+           scribus/scimagekernels.h \
            scribus/scimagestructs.h \
            scribus/sclayer.h \
            scribus/sclimits.h \
@@ -253,6 +264,7 @@ HEADERS += scribus/actionmanager.h \
            scribus/util_layer.h \
            scribus/util_math.h \
            scribus/util_os.h \
+           scribus/util_parallel.h \
            scribus/util_printer.h \
            scribus/util_text.h \
            scribus/vgradient.h \
@@ -314,6 +326,7 @@ HEADERS += scribus/actionmanager.h \
            scribus/fonts/scface.h \
            scribus/fonts/scface_ps.h \
            scribus/fonts/scface_ttf.h \
+           scribus/fonts/scfontindex.h \
            scribus/fonts/scfontmetrics.h \
            scribus/fonts/sfnt.h \
            scribus/fonts/sfnt_format.h \
@@ -374,6 +387,7 @@ HEADERS += scribus/actionmanager.h \
            scribus/text/itextcontext.h \
            scribus/text/itextsource.h \
            scribus/text/nlsconfig.h \
+           scribus/text/screenglyphcache.h \
            scribus/text/screenpainter.h \
            scribus/text/scrptrun.h \
            scribus/text/sctext_shared.h \
@@ -719,6 +733,7 @@ HEADERS += scribus/actionmanager.h \
            scribus/plugins/scriptplugin/cmdutil.h \
            scribus/plugins/scriptplugin/cmdvar.h \
            scribus/plugins/scriptplugin/guiapp.h \
+           scribus/plugins/scriptplugin/objbatch.h \
            scribus/plugins/scriptplugin/objimageexport.h \
            scribus/plugins/scriptplugin/objpdffile.h \
            scribus/plugins/scriptplugin/objprinter.h \
@@ -891,6 +906,7 @@ HEADERS += scribus/actionmanager.h \
            scribus/plugins/fileloader/scribus13format/scribus13formatimpl.h \
            scribus/plugins/fileloader/scribus150format/scribus150format.h \
            scribus/plugins/fileloader/scribus150format/scribus150formatimpl.h \
+           scribus/plugins/fileloader/scribus150format/slaindex.h \
            scribus/plugins/gettext/csvim/csvdia.h \
            scribus/plugins/gettext/csvim/csvim.h \
            scribus/plugins/gettext/docim/docim.h \
@@ -1194,6 +1210,7 @@ SOURCES += scribus/actionmanager.cpp \
            scribus/canvasmode_objimport.cpp \
            scribus/canvasmode_panning.cpp \
            scribus/canvasmode_rotate.cpp \
+           scribus/canvastilecache.cpp \
            scribus/cellarea.cpp \
            scribus/chartablemodel.cpp \
            scribus/chartableview.cpp \
@@ -1229,8 +1246,12 @@ SOURCES += scribus/actionmanager.cpp \
            scribus/guidesmodel.cpp \
            scribus/guidesview.cpp \
            scribus/hyphenator.cpp \
+           scribus/hyphenwordcache.cpp \
            scribus/iconmanager.cpp \
+           scribus/imagebandwriter.cpp \
+           scribus/imageloadqueue.cpp \
            scribus/ioapi.c \
+           scribus/itemrastercache.cpp \
            scribus/KarbonCurveFit.cpp \
            scribus/langdef.cpp \
            scribus/langmgr.cpp \
@@ -1267,9 +1288,12 @@ SOURCES += scribus/actionmanager.cpp \
            scribus/pageitem_symbol.cpp \
            scribus/pageitem_table.cpp \
            scribus/pageitem_textframe.cpp \
+           scribus/pageitemindex.cpp \
            scribus/pageitemiterator.cpp \
+           scribus/pageitemnameindex.cpp \
            scribus/pageitempointer.cpp \
            scribus/pageitempreview.cpp \
+           scribus/pagerenderer.cpp \
            scribus/pagesize.cpp \
            scribus/pdf_analyzer.cpp \
            scribus/pdflib.cpp \
@@ -1290,11 +1314,13 @@ SOURCES += scribus/actionmanager.cpp \
            scribus/rawimage.cpp \
            scribus/rc4.c \
            scribus/sampleitem.cpp \
+           scribus/scblobstore.cpp \
            scribus/scclocale.cpp \
            scribus/sccolor.cpp \
            scribus/sccolorengine.cpp \
            scribus/sccolorshade.cpp \
            scribus/sccolorstructs.cpp \
+           scribus/sccontentstream.cpp \
            scribus/scdocoutput.cpp \
            scribus/scdocoutput_ps2.cpp \
            scribus/scdomelement.cpp \
@@ -1307,6 +1333,7 @@ SOURCES += scribus/actionmanager.cpp \
            scribus/scimagecachemanager.cpp \
            scribus/scimagecacheproxy.cpp \
            scribus/scimagecachewriteaction.cpp \
+           scribus/scimagekernels.cpp \
            scribus/scimagestructs.cpp \
            scribus/sclayer.cpp \
            scribus/sclockedfile.cpp \
@@ -1373,6 +1400,7 @@ SOURCES += scribus/actionmanager.cpp \
            scribus/util_layer.cpp \
            scribus/util_math.cpp \
            scribus/util_os.cpp \
+           scribus/util_parallel.cpp \
            scribus/util_printer.cpp \
            scribus/util_text.cpp \
            scribus/vgradient.cpp \
@@ -1418,6 +1446,7 @@ SOURCES += scribus/actionmanager.cpp \
            scribus/fonts/scface.cpp \
            scribus/fonts/scface_ps.cpp \
            scribus/fonts/scface_ttf.cpp \
+           scribus/fonts/scfontindex.cpp \
            scribus/fonts/scfontmetrics.cpp \
            scribus/fonts/sfnt.cpp \
            scribus/imagedataloaders/scimgdataloader.cpp \
@@ -1476,6 +1505,7 @@ SOURCES += scribus/actionmanager.cpp \
            scribus/text/fsize.cpp \
            scribus/text/glyphcluster.cpp \
            scribus/text/index.cpp \
+           scribus/text/screenglyphcache.cpp \
            scribus/text/screenpainter.cpp \
            scribus/text/scrptrun.cc \
            scribus/text/scrptrun.cpp \
@@ -1817,6 +1847,7 @@ SOURCES += scribus/actionmanager.cpp \
            scribus/plugins/scriptplugin/cmdtext.cpp \
            scribus/plugins/scriptplugin/cmdutil.cpp \
            scribus/plugins/scriptplugin/guiapp.cpp \
+           scribus/plugins/scriptplugin/objbatch.cpp \
            scribus/plugins/scriptplugin/objimageexport.cpp \
            scribus/plugins/scriptplugin/objpdffile.cpp \
            scribus/plugins/scriptplugin/objprinter.cpp \
@@ -2008,6 +2039,7 @@ SOURCES += scribus/actionmanager.cpp \
            scribus/plugins/fileloader/scribus150format/scribus150format.cpp \
            scribus/plugins/fileloader/scribus150format/scribus150format_save.cpp \
            scribus/plugins/fileloader/scribus150format/scribus150formatimpl.cpp \
+           scribus/plugins/fileloader/scribus150format/slaindex.cpp \
            scribus/plugins/gettext/csvim/csvdia.cpp \
            scribus/plugins/gettext/csvim/csvim.cpp \
            scribus/plugins/gettext/docim/docim.cpp \
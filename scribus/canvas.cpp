@@ -19,6 +19,9 @@
 #include <cmath>
 
 // #include <QDebug>
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QTimer>
 #include <QToolTip>
 #include <QWidget>
 
@@ -92,6 +95,9 @@ Canvas::Canvas(ScribusDoc* doc, ScribusView* parent) : QWidget(parent), m_doc(do
 	m_buffer = QPixmap();
 	m_bufferRect = QRect();
 	m_renderMode = RENDER_NORMAL;
+	m_tileTimer = new QTimer(this);
+	m_tileTimer->setSingleShot(true);
+	connect(m_tileTimer, SIGNAL(timeout()), this, SLOT(renderPendingTiles()));
 }
 
 void Canvas::setPreviewVisual(int mode)
@@ -466,10 +472,22 @@ PageItem* Canvas::itemUnderCursor(QPoint globalPos, PageItem* itemAbove, bool al
 		return nullptr;
 
 	QList<PageItem*> *itemList = (itemAbove && itemAbove->isGroupChild()) ? &itemAbove->parentGroup()->groupItemList : m_doc->Items;
-	int currNr = itemAbove ? itemList->indexOf(itemAbove) - 1 : itemList->count() - 1;
+	// group members are not indexed, but there are only a few of them
+	QList<PageItem*> itemsNearCursor = (itemList == m_doc->Items) ? m_doc->itemIndex().itemsIn(itemList, mouseArea) : *itemList;
+	int currNr = itemsNearCursor.count() - 1;
+	if (itemAbove)
+	{
+		currNr = itemsNearCursor.indexOf(itemAbove) - 1;
+		// itemAbove may lie outside of the mouse area
+		if (currNr < -1)
+		{
+			itemsNearCursor = *itemList;
+			currNr = itemList->indexOf(itemAbove) - 1;
+		}
+	}
 	while (currNr >= 0)
 	{
-		currItem = itemList->at(currNr);
+		currItem = itemsNearCursor.at(currNr);
 		if ((m_doc->masterPageMode())  && (!((currItem->OwnPage == -1) || (currItem->OwnPage == static_cast<int>(m_doc->currentPage()->pageNr())))))
 		{
 			--currNr;
@@ -634,6 +652,7 @@ void Canvas::setRenderMode(RenderMode mode)
 
 void Canvas::clearBuffers()
 {
+	clearTiles();
 	m_buffer = QPixmap();
 	m_bufferRect = QRect();
 	m_selectionBuffer = QPixmap();
@@ -645,10 +664,30 @@ void Canvas::setScale(double scale)
 	if (m_viewMode.scale == scale)
 		return;
 	m_viewMode.scale = scale;
-	clearBuffers();
+	// Tiles are kept per zoom level, only the buffers depend on the scale
+	m_buffer = QPixmap();
+	m_bufferRect = QRect();
+	m_selectionBuffer = QPixmap();
+	m_selectionRect = QRect();
+	m_pendingTiles.clear();
 	update();
 }
 
+void Canvas::setForcedRedraw(const QRectF& changedArea)
+{
+	m_viewMode.forceRedraw = true;
+	if (changedArea.isValid())
+	{
+		m_tileCache.invalidate(changedArea);
+		m_itemCache.invalidate(changedArea);
+	}
+	else
+	{
+		clearTiles();
+		m_itemCache.clear();
+	}
+}
+
 
 bool Canvas::adjustBuffer()
 {
@@ -670,7 +709,7 @@ bool Canvas::adjustBuffer()
 //		qDebug() << "adjust buffer: invalid buffer, viewport" << viewport;
 		m_bufferRect = viewport;
 		m_buffer = createPixmap(m_bufferRect.width(), m_bufferRect.height());
-		fillBuffer(&m_buffer, m_bufferRect.topLeft(), m_bufferRect);
+		fillBufferFromTiles(&m_buffer, m_bufferRect.topLeft(), m_bufferRect);
 		ret = true;
 #if DRAW_DEBUG_LINES
 		QPainter p(&m_buffer);
@@ -698,7 +737,7 @@ bool Canvas::adjustBuffer()
 //			qDebug() << "adjust buffer: fresh buffer" << m_bufferRect << "-->" << newRect;
 			m_bufferRect = newRect;
 			m_buffer = createPixmap(m_bufferRect.width(), m_bufferRect.height());
-			fillBuffer(&m_buffer, m_bufferRect.topLeft(), m_bufferRect);
+			fillBufferFromTiles(&m_buffer, m_bufferRect.topLeft(), m_bufferRect);
 			ret = true;
 #if DRAW_DEBUG_LINES
 			QPainter p(&m_buffer);
@@ -756,22 +795,22 @@ bool Canvas::adjustBuffer()
 			// canvas has just been resized, after an object has been put in scrap area for eg.
 			if (newRect.top() < m_bufferRect.top())
 			{
-				fillBuffer(&newBuffer, newRect.topLeft(), QRect(newRect.left(), newRect.top(), newRect.width(), m_bufferRect.top() - newRect.top() + 2));
+				fillBufferFromTiles(&newBuffer, newRect.topLeft(), QRect(newRect.left(), newRect.top(), newRect.width(), m_bufferRect.top() - newRect.top() + 2));
 				//ret = true;
 			}
 			if (newRect.bottom() > m_bufferRect.bottom())
 			{
-				fillBuffer(&newBuffer, newRect.topLeft(), QRect(newRect.left(), m_bufferRect.bottom() - 1, newRect.width(), newRect.bottom() - m_bufferRect.bottom() + 2));
+				fillBufferFromTiles(&newBuffer, newRect.topLeft(), QRect(newRect.left(), m_bufferRect.bottom() - 1, newRect.width(), newRect.bottom() - m_bufferRect.bottom() + 2));
 				//ret = true;
 			}
 			if (newRect.left() < m_bufferRect.left())
 			{
-				fillBuffer(&newBuffer, newRect.topLeft(), QRect(newRect.left(), m_bufferRect.top(), m_bufferRect.left() - newRect.left() + 2, m_bufferRect.height()));
+				fillBufferFromTiles(&newBuffer, newRect.topLeft(), QRect(newRect.left(), m_bufferRect.top(), m_bufferRect.left() - newRect.left() + 2, m_bufferRect.height()));
 				//ret = true;
 			}
 			if (newRect.right() > m_bufferRect.right())
 			{
-				fillBuffer(&newBuffer, newRect.topLeft(), QRect(m_bufferRect.right() - 1, m_bufferRect.top(), newRect.right() - m_bufferRect.right() + 2, m_bufferRect.height()));
+				fillBufferFromTiles(&newBuffer, newRect.topLeft(), QRect(m_bufferRect.right() - 1, m_bufferRect.top(), newRect.right() - m_bufferRect.right() + 2, m_bufferRect.height()));
 				//ret = true;
 			}
 			m_buffer = newBuffer;
@@ -787,6 +826,8 @@ bool Canvas::adjustBuffer()
 //	else
 //		qDebug() << "adjustBuffer: reusing" << m_bufferRect;
 // 	qDebug() << "Canvas::adjustBuffer"<<ret;
+	if (useTileCache())
+		queueTilePrefetch();
 	return ret;
 }
 
@@ -799,6 +840,154 @@ void Canvas::fillBuffer(QPaintDevice* buffer, QPoint bufferOrigin, QRect clipRec
 	painter.end();
 }
 
+/*
+ Tiled rendering:
+
+ Tile (column, row) covers the local rectangle starting at
+ canvasToLocal(0,0) + TileSize * (column, row), so tiles are anchored at the
+ document origin and survive scrolling. Tiles of the last few zoom levels are
+ kept, edits reported through setForcedRedraw(QRectF) only drop the tiles
+ they touch. Visible tiles are rendered on demand, the ring around the
+ viewport is rendered when the event loop is idle.
+ */
+
+void Canvas::fillBufferFromTiles(QPaintDevice* buffer, QPoint bufferOrigin, QRect clipRect)
+{
+	if (!useTileCache())
+	{
+		fillBuffer(buffer, bufferOrigin, clipRect);
+		return;
+	}
+	const int tileSize = CanvasTileCache::TileSize;
+	QPoint tileOrigin = selectTileLevel();
+	QRect tiles = CanvasTileCache::tileRange(clipRect.translated(-tileOrigin));
+	QPainter painter(buffer);
+	painter.setClipRect(clipRect.translated(-bufferOrigin));
+	for (int row = tiles.top(); row <= tiles.bottom(); ++row)
+	{
+		for (int column = tiles.left(); column <= tiles.right(); ++column)
+		{
+			QPixmap tile;
+			if (!m_tileCache.find(column, row, tile))
+			{
+				tile = renderTile(tileOrigin, column, row);
+				m_tileCache.insert(column, row, tile);
+			}
+			painter.drawPixmap(tileOrigin + QPoint(column * tileSize, row * tileSize) - bufferOrigin, tile);
+		}
+	}
+	painter.end();
+}
+
+bool Canvas::useTileCache() const
+{
+	// Tiles hold the plain contents, not the partial ones of the other render modes
+	return (m_renderMode == RENDER_NORMAL) && !m_viewMode.drawSelectedItemsWithControls && !m_viewMode.operTextSelecting;
+}
+
+uint Canvas::tileSignature() const
+{
+	uint signature = m_doc->masterPageMode() ? 1 : 0;
+	signature = signature * 31 + (m_viewMode.previewMode ? 1 : 0);
+	signature = signature * 31 + (m_viewMode.viewAsPreview ? 1 : 0);
+	signature = signature * 31 + uint(m_viewMode.previewVisual + 1);
+	signature = signature * 31 + (m_viewMode.drawFramelinksWithContents ? 1 : 0);
+	return signature;
+}
+
+QRectF Canvas::selectionTileArea() const
+{
+	// Selected items draw their frame in another color
+	QRectF area;
+	for (int i = 0; i < m_doc->m_Selection->count(); ++i)
+		area |= m_doc->m_Selection->itemAt(i)->getVisualBoundingRect();
+	// and the link modes draw the frame links of the first selected chain
+	if (((m_doc->appMode == modeLinkFrames) || (m_doc->appMode == modeUnlinkFrames)) && (m_doc->m_Selection->count() > 0))
+	{
+		PageItem* currItem = m_doc->m_Selection->itemAt(0);
+		if (currItem->isTextFrame())
+		{
+			for (PageItem* nextItem = currItem->firstInChain(); nextItem != nullptr; nextItem = nextItem->nextInChain())
+				area |= nextItem->getVisualBoundingRect();
+		}
+	}
+	return area;
+}
+
+void Canvas::invalidateSelectionTiles()
+{
+	QList<PageItem*> selection = m_doc->m_Selection->items();
+	bool linkMode = (m_doc->appMode == modeLinkFrames) || (m_doc->appMode == modeUnlinkFrames);
+	if ((selection == m_tileSelection) && (linkMode == m_tileSelectionLinkMode))
+		return;
+	QRectF area = selectionTileArea();
+	if (m_tileSelectionArea.isValid())
+		m_tileCache.invalidate(m_tileSelectionArea);
+	if (area.isValid())
+		m_tileCache.invalidate(area);
+	m_tileSelection = selection;
+	m_tileSelectionLinkMode = linkMode;
+	m_tileSelectionArea = area;
+}
+
+QPoint Canvas::selectTileLevel()
+{
+	invalidateSelectionTiles();
+	QPoint tileOrigin = canvasToLocal(QPointF(0.0, 0.0));
+	QPointF exactOrigin(-m_doc->minCanvasCoordinate.x() * m_viewMode.scale, -m_doc->minCanvasCoordinate.y() * m_viewMode.scale);
+	m_tileCache.setLevel(m_viewMode.scale, QPointF(tileOrigin) - exactOrigin, tileSignature());
+	return tileOrigin;
+}
+
+QPixmap Canvas::renderTile(QPoint tileOrigin, int column, int row)
+{
+	const int tileSize = CanvasTileCache::TileSize;
+	QRect tileRect(tileOrigin + QPoint(column * tileSize, row * tileSize), QSize(tileSize, tileSize));
+	QPixmap tile = createPixmap(tileSize, tileSize);
+	fillBuffer(&tile, tileRect.topLeft(), tileRect);
+	return tile;
+}
+
+void Canvas::queueTilePrefetch()
+{
+	QPoint tileOrigin = selectTileLevel();
+	QRect viewport(-x(), -y(), m_view->viewport()->width(), m_view->viewport()->height());
+	QRect tiles = CanvasTileCache::tileRange(viewport.translated(-tileOrigin)).adjusted(-1, -1, 1, 1);
+	tiles &= CanvasTileCache::tileRange(rect().translated(-tileOrigin));
+	for (int row = tiles.top(); row <= tiles.bottom(); ++row)
+	{
+		for (int column = tiles.left(); column <= tiles.right(); ++column)
+		{
+			QPoint tile(column, row);
+			if (!m_tileCache.contains(column, row) && !m_pendingTiles.contains(tile))
+				m_pendingTiles.append(tile);
+		}
+	}
+	if (!m_pendingTiles.isEmpty() && !m_tileTimer->isActive())
+		m_tileTimer->start(20);
+}
+
+void Canvas::renderPendingTiles()
+{
+	if (!useTileCache() || m_doc->isLoading() || !m_doc->DoDrawing || !isVisible())
+	{
+		m_pendingTiles.clear();
+		return;
+	}
+	QPoint tileOrigin = selectTileLevel();
+	QElapsedTimer timer;
+	timer.start();
+	// Keep each slice short so that input stays responsive
+	while (!m_pendingTiles.isEmpty() && timer.elapsed() < 15)
+	{
+		QPoint tile = m_pendingTiles.takeFirst();
+		if (!m_tileCache.contains(tile.x(), tile.y()))
+			m_tileCache.insert(tile.x(), tile.y(), renderTile(tileOrigin, tile.x(), tile.y()));
+	}
+	if (!m_pendingTiles.isEmpty())
+		m_tileTimer->start(0);
+}
+
 /**
   Actually we have at least three super-layers:
   - background (page outlines, guides if below)
@@ -820,6 +1009,9 @@ void Canvas::paintEvent ( QPaintEvent * p )
 	t1 = t2=t3=t4=t5 =t6= 0;
 	t.start();
 #endif
+	// text selections are drawn with the contents, tiles drawn before are stale
+	if (m_viewMode.operTextSelecting)
+		clearTiles();
 	// fill buffer if necessary
 	bool bufferFilled = adjustBuffer();
 	QPainter qp(this);
@@ -1453,6 +1645,120 @@ void Canvas::DrawMasterItems(ScPainter *painter, ScPage *page, ScLayer& layer, Q
 /**
   draws page items contained in a specific Layer
  */
+void Canvas::drawPageItem(ScPainter* painter, PageItem* item, const QRectF& cullingArea)
+{
+	// Images are cached in device pixels, so only plain scaled and translated painters can use them
+	QTransform matrix = painter->worldMatrix();
+	if (!useItemCache(item) || matrix.isRotating() || !qFuzzyCompare(matrix.m11(), matrix.m22()))
+	{
+		item->DrawObj(painter, cullingArea);
+		return;
+	}
+
+	double ratio = devicePixelRatioF();
+	double deviceScale = matrix.m11() * ratio;
+	double baseX = floor(matrix.dx() * ratio);
+	double baseY = floor(matrix.dy() * ratio);
+	double fractionX = matrix.dx() * ratio - baseX;
+	double fractionY = matrix.dy() * ratio - baseY;
+
+	QRectF itemRect = item->getVisualBoundingRect();
+	if (item->hasSoftShadow())
+	{
+		double shadowExtent = qMax(fabs(item->softShadowXOffset()), fabs(item->softShadowYOffset())) + item->softShadowBlurRadius();
+		itemRect.adjust(-shadowExtent, -shadowExtent, shadowExtent, shadowExtent);
+	}
+	QRect pixelRect = QRectF(itemRect.x() * deviceScale + fractionX, itemRect.y() * deviceScale + fractionY,
+							 itemRect.width() * deviceScale, itemRect.height() * deviceScale).toAlignedRect().adjusted(-2, -2, 2, 2);
+	if (pixelRect.isEmpty() || (pixelRect.width() > 4096) || (pixelRect.height() > 4096))
+	{
+		item->DrawObj(painter, cullingArea);
+		return;
+	}
+
+	m_itemCache.setMaxBytes(qint64(PrefsManager::instance().appPrefs.displayPrefs.itemRasterCacheSizeMiB) * 1024 * 1024);
+	uint state = itemCacheState(item, deviceScale, fractionX, fractionY);
+	QImage image;
+	QPoint position;
+	if (!m_itemCache.find(item->renderRevision(), state, image, position))
+	{
+		image = QImage(pixelRect.size(), QImage::Format_ARGB32_Premultiplied);
+		image.fill(qRgba(0, 0, 0, 0));
+		image.setDevicePixelRatio(ratio);
+		ScPainter itemPainter(&image, image.width(), image.height(), 1.0, 0);
+		itemPainter.setZoomFactor(painter->zoomFactor());
+		itemPainter.setWorldMatrix(QTransform(matrix.m11(), 0.0, 0.0, matrix.m22(), (matrix.dx() * ratio - baseX - pixelRect.x()) / ratio, (matrix.dy() * ratio - baseY - pixelRect.y()) / ratio));
+		item->DrawObj(&itemPainter, QRectF());
+		itemPainter.end();
+		position = pixelRect.topLeft();
+		m_itemCache.insert(item->renderRevision(), state, image, position, itemRect);
+	}
+
+	// drawImage() composes with the current fill settings, the next item sets its own
+	int blendMode = painter->blendModeFill();
+	double opacity = painter->brushOpacity();
+	int maskMode = painter->maskMode();
+	painter->save();
+	painter->setWorldMatrix(QTransform(1.0 / ratio, 0.0, 0.0, 1.0 / ratio, (baseX + position.x()) / ratio, (baseY + position.y()) / ratio));
+	painter->setBlendModeFill(0);
+	painter->setBrushOpacity(1.0);
+	painter->setMaskMode(0);
+	painter->drawImage(&image);
+	painter->restore();
+	painter->setBlendModeFill(blendMode);
+	painter->setBrushOpacity(opacity);
+	painter->setMaskMode(maskMode);
+}
+
+bool Canvas::useItemCache(PageItem* item) const
+{
+	if (!PrefsManager::instance().appPrefs.displayPrefs.itemRasterCacheEnabled || (m_renderMode != RENDER_NORMAL))
+		return false;
+	// Text may be edited or selected at any time, selected items are redrawn while they change
+	if (item->isSelected() || item->isTextFrame() || item->isPathText() || item->isTable() || item->isAnnotation())
+		return false;
+	// The image is composed with the normal blend mode
+	if ((item->fillBlendmode() != 0) || (item->lineBlendmode() != 0) || (item->hasSoftShadow() && (item->softShadowBlendMode() != 0)))
+		return false;
+	if (item->isGroup() || item->isSymbol())
+	{
+		const QList<PageItem*> children = item->getAllChildren();
+		for (const PageItem* child : children)
+		{
+			if (child->isSelected())
+				return false;
+		}
+		return true;
+	}
+	// Only items which are expensive to draw are worth the memory
+	int gradientType = item->gradientType();
+	if ((gradientType == Gradient_Pattern) || (gradientType == Gradient_4Colors) || (gradientType == Gradient_Diamond)
+		|| (gradientType == Gradient_Mesh) || (gradientType == Gradient_PatchMesh) || (gradientType == Gradient_Hatch))
+		return true;
+	return item->hasSoftShadow() || (item->isImageFrame() && item->imageIsAvailable) || (item->PoLine.size() > 1000);
+}
+
+uint Canvas::itemCacheState(PageItem* item, double deviceScale, double fractionX, double fractionY) const
+{
+	uint state = qHash(qRound64(deviceScale * 10000.0));
+	state = state * 31 + uint(qRound(fractionX * 16.0)) * 17 + uint(qRound(fractionY * 16.0));
+	state = state * 31 + qHash(qRound64(item->xPos() * 1000.0)) + qHash(qRound64(item->yPos() * 1000.0));
+	state = state * 31 + qHash(qRound64(item->width() * 1000.0)) + qHash(qRound64(item->height() * 1000.0));
+	state = state * 31 + qHash(qRound64(item->rotation() * 1000.0));
+	state = state * 31 + (m_viewMode.previewMode ? 1 : 0) + (m_viewMode.viewAsPreview ? 2 : 0);
+	state = state * 31 + uint(m_viewMode.previewVisual + 1);
+	state = state * 31 + (m_doc->HasCMS ? 1 : 0) + (m_doc->SoftProofing ? 2 : 0) + (m_doc->Gamut ? 4 : 0);
+	state = state * 31 + ((m_doc->appMode == modeEdit) ? 1 : 0) + (m_doc->layerOutline(item->m_layerID) ? 2 : 0);
+	state = state * 31 + (m_doc->guidesPrefs().showPic ? 1 : 0) + (m_doc->guidesPrefs().framesShown ? 2 : 0);
+	if (item->isGroup() || item->isSymbol())
+	{
+		const QList<PageItem*> children = item->getAllChildren();
+		for (const PageItem* child : children)
+			state = state * 31 + qHash(child->renderRevision());
+	}
+	return state;
+}
+
 void Canvas::DrawPageItems(ScPainter *painter, ScLayer& layer, QRect clip, bool notesFramesPass)
 {
 	if ((m_viewMode.previewMode) && (!layer.isPrintable))
@@ -1479,9 +1785,9 @@ void Canvas::DrawPageItems(ScPainter *painter, ScLayer& layer, QRect clip, bool
 	//then we must be sure that text frames are valid and all notes frames are created before we start drawing
 	if (!notesFramesPass && !m_doc->notesList().isEmpty())
 	{
-		for (auto it = m_doc->Items->begin(); it != m_doc->Items->end(); ++it)
+		const QList<PageItem*> itemsToLayout = m_doc->itemIndex().itemsIn(m_doc->Items, cullingArea);
+		for (PageItem* currItem : itemsToLayout)
 		{
-			PageItem* currItem = *it;
 			if ( !currItem->isTextFrame()
 				|| currItem->isNoteFrame()
 				|| !currItem->invalid
@@ -1495,9 +1801,16 @@ void Canvas::DrawPageItems(ScPainter *painter, ScLayer& layer, QRect clip, bool
 				currItem->layout();
 		}
 	}
-	for (int it = 0; it < m_doc->Items->count(); ++it)
+	// Drawing may lay out text and that may delete notes frames, which are dropped from the list then
+	const QList<PageItem*> itemsInArea = m_doc->itemIndex().itemsIn(m_doc->Items, cullingArea);
+	QList<QPointer<PageItem> > itemsToDraw;
+	for (PageItem* item : itemsInArea)
+		itemsToDraw.append(item);
+	for (int it = 0; it < itemsToDraw.count(); ++it)
 	{
-		currItem = m_doc->Items->at(it);
+		currItem = itemsToDraw.at(it);
+		if (currItem == nullptr)
+			continue;
 		if (notesFramesPass && !currItem->isNoteFrame())
 			continue;
 		if (!notesFramesPass && currItem->isNoteFrame())
@@ -1527,7 +1840,7 @@ void Canvas::DrawPageItems(ScPainter *painter, ScLayer& layer, QRect clip, bool
 			else if (m_viewMode.operItemSelecting)
 			{
 				currItem->invalid = false;
-				currItem->DrawObj(painter, cullingArea);
+				drawPageItem(painter, currItem, cullingArea);
 				currItem->DrawObj_Decoration(painter);
 			}
 			else
@@ -1536,7 +1849,7 @@ void Canvas::DrawPageItems(ScPainter *painter, ScLayer& layer, QRect clip, bool
 				// alter the "data". And it really prevents optimisation - pm
 // 				if (m_viewMode.forceRedraw)
 // 					currItem->invalidateLayout();
-				currItem->DrawObj(painter, cullingArea);
+				drawPageItem(painter, currItem, cullingArea);
 				currItem->DrawObj_Decoration(painter);
 			}
 			getLinkedFrames(currItem);
@@ -33,12 +33,15 @@ scribusview.h  -  description
 
 #include "scribusapi.h"
 
+#include "canvastilecache.h"
 #include "commonstrings.h"
 #include "fpoint.h"
 #include "fpointarray.h"
+#include "itemrastercache.h"
 #include "pageitempointer.h"
 
 
+class QTimer;
 class ScPage;
 class PageItem;
 class ScLayer;
@@ -184,8 +187,12 @@ public:
 		m_viewMode.redrawPolygon.clear();
 		return m_viewMode.redrawPolygon;
 	}
-	void setForcedRedraw(bool on) { m_viewMode.forceRedraw = on; }
+	void setForcedRedraw(bool on) { m_viewMode.forceRedraw = on; if (on) { clearTiles(); m_itemCache.clear(); } }
+	/** Forces a redraw after a change limited to changedArea (canvas coordinates), cached tiles elsewhere stay valid */
+	void setForcedRedraw(const QRectF& changedArea);
 	bool isForcedRedraw() const { return m_viewMode.forceRedraw; }
+	/** Drops the cached tiles and items for changes that are not redrawn right away, the buffer is kept */
+	void dropCachedRendering() { clearTiles(); m_itemCache.clear(); }
 	void setPreviewMode(bool on) { m_viewMode.previewMode = on; }
 	bool isPreviewMode() const { return m_viewMode.previewMode || m_viewMode.viewAsPreview; }
 	bool usePreviewVisual() const { return m_viewMode.viewAsPreview && m_viewMode.previewVisual != 0; }
@@ -242,6 +249,27 @@ private:
 	    bufferOrigin and clipRect are in local coordinates
 	 */
 	void fillBuffer(QPaintDevice* buffer, QPoint bufferOrigin, QRect clipRect);
+	/**
+		Same as fillBuffer(), but composes the contents from cached tiles
+		and renders only the missing ones
+	 */
+	void fillBufferFromTiles(QPaintDevice* buffer, QPoint bufferOrigin, QRect clipRect);
+	bool useTileCache() const;
+	uint tileSignature() const;
+	/// Document area drawn differently because of the current selection
+	QRectF selectionTileArea() const;
+	/// Drops the tiles around the old and the new selection if the selection changed since the tiles were drawn
+	void invalidateSelectionTiles();
+	/// Selects the tile cache level for the current view, returns the local position of tile (0, 0)
+	QPoint selectTileLevel();
+	QPixmap renderTile(QPoint tileOrigin, int column, int row);
+	/// Queues the tiles around the viewport for rendering when idle
+	void queueTilePrefetch();
+	void clearTiles() { m_tileCache.clear(); m_pendingTiles.clear(); }
+	/// Draws a page item, from the item raster cache if it is worth caching
+	void drawPageItem(ScPainter* painter, PageItem* item, const QRectF& cullingArea);
+	bool useItemCache(PageItem* item) const;
+	uint itemCacheState(PageItem* item, double deviceScale, double fractionX, double fractionY) const;
 	void drawContents(QPainter *p, int clipx, int clipy, int clipw, int cliph);
 	void drawBackgroundMasterpage(ScPainter* painter, int clipx, int clipy, int clipw, int cliph);
 	void drawBackgroundPageOutlines(ScPainter* painter, int clipx, int clipy, int clipw, int cliph);
@@ -260,6 +288,9 @@ private:
 	QPixmap createPixmap(double w, double h);
 	// draw a potentially hidpi pixmap
 	void drawPixmap(QPainter &painter, double x, double y, const QPixmap &pixmap, double sx, double sy, double sw, double sh);
+
+private slots:
+	void renderPendingTiles();
 		
 private:
 	ScribusDoc* m_doc;
@@ -272,6 +303,14 @@ private:
 	QPixmap m_selectionBuffer;
 	QRect   m_selectionRect;
 	QPoint  m_oldMinCanvasCoordinate;
+	CanvasTileCache m_tileCache;
+	QList<QPoint> m_pendingTiles;
+	/// Selection the cached tiles were drawn with, only compared, never dereferenced
+	QList<PageItem*> m_tileSelection;
+	bool m_tileSelectionLinkMode { false };
+	QRectF m_tileSelectionArea;
+	QTimer* m_tileTimer { nullptr };
+	ItemRasterCache m_itemCache;
 };
 
 
@@ -1151,9 +1151,9 @@ void CanvasMode_Normal::mouseReleaseEvent(QMouseEvent *m)
 			bool altPressed = m->modifiers() & Qt::AltModifier;
 			bool shiftPressed = m->modifiers() & Qt::ShiftModifier;
 
-			for (int a = 0; a < docItemCount; ++a)
+			const QList<PageItem*> itemsInRect = m_doc->itemIndex().itemsIn(m_doc->Items, canvasSele);
+			for (PageItem* docItem : itemsInRect)
 			{
-				PageItem* docItem = m_doc->Items->at(a);
 				if ((m_doc->masterPageMode()) && (docItem->OnMasterPage != m_doc->currentPage()->pageName()))
 					continue;
 				if (m_doc->canSelectItemOnLayer(docItem->m_layerID))
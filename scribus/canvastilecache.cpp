@@ -0,0 +1,183 @@
+/*
+ For general Scribus (>=1.3.2) copyright and licensing information please refer
+ to the COPYING file provided with the program. Following this notice may exist
+ a copyright and/or license notice that predates the release of Scribus 1.3.2
+ for which a new license (GPL+exception) is in place.
+ */
+
+#include <QtMath>
+
+#include "canvastilecache.h"
+
+// Extra pixels dropped around invalidated areas, as ScribusView::updateCanvas() does
+static const int invalidationMargin = 12;
+
+CanvasTileCache::CanvasTileCache(int maxTiles, int maxLevels) :
+	m_maxTiles(qMax(1, maxTiles)),
+	m_maxLevels(qMax(1, maxLevels))
+{
+}
+
+void CanvasTileCache::setLevel(double scale, const QPointF& originOffset, uint signature)
+{
+	// Tiles drawn with another view state are useless at any scale
+	for (int i = m_levels.count() - 1; i >= 0; --i)
+	{
+		if (m_levels.at(i).signature != signature)
+			removeLevel(i);
+	}
+
+	m_current = -1;
+	for (int i = 0; i < m_levels.count(); ++i)
+	{
+		const Level& level = m_levels.at(i);
+		if (qFuzzyCompare(level.scale, scale) && qAbs(level.originOffset.x() - originOffset.x()) < 0.001 && qAbs(level.originOffset.y() - originOffset.y()) < 0.001)
+		{
+			m_current = i;
+			break;
+		}
+	}
+	if (m_current < 0)
+	{
+		while (m_levels.count() >= m_maxLevels)
+		{
+			int oldest = 0;
+			for (int i = 1; i < m_levels.count(); ++i)
+			{
+				if (m_levels.at(i).lastUse < m_levels.at(oldest).lastUse)
+					oldest = i;
+			}
+			removeLevel(oldest);
+		}
+		Level level;
+		level.scale = scale;
+		level.originOffset = originOffset;
+		level.signature = signature;
+		m_levels.append(level);
+		m_current = m_levels.count() - 1;
+	}
+	m_levels[m_current].lastUse = ++m_useCounter;
+}
+
+bool CanvasTileCache::contains(int column, int row) const
+{
+	if (m_current < 0)
+		return false;
+	return m_levels.at(m_current).tiles.contains(tileKey(column, row));
+}
+
+bool CanvasTileCache::find(int column, int row, QPixmap& tile)
+{
+	if (m_current < 0)
+		return false;
+	QHash<quint64, Tile>& tiles = m_levels[m_current].tiles;
+	auto it = tiles.find(tileKey(column, row));
+	if (it == tiles.end())
+		return false;
+	it->lastUse = ++m_useCounter;
+	tile = it->pixmap;
+	return true;
+}
+
+void CanvasTileCache::insert(int column, int row, const QPixmap& tile)
+{
+	if (m_current < 0)
+		return;
+	QHash<quint64, Tile>& tiles = m_levels[m_current].tiles;
+	quint64 key = tileKey(column, row);
+	if (!tiles.contains(key))
+	{
+		if (m_count >= m_maxTiles)
+			evictTile();
+		++m_count;
+	}
+	Tile& entry = m_levels[m_current].tiles[key];
+	entry.pixmap = tile;
+	entry.lastUse = ++m_useCounter;
+}
+
+void CanvasTileCache::invalidate(const QRectF& canvasRect)
+{
+	for (int i = 0; i < m_levels.count(); ++i)
+	{
+		Level& level = m_levels[i];
+		if (level.tiles.isEmpty())
+			continue;
+		QRect pixelRect(qFloor(canvasRect.left() * level.scale) - invalidationMargin,
+		                qFloor(canvasRect.top() * level.scale) - invalidationMargin,
+		                qCeil(canvasRect.width() * level.scale) + 2 * invalidationMargin,
+		                qCeil(canvasRect.height() * level.scale) + 2 * invalidationMargin);
+		QRect range = tileRange(pixelRect);
+		if (qint64(range.width()) * range.height() > level.tiles.count())
+		{
+			for (auto it = level.tiles.begin(); it != level.tiles.end(); )
+			{
+				int column = int(qint32(it.key() >> 32));
+				int row = int(qint32(it.key() & 0xFFFFFFFF));
+				if (range.contains(column, row))
+				{
+					it = level.tiles.erase(it);
+					--m_count;
+				}
+				else
+					++it;
+			}
+		}
+		else
+		{
+			for (int row = range.top(); row <= range.bottom(); ++row)
+			{
+				for (int column = range.left(); column <= range.right(); ++column)
+					m_count -= level.tiles.remove(tileKey(column, row));
+			}
+		}
+	}
+}
+
+void CanvasTileCache::clear()
+{
+	m_levels.clear();
+	m_current = -1;
+	m_count = 0;
+}
+
+QRect CanvasTileCache::tileRange(const QRect& pixelRect)
+{
+	int left = qFloor(pixelRect.left() / double(TileSize));
+	int top = qFloor(pixelRect.top() / double(TileSize));
+	int right = qFloor(pixelRect.right() / double(TileSize));
+	int bottom = qFloor(pixelRect.bottom() / double(TileSize));
+	return QRect(QPoint(left, top), QPoint(right, bottom));
+}
+
+void CanvasTileCache::removeLevel(int index)
+{
+	m_count -= m_levels.at(index).tiles.count();
+	m_levels.removeAt(index);
+	if (m_current == index)
+		m_current = -1;
+	else if (m_current > index)
+		--m_current;
+}
+
+void CanvasTileCache::evictTile()
+{
+	int levelIndex = -1;
+	quint64 key = 0;
+	quint64 oldest = 0;
+	for (int i = 0; i < m_levels.count(); ++i)
+	{
+		const QHash<quint64, Tile>& tiles = m_levels.at(i).tiles;
+		for (auto it = tiles.constBegin(); it != tiles.constEnd(); ++it)
+		{
+			if (levelIndex < 0 || it->lastUse < oldest)
+			{
+				levelIndex = i;
+				key = it.key();
+				oldest = it->lastUse;
+			}
+		}
+	}
+	if (levelIndex >= 0)
+		m_count -= m_levels[levelIndex].tiles.remove(key);
+}
@@ -0,0 +1,80 @@
+/*
+ For general Scribus (>=1.3.2) copyright and licensing information please refer
+ to the COPYING file provided with the program. Following this notice may exist
+ a copyright and/or license notice that predates the release of Scribus 1.3.2
+ for which a new license (GPL+exception) is in place.
+ */
+
+#ifndef CANVASTILECACHE_H
+#define CANVASTILECACHE_H
+
+#include <QHash>
+#include <QList>
+#include <QPixmap>
+#include <QPointF>
+#include <QRect>
+#include <QRectF>
+
+#include "scribusapi.h"
+
+/**
+  Cache of rendered canvas tiles for the last few zoom levels.
+
+  Tiles are squares of TileSize pixels in a pixel space anchored at the
+  document origin, so the same tile stays valid while the view scrolls.
+  A level is identified by the scale, the sub-pixel offset of the document
+  origin on screen and a signature of the view state the tiles were drawn
+  with; tiles of a level are only reused when all three match.
+ */
+class SCRIBUS_API CanvasTileCache
+{
+public:
+	static const int TileSize = 256;
+
+	explicit CanvasTileCache(int maxTiles = 256, int maxLevels = 3);
+
+	/// Selects the level further lookups and insertions refer to
+	void setLevel(double scale, const QPointF& originOffset, uint signature);
+	double scale() const { return m_current >= 0 ? m_levels.at(m_current).scale : 0.0; }
+
+	bool contains(int column, int row) const;
+	bool find(int column, int row, QPixmap& tile);
+	void insert(int column, int row, const QPixmap& tile);
+
+	/// Drops the tiles of every level which overlap the given rectangle in document coordinates
+	void invalidate(const QRectF& canvasRect);
+	void clear();
+	int count() const { return m_count; }
+
+	/// Returns the columns and rows of the tiles covering a rectangle in tile pixel space
+	static QRect tileRange(const QRect& pixelRect);
+
+private:
+	struct Tile
+	{
+		QPixmap pixmap;
+		quint64 lastUse { 0 };
+	};
+
+	struct Level
+	{
+		double  scale { 0.0 };
+		QPointF originOffset;
+		uint    signature { 0 };
+		quint64 lastUse { 0 };
+		QHash<quint64, Tile> tiles;
+	};
+
+	static quint64 tileKey(int column, int row) { return (quint64(quint32(column)) << 32) | quint32(row); }
+	void removeLevel(int index);
+	void evictTile();
+
+	QList<Level> m_levels;
+	int m_current { -1 };
+	int m_count { 0 };
+	int m_maxTiles;
+	int m_maxLevels;
+	quint64 m_useCounter { 0 };
+};
+
+#endif
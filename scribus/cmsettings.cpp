@@ -25,8 +25,57 @@ for which a new license (GPL+exception) is in place.
  ***************************************************************************/
 
 #include "cmsettings.h"
+#include "scribuscore.h"
 #include "scribusdoc.h"
 
+struct CMSettings::DocumentState
+{
+	explicit DocumentState(ScribusDoc* doc) :
+		HasCMS(doc->HasCMS),
+		settings(doc->cmsSettings()),
+		IntentColors(doc->IntentColors),
+		IntentImages(doc->IntentImages),
+		colorEngine(doc->colorEngine),
+		DocDisplayProf(doc->DocDisplayProf),
+		DocPrinterProf(doc->DocPrinterProf),
+		DocInputImageRGBProf(doc->DocInputImageRGBProf),
+		DocInputImageCMYKProf(doc->DocInputImageCMYKProf),
+		stdTransRGBMon(doc->stdTransRGBMon),
+		stdProof(doc->stdProof),
+		stdTransImg(doc->stdTransImg),
+		stdProofImg(doc->stdProofImg),
+		stdTransCMYK(doc->stdTransCMYK),
+		stdProofGC(doc->stdProofGC),
+		stdTransCMYKMon(doc->stdTransCMYKMon),
+		stdProofCMYK(doc->stdProofCMYK),
+		stdProofImgCMYK(doc->stdProofImgCMYK),
+		stdTransRGB(doc->stdTransRGB),
+		stdProofCMYKGC(doc->stdProofCMYKGC)
+	{
+	}
+
+	bool HasCMS;
+	CMSData settings;
+	eRenderIntent IntentColors;
+	eRenderIntent IntentImages;
+	ScColorMgmtEngine colorEngine;
+	ScColorProfile DocDisplayProf;
+	ScColorProfile DocPrinterProf;
+	ScColorProfile DocInputImageRGBProf;
+	ScColorProfile DocInputImageCMYKProf;
+	ScColorTransform stdTransRGBMon;
+	ScColorTransform stdProof;
+	ScColorTransform stdTransImg;
+	ScColorTransform stdProofImg;
+	ScColorTransform stdTransCMYK;
+	ScColorTransform stdProofGC;
+	ScColorTransform stdTransCMYKMon;
+	ScColorTransform stdProofCMYK;
+	ScColorTransform stdProofImgCMYK;
+	ScColorTransform stdTransRGB;
+	ScColorTransform stdProofCMYKGC;
+};
+
 CMSettings::CMSettings(ScribusDoc* doc, const QString& profileName, eRenderIntent intent) :
 	m_Doc(doc),
 	m_ProfileName(profileName),
@@ -36,8 +85,44 @@ CMSettings::CMSettings(ScribusDoc* doc, const QString& profileName, eRenderInten
 
 CMSettings::~CMSettings() = default;
 
+void CMSettings::detachFromDocument()
+{
+	if (m_Doc)
+		m_state.reset(new DocumentState(m_Doc));
+	m_Doc = nullptr;
+}
+
+ScColorMgmtEngine CMSettings::colorEngine() const
+{
+	if (m_state)
+		return m_state->colorEngine;
+	if (m_Doc)
+		return m_Doc->colorEngine;
+	return ScCore->defaultEngine;
+}
+
+ScColorProfile CMSettings::inputImageRGBProfile() const
+{
+	if (m_state)
+		return m_state->DocInputImageRGBProf;
+	if (m_Doc)
+		return m_Doc->DocInputImageRGBProf;
+	return ScColorProfile();
+}
+
+ScColorProfile CMSettings::inputImageCMYKProfile() const
+{
+	if (m_state)
+		return m_state->DocInputImageCMYKProf;
+	if (m_Doc)
+		return m_Doc->DocInputImageCMYKProf;
+	return ScColorProfile();
+}
+
 bool CMSettings::useColorManagement() const
 {
+	if (m_state)
+		return (m_state->HasCMS && m_colorManagementAllowed);
 	if (m_Doc)
 		return (m_Doc->HasCMS && m_colorManagementAllowed);
 	return false;
@@ -45,6 +130,8 @@ bool CMSettings::useColorManagement() const
 
 QString CMSettings::defaultMonitorProfile() const
 {
+	if (m_state)
+		return m_state->settings.DefaultMonitorProfile;
 	if (m_Doc)
 		return m_Doc->cmsSettings().DefaultMonitorProfile;
 	return QString();
@@ -52,6 +139,8 @@ QString CMSettings::defaultMonitorProfile() const
 
 QString CMSettings::defaultPrinterProfile() const
 {
+	if (m_state)
+		return m_state->settings.DefaultPrinterProfile;
 	if (m_Doc)
 		return m_Doc->cmsSettings().DefaultPrinterProfile;
 	return QString();
@@ -59,6 +148,8 @@ QString CMSettings::defaultPrinterProfile() const
 
 QString CMSettings::defaultImageRGBProfile() const
 {
+	if (m_state)
+		return m_state->settings.DefaultImageRGBProfile;
 	if (m_Doc)
 		return m_Doc->cmsSettings().DefaultImageRGBProfile;
 	return QString();
@@ -66,6 +157,8 @@ QString CMSettings::defaultImageRGBProfile() const
 
 QString CMSettings::defaultImageCMYKProfile() const
 {
+	if (m_state)
+		return m_state->settings.DefaultImageCMYKProfile;
 	if (m_Doc)
 		return m_Doc->cmsSettings().DefaultImageCMYKProfile;
 	return QString();
@@ -73,6 +166,8 @@ QString CMSettings::defaultImageCMYKProfile() const
 
 QString CMSettings::defaultSolidColorRGBProfile() const
 {
+	if (m_state)
+		return m_state->settings.DefaultSolidColorRGBProfile;
 	if (m_Doc)
 		return m_Doc->cmsSettings().DefaultSolidColorRGBProfile;
 	return QString();
@@ -80,6 +175,8 @@ QString CMSettings::defaultSolidColorRGBProfile() const
 
 QString CMSettings::defaultSolidColorCMYKProfile() const
 {
+	if (m_state)
+		return m_state->settings.DefaultSolidColorCMYKProfile;
 	if (m_Doc)
 		return m_Doc->cmsSettings().DefaultSolidColorCMYKProfile;
 	return QString();
@@ -87,6 +184,8 @@ QString CMSettings::defaultSolidColorCMYKProfile() const
 
 eRenderIntent CMSettings::colorRenderingIntent() const
 {
+	if (m_state)
+		return m_state->IntentColors;
 	if (m_Doc)
 		return m_Doc->IntentColors;
 	return Intent_Relative_Colorimetric; // Use relative colorimetric by default
@@ -94,6 +193,8 @@ eRenderIntent CMSettings::colorRenderingIntent() const
 
 eRenderIntent CMSettings::imageRenderingIntent() const
 {
+	if (m_state)
+		return m_state->IntentImages;
 	if (m_Doc)
 		return m_Doc->IntentImages;
 	return Intent_Perceptual; // Use perceptual by default
@@ -101,6 +202,8 @@ eRenderIntent CMSettings::imageRenderingIntent() const
 
 bool CMSettings::useBlackPoint() const
 {
+	if (m_state)
+		return m_state->settings.BlackPoint;
 	if (m_Doc)
 		return m_Doc->cmsSettings().BlackPoint;
 	return false;
@@ -108,6 +211,8 @@ bool CMSettings::useBlackPoint() const
 
 bool CMSettings::doSoftProofing() const
 {
+	if (m_state)
+		return (m_state->settings.SoftProofOn && m_softProofingAllowed);
 	if (m_Doc)
 		return (m_Doc->cmsSettings().SoftProofOn && m_softProofingAllowed);
 	return false;
@@ -115,6 +220,8 @@ bool CMSettings::doSoftProofing() const
 
 bool CMSettings::doGamutCheck() const
 {
+	if (m_state)
+		return (m_state->settings.GamutCheck && m_softProofingAllowed);
 	if (m_Doc)
 		return (m_Doc->cmsSettings().GamutCheck && m_softProofingAllowed);
 	return false;
@@ -122,6 +229,8 @@ bool CMSettings::doGamutCheck() const
 
 ScColorProfile CMSettings::monitorProfile() const
 {
+	if (m_state)
+		return m_state->DocDisplayProf;
 	if (m_Doc)
 		return m_Doc->DocDisplayProf;
 	return ScColorProfile();
@@ -129,6 +238,8 @@ ScColorProfile CMSettings::monitorProfile() const
 
 ScColorProfile CMSettings::printerProfile() const
 {
+	if (m_state)
+		return m_state->DocPrinterProf;
 	if (m_Doc)
 		return m_Doc->DocPrinterProf;
 	return ScColorProfile();
@@ -141,6 +252,8 @@ ScColorProfile CMSettings::outputProfile() const
 
 ScColorTransform CMSettings::rgbColorDisplayTransform() const  // stdTransRGBMonG
 {
+	if (m_state)
+		return m_state->stdTransRGBMon;
 	if (m_Doc)
 		return m_Doc->stdTransRGBMon;
 	return ScColorTransform();
@@ -148,6 +261,8 @@ ScColorTransform CMSettings::rgbColorDisplayTransform() const  // stdTransRGBMon
 
 ScColorTransform CMSettings::rgbColorProofingTransform() const  // stdProofG
 {
+	if (m_state)
+		return m_state->stdProof;
 	if (m_Doc)
 		return m_Doc->stdProof;
 	return ScColorTransform();
@@ -155,6 +270,8 @@ ScColorTransform CMSettings::rgbColorProofingTransform() const  // stdProofG
 
 ScColorTransform CMSettings::rgbImageDisplayTransform() const   // stdTransImgG
 {
+	if (m_state)
+		return m_state->stdTransImg;
 	if (m_Doc)
 		return m_Doc->stdTransImg;
 	return ScColorTransform();
@@ -162,6 +279,8 @@ ScColorTransform CMSettings::rgbImageDisplayTransform() const   // stdTransImgG
 
 ScColorTransform CMSettings::rgbImageProofingTransform() const  // stdProofImgG
 {
+	if (m_state)
+		return m_state->stdProofImg;
 	if (m_Doc)
 		return m_Doc->stdProofImg;
 	return ScColorTransform();
@@ -169,6 +288,8 @@ ScColorTransform CMSettings::rgbImageProofingTransform() const  // stdProofImgG
 
 ScColorTransform CMSettings::rgbToCymkColorTransform() const // stdTransCMYKG
 {
+	if (m_state)
+		return m_state->stdTransCMYK;
 	if (m_Doc)
 		return m_Doc->stdTransCMYK;
 	return ScColorTransform();
@@ -176,6 +297,8 @@ ScColorTransform CMSettings::rgbToCymkColorTransform() const // stdTransCMYKG
 
 ScColorTransform CMSettings::rgbGamutCheckTransform() const // stdProofGCG
 {
+	if (m_state)
+		return m_state->stdProofGC;
 	if (m_Doc)
 		return m_Doc->stdProofGC;
 	return ScColorTransform();
@@ -183,6 +306,8 @@ ScColorTransform CMSettings::rgbGamutCheckTransform() const // stdProofGCG
 
 ScColorTransform CMSettings::cmykColorDisplayTransform() const // stdTransCMYKMonG
 {
+	if (m_state)
+		return m_state->stdTransCMYKMon;
 	if (m_Doc)
 		return m_Doc->stdTransCMYKMon;
 	return ScColorTransform();
@@ -190,6 +315,8 @@ ScColorTransform CMSettings::cmykColorDisplayTransform() const // stdTransCMYKMo
 
 ScColorTransform CMSettings::cmykColorProofingTransform() const // stdProofCMYKG
 {
+	if (m_state)
+		return m_state->stdProofCMYK;
 	if (m_Doc)
 		return m_Doc->stdProofCMYK;
 	return ScColorTransform();
@@ -197,6 +324,8 @@ ScColorTransform CMSettings::cmykColorProofingTransform() const // stdProofCMYKG
 
 ScColorTransform CMSettings::cmykImageProofingTransform() const // stdProofImgCMYK
 {
+	if (m_state)
+		return m_state->stdProofImgCMYK;
 	if (m_Doc)
 		return m_Doc->stdProofImgCMYK;
 	return ScColorTransform();
@@ -204,6 +333,8 @@ ScColorTransform CMSettings::cmykImageProofingTransform() const // stdProofImgCM
 
 ScColorTransform CMSettings::cmykToRgbColorTransform() const  // stdTransRGBG
 {
+	if (m_state)
+		return m_state->stdTransRGB;
 	if (m_Doc)
 		return m_Doc->stdTransRGB;
 	return ScColorTransform();
@@ -211,6 +342,8 @@ ScColorTransform CMSettings::cmykToRgbColorTransform() const  // stdTransRGBG
 
 ScColorTransform CMSettings::cmykGamutCheckTransform() const //stdProofCMYKGCG
 {
+	if (m_state)
+		return m_state->stdProofCMYKGC;
 	if (m_Doc)
 		return m_Doc->stdProofCMYKGC;
 	return ScColorTransform();
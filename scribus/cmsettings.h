@@ -27,6 +27,7 @@ for which a new license (GPL+exception) is in place.
 #ifndef CMSETTINGS_H
 #define CMSETTINGS_H
 
+#include <QSharedPointer>
 #include <QString>
 
 #include "scconfig.h"
@@ -42,6 +43,9 @@ class SCRIBUS_API CMSettings
 		~CMSettings();
 
 		ScribusDoc* doc() const {return m_Doc;}
+		/// Copies what the settings read from the document; afterwards they don't access it and may be used in another thread
+		void detachFromDocument();
+		bool isDetached() const { return !m_state.isNull(); }
 		QString profileName() const {return m_ProfileName;}
 		eRenderIntent intent() const { return m_Intent; }
 
@@ -58,6 +62,9 @@ class SCRIBUS_API CMSettings
 		void setOutputProfile(const ScColorProfile& prof) { m_outputProfile = prof; }
 
 		bool useColorManagement() const;
+		ScColorMgmtEngine colorEngine() const;
+		ScColorProfile inputImageRGBProfile() const;
+		ScColorProfile inputImageCMYKProfile() const;
 
 		QString defaultMonitorProfile() const;
 		QString defaultPrinterProfile() const;
@@ -91,7 +98,10 @@ class SCRIBUS_API CMSettings
 		ScColorTransform cmykGamutCheckTransform() const;    //stdProofCMYKGCG
 
 	private:
+		struct DocumentState;
+
 		ScribusDoc*    m_Doc {nullptr};
+		QSharedPointer<const DocumentState> m_state;
 		bool           m_colorManagementAllowed {true};
 		bool           m_softProofingAllowed {false};
 		bool           m_useEmbeddedProfile {false};
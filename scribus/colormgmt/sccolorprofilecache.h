@@ -9,10 +9,12 @@ for which a new license (GPL+exception) is in place.
 #define SCCOLORPROFILECACHE_H
 
 #include <QMap>
+#include <QMutex>
 #include <QString>
 #include <QWeakPointer>
 #include "sccolorprofile.h"
 
+// Thread safe, images may be loaded in parallel
 class ScColorProfileCache 
 {
 public:
@@ -25,6 +27,7 @@ public:
 
 protected:
 	QMap<QString, QWeakPointer<ScColorProfileData> > m_profileMap;
+	QMutex m_mutex;
 };
 
 #endif
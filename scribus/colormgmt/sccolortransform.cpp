@@ -29,6 +29,11 @@ bool ScColorTransform::apply(QByteArray& input, QByteArray& output, uint numElem
 	return m_data->apply(input, output, numElem);
 }
 
+bool ScColorTransform::apply(void* input, void* output, uint pixelsPerLine, uint lineCount, uint bytesPerLineIn, uint bytesPerLineOut)
+{
+	return m_data->apply(input, output, pixelsPerLine, lineCount, bytesPerLineIn, bytesPerLineOut);
+}
+
 bool ScColorTransform::operator==(const ScColorTransform& other) const
 {
 	return m_data == other.m_data;
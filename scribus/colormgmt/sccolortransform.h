@@ -31,6 +31,11 @@ public:
 
 	bool apply(void* input, void* output, uint numElem);
 	bool apply(QByteArray& input, QByteArray& output, uint numElem);
+	// Transforms lineCount lines of pixelsPerLine pixels, lines start every bytesPerLineIn / bytesPerLineOut bytes
+	bool apply(void* input, void* output, uint pixelsPerLine, uint lineCount, uint bytesPerLineIn, uint bytesPerLineOut);
+
+	// Whether the transform may be applied from several threads at once
+	bool isReentrant() const { return !isNull() && m_data->isReentrant(); }
 
 	bool operator==(const ScColorTransform& other) const;
 
@@ -27,6 +27,10 @@ public:
 
 	virtual bool apply(void* input, void* output, uint numElem) = 0;
 	virtual bool apply(QByteArray& input, QByteArray& output, uint numElem) = 0;
+	virtual bool apply(void* input, void* output, uint pixelsPerLine, uint lineCount, uint bytesPerLineIn, uint bytesPerLineOut) = 0;
+
+	// Whether apply() may be called from several threads at once
+	virtual bool isReentrant() const { return false; }
 };
 
 #endif
@@ -9,10 +9,12 @@ for which a new license (GPL+exception) is in place.
 #define SCCOLORTRANSFORMPOOL_H
 
 #include <QList>
+#include <QMutex>
 #include <QWeakPointer>
 #include "sccolormgmtstructs.h"
 #include "sccolortransform.h"
 
+// Thread safe, images may be loaded in parallel
 class ScColorTransformPool
 {
 	friend class ScColorMgmtEngineData;
@@ -30,6 +32,9 @@ public:
 protected:
 	int m_engineID;
 	QList< QWeakPointer<ScColorTransformData> > m_pool;
+	mutable QMutex m_mutex;
+
+	ScColorTransform findTransformUnlocked(const ScColorTransformInfo& info) const;
 };
 
 #endif
@@ -44,6 +44,21 @@ bool ScLcms2ColorTransformImpl::apply(QByteArray& input, QByteArray& output, uin
 	return false;
 }
 
+bool ScLcms2ColorTransformImpl::apply(void* input, void* output, uint pixelsPerLine, uint lineCount, uint bytesPerLineIn, uint bytesPerLineOut)
+{
+	if (!m_transformHandle)
+		return false;
+#if LCMS_VERSION >= 2080
+	cmsDoTransformLineStride(m_transformHandle, input, output, pixelsPerLine, lineCount, bytesPerLineIn, bytesPerLineOut, 0, 0);
+#else
+	const uchar* in = (const uchar*) input;
+	uchar* out = (uchar*) output;
+	for (uint i = 0; i < lineCount; ++i, in += bytesPerLineIn, out += bytesPerLineOut)
+		cmsDoTransform(m_transformHandle, in, out, pixelsPerLine);
+#endif
+	return true;
+}
+
 void ScLcms2ColorTransformImpl::deleteTransform()
 {
 	if (m_transformHandle)
@@ -24,6 +24,10 @@ public:
 
 	bool apply(void* input, void* output, uint numElem) override;
 	bool apply(QByteArray& input, QByteArray& output, uint numElem) override;
+	bool apply(void* input, void* output, uint pixelsPerLine, uint lineCount, uint bytesPerLineIn, uint bytesPerLineOut) override;
+
+	// lcms2 keeps the cache of a transform on the stack of each call
+	bool isReentrant() const override { return true; }
 
 protected:
 	cmsHTRANSFORM m_transformHandle;
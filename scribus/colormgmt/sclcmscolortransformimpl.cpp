@@ -44,6 +44,17 @@ bool ScLcmsColorTransformImpl::apply(QByteArray& input, QByteArray& output, uint
 	return false;
 }
 
+bool ScLcmsColorTransformImpl::apply(void* input, void* output, uint pixelsPerLine, uint lineCount, uint bytesPerLineIn, uint bytesPerLineOut)
+{
+	if (!m_transformHandle)
+		return false;
+	uchar* in = (uchar*) input;
+	uchar* out = (uchar*) output;
+	for (uint i = 0; i < lineCount; ++i, in += bytesPerLineIn, out += bytesPerLineOut)
+		cmsDoTransform(m_transformHandle, in, out, pixelsPerLine);
+	return true;
+}
+
 void ScLcmsColorTransformImpl::deleteTransform(void)
 {
 	if (m_transformHandle)
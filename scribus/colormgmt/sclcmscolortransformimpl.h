@@ -24,6 +24,7 @@ public:
 
 	virtual bool apply(void* input, void* output, uint numElem);
 	virtual bool apply(QByteArray& input, QByteArray& output, uint numElem);
+	virtual bool apply(void* input, void* output, uint pixelsPerLine, uint lineCount, uint bytesPerLineIn, uint bytesPerLineOut);
 
 protected:
 	cmsHTRANSFORM m_transformHandle;
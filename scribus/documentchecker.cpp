@@ -25,6 +25,7 @@ for which a new license (GPL+exception) is in place.
 #include "documentchecker.h"
 #include "pageitem.h"
 #include "pdf_analyzer.h"
+#include "prefsmanager.h"
 #include "sccolor.h"
 #include "sclayer.h"
 #include "scpage.h"
@@ -34,7 +35,9 @@ for which a new license (GPL+exception) is in place.
 #include "util.h"
 #include "util_formats.h"
 
+#include <QFileInfo>
 #include <QList>
+#include <QPair>
 
 
 class MissingGlyphsPainter: public TextLayoutPainter
@@ -65,6 +68,28 @@ public:
 	void drawObject(PageItem*) override { }
 };
 
+bool DocumentCheckerCache::ItemStamp::operator==(const ItemStamp& other) const
+{
+	return (revision == other.revision) && (chainRevision == other.chainRevision) && (chainLength == other.chainLength)
+		&& (textVersion == other.textVersion) && (paragraphStylesVersion == other.paragraphStylesVersion)
+		&& (charStylesVersion == other.charStylesVersion) && (fontGeneration == other.fontGeneration)
+		&& (layoutInvalid == other.layoutInvalid)
+		&& (overflows == other.overflows) && (underflows == other.underflows)
+		&& (ownPage == other.ownPage) && (layerPrintable == other.layerPrintable)
+		&& (imageAvailable == other.imageAvailable) && (imageFile == other.imageFile)
+		&& (imageModified == other.imageModified) && (imageSize == other.imageSize);
+}
+
+void DocumentCheckerCache::clear()
+{
+	m_items.clear();
+	m_valid = false;
+	m_changedItems.clear();
+	m_pageErrorsChanged = false;
+	m_layerErrorsChanged = false;
+	m_recheckedItems = 0;
+}
+
 bool isPartFilledImageFrame(PageItem * currItem)
 {
 	double imageRealWidth  = currItem->imageXScale() * currItem->pixm.imgInfo.lowResScale * currItem->pixm.width();
@@ -89,8 +114,13 @@ bool DocumentChecker::checkDocument(ScribusDoc *currDoc, const QString& checkerP
 	if (!checkerProfiles.contains(checkerProfile))
 		return false;
 
+	// Images still loading in the background would be reported as missing
+	currDoc->finishPictLoading();
+
 	struct CheckerPrefs checkerSettings;
 	checkerSettings = checkerProfiles[checkerProfile];
+	QMap<int, errorCodes> previousPageErrors = currDoc->pageErrors;
+	QMap<int, errorCodes> previousLayerErrors = currDoc->docLayerErrors;
 	currDoc->pageErrors.clear();
 	currDoc->docItemErrors.clear();
 	currDoc->masterItemErrors.clear();
@@ -98,6 +128,9 @@ bool DocumentChecker::checkDocument(ScribusDoc *currDoc, const QString& checkerP
 
 	checkPages(currDoc, checkerSettings);
 	checkLayers(currDoc, checkerSettings);
+	DocumentCheckerCache& cache = currDoc->checkerCache();
+	cache.m_pageErrorsChanged = (currDoc->pageErrors != previousPageErrors);
+	cache.m_layerErrorsChanged = (currDoc->docLayerErrors != previousLayerErrors);
 	//update all marks references and check if that changes anything in doc
 	currDoc->setNotesChanged(currDoc->updateMarks(true));
 
@@ -172,534 +205,402 @@ void DocumentChecker::checkLayers(ScribusDoc *currDoc, const CheckerPrefs& check
 	}
 }
 
+void DocumentChecker::validateCache(ScribusDoc *currDoc, const CheckerPrefs& checkerSettings)
+{
+	DocumentCheckerCache& cache = currDoc->checkerCache();
+	int printerColorSpace = currDoc->HasCMS ? static_cast<int>(currDoc->DocPrinterProf.colorSpace()) : -1;
+	QMap<QString, int> colorModels;
+	for (auto it = currDoc->PageColors.cbegin(); it != currDoc->PageColors.cend(); ++it)
+		colorModels.insert(it.key(), static_cast<int>(it.value().getColorModel()));
+
+	const CheckerPrefs& s = cache.m_settings;
+	bool sameSettings = (s.checkGlyphs == checkerSettings.checkGlyphs)
+			&& (s.checkOverflow == checkerSettings.checkOverflow)
+			&& (s.checkOrphans == checkerSettings.checkOrphans)
+			&& (s.checkPictures == checkerSettings.checkPictures)
+			&& (s.checkResolution == checkerSettings.checkResolution)
+			&& (s.minResolution == checkerSettings.minResolution)
+			&& (s.maxResolution == checkerSettings.maxResolution)
+			&& (s.checkTransparency == checkerSettings.checkTransparency)
+			&& (s.checkAnnotations == checkerSettings.checkAnnotations)
+			&& (s.checkRasterPDF == checkerSettings.checkRasterPDF)
+			&& (s.checkForGIF == checkerSettings.checkForGIF)
+			&& (s.ignoreOffLayers == checkerSettings.ignoreOffLayers)
+			&& (s.checkNotCMYKOrSpot == checkerSettings.checkNotCMYKOrSpot)
+			&& (s.checkDeviceColorsAndOutputIntent == checkerSettings.checkDeviceColorsAndOutputIntent)
+			&& (s.checkFontNotEmbedded == checkerSettings.checkFontNotEmbedded)
+			&& (s.checkFontIsOpenType == checkerSettings.checkFontIsOpenType)
+			&& (s.checkPartFilledImageFrames == checkerSettings.checkPartFilledImageFrames)
+			&& (s.checkEmptyTextFrames == checkerSettings.checkEmptyTextFrames);
+	if (cache.m_valid && sameSettings && (cache.m_hasCMS == currDoc->HasCMS)
+			&& (cache.m_printerColorSpace == printerColorSpace) && (cache.m_colorModels == colorModels))
+		return;
+
+	// Results of other settings are still reported as changes, so the item list is kept with empty stamps
+	for (auto it = cache.m_items.begin(); it != cache.m_items.end(); ++it)
+		it->stamp = DocumentCheckerCache::ItemStamp();
+	cache.m_valid = true;
+	cache.m_settings = checkerSettings;
+	cache.m_hasCMS = currDoc->HasCMS;
+	cache.m_printerColorSpace = printerColorSpace;
+	cache.m_colorModels = colorModels;
+}
+
 void DocumentChecker::checkItems(ScribusDoc *currDoc, const CheckerPrefs& checkerSettings)
 {
-	errorCodes itemError;
+	validateCache(currDoc, checkerSettings);
+	DocumentCheckerCache& cache = currDoc->checkerCache();
+	QHash<PageItem*, DocumentCheckerCache::ItemResult> previous;
+	previous.swap(cache.m_items);
+	cache.m_changedItems.clear();
+	cache.m_recheckedItems = 0;
 
-	QList<PageItem*> allItems;
-	uint masterItemsCount = currDoc->MasterItems.count();
-	for (uint i = 0; i < masterItemsCount; ++i)
+	// Linked frames share their overflow, so a text frame also depends on the other frames of its chain
+	QHash<PageItem*, QPair<quint64, int> > chainRevisions;
+	auto itemStamp = [&](PageItem* currItem)
 	{
-		PageItem* currItem = currDoc->MasterItems.at(i);
-		if (currItem->isGroup())
-			allItems = currItem->getAllChildren();
-		else
-			allItems.append(currItem);
-		for (int ii = 0; ii < allItems.count(); ii++)
+		DocumentCheckerCache::ItemStamp stamp;
+		stamp.revision = currItem->renderRevision();
+		stamp.ownPage = currItem->OwnPage;
+		stamp.layerPrintable = currDoc->layerPrintable(currItem->m_layerID);
+		if (currItem->isTextFrame() || currItem->isPathText())
 		{
-			currItem = allItems.at(ii);
-			if (!currItem->printEnabled())
-				continue;
-			if (!(currDoc->layerPrintable(currItem->m_layerID)) && (checkerSettings.ignoreOffLayers))
-				continue;
-			itemError.clear();
-			if (((currItem->isAnnotation()) || (currItem->isBookmark)) && (checkerSettings.checkAnnotations))
-				itemError.insert(PDFAnnotField, 0);
-			if (currItem->hasSoftShadow() && checkerSettings.checkTransparency)
-				itemError.insert(Transparency, 0);
-			if ((currItem->GrType == 0) && (checkerSettings.checkTransparency))
+			stamp.textVersion = currItem->itemText.version();
+			stamp.paragraphStylesVersion = currDoc->paragraphStyles().version();
+			stamp.charStylesVersion = currDoc->charStyles().version();
+			stamp.fontGeneration = PrefsManager::instance().appPrefs.fontPrefs.AvailFonts.generation();
+			PageItem* firstItem = currItem->firstInChain();
+			auto chainIt = chainRevisions.constFind(firstItem);
+			if (chainIt == chainRevisions.constEnd())
 			{
-				if (currItem->fillColor() != CommonStrings::None)
+				QPair<quint64, int> chain(0, 0);
+				for (PageItem* chainItem = firstItem; chainItem != nullptr; chainItem = chainItem->nextInChain())
 				{
-					if ((currItem->fillTransparency() != 0.0) || (currItem->fillBlendmode() != 0))
-						itemError.insert(Transparency, 0);
+					chain.first = qMax(chain.first, chainItem->renderRevision());
+					++chain.second;
 				}
+				chainIt = chainRevisions.insert(firstItem, chain);
 			}
-			if ((currItem->GrType != 0) && (checkerSettings.checkTransparency))
+			stamp.chainRevision = chainIt->first;
+			stamp.chainLength = chainIt->second;
+			// The text may flow differently without any change to the chain, e.g. when an
+			// item it wraps around moves, so the results of the last layout count as well
+			stamp.layoutInvalid = currItem->invalid;
+			stamp.overflows = currItem->frameOverflows();
+			stamp.underflows = currItem->frameUnderflows();
+		}
+		if (currItem->isImageFrame())
+		{
+			stamp.imageAvailable = currItem->imageIsAvailable;
+			stamp.imageFile = currItem->Pfile;
+			stamp.imageSize = QSize(currItem->pixm.width(), currItem->pixm.height());
+			// Placed PDFs are analyzed from the file
+			if (!currItem->Pfile.isEmpty())
+				stamp.imageModified = QFileInfo(currItem->Pfile).lastModified().toMSecsSinceEpoch();
+		}
+		return stamp;
+	};
+
+	auto checkItemList = [&](const QList<PageItem*>& items, bool master)
+	{
+		QList<PageItem*> allItems;
+		for (int i = 0; i < items.count(); ++i)
+		{
+			PageItem* currItem = items.at(i);
+			if (currItem->isGroup())
+				allItems = currItem->getAllChildren();
+			else
+				allItems.append(currItem);
+			for (int ii = 0; ii < allItems.count(); ii++)
 			{
-				if (currItem->GrType == Gradient_4Colors)
-				{
-					if (currItem->GrCol1transp != 1.0)
-						itemError.insert(Transparency, 0);
-					else if (currItem->GrCol2transp != 1.0)
-						itemError.insert(Transparency, 0);
-					else if (currItem->GrCol3transp != 1.0)
-						itemError.insert(Transparency, 0);
-					else if (currItem->GrCol4transp != 1.0)
-						itemError.insert(Transparency, 0);
-				}
-				else if (currItem->GrType == Gradient_Mesh)
-				{
-					for (int grow = 0; grow < currItem->meshGradientArray.count(); grow++)
-					{
-						for (int gcol = 0; gcol < currItem->meshGradientArray[grow].count(); gcol++)
-						{
-							if (currItem->meshGradientArray[grow][gcol].transparency != 1.0)
-								itemError.insert(Transparency, 0);
-						}
-					}
-				}
-				else if (currItem->GrType == Gradient_PatchMesh)
-				{
-					for (int grow = 0; grow < currItem->meshGradientPatches.count(); grow++)
-					{
-						meshGradientPatch patch = currItem->meshGradientPatches[grow];
-						if (currItem->meshGradientPatches[grow].TL.transparency != 1.0)
-							itemError.insert(Transparency, 0);
-						if (currItem->meshGradientPatches[grow].TR.transparency != 1.0)
-							itemError.insert(Transparency, 0);
-						if (currItem->meshGradientPatches[grow].BR.transparency != 1.0)
-							itemError.insert(Transparency, 0);
-						if (currItem->meshGradientPatches[grow].BL.transparency != 1.0)
-							itemError.insert(Transparency, 0);
-					}
-				}
+				currItem = allItems.at(ii);
+				if (!currItem->printEnabled())
+					continue;
+				if (!(currDoc->layerPrintable(currItem->m_layerID)) && (checkerSettings.ignoreOffLayers))
+					continue;
+				DocumentCheckerCache::ItemResult result;
+				result.master = master;
+				result.stamp = itemStamp(currItem);
+				auto old = previous.find(currItem);
+				bool known = (old != previous.end());
+				if (known && (old->master == master) && (old->stamp == result.stamp))
+					result.errors = old->errors;
 				else
 				{
-					QList<VColorStop*> colorStops = currItem->fill_gradient.colorStops();
-					for (int offset = 0 ; offset < colorStops.count() ; offset++)
-					{
-						if (colorStops[offset]->opacity != 1.0)
-						{
-							itemError.insert(Transparency, 0);
-							break;
-						}
-					}
+					checkItem(currDoc, checkerSettings, currItem, result.errors);
+					// Checking may lay out the text, which must not count as a change next time
+					result.stamp = itemStamp(currItem);
+					++cache.m_recheckedItems;
 				}
-			}
-			if ((currItem->GrTypeStroke == 0) && (checkerSettings.checkTransparency))
-			{
-				if ((currItem->lineColor() != CommonStrings::None) || !currItem->NamedLStyle.isEmpty())
+				if (known ? ((old->errors != result.errors) || (old->master != master)) : !result.errors.isEmpty())
+					cache.m_changedItems.append(currItem);
+				if (known)
+					previous.erase(old);
+				if (result.errors.count() != 0)
 				{
-					if ((currItem->lineTransparency() != 0.0) || (currItem->lineBlendmode() != 0))
-						itemError.insert(Transparency, 0);
+					if (master)
+						currDoc->masterItemErrors.insert(currItem, result.errors);
+					else
+						currDoc->docItemErrors.insert(currItem, result.errors);
 				}
+				cache.m_items.insert(currItem, result);
 			}
-			if ((currItem->GrTypeStroke != 0) && (checkerSettings.checkTransparency))
-			{
-				QList<VColorStop*> colorStops = currItem->stroke_gradient.colorStops();
-				for (int offset = 0 ; offset < colorStops.count() ; offset++)
-				{
-					if (colorStops[offset]->opacity != 1.0)
-					{
-						itemError.insert(Transparency, 0);
-						break;
-					}
-				}
-			}
-			if ((currItem->GrMask > 0) && (checkerSettings.checkTransparency))
-				itemError.insert(Transparency, 0);
-			if ((currItem->OwnPage == -1) && (checkerSettings.checkOrphans))
-				itemError.insert(ObjectNotOnPage, 0);
-			if (currItem->isImageFrame() && !currItem->isOSGFrame())
-			{
-				// check image vs. frame sizes
-				if (checkerSettings.checkPartFilledImageFrames && isPartFilledImageFrame(currItem))
-				{
-					itemError.insert(PartFilledImageFrame, 0);
-				}
+			allItems.clear();
+		}
+	};
 
-				if ((!currItem->imageIsAvailable) && (checkerSettings.checkPictures))
-					itemError.insert(MissingImage, 0);
-				else
-				{
-					if (currItem->imageIsAvailable)
-					{
-						if (checkerSettings.checkTransparency && currItem->pixm.hasSmoothAlpha())
-							itemError.insert(Transparency, 0);
-					}
-					if  (((qRound(72.0 / currItem->imageXScale()) < checkerSettings.minResolution) || (qRound(72.0 / currItem->imageYScale()) < checkerSettings.minResolution))
-							&& (currItem->isRaster) && (checkerSettings.checkResolution))
-						itemError.insert(ImageDPITooLow, 0);
-					if  (((qRound(72.0 / currItem->imageXScale()) > checkerSettings.maxResolution) || (qRound(72.0 / currItem->imageYScale()) > checkerSettings.maxResolution))
-							&& (currItem->isRaster) && (checkerSettings.checkResolution))
-						itemError.insert(ImageDPITooHigh, 0);
-					QFileInfo fi = QFileInfo(currItem->Pfile);
-					QString ext = fi.suffix().toLower();
-					if (extensionIndicatesPDF(ext) && (checkerSettings.checkRasterPDF))
-						itemError.insert(PlacedPDF, 0);
-					if ((ext == "gif") && (checkerSettings.checkForGIF))
-						itemError.insert(ImageIsGIF, 0);
-
-					if (extensionIndicatesPDF(ext))
-					{
-						PDFAnalyzer analyst(currItem->Pfile);
-						QList<PDFColorSpace> usedColorSpaces;
-						bool hasTransparency = false;
-						QList<PDFFont> usedFonts;
-						int pageNum = qMin(qMax(1, currItem->pixm.imgInfo.actualPageNumber), currItem->pixm.imgInfo.numberOfPages) - 1;
-						QList<PDFImage> imgs;
-						bool succeeded = analyst.inspectPDF(pageNum, usedColorSpaces, hasTransparency, usedFonts, imgs);
-						if (succeeded)
-						{
-							if (checkerSettings.checkNotCMYKOrSpot || checkerSettings.checkDeviceColorsAndOutputIntent)
-							{
-								eColorSpaceType currPrintProfCS = ColorSpace_Unknown;
-								if (currDoc->HasCMS)
-								{
-									ScColorProfile printerProf = currDoc->DocPrinterProf;
-									currPrintProfCS = printerProf.colorSpace();
-								}
-								if (checkerSettings.checkNotCMYKOrSpot)
-								{
-									for (int i=0; i<usedColorSpaces.size(); ++i)
-									{
-										if (usedColorSpaces[i] == CS_DeviceRGB || usedColorSpaces[i] == CS_ICCBased || usedColorSpaces[i] == CS_CalGray
-											|| usedColorSpaces[i] == CS_CalRGB || usedColorSpaces[i] == CS_Lab)
-										{
-											itemError.insert(NotCMYKOrSpot, 0);
-											break;
-										}
-									}
-								}
-								if (checkerSettings.checkDeviceColorsAndOutputIntent && currDoc->HasCMS)
-								{
-									for (int i=0; i<usedColorSpaces.size(); ++i)
-									{
-										if (currPrintProfCS == ColorSpace_Cmyk && (usedColorSpaces[i] == CS_DeviceRGB || usedColorSpaces[i] == CS_DeviceGray))
-										{
-											itemError.insert(DeviceColorsAndOutputIntent, 0);
-											break;
-										}
-										if (currPrintProfCS == ColorSpace_Rgb && (usedColorSpaces[i] == CS_DeviceCMYK || usedColorSpaces[i] == CS_DeviceGray))
-										{
-											itemError.insert(DeviceColorsAndOutputIntent, 0);
-											break;
-										}
-									}
-								}
-							}
-							if (checkerSettings.checkTransparency && hasTransparency)
-								itemError.insert(Transparency, 0);
-							if (checkerSettings.checkFontNotEmbedded || checkerSettings.checkFontIsOpenType)
-							{
-								for (int i=0; i<usedFonts.size(); ++i)
-								{
-									PDFFont currentFont = usedFonts[i];
-									if (!currentFont.isEmbedded && checkerSettings.checkFontNotEmbedded)
-										itemError.insert(FontNotEmbedded, 0);
-									if (currentFont.isEmbedded && currentFont.isOpenType && checkerSettings.checkFontIsOpenType)
-										itemError.insert(EmbeddedFontIsOpenType, 0);
-								}
-							}
-							if (checkerSettings.checkResolution)
-							{
-								for (int i=0; i<imgs.size(); ++i)
-								{
-									if ((imgs[i].dpiX < checkerSettings.minResolution) || (imgs[i].dpiY < checkerSettings.minResolution))
-										itemError.insert(ImageDPITooLow, 0);
-									if ((imgs[i].dpiX > checkerSettings.maxResolution) || (imgs[i].dpiY > checkerSettings.maxResolution))
-										itemError.insert(ImageDPITooHigh, 0);
-								}
-							}
-						}
-					}
-				}
-			}
-			if ((currItem->isTextFrame()) || (currItem->isPathText()))
-			{
-				if ( currItem->frameOverflows() && (checkerSettings.checkOverflow) && (!((currItem->isAnnotation()) && ((currItem->annotation().Type() == Annotation::Combobox) || (currItem->annotation().Type() == Annotation::Listbox)))))
-					itemError.insert(TextOverflow, 0);
+	checkItemList(currDoc->MasterItems, true);
+	checkItemList(currDoc->DocItems, false);
 
-				if (checkerSettings.checkEmptyTextFrames && (currItem->itemText.length() == 0 || currItem->frameUnderflows()))
-				{
-					bool isEmptyAnnotation = (currItem->isAnnotation() && 
-					                         ((currItem->annotation().Type() == Annotation::Link) ||
-					                          (currItem->annotation().Type() == Annotation::Checkbox) ||
-					                          (currItem->annotation().Type() == Annotation::RadioButton)));
-					if (!isEmptyAnnotation)
-						itemError.insert(EmptyTextFrame, 0);
-				}
-				
-				if (currItem->isAnnotation())
-				{
-					ScFace::FontFormat fformat = currItem->itemText.defaultStyle().charStyle().font().format();
-					if (!(fformat == ScFace::SFNT || fformat == ScFace::TTCF))
-						itemError.insert(WrongFontInAnnotation, 0);
-				}
+	// Items which were deleted or are not checked anymore lose their errors
+	for (auto it = previous.cbegin(); it != previous.cend(); ++it)
+	{
+		if (!it->errors.isEmpty())
+			cache.m_changedItems.append(it.key());
+	}
+}
 
-				if (checkerSettings.checkGlyphs)
-				{
-					if (currItem->invalid)
-						currItem->layout();
-					MissingGlyphsPainter p(itemError, currItem->textLayout);
-					currItem->textLayout.render(&p);
-				}
-			}
-			if (((currItem->fillColor() != CommonStrings::None) || (currItem->lineColor() != CommonStrings::None)) && (checkerSettings.checkNotCMYKOrSpot))
-			{
-				bool rgbUsed = false;
-				if ((currItem->fillColor() != CommonStrings::None))
-				{
-					ScColor tmpC = currDoc->PageColors[currItem->fillColor()];
-					if (tmpC.getColorModel() == colorModelRGB)
-						rgbUsed = true;
-				}
-				if ((currItem->lineColor() != CommonStrings::None))
-				{
-					ScColor tmpC = currDoc->PageColors[currItem->lineColor()];
-					if (tmpC.getColorModel() == colorModelRGB)
-						rgbUsed = true;
-				}
-				if (rgbUsed)
-					itemError.insert(NotCMYKOrSpot, 0);
-			}
-			if (itemError.count() != 0)
-				currDoc->masterItemErrors.insert(currItem, itemError);
+void DocumentChecker::checkItem(ScribusDoc *currDoc, const CheckerPrefs& checkerSettings, PageItem* currItem, errorCodes& itemError)
+{
+	if (currItem->hasSoftShadow() && checkerSettings.checkTransparency)
+		itemError.insert(Transparency, 0);
+	if ((currItem->GrType == 0) && (checkerSettings.checkTransparency))
+	{
+		if (currItem->fillColor() != CommonStrings::None)
+		{
+			if ((currItem->fillTransparency() != 0.0) || (currItem->fillBlendmode() != 0))
+				itemError.insert(Transparency, 0);
 		}
-		allItems.clear();
 	}
-	allItems.clear();
-	uint docItemsCount = currDoc->DocItems.count();
-	for (uint i = 0; i < docItemsCount; ++i)
+	if ((currItem->GrType != 0) && (checkerSettings.checkTransparency))
 	{
-		PageItem* currItem = currDoc->DocItems.at(i);
-		if (currItem->isGroup())
-			allItems = currItem->getAllChildren();
-		else
-			allItems.append(currItem);
-		for (int ii = 0; ii < allItems.count(); ii++)
+		if (currItem->GrType == Gradient_4Colors)
 		{
-			currItem = allItems.at(ii);
-			if (!currItem->printEnabled())
-				continue;
-			if (!(currDoc->layerPrintable(currItem->m_layerID)) && (checkerSettings.ignoreOffLayers))
-				continue;
-			itemError.clear();
-			if (currItem->hasSoftShadow() && checkerSettings.checkTransparency)
+			if (currItem->GrCol1transp != 1.0)
 				itemError.insert(Transparency, 0);
-			if ((currItem->GrType == 0) && (checkerSettings.checkTransparency))
-			{
-				if (currItem->fillColor() != CommonStrings::None)
-				{
-					if ((currItem->fillTransparency() != 0.0) || (currItem->fillBlendmode() != 0))
-						itemError.insert(Transparency, 0);
-				}
-			}
-			if ((currItem->GrType != 0) && (checkerSettings.checkTransparency))
+			else if (currItem->GrCol2transp != 1.0)
+				itemError.insert(Transparency, 0);
+			else if (currItem->GrCol3transp != 1.0)
+				itemError.insert(Transparency, 0);
+			else if (currItem->GrCol4transp != 1.0)
+				itemError.insert(Transparency, 0);
+		}
+		else if (currItem->GrType == Gradient_Mesh)
+		{
+			for (int grow = 0; grow < currItem->meshGradientArray.count(); grow++)
 			{
-				if (currItem->GrType == Gradient_4Colors)
+				for (int gcol = 0; gcol < currItem->meshGradientArray[grow].count(); gcol++)
 				{
-					if (currItem->GrCol1transp != 1.0)
-						itemError.insert(Transparency, 0);
-					else if (currItem->GrCol2transp != 1.0)
-						itemError.insert(Transparency, 0);
-					else if (currItem->GrCol3transp != 1.0)
+					if (currItem->meshGradientArray[grow][gcol].transparency != 1.0)
 						itemError.insert(Transparency, 0);
-					else if (currItem->GrCol4transp != 1.0)
-						itemError.insert(Transparency, 0);
-				}
-				else if (currItem->GrType == Gradient_Mesh)
-				{
-					for (int grow = 0; grow < currItem->meshGradientArray.count(); grow++)
-					{
-						for (int gcol = 0; gcol < currItem->meshGradientArray[grow].count(); gcol++)
-						{
-							if (currItem->meshGradientArray[grow][gcol].transparency != 1.0)
-								itemError.insert(Transparency, 0);
-						}
-					}
-				}
-				else if (currItem->GrType == Gradient_PatchMesh)
-				{
-					for (int grow = 0; grow < currItem->meshGradientPatches.count(); grow++)
-					{
-						meshGradientPatch patch = currItem->meshGradientPatches[grow];
-						if (currItem->meshGradientPatches[grow].TL.transparency != 1.0)
-							itemError.insert(Transparency, 0);
-						if (currItem->meshGradientPatches[grow].TR.transparency != 1.0)
-							itemError.insert(Transparency, 0);
-						if (currItem->meshGradientPatches[grow].BR.transparency != 1.0)
-							itemError.insert(Transparency, 0);
-						if (currItem->meshGradientPatches[grow].BL.transparency != 1.0)
-							itemError.insert(Transparency, 0);
-					}
-				}
-				else
-				{
-					QList<VColorStop*> colorStops = currItem->fill_gradient.colorStops();
-					for (int offset = 0 ; offset < colorStops.count() ; offset++)
-					{
-						if (colorStops[offset]->opacity != 1.0)
-						{
-							itemError.insert(Transparency, 0);
-							break;
-						}
-					}
 				}
 			}
-			if ((currItem->GrTypeStroke == 0) && (checkerSettings.checkTransparency))
+		}
+		else if (currItem->GrType == Gradient_PatchMesh)
+		{
+			for (int grow = 0; grow < currItem->meshGradientPatches.count(); grow++)
 			{
-				if ((currItem->lineColor() != CommonStrings::None) || !currItem->NamedLStyle.isEmpty())
-				{
-					if ((currItem->lineTransparency() != 0.0) || (currItem->lineBlendmode() != 0))
-						itemError.insert(Transparency, 0);
-				}
+				meshGradientPatch patch = currItem->meshGradientPatches[grow];
+				if (currItem->meshGradientPatches[grow].TL.transparency != 1.0)
+					itemError.insert(Transparency, 0);
+				if (currItem->meshGradientPatches[grow].TR.transparency != 1.0)
+					itemError.insert(Transparency, 0);
+				if (currItem->meshGradientPatches[grow].BR.transparency != 1.0)
+					itemError.insert(Transparency, 0);
+				if (currItem->meshGradientPatches[grow].BL.transparency != 1.0)
+					itemError.insert(Transparency, 0);
 			}
-			if ((currItem->GrTypeStroke != 0) && (checkerSettings.checkTransparency))
+		}
+		else
+		{
+			QList<VColorStop*> colorStops = currItem->fill_gradient.colorStops();
+			for (int offset = 0 ; offset < colorStops.count() ; offset++)
 			{
-				QList<VColorStop*> colorStops = currItem->stroke_gradient.colorStops();
-				for (int offset = 0 ; offset < colorStops.count() ; offset++)
+				if (colorStops[offset]->opacity != 1.0)
 				{
-					if (colorStops[offset]->opacity != 1.0)
-					{
-						itemError.insert(Transparency, 0);
-						break;
-					}
+					itemError.insert(Transparency, 0);
+					break;
 				}
 			}
-			if ((currItem->GrMask > 0) && (checkerSettings.checkTransparency))
+		}
+	}
+	if ((currItem->GrTypeStroke == 0) && (checkerSettings.checkTransparency))
+	{
+		if ((currItem->lineColor() != CommonStrings::None) || !currItem->NamedLStyle.isEmpty())
+		{
+			if ((currItem->lineTransparency() != 0.0) || (currItem->lineBlendmode() != 0))
 				itemError.insert(Transparency, 0);
-			if (((currItem->isAnnotation()) || (currItem->isBookmark)) && (checkerSettings.checkAnnotations))
-				itemError.insert(PDFAnnotField, 0);
-			if ((currItem->OwnPage == -1) && (checkerSettings.checkOrphans))
-				itemError.insert(ObjectNotOnPage, 0);
-			if (currItem->isImageFrame() && !currItem->isOSGFrame())
+		}
+	}
+	if ((currItem->GrTypeStroke != 0) && (checkerSettings.checkTransparency))
+	{
+		QList<VColorStop*> colorStops = currItem->stroke_gradient.colorStops();
+		for (int offset = 0 ; offset < colorStops.count() ; offset++)
+		{
+			if (colorStops[offset]->opacity != 1.0)
 			{
+				itemError.insert(Transparency, 0);
+				break;
+			}
+		}
+	}
+	if ((currItem->GrMask > 0) && (checkerSettings.checkTransparency))
+		itemError.insert(Transparency, 0);
+	if (((currItem->isAnnotation()) || (currItem->isBookmark)) && (checkerSettings.checkAnnotations))
+		itemError.insert(PDFAnnotField, 0);
+	if ((currItem->OwnPage == -1) && (checkerSettings.checkOrphans))
+		itemError.insert(ObjectNotOnPage, 0);
+	if (currItem->isImageFrame() && !currItem->isOSGFrame())
+	{
 
-				// check image vs. frame sizes
-				if (checkerSettings.checkPartFilledImageFrames && isPartFilledImageFrame(currItem))
-				{
-					itemError.insert(PartFilledImageFrame, 0);
-				}
+		// check image vs. frame sizes
+		if (checkerSettings.checkPartFilledImageFrames && isPartFilledImageFrame(currItem))
+		{
+			itemError.insert(PartFilledImageFrame, 0);
+		}
 
-				if ((!currItem->imageIsAvailable) && (checkerSettings.checkPictures))
-					itemError.insert(MissingImage, 0);
-				else
+		if ((!currItem->imageIsAvailable) && (checkerSettings.checkPictures))
+			itemError.insert(MissingImage, 0);
+		else
+		{
+			if (currItem->imageIsAvailable)
+			{
+				if (checkerSettings.checkTransparency && currItem->pixm.hasSmoothAlpha())
+					itemError.insert(Transparency, 0);
+			}
+			if  (((qRound(72.0 / currItem->imageXScale()) < checkerSettings.minResolution) || (qRound(72.0 / currItem->imageYScale()) < checkerSettings.minResolution))
+					&& (currItem->isRaster) && (checkerSettings.checkResolution))
+				itemError.insert(ImageDPITooLow, 0);
+			if  (((qRound(72.0 / currItem->imageXScale()) > checkerSettings.maxResolution) || (qRound(72.0 / currItem->imageYScale()) > checkerSettings.maxResolution))
+					&& (currItem->isRaster) && (checkerSettings.checkResolution))
+				itemError.insert(ImageDPITooHigh, 0);
+			QFileInfo fi = QFileInfo(currItem->Pfile);
+			QString ext = fi.suffix().toLower();
+			if (extensionIndicatesPDF(ext) && (checkerSettings.checkRasterPDF))
+				itemError.insert(PlacedPDF, 0);
+			if ((ext == "gif") && (checkerSettings.checkForGIF))
+				itemError.insert(ImageIsGIF, 0);
+
+			if (extensionIndicatesPDF(ext))
+			{
+				PDFAnalyzer analyst(currItem->Pfile);
+				QList<PDFColorSpace> usedColorSpaces;
+				bool hasTransparency = false;
+				QList<PDFFont> usedFonts;
+				int pageNum = qMin(qMax(1, currItem->pixm.imgInfo.actualPageNumber), currItem->pixm.imgInfo.numberOfPages) - 1;
+				QList<PDFImage> imgs;
+				bool succeeded = analyst.inspectPDF(pageNum, usedColorSpaces, hasTransparency, usedFonts, imgs);
+				if (succeeded)
 				{
-					if (currItem->imageIsAvailable)
-					{
-						if (checkerSettings.checkTransparency && currItem->pixm.hasSmoothAlpha())
-							itemError.insert(Transparency, 0);
-					}
-					if  (((qRound(72.0 / currItem->imageXScale()) < checkerSettings.minResolution) || (qRound(72.0 / currItem->imageYScale()) < checkerSettings.minResolution))
-							&& (currItem->isRaster) && (checkerSettings.checkResolution))
-						itemError.insert(ImageDPITooLow, 0);
-					if  (((qRound(72.0 / currItem->imageXScale()) > checkerSettings.maxResolution) || (qRound(72.0 / currItem->imageYScale()) > checkerSettings.maxResolution))
-							&& (currItem->isRaster) && (checkerSettings.checkResolution))
-						itemError.insert(ImageDPITooHigh, 0);
-					QFileInfo fi = QFileInfo(currItem->Pfile);
-					QString ext = fi.suffix().toLower();
-					if (extensionIndicatesPDF(ext) && (checkerSettings.checkRasterPDF))
-						itemError.insert(PlacedPDF, 0);
-					if ((ext == "gif") && (checkerSettings.checkForGIF))
-						itemError.insert(ImageIsGIF, 0);
-
-					if (extensionIndicatesPDF(ext))
+					if (checkerSettings.checkNotCMYKOrSpot || checkerSettings.checkDeviceColorsAndOutputIntent)
 					{
-						PDFAnalyzer analyst(currItem->Pfile);
-						QList<PDFColorSpace> usedColorSpaces;
-						bool hasTransparency = false;
-						QList<PDFFont> usedFonts;
-						int pageNum = qMin(qMax(1, currItem->pixm.imgInfo.actualPageNumber), currItem->pixm.imgInfo.numberOfPages) - 1;
-						QList<PDFImage> imgs;
-						bool succeeded = analyst.inspectPDF(pageNum, usedColorSpaces, hasTransparency, usedFonts, imgs);
-						if (succeeded)
+						int currPrintProfCS = -1;
+						if (currDoc->HasCMS)
 						{
-							if (checkerSettings.checkNotCMYKOrSpot || checkerSettings.checkDeviceColorsAndOutputIntent)
+							ScColorProfile printerProf = currDoc->DocPrinterProf;
+							currPrintProfCS = static_cast<int>(printerProf.colorSpace());
+						}
+						if (checkerSettings.checkNotCMYKOrSpot)
+						{
+							for (int i=0; i<usedColorSpaces.size(); ++i)
 							{
-								int currPrintProfCS = -1;
-								if (currDoc->HasCMS)
-								{
-									ScColorProfile printerProf = currDoc->DocPrinterProf;
-									currPrintProfCS = static_cast<int>(printerProf.colorSpace());
-								}
-								if (checkerSettings.checkNotCMYKOrSpot)
+								if (usedColorSpaces[i] == CS_DeviceRGB || usedColorSpaces[i] == CS_ICCBased || usedColorSpaces[i] == CS_CalGray
+									|| usedColorSpaces[i] == CS_CalRGB || usedColorSpaces[i] == CS_Lab)
 								{
-									for (int i=0; i<usedColorSpaces.size(); ++i)
-									{
-										if (usedColorSpaces[i] == CS_DeviceRGB || usedColorSpaces[i] == CS_ICCBased || usedColorSpaces[i] == CS_CalGray
-											|| usedColorSpaces[i] == CS_CalRGB || usedColorSpaces[i] == CS_Lab)
-										{
-											itemError.insert(NotCMYKOrSpot, 0);
-											break;
-										}
-									}
-								}
-								if (checkerSettings.checkDeviceColorsAndOutputIntent && currDoc->HasCMS)
-								{
-									for (int i=0; i<usedColorSpaces.size(); ++i)
-									{
-										if (currPrintProfCS == ColorSpace_Cmyk && (usedColorSpaces[i] == CS_DeviceRGB || usedColorSpaces[i] == CS_DeviceGray))
-										{
-											itemError.insert(DeviceColorsAndOutputIntent, 0);
-											break;
-										}
-										if (currPrintProfCS == ColorSpace_Rgb && (usedColorSpaces[i] == CS_DeviceCMYK || usedColorSpaces[i] == CS_DeviceGray))
-										{
-											itemError.insert(DeviceColorsAndOutputIntent, 0);
-											break;
-										}
-									}
+									itemError.insert(NotCMYKOrSpot, 0);
+									break;
 								}
 							}
-							if (checkerSettings.checkTransparency && hasTransparency)
-								itemError.insert(Transparency, 0);
-							if (checkerSettings.checkFontNotEmbedded || checkerSettings.checkFontIsOpenType)
+						}
+						if (checkerSettings.checkDeviceColorsAndOutputIntent && currDoc->HasCMS)
+						{
+							for (int i=0; i<usedColorSpaces.size(); ++i)
 							{
-								for (int i=0; i<usedFonts.size(); ++i)
+								if (currPrintProfCS == ColorSpace_Cmyk && (usedColorSpaces[i] == CS_DeviceRGB || usedColorSpaces[i] == CS_DeviceGray))
 								{
-									PDFFont currentFont = usedFonts[i];
-									if (!currentFont.isEmbedded && checkerSettings.checkFontNotEmbedded)
-										itemError.insert(FontNotEmbedded, 0);
-									if (currentFont.isEmbedded && currentFont.isOpenType && checkerSettings.checkFontIsOpenType)
-										itemError.insert(EmbeddedFontIsOpenType, 0);
+									itemError.insert(DeviceColorsAndOutputIntent, 0);
+									break;
 								}
-							}
-							if (checkerSettings.checkResolution)
-							{
-								for (int i=0; i<imgs.size(); ++i)
+								if (currPrintProfCS == ColorSpace_Rgb && (usedColorSpaces[i] == CS_DeviceCMYK || usedColorSpaces[i] == CS_DeviceGray))
 								{
-									if ((imgs[i].dpiX < checkerSettings.minResolution) || (imgs[i].dpiY < checkerSettings.minResolution))
-										itemError.insert(ImageDPITooLow, 0);
-									if ((imgs[i].dpiX > checkerSettings.maxResolution) || (imgs[i].dpiY > checkerSettings.maxResolution))
-										itemError.insert(ImageDPITooHigh, 0);
+									itemError.insert(DeviceColorsAndOutputIntent, 0);
+									break;
 								}
 							}
 						}
 					}
+					if (checkerSettings.checkTransparency && hasTransparency)
+						itemError.insert(Transparency, 0);
+					if (checkerSettings.checkFontNotEmbedded || checkerSettings.checkFontIsOpenType)
+					{
+						for (int i=0; i<usedFonts.size(); ++i)
+						{
+							PDFFont currentFont = usedFonts[i];
+							if (!currentFont.isEmbedded && checkerSettings.checkFontNotEmbedded)
+								itemError.insert(FontNotEmbedded, 0);
+							if (currentFont.isEmbedded && currentFont.isOpenType && checkerSettings.checkFontIsOpenType)
+								itemError.insert(EmbeddedFontIsOpenType, 0);
+						}
+					}
+					if (checkerSettings.checkResolution)
+					{
+						for (int i=0; i<imgs.size(); ++i)
+						{
+							if ((imgs[i].dpiX < checkerSettings.minResolution) || (imgs[i].dpiY < checkerSettings.minResolution))
+								itemError.insert(ImageDPITooLow, 0);
+							if ((imgs[i].dpiX > checkerSettings.maxResolution) || (imgs[i].dpiY > checkerSettings.maxResolution))
+								itemError.insert(ImageDPITooHigh, 0);
+						}
+					}
 				}
 			}
-			if ((currItem->isTextFrame()) || (currItem->isPathText()))
-			{
-				if ( currItem->frameOverflows() && (checkerSettings.checkOverflow) && (!((currItem->isAnnotation()) && ((currItem->annotation().Type() == Annotation::Combobox) || (currItem->annotation().Type() == Annotation::Listbox)))))
-					itemError.insert(TextOverflow, 0);
+		}
+	}
+	if ((currItem->isTextFrame()) || (currItem->isPathText()))
+	{
+		if ( currItem->frameOverflows() && (checkerSettings.checkOverflow) && (!((currItem->isAnnotation()) && ((currItem->annotation().Type() == Annotation::Combobox) || (currItem->annotation().Type() == Annotation::Listbox)))))
+			itemError.insert(TextOverflow, 0);
 
-				if (checkerSettings.checkEmptyTextFrames && (currItem->itemText.length()==0 || currItem->frameUnderflows()))
-				{
-					bool isEmptyAnnotation = (currItem->isAnnotation() && 
-					                         ((currItem->annotation().Type() == Annotation::Link) ||
-					                          (currItem->annotation().Type() == Annotation::Checkbox) ||
-					                          (currItem->annotation().Type() == Annotation::RadioButton)));
-					if (!isEmptyAnnotation)
-						itemError.insert(EmptyTextFrame, 0);
-				}
+		if (checkerSettings.checkEmptyTextFrames && (currItem->itemText.length()==0 || currItem->frameUnderflows()))
+		{
+			bool isEmptyAnnotation = (currItem->isAnnotation() && 
+			                         ((currItem->annotation().Type() == Annotation::Link) ||
+			                          (currItem->annotation().Type() == Annotation::Checkbox) ||
+			                          (currItem->annotation().Type() == Annotation::RadioButton)));
+			if (!isEmptyAnnotation)
+				itemError.insert(EmptyTextFrame, 0);
+		}
 
-				if (currItem->isAnnotation())
-				{
-					ScFace::FontFormat fformat = currItem->itemText.defaultStyle().charStyle().font().format();
-					if (!(fformat == ScFace::SFNT || fformat == ScFace::TTCF))
-						itemError.insert(WrongFontInAnnotation, 0);
-				}
-				if (checkerSettings.checkGlyphs)
-				{
-					if (currItem->invalid)
-						currItem->layout();
-					MissingGlyphsPainter p(itemError, currItem->textLayout);
-					currItem->textLayout.render(&p);
-				}
-			}
-			if (((currItem->fillColor() != CommonStrings::None) || (currItem->lineColor() != CommonStrings::None)) && (checkerSettings.checkNotCMYKOrSpot))
-			{
-				bool rgbUsed = false;
-				if ((currItem->fillColor() != CommonStrings::None))
-				{
-					ScColor tmpC = currDoc->PageColors[currItem->fillColor()];
-					if (tmpC.getColorModel() == colorModelRGB)
-						rgbUsed = true;
-				}
-				if ((currItem->lineColor() != CommonStrings::None))
-				{
-					ScColor tmpC = currDoc->PageColors[currItem->lineColor()];
-					if (tmpC.getColorModel() == colorModelRGB)
-						rgbUsed = true;
-				}
-				if (rgbUsed)
-					itemError.insert(NotCMYKOrSpot, 0);
-			}
-			if (itemError.count() != 0)
-				currDoc->docItemErrors.insert(currItem, itemError);
+		if (currItem->isAnnotation())
+		{
+			ScFace::FontFormat fformat = currItem->itemText.defaultStyle().charStyle().font().format();
+			if (!(fformat == ScFace::SFNT || fformat == ScFace::TTCF))
+				itemError.insert(WrongFontInAnnotation, 0);
+		}
+		if (checkerSettings.checkGlyphs)
+		{
+			if (currItem->invalid)
+				currItem->layout();
+			MissingGlyphsPainter p(itemError, currItem->textLayout);
+			currItem->textLayout.render(&p);
+		}
+	}
+	if (((currItem->fillColor() != CommonStrings::None) || (currItem->lineColor() != CommonStrings::None)) && (checkerSettings.checkNotCMYKOrSpot))
+	{
+		bool rgbUsed = false;
+		if ((currItem->fillColor() != CommonStrings::None))
+		{
+			ScColor tmpC = currDoc->PageColors[currItem->fillColor()];
+			if (tmpC.getColorModel() == colorModelRGB)
+				rgbUsed = true;
+		}
+		if ((currItem->lineColor() != CommonStrings::None))
+		{
+			ScColor tmpC = currDoc->PageColors[currItem->lineColor()];
+			if (tmpC.getColorModel() == colorModelRGB)
+				rgbUsed = true;
 		}
-		allItems.clear();
+		if (rgbUsed)
+			itemError.insert(NotCMYKOrSpot, 0);
 	}
 }
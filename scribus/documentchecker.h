@@ -24,13 +24,89 @@ for which a new license (GPL+exception) is in place.
 #ifndef DOCUMENTCHECKER_H
 #define DOCUMENTCHECKER_H
 
+#include <QHash>
+#include <QList>
+#include <QMap>
+#include <QSize>
 #include <QString>
 
 #include "scribusapi.h"
 #include "prefsstructs.h"
+#include "scribusstructs.h"
 
+class PageItem;
 class ScribusDoc;
 
+/*! \brief Results of the previous check of a document.
+Items are only checked again if they were changed since, as told by their
+render revision, their text, the document styles and fonts their text
+uses, and their image. Changed checker settings,
+colors or color management drop all results. After each check the cache
+also tells which errors changed, so that views can update just these.
+*/
+class SCRIBUS_API DocumentCheckerCache
+{
+	friend class DocumentChecker;
+
+	public:
+		//! Items whose errors appeared, changed or vanished in the last check. Removed items are included but must not be dereferenced.
+		const QList<PageItem*>& changedItems() const { return m_changedItems; }
+		bool pageErrorsChanged() const { return m_pageErrorsChanged; }
+		bool layerErrorsChanged() const { return m_layerErrorsChanged; }
+		//! Whether the last check changed any error at all
+		bool hasChanges() const { return m_pageErrorsChanged || m_layerErrorsChanged || !m_changedItems.isEmpty(); }
+		//! Number of items the last check had to check again
+		int recheckedItems() const { return m_recheckedItems; }
+		//! Drops all results, the next check checks every item
+		void clear();
+
+		//! Everything the errors of an item depend on, besides the document wide settings
+		struct ItemStamp
+		{
+			quint64 revision { 0 };
+			quint64 chainRevision { 0 };
+			int chainLength { 0 };
+			uint textVersion { 0 };
+			//! Text is checked with the document styles and the fonts as they were
+			int paragraphStylesVersion { 0 };
+			int charStylesVersion { 0 };
+			uint fontGeneration { 0 };
+			bool layoutInvalid { false };
+			bool overflows { false };
+			bool underflows { false };
+			int ownPage { 0 };
+			bool layerPrintable { false };
+			bool imageAvailable { false };
+			QString imageFile;
+			qint64 imageModified { 0 };
+			QSize imageSize;
+
+			bool operator==(const ItemStamp& other) const;
+			bool operator!=(const ItemStamp& other) const { return !(*this == other); }
+		};
+
+	private:
+
+		struct ItemResult
+		{
+			ItemStamp stamp;
+			errorCodes errors;
+			bool master { false };
+		};
+
+		QHash<PageItem*, ItemResult> m_items;
+		bool m_valid { false };
+		CheckerPrefs m_settings;
+		bool m_hasCMS { false };
+		int m_printerColorSpace { -1 };
+		QMap<QString, int> m_colorModels;
+
+		QList<PageItem*> m_changedItems;
+		bool m_pageErrorsChanged { false };
+		bool m_layerErrorsChanged { false };
+		int m_recheckedItems { 0 };
+};
+
 /*! \brief It create a error/warning list for CheckDocument GUI class.
 All errors and/or warnings are stored in errorCodes (inherited QMap
 see scribusstructs.h) and parsed into tree view in CheckDocument widgets.
@@ -45,6 +121,12 @@ class SCRIBUS_API DocumentChecker
 		static void checkPages(ScribusDoc *currDoc, const CheckerPrefs& checkerSettings);
 		static void checkLayers(ScribusDoc *currDoc, const CheckerPrefs& checkerSettings);
 		static void checkItems(ScribusDoc *currDoc, const CheckerPrefs& checkerSettings);
+		//! Check a single item, the found errors are added to itemError
+		static void checkItem(ScribusDoc *currDoc, const CheckerPrefs& checkerSettings, PageItem* currItem, errorCodes& itemError);
+
+	private:
+		//! Drops the results of the cache if they were made with other settings than the current ones
+		static void validateCache(ScribusDoc *currDoc, const CheckerPrefs& checkerSettings);
 };
 
 #endif
@@ -0,0 +1,175 @@
+/*
+For general Scribus (>=1.3.2) copyright and licensing information please refer
+to the COPYING file provided with the program. Following this notice may exist
+a copyright and/or license notice that predates the release of Scribus 1.3.2
+for which a new license (GPL+exception) is in place.
+*/
+
+#include <QByteArray>
+#include <QDataStream>
+#include <QDir>
+#include <QFile>
+#include <QSaveFile>
+
+#include "scfontindex.h"
+
+static const quint32 indexMagic = 0x53434649; // "SCFI"
+static const quint32 indexVersion = 1;
+
+// Strings are stored as UTF-8, which halves the size of the mostly ASCII paths and names
+static void writeString(QDataStream& s, const QString& str)
+{
+	s << str.toUtf8();
+}
+
+static QString readString(QDataStream& s)
+{
+	QByteArray bytes;
+	s >> bytes;
+	return QString::fromUtf8(bytes);
+}
+
+bool ScFontIndexFace::operator==(const ScFontIndexFace& other) const
+{
+	return family == other.family && style == other.style && psName == other.psName
+		&& faceIndex == other.faceIndex && type == other.type && hasGlyphNames == other.hasGlyphNames
+		&& subset == other.subset && features == other.features;
+}
+
+bool ScFontIndexEntry::operator==(const ScFontIndexEntry& other) const
+{
+	return size == other.size && modified == other.modified && isOK == other.isOK && format == other.format
+		&& error == other.error && facesKnown == other.facesKnown && faces == other.faces;
+}
+
+QString ScFontIndex::fileName(const QString& prefsDir)
+{
+	return QDir(prefsDir).filePath("fontindex150.bin");
+}
+
+bool ScFontIndex::read(const QString& fileName)
+{
+	clear();
+	m_modified = false;
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly))
+		return false;
+	qint64 size = file.size();
+	QByteArray data;
+	const uchar* mapped = file.map(0, size);
+	if (mapped)
+		data = QByteArray::fromRawData(reinterpret_cast<const char*>(mapped), size);
+	else
+		data = file.readAll();
+
+	QDataStream s(data);
+	s.setVersion(QDataStream::Qt_5_6);
+	quint32 magic = 0, version = 0;
+	qint32 count = 0;
+	s >> magic >> version >> count;
+	if ((magic != indexMagic) || (version != indexVersion) || (count < 0) || (s.status() != QDataStream::Ok))
+		return false;
+	m_entries.reserve(count);
+	for (qint32 i = 0; i < count; ++i)
+	{
+		ScFontIndexEntry entry;
+		qint32 format = 0, faceCount = 0;
+		QString path = readString(s);
+		s >> entry.size >> entry.modified >> entry.isOK >> format;
+		entry.format = format;
+		entry.error = readString(s);
+		s >> entry.facesKnown >> faceCount;
+		if (faceCount < 0)
+			s.setStatus(QDataStream::ReadCorruptData);
+		if (s.status() != QDataStream::Ok)
+			break;
+		for (qint32 j = 0; j < faceCount; ++j)
+		{
+			ScFontIndexFace face;
+			qint32 faceIndex = 0, type = 0;
+			face.family = readString(s);
+			face.style = readString(s);
+			face.psName = readString(s);
+			s >> faceIndex >> type >> face.hasGlyphNames >> face.subset;
+			face.faceIndex = faceIndex;
+			face.type = type;
+			QString features = readString(s);
+			if (!features.isEmpty())
+				face.features = features.split(QLatin1Char(','));
+			entry.faces.append(face);
+		}
+		if (s.status() != QDataStream::Ok)
+			break;
+		m_entries.insert(path, entry);
+	}
+	if (s.status() != QDataStream::Ok)
+	{
+		clear();
+		m_modified = false;
+		return false;
+	}
+	return true;
+}
+
+bool ScFontIndex::write(const QString& fileName)
+{
+	QSaveFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly))
+		return false;
+	QDataStream s(&file);
+	s.setVersion(QDataStream::Qt_5_6);
+	s << indexMagic << indexVersion << qint32(m_entries.count());
+	for (auto it = m_entries.cbegin(); it != m_entries.cend(); ++it)
+	{
+		const ScFontIndexEntry& entry = it.value();
+		writeString(s, it.key());
+		s << entry.size << entry.modified << entry.isOK << qint32(entry.format);
+		writeString(s, entry.error);
+		s << entry.facesKnown << qint32(entry.faces.count());
+		for (const ScFontIndexFace& face : entry.faces)
+		{
+			writeString(s, face.family);
+			writeString(s, face.style);
+			writeString(s, face.psName);
+			s << qint32(face.faceIndex) << qint32(face.type) << face.hasGlyphNames << face.subset;
+			// OpenType feature tags are four ASCII characters, never a comma
+			writeString(s, face.features.join(QLatin1Char(',')));
+		}
+	}
+	if ((s.status() != QDataStream::Ok) || !file.commit())
+		return false;
+	m_modified = false;
+	return true;
+}
+
+const ScFontIndexEntry* ScFontIndex::find(const QString& path, qint64 size, qint64 modified) const
+{
+	auto it = m_entries.constFind(path);
+	if (it == m_entries.constEnd())
+		return nullptr;
+	if (it->modified != modified)
+		return nullptr;
+	// Entries taken over from the XML cache do not know the size
+	if ((it->size >= 0) && (it->size != size))
+		return nullptr;
+	return &it.value();
+}
+
+void ScFontIndex::insert(const QString& path, const ScFontIndexEntry& entry)
+{
+	m_entries.insert(path, entry);
+	m_modified = true;
+}
+
+void ScFontIndex::remove(const QString& path)
+{
+	if (m_entries.remove(path) > 0)
+		m_modified = true;
+}
+
+void ScFontIndex::clear()
+{
+	if (!m_entries.isEmpty())
+		m_modified = true;
+	m_entries.clear();
+}
@@ -0,0 +1,83 @@
+/*
+For general Scribus (>=1.3.2) copyright and licensing information please refer
+to the COPYING file provided with the program. Following this notice may exist
+a copyright and/or license notice that predates the release of Scribus 1.3.2
+for which a new license (GPL+exception) is in place.
+*/
+#ifndef SCFONTINDEX_H
+#define SCFONTINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include "scribusapi.h"
+
+/// What SCFonts needs to know about one face of a font file to create its ScFace
+struct SCRIBUS_API ScFontIndexFace
+{
+	QString family;
+	QString style;
+	QString psName;
+	int faceIndex { 0 };
+	int type { 0 };          ///< ScFace::FontType, only meaningful for sfnt based formats
+	bool hasGlyphNames { false };
+	bool subset { false };
+	QStringList features;
+
+	bool operator==(const ScFontIndexFace& other) const;
+};
+
+/// Result of checking a font file
+struct SCRIBUS_API ScFontIndexEntry
+{
+	qint64 size { -1 };      ///< File size in bytes, -1 if unknown
+	qint64 modified { 0 };   ///< Modification time in seconds since the epoch
+	bool isOK { false };
+	int format { 0 };        ///< ScFace::FontFormat
+	QString error;           ///< Reason for rejecting the file if !isOK
+	/// False for entries which only know the status, as taken over from checkfonts150.xml
+	bool facesKnown { false };
+	QList<ScFontIndexFace> faces;
+
+	bool operator==(const ScFontIndexEntry& other) const;
+};
+
+/**
+ * Index of the font files checked at startup, so that unchanged files need
+ * not be opened with FreeType again.
+ *
+ * The index is kept in a compact binary file which is read by mapping it
+ * into memory. Entries are valid as long as size and modification time of
+ * their file have not changed.
+ */
+class SCRIBUS_API ScFontIndex
+{
+public:
+	/// Location of the index file in the preferences directory prefsDir
+	static QString fileName(const QString& prefsDir);
+
+	/// Replaces the entries with those of the file, returns false and stays empty if it is missing or unreadable
+	bool read(const QString& fileName);
+	/// Writes all entries, replacing the file only if writing succeeds
+	bool write(const QString& fileName);
+
+	/// Returns the entry of path if it was made for this size and modification time, or nullptr
+	const ScFontIndexEntry* find(const QString& path, qint64 size, qint64 modified) const;
+	void insert(const QString& path, const ScFontIndexEntry& entry);
+	void remove(const QString& path);
+	void clear();
+
+	const QHash<QString, ScFontIndexEntry>& entries() const { return m_entries; }
+	int count() const { return m_entries.count(); }
+	bool isEmpty() const { return m_entries.isEmpty(); }
+	/// Whether entries were changed since the last read() or write()
+	bool isModified() const { return m_modified; }
+
+private:
+	QHash<QString, ScFontIndexEntry> m_entries;
+	bool m_modified { false };
+};
+
+#endif
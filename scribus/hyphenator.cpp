@@ -29,14 +29,18 @@ for which a new license (GPL+exception) is in place.
 #include <QCursor>
 #include <QCheckBox>
 #include <QByteArray>
+#include <QPair>
+#include <QVector>
 #include <unicode/brkiter.h>
 
+#include "hyphenwordcache.h"
 #include "langmgr.h"
 #include "scpaths.h"
 #include "scribuscore.h"
 #include "scribusdoc.h"
 #include "prefsfile.h"
 #include "prefsmanager.h"
+#include "util_parallel.h"
 
 using namespace icu;
 
@@ -55,36 +59,48 @@ Hyphenator::Hyphenator(QWidget* parent, ScribusDoc *dok) : QObject( parent ),
 
 Hyphenator::~Hyphenator()
 {
-	if (m_hdict)
-		hnj_hyphen_free(m_hdict);
+	for (auto it = m_dictionaries.begin(); it != m_dictionaries.end(); ++it)
+	{
+		if (it->dict)
+			hnj_hyphen_free(it->dict);
+	}
 }
 
 bool Hyphenator::loadDict(const QString& name)
 {
-	if (LanguageManager::instance()->getHyphFilename(name).isEmpty())
+	const Dictionary* dict = dictionary(name);
+	if (!dict)
 		return false;
-		
-	if (m_language != name)
-	{
-		m_language = name;
+	m_language = name;
+	m_hdict = dict->dict;
+	m_codec = dict->codec;
+	return true;
+}
 
-		QFile file(LanguageManager::instance()->getHyphFilename(m_language));
-		
-		if (m_hdict != nullptr)
-			hnj_hyphen_free(m_hdict);
+const Hyphenator::Dictionary* Hyphenator::dictionary(const QString& language)
+{
+	QString fileName = LanguageManager::instance()->getHyphFilename(language);
+	if (fileName.isEmpty())
+		return nullptr;
 
+	auto it = m_dictionaries.find(language);
+	if (it == m_dictionaries.end())
+	{
+		// Dictionaries which fail to load are kept as well, so that their file is not read again
+		Dictionary dict;
+		dict.fileName = fileName;
+		QFile file(fileName);
 		if (file.open(QIODevice::ReadOnly))
 		{
-			m_codec = QTextCodec::codecForName(file.readLine());
-			m_hdict = hnj_hyphen_load(file.fileName().toLocal8Bit().data());
+			dict.codec = QTextCodec::codecForName(file.readLine());
+			dict.dict = hnj_hyphen_load(file.fileName().toLocal8Bit().data());
 			file.close();
-			return true;
 		}
-		m_hdict = nullptr;
-		return false;
+		it = m_dictionaries.insert(language, dict);
 	}
-
-	return (m_codec != nullptr && m_hdict != nullptr);
+	if (it->dict == nullptr || it->codec == nullptr)
+		return nullptr;
+	return &it.value();
 }
 
 void Hyphenator::slotNewSettings(bool Autom, bool ACheck)
@@ -131,208 +147,289 @@ void Hyphenator::slotHyphenateWord(PageItem* it, const QString& text, int firstC
 	free(cut);
 }
 
-void Hyphenator::slotHyphenate(PageItem* it)
+namespace
 {
-	if (!(it->isTextFrame()) || (it->itemText.length() == 0))
-		return;
-	m_doc->DoDrawing = false;
+	// A word of a story, with the index of its lower case form in the distinct words of a batch
+	struct StoryWord
+	{
+		int pos;
+		int length;
+		QString word;
+		int distinct;
+	};
+
+	struct HyphenStory
+	{
+		PageItem* item;
+		int start;
+		int length;
+		QList<StoryWord> words;
+	};
 
-	QString text = "";
+	// Lower case word of a dictionary, hyphenated once per batch at most
+	struct DistinctWord
+	{
+		HyphenDict* dict { nullptr };
+		QString dictionary;
+		QString lower;
+		QByteArray encoded;
+		QByteArray hyphens;
+	};
+}
 
-	int startC = 0;
-	if (it->itemText.hasSelection())
+// libhyphen only reads the dictionary, so words can be hyphenated with the same dictionary in several threads.
+// Returns an empty array if the word could not be hyphenated.
+static QByteArray hyphenateEncodedWord(HyphenDict* dict, const QByteArray& word)
+{
+	QByteArray hyphens(word.length() + 5, '\0');
+	char **rep = nullptr;
+	int *pos = nullptr;
+	int *cut = nullptr;
+	// TODO: support non-standard hyphenation, see hnj_hyphen_hyphenate2 docs
+	bool failed = hnj_hyphen_hyphenate2(dict, word.constData(), word.length(), hyphens.data(), nullptr, &rep, &pos, &cut);
+	if (rep)
 	{
-		startC = it->itemText.startOfSelection();
-		text = it->itemText.text(startC, it->itemText.selectionLength());
+		for (int i = 0; i < word.length() - 1; ++i)
+			free(rep[i]);
 	}
-	else {
-		text = it->itemText.text(0, it->itemText.length());
+	free(rep);
+	free(pos);
+	free(cut);
+	if (failed)
+		return QByteArray();
+	hyphens[word.length()] = '\0';
+	return hyphens;
+}
+
+// Sets hyphens from a hyphenated form of the word such as "hy-phen-ate"
+static void setHyphens(const QString& outs, QByteArray& hyphens)
+{
+	int ii = 1;
+	for (int i = 1; (i < outs.length() - 1) && (ii < hyphens.length()); ++i)
+	{
+		if (outs[i] == '-')
+			hyphens[ii - 1] = 1;
+		else
+		{
+			hyphens[ii] = 0;
+			++ii;
+		}
 	}
+}
 
+bool Hyphenator::applyHyphens(const QString& word, QByteArray hyphens, char* flags)
+{
+	int i = 0;
+	int length = word.length();
+	bool hasHyphen = false;
+	for (i = 1; i < length - 1; ++i)
+	{
+		if (hyphens[i] & 1)
+		{
+			hasHyphen = true;
+			break;
+		}
+	}
+	QString outs = "";
+	QString input = "";
+	outs += word[0];
+	for (i = 1; i < length - 1; ++i)
+	{
+		outs += word[i];
+		if (hyphens[i] & 1)
+			outs += "-";
+	}
+	outs += word.rightRef(1);
+	input = outs;
+	if (ignoredWords.contains(word))
+		return true;
+
+	if (hasHyphen)
+	{
+		if (specialWords.contains(word))
+		{
+			outs = specialWords.value(word);
+			setHyphens(outs, hyphens);
+		}
+		if (!m_automatic)
+		{
+			if (rememberedWords.contains(input))
+				setHyphens(rememberedWords.value(input), hyphens);
+			else
+			{
+				qApp->changeOverrideCursor(QCursor(Qt::ArrowCursor));
+				PrefsContext* prefs = PrefsManager::instance().prefsFile->getContext("hyhpen_options");
+				int xpos = prefs->getInt("Xposition", -9999);
+				int ypos = prefs->getInt("Yposition", -9999);
+				HyAsk *dia = new HyAsk((QWidget*)parent(), outs);
+				if ((xpos != -9999) && (ypos != -9999))
+					dia->move(xpos, ypos);
+				qApp->processEvents();
+				bool accepted = dia->exec();
+				if (accepted)
+				{
+					outs = dia->Wort->text();
+					setHyphens(outs, hyphens);
+					if (!rememberedWords.contains(input))
+						rememberedWords.insert(input, outs);
+					if (dia->addToIgnoreList->isChecked())
+					{
+						if (!ignoredWords.contains(word))
+							ignoredWords.insert(word);
+					}
+					if (dia->addToExceptionList->isChecked())
+					{
+						if (!specialWords.contains(word))
+							specialWords.insert(word, outs);
+					}
+				}
+				prefs->set("Xposition", dia->xpos);
+				prefs->set("Yposition", dia->ypos);
+				delete dia;
+				if (!accepted)
+					return false;
+				qApp->changeOverrideCursor(QCursor(Qt::WaitCursor));
+			}
+		}
+	}
+	// Words without any hyphenation point lose the hyphens they had
+	for (i = 0; i < length; ++i)
+		flags[i] = hasHyphen ? (hyphens[i] & 1) : 0;
+	return true;
+}
+
+void Hyphenator::slotHyphenate(PageItem* it)
+{
+	hyphenateStories(QList<PageItem*>() << it);
+}
+
+void Hyphenator::hyphenateStories(const QList<PageItem*>& items)
+{
+	QList<HyphenStory> stories;
+	QSet<PageItem*> chains;
+	for (PageItem* it : items)
+	{
+		if (!it || !(it->isTextFrame()) || (it->itemText.length() == 0))
+			continue;
+		// Linked frames share their story
+		PageItem* first = it->firstInChain();
+		if (chains.contains(first))
+			continue;
+		chains.insert(first);
+
+		HyphenStory story;
+		story.item = it;
+		if (it->itemText.hasSelection())
+		{
+			story.start = it->itemText.startOfSelection();
+			story.length = it->itemText.selectionLength();
+		}
+		else
+		{
+			story.start = 0;
+			story.length = it->itemText.length();
+		}
+		stories.append(story);
+	}
+	if (stories.isEmpty())
+		return;
+
+	m_doc->DoDrawing = false;
 	rememberedWords.clear();
 	qApp->setOverrideCursor(QCursor(Qt::WaitCursor));
 
+	// Split the stories into words. The word iterator is shared by all stories, so this is done in the GUI thread.
+	HyphenWordCache& cache = HyphenWordCache::instance();
+	QVector<DistinctWord> distinctWords;
+	QHash<QPair<QString, QString>, int> distinctIndex;
+	QVector<int> missingWords;
 	BreakIterator* bi = StoryText::getWordIterator();
-	bi->setText((const UChar*) text.utf16());
-	int pos = bi->first();
-	while (pos != BreakIterator::DONE)
+	for (HyphenStory& story : stories)
 	{
-		int firstC = pos;
-		pos = bi->next();
-		int lastC = pos;
-		int countC = lastC - firstC;
-
-		const CharStyle& style = it->itemText.charStyle(firstC);
-		if (countC > 0 && countC > style.hyphenWordMin() - 1)
+		const StoryText& itemText = story.item->itemText;
+		QString text = itemText.text(story.start, story.length);
+		bi->setText((const UChar*) text.utf16());
+		int pos = bi->first();
+		while (pos != BreakIterator::DONE)
 		{
+			int firstC = pos;
+			pos = bi->next();
+			int lastC = pos;
+			int countC = lastC - firstC;
+
+			const CharStyle& style = itemText.charStyle(story.start + firstC);
+			if (countC <= 0 || countC < style.hyphenWordMin())
+				continue;
 			QString word = text.mid(firstC, countC);
 			QString wordLower = QLocale(style.language()).toLower(word);
 			if (wordLower.contains(SpecialChars::SHYPHEN))
 				break;
-
-			bool ok = loadDict(style.language());
-			if (!ok)
+			// Hyphens are flagged per character, so the lower case word has to line up with the text
+			if (wordLower.length() != countC)
+				continue;
+			const Dictionary* dict = dictionary(style.language());
+			if (!dict)
 				continue;
 
-			QByteArray te = m_codec->fromUnicode(wordLower);
-			char *buffer = static_cast<char*>(malloc(te.length() + 5));
-			if (buffer == nullptr)
-				break;
-
-			char **rep = nullptr;
-			int *pos = nullptr;
-			int *cut = nullptr;
-			// TODO: support non-standard hyphenation, see hnj_hyphen_hyphenate2 docs
-			if (!hnj_hyphen_hyphenate2(m_hdict, te.data(), te.length(), buffer, nullptr, &rep, &pos, &cut))
+			QPair<QString, QString> key(dict->fileName, wordLower);
+			int index = distinctIndex.value(key, -1);
+			if (index < 0)
 			{
-	  			int i = 0;
-				buffer[te.length()] = '\0';
-				bool hasHyphen = false;
-				for (i = 1; i < wordLower.length()-1; ++i)
+				DistinctWord distinct;
+				distinct.dict = dict->dict;
+				distinct.dictionary = dict->fileName;
+				distinct.lower = wordLower;
+				index = distinctWords.count();
+				if (!cache.find(distinct.dictionary, wordLower, distinct.hyphens))
 				{
-					if(buffer[i] & 1)
-					{
-						hasHyphen = true;
-						break;
-					}
-				}
-				QString outs = "";
-				QString input = "";
-				outs += word[0];
-				for (i = 1; i < wordLower.length()-1; ++i)
-				{
-					outs += word[i];
-					if(buffer[i] & 1)
-						outs += "-";
-				}
-				outs += word.rightRef(1);
-				input = outs;
-				if (!ignoredWords.contains(word))
-				{
-					if (!hasHyphen)
-						it->itemText.hyphenateWord(startC + firstC, wordLower.length(), nullptr);
-					else if (m_automatic)
-					{
-						if (specialWords.contains(word))
-						{
-							outs = specialWords.value(word);
-							uint ii = 1;
-							for (i = 1; i < outs.length()-1; ++i)
-							{
-								QChar cht = outs[i];
-								if (cht == '-')
-									buffer[ii-1] = 1;
-								else
-								{
-									buffer[ii] = 0;
-									++ii;
-								}
-							}
-						}
-						it->itemText.hyphenateWord(startC + firstC, wordLower.length(), buffer);
-					}
-					else
-					{
-						if (specialWords.contains(word))
-						{
-							outs = specialWords.value(word);
-							uint ii = 1;
-							for (i = 1; i < outs.length()-1; ++i)
-							{
-								QChar cht = outs[i];
-								if (cht == '-')
-									buffer[ii-1] = 1;
-								else
-								{
-									buffer[ii] = 0;
-									++ii;
-								}
-							}
-						}
-						if (rememberedWords.contains(input))
-						{
-							outs = rememberedWords.value(input);
-							uint ii = 1;
-							for (i = 1; i < outs.length()-1; ++i)
-							{
-								QChar cht = outs[i];
-								if (cht == '-')
-									buffer[ii-1] = 1;
-								else
-								{
-									buffer[ii] = 0;
-									++ii;
-								}
-							}
-							it->itemText.hyphenateWord(firstC, wordLower.length(), buffer);
-						}
-						else
-						{
-							qApp->changeOverrideCursor(QCursor(Qt::ArrowCursor));
-							PrefsContext* prefs = PrefsManager::instance().prefsFile->getContext("hyhpen_options");
-							int xpos = prefs->getInt("Xposition", -9999);
-							int ypos = prefs->getInt("Yposition", -9999);
-							HyAsk *dia = new HyAsk((QWidget*)parent(), outs);
-							if ((xpos != -9999) && (ypos != -9999))
-								dia->move(xpos, ypos);
-							qApp->processEvents();
-							if (dia->exec())
-							{
-								outs = dia->Wort->text();
-								uint ii = 1;
-								for (i = 1; i < outs.length()-1; ++i)
-								{
-									QChar cht = outs[i];
-									if (cht == '-')
-										buffer[ii-1] = 1;
-									else
-									{
-										buffer[ii] = 0;
-										++ii;
-									}
-								}
-								if (!rememberedWords.contains(input))
-									rememberedWords.insert(input, outs);
-								if (dia->addToIgnoreList->isChecked())
-								{
-									if (!ignoredWords.contains(word))
-										ignoredWords.insert(word);
-								}
-								if (dia->addToExceptionList->isChecked())
-								{
-									if (!specialWords.contains(word))
-										specialWords.insert(word, outs);
-								}
-								it->itemText.hyphenateWord(firstC, wordLower.length(), buffer);
-							}
-							else
-							{
-								free(buffer);
-								buffer = nullptr;
-								prefs->set("Xposition", dia->xpos);
-								prefs->set("Yposition", dia->ypos);
-								delete dia;
-								break;
-							}
-							prefs->set("Xposition", dia->xpos);
-							prefs->set("Yposition", dia->ypos);
-							delete dia;
-							qApp->changeOverrideCursor(QCursor(Qt::WaitCursor));
-						}
-					}
+					distinct.encoded = dict->codec->fromUnicode(wordLower);
+					missingWords.append(index);
 				}
+				distinctWords.append(distinct);
+				distinctIndex.insert(key, index);
 			}
-			free(buffer);
-			if (rep)
+			story.words.append({ story.start + firstC, countC, word, index });
+		}
+	}
+
+	// Hyphenate the words which are not cached yet
+	DistinctWord* words = distinctWords.data();
+	parallelFor(missingWords.count(), [&](int i) {
+		DistinctWord& distinct = words[missingWords.at(i)];
+		distinct.hyphens = hyphenateEncodedWord(distinct.dict, distinct.encoded);
+	});
+	for (int index : qAsConst(missingWords))
+		cache.insert(words[index].dictionary, words[index].lower, words[index].hyphens);
+
+	// Apply the hyphens to each story at once
+	bool cancelled = false;
+	for (const HyphenStory& story : qAsConst(stories))
+	{
+		StoryText& itemText = story.item->itemText;
+		QByteArray flags(story.length, '\0');
+		for (int i = 0; i < story.length; ++i)
+		{
+			if (itemText.hasFlag(story.start + i, ScLayout_HyphenationPossible))
+				flags[i] = 1;
+		}
+		const QByteArray oldFlags(flags);
+		for (const StoryWord& word : story.words)
+		{
+			const QByteArray& hyphens = distinctWords.at(word.distinct).hyphens;
+			if (hyphens.isEmpty())
+				continue;
+			if (!applyHyphens(word.word, hyphens, flags.data() + word.pos - story.start))
 			{
-				for (int i = 0; i < te.length() - 1; ++i)
-					free(rep[i]);
+				cancelled = true;
+				break;
 			}
-			free(rep);
-			free(pos);
-			free(cut);
 		}
+		if (flags != oldFlags)
+			itemText.hyphenateWord(story.start, story.length, flags.constData());
+		if (cancelled)
+			break;
 	}
+
 	qApp->restoreOverrideCursor();
 	m_doc->DoDrawing = true;
 	rememberedWords.clear();
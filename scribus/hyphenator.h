@@ -10,6 +10,7 @@ for which a new license (GPL+exception) is in place.
 #include <QObject>
 #include <QTextCodec>
 #include <QHash>
+#include <QList>
 #include <QSet>
 
 #include "scribusapi.h"
@@ -46,6 +47,14 @@ public:
 	
 private:
 
+	/*! A loaded hyphenation dictionary */
+	struct Dictionary
+	{
+		HyphenDict *dict { nullptr };
+		QTextCodec *codec { nullptr };
+		QString fileName;
+	};
+
 	/*! Embedded reference to the \see ScribusDoc filled by \a dok */
 	ScribusDoc *m_doc;
 	/*! Reference to the hyphen dictionary structure. */
@@ -54,6 +63,8 @@ private:
 	QTextCodec *m_codec;
 	/*! Language in use */
 	QString m_language;
+	/*! Dictionaries loaded so far by language, they are kept for hyphenating texts in several languages */
+	QHash<QString, Dictionary> m_dictionaries;
 
 	/*! Flag - if user set auto hyphen processing.*/
 	bool m_automatic;
@@ -65,6 +76,20 @@ private:
 	 \param name is the name of specified language.
 	 */
 	bool loadDict(const QString& name);
+	/*!
+		\brief Returns the dictionary of a language, loading it on first use.
+	 \param language is the name of specified language.
+	 \retval nullptr if there is no usable dictionary for the language
+	 */
+	const Dictionary* dictionary(const QString& language);
+	/*!
+		\brief Decides the hyphenation points of one word, asking the user in manual mode.
+	 \param word is the word as written in the text.
+	 \param hyphens are the flags libhyphen found for the lower case word.
+	 \param flags receives one flag per character of \a word.
+	 \retval false if the user cancelled the hyphenation
+	 */
+	bool applyHyphens(const QString& word, QByteArray hyphens, char* flags);
 	
 public:
 	/*! Flag - obsolete? */
@@ -101,6 +126,14 @@ public slots:
 	*/
 	void slotHyphenate(PageItem *it);
 	/*!
+	\brief Make hyphenation as described in \see slotHyphenate for the stories of several text frames at once.
+	The words of all stories are collected first, words which are not in the \see HyphenWordCache yet
+	are hyphenated in parallel, then the result is applied to each story at once.
+	Linked frames share their story, so it is only hyphenated once.
+	\param items references \see PageItem - text frames, other items are skipped.
+	*/
+	void hyphenateStories(const QList<PageItem*>& items);
+	/*!
 	\fn void Hyphenator::slotDeHyphenate(PageItem* it)
 	\brief Removes hyphenation either for the whole text frame or the selected text if there is a selection.
 	\date
@@ -0,0 +1,91 @@
+/*
+For general Scribus (>=1.3.2) copyright and licensing information please refer
+to the COPYING file provided with the program. Following this notice may exist
+a copyright and/or license notice that predates the release of Scribus 1.3.2
+for which a new license (GPL+exception) is in place.
+*/
+
+#include <algorithm>
+
+#include <QPair>
+#include <QVector>
+
+#include "hyphenwordcache.h"
+
+HyphenWordCache& HyphenWordCache::instance()
+{
+	static HyphenWordCache cache;
+	return cache;
+}
+
+HyphenWordCache::HyphenWordCache(int maxWords) :
+	m_maxWords(qMax(0, maxWords))
+{
+}
+
+void HyphenWordCache::setMaxWords(int maxWords)
+{
+	m_maxWords = qMax(0, maxWords);
+	for (auto it = m_dictionaries.begin(); it != m_dictionaries.end(); ++it)
+		evict(it.value(), 0);
+}
+
+int HyphenWordCache::count(const QString& dictionary) const
+{
+	return m_dictionaries.value(dictionary).count();
+}
+
+bool HyphenWordCache::find(const QString& dictionary, const QString& word, QByteArray& hyphens)
+{
+	auto dict = m_dictionaries.find(dictionary);
+	if (dict != m_dictionaries.end())
+	{
+		auto it = dict->find(word);
+		if (it != dict->end())
+		{
+			++m_statistics.hits;
+			it->lastUse = ++m_useCounter;
+			hyphens = it->hyphens;
+			return true;
+		}
+	}
+	++m_statistics.misses;
+	return false;
+}
+
+void HyphenWordCache::insert(const QString& dictionary, const QString& word, const QByteArray& hyphens)
+{
+	if (m_maxWords == 0)
+		return;
+	WordHash& words = m_dictionaries[dictionary];
+	if (!words.contains(word))
+		evict(words, 1);
+	Entry& entry = words[word];
+	entry.hyphens = hyphens;
+	entry.lastUse = ++m_useCounter;
+}
+
+void HyphenWordCache::clear(const QString& dictionary)
+{
+	m_dictionaries.remove(dictionary);
+}
+
+void HyphenWordCache::clear()
+{
+	m_dictionaries.clear();
+}
+
+void HyphenWordCache::evict(WordHash& words, int neededWords)
+{
+	if (words.count() + neededWords <= m_maxWords)
+		return;
+	// Dropping a quarter at once keeps eviction rare while a long story is hyphenated
+	int target = qMax(0, m_maxWords - m_maxWords / 4 - neededWords);
+	QVector<QPair<quint64, QString> > byAge;
+	byAge.reserve(words.count());
+	for (auto it = words.constBegin(); it != words.constEnd(); ++it)
+		byAge.append(qMakePair(it->lastUse, it.key()));
+	std::sort(byAge.begin(), byAge.end(), [](const QPair<quint64, QString>& a, const QPair<quint64, QString>& b) { return a.first < b.first; });
+	for (int i = 0; (i < byAge.count()) && (words.count() > target); ++i)
+		words.remove(byAge.at(i).second);
+}
@@ -0,0 +1,72 @@
+/*
+For general Scribus (>=1.3.2) copyright and licensing information please refer
+to the COPYING file provided with the program. Following this notice may exist
+a copyright and/or license notice that predates the release of Scribus 1.3.2
+for which a new license (GPL+exception) is in place.
+*/
+
+#ifndef HYPHENWORDCACHE_H
+#define HYPHENWORDCACHE_H
+
+#include <QByteArray>
+#include <QHash>
+#include <QString>
+
+#include "scribusapi.h"
+
+/**
+  Cache of hyphenated words, shared by all documents.
+
+  For each hyphenation dictionary the cache keeps the hyphen flags which
+  hnj_hyphen_hyphenate2() returned for lower case words, so that words
+  repeated across stories and documents are only hyphenated once. An empty
+  result marks a word the dictionary failed on. When a dictionary holds
+  more than maxWords words, the least recently used quarter is dropped.
+  The cache must only be used in the GUI thread.
+ */
+class SCRIBUS_API HyphenWordCache
+{
+public:
+	struct Statistics
+	{
+		quint64 hits { 0 };
+		quint64 misses { 0 };
+	};
+
+	/// The cache used by Hyphenator
+	static HyphenWordCache& instance();
+
+	explicit HyphenWordCache(int maxWords = 50000);
+
+	void setMaxWords(int maxWords);
+	int maxWords() const { return m_maxWords; }
+	/// Number of words cached for a dictionary
+	int count(const QString& dictionary) const;
+
+	/// Returns true and the flags of word if it was hyphenated with dictionary before
+	bool find(const QString& dictionary, const QString& word, QByteArray& hyphens);
+	void insert(const QString& dictionary, const QString& word, const QByteArray& hyphens);
+	/// Drops the words of one dictionary, eg. when its file was changed
+	void clear(const QString& dictionary);
+	void clear();
+
+	const Statistics& statistics() const { return m_statistics; }
+	void resetStatistics() { m_statistics = Statistics(); }
+
+private:
+	struct Entry
+	{
+		QByteArray hyphens;
+		quint64 lastUse { 0 };
+	};
+	typedef QHash<QString, Entry> WordHash;
+
+	void evict(WordHash& words, int neededWords);
+
+	QHash<QString, WordHash> m_dictionaries;
+	int m_maxWords;
+	quint64 m_useCounter { 0 };
+	Statistics m_statistics;
+};
+
+#endif
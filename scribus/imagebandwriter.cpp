@@ -0,0 +1,301 @@
+/*
+For general Scribus (>=1.3.2) copyright and licensing information please refer
+to the COPYING file provided with the program. Following this notice may exist
+a copyright and/or license notice that predates the release of Scribus 1.3.2
+for which a new license (GPL+exception) is in place.
+*/
+
+#include <cstdint>
+#include <png.h>
+#include <tiffio.h>
+
+#include <QFile>
+#include <QMutexLocker>
+#include <QThread>
+
+#include "imagebandwriter.h"
+
+class ImageBandWriter::Encoder
+{
+public:
+	virtual ~Encoder() = default;
+
+	virtual bool open(const QString& fileName, const QSize& size, int dotsPerMeter, bool withAlpha, int quality) = 0;
+	/// Writes rows in Format_RGBA8888 or Format_RGB888, depending on withAlpha
+	virtual bool writeRows(const QImage& rows) = 0;
+	/// Completes the file after all rows were written
+	virtual bool finish() = 0;
+};
+
+static void ImageBandWriter_PNG_write_fn(png_structp pngPtr, png_bytep data, png_size_t length)
+{
+	QFile *file = (QFile*) png_get_io_ptr(pngPtr);
+	if (file->write((const char*) data, length) != (qint64) length)
+		png_error(pngPtr, "Write Error");
+}
+
+static void ImageBandWriter_PNG_flush_fn(png_structp pngPtr)
+{
+	QFile *file = (QFile*) png_get_io_ptr(pngPtr);
+	file->flush();
+}
+
+class ImageBandWriter::PngEncoder : public ImageBandWriter::Encoder
+{
+public:
+	~PngEncoder() override
+	{
+		if (m_png)
+			png_destroy_write_struct(&m_png, m_info ? &m_info : (png_infopp) nullptr);
+	}
+
+	bool open(const QString& fileName, const QSize& size, int dotsPerMeter, bool withAlpha, int quality) override
+	{
+		m_file.setFileName(fileName);
+		if (!m_file.open(QIODevice::WriteOnly))
+			return false;
+		m_png = png_create_write_struct(PNG_LIBPNG_VER_STRING, nullptr, nullptr, nullptr);
+		if (!m_png)
+			return false;
+		m_info = png_create_info_struct(m_png);
+		if (!m_info)
+			return false;
+		if (setjmp(png_jmpbuf(m_png)))
+			return false;
+		png_set_write_fn(m_png, &m_file, ImageBandWriter_PNG_write_fn, ImageBandWriter_PNG_flush_fn);
+		// Same mapping of quality to compression level as Qt's PNG writer
+		if (quality >= 0)
+			png_set_compression_level(m_png, (100 - qMin(quality, 100)) * 9 / 91);
+		png_set_IHDR(m_png, m_info, size.width(), size.height(), 8, withAlpha ? PNG_COLOR_TYPE_RGB_ALPHA : PNG_COLOR_TYPE_RGB,
+					 PNG_INTERLACE_NONE, PNG_COMPRESSION_TYPE_BASE, PNG_FILTER_TYPE_BASE);
+		if (dotsPerMeter > 0)
+			png_set_pHYs(m_png, m_info, dotsPerMeter, dotsPerMeter, PNG_RESOLUTION_METER);
+		png_write_info(m_png, m_info);
+		return true;
+	}
+
+	bool writeRows(const QImage& rows) override
+	{
+		if (setjmp(png_jmpbuf(m_png)))
+			return false;
+		for (int y = 0; y < rows.height(); ++y)
+			png_write_row(m_png, (png_bytep) rows.constScanLine(y));
+		return true;
+	}
+
+	bool finish() override
+	{
+		if (setjmp(png_jmpbuf(m_png)))
+			return false;
+		png_write_end(m_png, m_info);
+		m_file.close();
+		return (m_file.error() == QFileDevice::NoError);
+	}
+
+private:
+	QFile m_file;
+	png_structp m_png { nullptr };
+	png_infop m_info { nullptr };
+};
+
+class ImageBandWriter::TiffEncoder : public ImageBandWriter::Encoder
+{
+public:
+	~TiffEncoder() override
+	{
+		if (m_tiff)
+			TIFFClose(m_tiff);
+	}
+
+	bool open(const QString& fileName, const QSize& size, int dotsPerMeter, bool withAlpha, int /*quality*/) override
+	{
+		m_tiff = TIFFOpen(fileName.toLocal8Bit().data(), "w");
+		if (!m_tiff)
+			return false;
+		TIFFSetField(m_tiff, TIFFTAG_IMAGEWIDTH, size.width());
+		TIFFSetField(m_tiff, TIFFTAG_IMAGELENGTH, size.height());
+		TIFFSetField(m_tiff, TIFFTAG_BITSPERSAMPLE, 8);
+		TIFFSetField(m_tiff, TIFFTAG_SAMPLESPERPIXEL, withAlpha ? 4 : 3);
+		if (withAlpha)
+		{
+			uint16_t extraSample = EXTRASAMPLE_UNASSALPHA;
+			TIFFSetField(m_tiff, TIFFTAG_EXTRASAMPLES, 1, &extraSample);
+		}
+		TIFFSetField(m_tiff, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+		TIFFSetField(m_tiff, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_RGB);
+		TIFFSetField(m_tiff, TIFFTAG_COMPRESSION, COMPRESSION_LZW);
+		TIFFSetField(m_tiff, TIFFTAG_ROWSPERSTRIP, TIFFDefaultStripSize(m_tiff, 0));
+		if (dotsPerMeter > 0)
+		{
+			TIFFSetField(m_tiff, TIFFTAG_RESOLUTIONUNIT, RESUNIT_CENTIMETER);
+			TIFFSetField(m_tiff, TIFFTAG_XRESOLUTION, float(dotsPerMeter / 100.0));
+			TIFFSetField(m_tiff, TIFFTAG_YRESOLUTION, float(dotsPerMeter / 100.0));
+		}
+		return true;
+	}
+
+	bool writeRows(const QImage& rows) override
+	{
+		for (int y = 0; y < rows.height(); ++y)
+		{
+			if (TIFFWriteScanline(m_tiff, (void*) rows.constScanLine(y), m_row++, 0) < 0)
+				return false;
+		}
+		return true;
+	}
+
+	bool finish() override
+	{
+		bool flushed = (TIFFFlush(m_tiff) != 0);
+		TIFFClose(m_tiff);
+		m_tiff = nullptr;
+		return flushed;
+	}
+
+private:
+	TIFF* m_tiff { nullptr };
+	uint32_t m_row { 0 };
+};
+
+class ImageBandWriter::EncoderThread : public QThread
+{
+public:
+	explicit EncoderThread(ImageBandWriter* writer) : m_writer(writer) {}
+
+protected:
+	void run() override { m_writer->encodeBands(); }
+
+private:
+	ImageBandWriter* m_writer;
+};
+
+bool ImageBandWriter::canWrite(const QString& format)
+{
+	QString fmt = format.toLower();
+	return (fmt == "png") || (fmt == "tif") || (fmt == "tiff");
+}
+
+ImageBandWriter::ImageBandWriter(int maxQueuedBands) :
+	m_maxQueuedBands(qMax(1, maxQueuedBands))
+{
+}
+
+ImageBandWriter::~ImageBandWriter()
+{
+	if (isOpen())
+		abort();
+}
+
+bool ImageBandWriter::open(const QString& fileName, const QString& format, const QSize& size, int dotsPerMeter, bool withAlpha, int quality)
+{
+	if (isOpen() || size.isEmpty() || !canWrite(format))
+		return false;
+	if (format.toLower() == "png")
+		m_encoder = new PngEncoder();
+	else
+		m_encoder = new TiffEncoder();
+	if (!m_encoder->open(fileName, size, dotsPerMeter, withAlpha, quality))
+	{
+		delete m_encoder;
+		m_encoder = nullptr;
+		QFile::remove(fileName);
+		return false;
+	}
+	m_fileName = fileName;
+	m_size = size;
+	m_withAlpha = withAlpha;
+	m_rowsQueued = 0;
+	m_finishing = false;
+	m_failed = false;
+	m_queue.clear();
+	m_thread = new EncoderThread(this);
+	m_thread->start();
+	return true;
+}
+
+bool ImageBandWriter::writeBand(const QImage& band)
+{
+	if (!isOpen() || band.isNull() || (band.width() != m_size.width()) || (m_rowsQueued + band.height() > m_size.height()))
+		return false;
+	QMutexLocker locker(&m_mutex);
+	while ((m_queue.count() >= m_maxQueuedBands) && !m_failed)
+		m_queueChanged.wait(&m_mutex);
+	if (m_failed)
+		return false;
+	m_queue.enqueue(band);
+	m_rowsQueued += band.height();
+	m_queueChanged.wakeAll();
+	return true;
+}
+
+bool ImageBandWriter::close()
+{
+	if (!isOpen())
+		return false;
+	stopThread();
+	bool success = !m_failed && (m_rowsQueued == m_size.height());
+	if (success)
+		success = m_encoder->finish();
+	delete m_encoder;
+	m_encoder = nullptr;
+	if (!success)
+		QFile::remove(m_fileName);
+	return success;
+}
+
+void ImageBandWriter::abort()
+{
+	if (!isOpen())
+		return;
+	{
+		QMutexLocker locker(&m_mutex);
+		m_failed = true;
+		m_queueChanged.wakeAll();
+	}
+	stopThread();
+	delete m_encoder;
+	m_encoder = nullptr;
+	QFile::remove(m_fileName);
+}
+
+void ImageBandWriter::stopThread()
+{
+	{
+		QMutexLocker locker(&m_mutex);
+		m_finishing = true;
+		m_queueChanged.wakeAll();
+	}
+	m_thread->wait();
+	delete m_thread;
+	m_thread = nullptr;
+}
+
+void ImageBandWriter::encodeBands()
+{
+	QImage::Format rowFormat = m_withAlpha ? QImage::Format_RGBA8888 : QImage::Format_RGB888;
+	while (true)
+	{
+		QImage band;
+		{
+			QMutexLocker locker(&m_mutex);
+			while (m_queue.isEmpty() && !m_finishing && !m_failed)
+				m_queueChanged.wait(&m_mutex);
+			if (m_queue.isEmpty() || m_failed)
+			{
+				m_queue.clear();
+				m_queueChanged.wakeAll();
+				return;
+			}
+			// The band stays queued while it is encoded, so that it counts against the queue size
+			band = m_queue.head();
+		}
+		bool success = m_encoder->writeRows(band.convertToFormat(rowFormat));
+		{
+			QMutexLocker locker(&m_mutex);
+			m_queue.dequeue();
+			if (!success)
+				m_failed = true;
+			m_queueChanged.wakeAll();
+		}
+	}
+}
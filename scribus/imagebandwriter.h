@@ -0,0 +1,81 @@
+/*
+For general Scribus (>=1.3.2) copyright and licensing information please refer
+to the COPYING file provided with the program. Following this notice may exist
+a copyright and/or license notice that predates the release of Scribus 1.3.2
+for which a new license (GPL+exception) is in place.
+*/
+
+#ifndef IMAGEBANDWRITER_H
+#define IMAGEBANDWRITER_H
+
+#include <QImage>
+#include <QMutex>
+#include <QQueue>
+#include <QSize>
+#include <QString>
+#include <QWaitCondition>
+
+#include "scribusapi.h"
+
+class QThread;
+
+/**
+  * @brief Writes a PNG or TIFF file from horizontal bands of the image.
+  *
+  * Bands are handed over from top to bottom and encoded row by row by a
+  * worker thread while the caller prepares the next band. At most
+  * maxQueuedBands bands wait for the encoder, so an image of any size is
+  * written with a bounded amount of memory.
+  */
+class SCRIBUS_API ImageBandWriter
+{
+public:
+	/// Whether files of a format, named as for QImageWriter, can be written band by band
+	static bool canWrite(const QString& format);
+
+	explicit ImageBandWriter(int maxQueuedBands = 2);
+	~ImageBandWriter();
+
+	ImageBandWriter(const ImageBandWriter&) = delete;
+	ImageBandWriter& operator=(const ImageBandWriter&) = delete;
+
+	/**
+	 * Creates fileName for an image of the given size. Alpha is only written
+	 * if withAlpha is set. For PNG files quality selects the compression
+	 * level the way QImageWriter does, -1 is the default.
+	 */
+	bool open(const QString& fileName, const QString& format, const QSize& size, int dotsPerMeter, bool withAlpha, int quality = -1);
+	/// Queues the next rows of the image, blocks while the queue is full. Returns false once writing failed.
+	bool writeBand(const QImage& band);
+	/// Waits until all rows are written and closes the file, returns false if anything failed
+	bool close();
+	/// Stops writing and removes the incomplete file
+	void abort();
+
+	bool isOpen() const { return m_thread != nullptr; }
+
+private:
+	class Encoder;
+	class PngEncoder;
+	class TiffEncoder;
+	class EncoderThread;
+
+	void encodeBands();
+	void stopThread();
+
+	int m_maxQueuedBands;
+	Encoder* m_encoder { nullptr };
+	QThread* m_thread { nullptr };
+	QString m_fileName;
+	QSize m_size;
+	bool m_withAlpha { false };
+	int m_rowsQueued { 0 };
+
+	QMutex m_mutex;
+	QWaitCondition m_queueChanged;
+	QQueue<QImage> m_queue;
+	bool m_finishing { false };
+	bool m_failed { false };
+};
+
+#endif
@@ -0,0 +1,591 @@
+/*
+For general Scribus (>=1.3.2) copyright and licensing information please refer
+to the COPYING file provided with the program. Following this notice may exist
+a copyright and/or license notice that predates the release of Scribus 1.3.2
+for which a new license (GPL+exception) is in place.
+*/
+
+#include "imageloadqueue.h"
+
+#include <cmath>
+
+#include <QColor>
+#include <QFileInfo>
+#include <QImageReader>
+#include <QMetaObject>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QRunnable>
+#include <QScopedPointer>
+#include <QThreadPool>
+#include <QTimer>
+#include <QTransform>
+#include <QWaitCondition>
+
+#include "colorblind.h"
+#include "filewatcher.h"
+#include "pageitem.h"
+#include "prefsmanager.h"
+#include "scribuscore.h"
+#include "scribusdoc.h"
+#include "scribusview.h"
+#include "util_parallel.h"
+
+// Ids of the jobs the worker threads are done with
+class ImageLoadResults
+{
+public:
+	/// If receiver is set, its applyResults() slot is called in its thread after each job
+	explicit ImageLoadResults(QObject* receiver = nullptr) : m_receiver(receiver) {}
+
+	void finished(int id)
+	{
+		QMutexLocker locker(&m_mutex);
+		m_done.append(id);
+		m_condition.wakeAll();
+		if (m_receiver)
+			QMetaObject::invokeMethod(m_receiver, "applyResults", Qt::QueuedConnection);
+	}
+
+	QList<int> take()
+	{
+		QMutexLocker locker(&m_mutex);
+		QList<int> done;
+		done.swap(m_done);
+		return done;
+	}
+
+	QList<int> wait()
+	{
+		QMutexLocker locker(&m_mutex);
+		while (m_done.isEmpty())
+			m_condition.wait(&m_mutex);
+		QList<int> done;
+		done.swap(m_done);
+		return done;
+	}
+
+private:
+	QObject* m_receiver;
+	QMutex m_mutex;
+	QWaitCondition m_condition;
+	QList<int> m_done;
+};
+
+namespace
+{
+	class ImageLoadTask : public QRunnable
+	{
+	public:
+		ImageLoadTask(ImageLoadJob* job, int index, ImageLoadResults* results) :
+			m_job(job), m_index(index), m_results(results) {}
+
+		void run() override
+		{
+			if (m_job->decode())
+				m_job->process();
+			m_results->finished(m_index);
+		}
+
+	private:
+		ImageLoadJob* m_job;
+		int m_index;
+		ImageLoadResults* m_results;
+	};
+}
+
+ImageLoadJob::ImageLoadJob(ScribusDoc* doc, const QString& name, const QString& profile, eRenderIntent intent) :
+	fileName(name),
+	cms(doc, profile, intent),
+	cache(name)
+{
+}
+
+bool ImageLoadJob::decode()
+{
+	if (storeMissing)
+	{
+		success = false;
+		return false;
+	}
+	bool dummy;
+	success = image.loadPicture(cache, fromCache, image.imgInfo.actualPageNumber, cms, ScImage::RGBData, gsResolution, &dummy, showMessages);
+	if (!success)
+		return false;
+
+	if (fromCache)
+	{
+		origWidth = cache.getInfo("OrigW").toInt();
+		origHeight = cache.getInfo("OrigH").toInt();
+	}
+	else
+	{
+		origWidth = image.width();
+		origHeight = image.height();
+		cache.addInfo("OrigW", QString::number(origWidth));
+		cache.addInfo("OrigH", QString::number(origHeight));
+	}
+
+	if (!isRaster)
+	{
+		effects.clear();
+		cache.delModifier("effectsInUse");
+	}
+	return true;
+}
+
+void ImageLoadJob::process()
+{
+	if (!success)
+		return;
+	if (!fromCache)
+	{
+		image.applyEffect(effects, colors, false);
+		image.imgInfo.lowResType = lowResType;
+		if (image.imgInfo.lowResType != 0)
+		{
+			double scaling = image.imgInfo.xres / 36.0;
+			if (image.imgInfo.lowResType == 1)
+				scaling = image.imgInfo.xres / 72.0;
+			// Prevent exagerately large images when using low res preview modes
+			uint pixels = qRound(image.width() * image.height() / (scaling * scaling));
+			if (pixels > 3000000)
+			{
+				double ratio = pixels / 3000000.0;
+				scaling *= sqrt(ratio);
+			}
+			if (image.createLowRes(scaling))
+			{
+				image.imgInfo.lowResScale = scaling;
+				image.saveCache(cache);
+			}
+			else
+				image.imgInfo.lowResScale = 1.0;
+		}
+	}
+	if (viewAsPreview)
+	{
+		VisionDefectColor defect;
+		QColor tmpC;
+		int h = image.qImagePtr()->height();
+		int w = image.qImagePtr()->width();
+		int r, g, b, a;
+		QRgb *s;
+		QRgb rgb;
+		for (int yi=0; yi < h; ++yi)
+		{
+			s = (QRgb*)(image.qImagePtr()->scanLine( yi ));
+			for (int xi = 0; xi < w; ++xi)
+			{
+				rgb = *s;
+				tmpC.setRgb(rgb);
+				tmpC = defect.convertDefect(tmpC, previewVisual);
+				a = qAlpha(rgb);
+				tmpC.getRgb(&r, &g, &b);
+				*s = qRgba(r, g, b, a);
+				s++;
+			}
+		}
+	}
+}
+
+void ImageLoadJob::adoptResult(const ImageLoadJob& other)
+{
+	// Shallow copy, the frames share the pixels until one of them changes them
+	image = other.image;
+	effects = other.effects;
+	success = other.success;
+	fromCache = other.fromCache;
+	origWidth = other.origWidth;
+	origHeight = other.origHeight;
+}
+
+QString ImageLoadJob::key() const
+{
+	// Layer and path requests depend on more than the file
+	if (image.imgInfo.isRequest)
+		return QString();
+	QStringList parts;
+	parts << fileName
+	      << QString::number(image.imgInfo.actualPageNumber)
+	      << cms.profileName()
+	      << QString::number(static_cast<int>(cms.intent()))
+	      << QString::number(static_cast<int>(cms.useEmbeddedProfile()))
+	      << QString::number(lowResType)
+	      << QString::number(gsResolution)
+	      << effectsModifier
+	      << QString::number(static_cast<int>(viewAsPreview))
+	      << QString::number(previewVisual);
+	return parts.join(QChar('\n'));
+}
+
+ImageLoadQueue::ImageLoadQueue(qint64 memoryBudget) :
+	m_memoryBudget(memoryBudget)
+{
+}
+
+void ImageLoadQueue::addItem(PageItem* item)
+{
+	m_items.append(item);
+}
+
+QList<int> ImageLoadQueue::groupByKey(const QStringList& keys)
+{
+	QList<int> owners;
+	owners.reserve(keys.count());
+	QHash<QString, int> firstIndex;
+	for (int i = 0; i < keys.count(); ++i)
+	{
+		const QString& key = keys.at(i);
+		if (key.isEmpty())
+		{
+			owners.append(i);
+			continue;
+		}
+		auto it = firstIndex.constFind(key);
+		if (it == firstIndex.constEnd())
+		{
+			firstIndex.insert(key, i);
+			owners.append(i);
+		}
+		else
+			owners.append(it.value());
+	}
+	return owners;
+}
+
+bool ImageLoadQueue::fitsBudget(qint64 bytesInFlight, qint64 bytes, qint64 memoryBudget, int running)
+{
+	return (running == 0) || (bytesInFlight + bytes <= memoryBudget);
+}
+
+int ImageLoadQueue::run(const ProgressFunction& progress)
+{
+	const int total = m_items.count();
+	if (total == 0)
+		return 0;
+
+	QList< QSharedPointer<ImageLoadJob> > jobs;
+	jobs.reserve(total);
+	for (PageItem* item : qAsConst(m_items))
+		jobs.append(QSharedPointer<ImageLoadJob>(item->createImageLoadJob(item->Pfile)));
+
+	int done = 0;
+	int loaded = 0;
+	runJobs(std::move(jobs), m_memoryBudget, parallelThreadCount(), [&](int index, ImageLoadJob& job)
+	{
+		PageItem* item = m_items.at(index);
+		if (item->finishImageLoad(job, true))
+		{
+			++loaded;
+			if (!item->doc()->isLoading())
+				item->update();
+		}
+		++done;
+		return !progress || progress(done, total);
+	});
+	return loaded;
+}
+
+void ImageLoadQueue::runJobs(QList< QSharedPointer<ImageLoadJob> > jobs, qint64 memoryBudget, int maxThreads, const FinishFunction& finish)
+{
+	const int total = jobs.count();
+	QStringList keys;
+	keys.reserve(total);
+	for (const QSharedPointer<ImageLoadJob>& job : qAsConst(jobs))
+		keys.append(job->key());
+
+	// Only the first job of each group is run, the others take over its result
+	const QList<int> owners = groupByKey(keys);
+	QList<int> pending;
+	QHash<int, QList<int> > followers;
+	for (int i = 0; i < total; ++i)
+	{
+		if (owners.at(i) == i)
+			pending.append(i);
+		else
+			followers[owners.at(i)].append(i);
+	}
+
+	ImageLoadResults results;
+	int next = 0;
+	int running = 0;
+	qint64 bytesInFlight = 0;
+	bool canceled = false;
+	while (running > 0 || (!canceled && next < pending.count()))
+	{
+		while (!canceled && next < pending.count() && running < maxThreads)
+		{
+			int index = pending.at(next);
+			ImageLoadJob* job = jobs.at(index).data();
+			if (!fitsBudget(bytesInFlight, job->expectedBytes(), memoryBudget, running))
+				break;
+			bytesInFlight += job->expectedBytes();
+			++running;
+			++next;
+			ImageLoadTask* task = new ImageLoadTask(job, index, &results);
+			if (maxThreads > 1 && job->canRunInThread())
+				QThreadPool::globalInstance()->start(task);
+			else
+			{
+				task->run();
+				delete task;
+			}
+		}
+
+		const QList<int> finished = results.wait();
+		for (int index : finished)
+		{
+			--running;
+			QSharedPointer<ImageLoadJob> job = jobs.at(index);
+			bytesInFlight -= job->expectedBytes();
+			QList<int> group;
+			group << index << followers.value(index);
+			for (int member : qAsConst(group))
+			{
+				if (member != index)
+					jobs[member]->adoptResult(*job);
+				if (!finish(member, *jobs[member]))
+					canceled = true;
+				jobs[member].reset();
+			}
+		}
+	}
+}
+
+BackgroundImageLoader::BackgroundImageLoader(ScribusDoc* doc) :
+	m_doc(doc),
+	m_results(new ImageLoadResults(this)),
+	m_memoryBudget(qint64(PrefsManager::instance().appPrefs.imageCachePrefs.loadMemoryMiB) * 1024 * 1024),
+	m_maxThreads(parallelThreadCount())
+{
+}
+
+BackgroundImageLoader::~BackgroundImageLoader()
+{
+	cancel();
+	waitForRunningJobs();
+	delete m_results;
+}
+
+void BackgroundImageLoader::addItem(PageItem* item)
+{
+	item->imageLoadPending = true;
+	m_pending.append(item);
+	++m_total;
+	if (!m_startScheduled)
+	{
+		m_startScheduled = true;
+		QTimer::singleShot(0, this, SLOT(start()));
+	}
+}
+
+void BackgroundImageLoader::removeItem(PageItem* item)
+{
+	item->imageLoadPending = false;
+	m_total -= m_pending.removeAll(item);
+	for (auto it = m_running.begin(); it != m_running.end(); ++it)
+	{
+		if (it->item == item)
+			it->item.clear();
+	}
+}
+
+void BackgroundImageLoader::cancel()
+{
+	for (const QPointer<PageItem>& item : qAsConst(m_pending))
+	{
+		if (item)
+			item->imageLoadPending = false;
+	}
+	m_pending.clear();
+	for (auto it = m_running.begin(); it != m_running.end(); ++it)
+	{
+		if (it->item)
+			it->item->imageLoadPending = false;
+		it->item.clear();
+	}
+}
+
+void BackgroundImageLoader::finish()
+{
+	while (isBusy())
+	{
+		startJobs();
+		if (!m_running.isEmpty())
+			applyFinished(m_results->wait());
+	}
+}
+
+void BackgroundImageLoader::start()
+{
+	m_startScheduled = false;
+	// Wait until the frames have their final position and the view is set up
+	if (m_doc->isLoading())
+	{
+		m_startScheduled = true;
+		QTimer::singleShot(100, this, SLOT(start()));
+		return;
+	}
+	startJobs();
+}
+
+void BackgroundImageLoader::applyResults()
+{
+	applyFinished(m_results->take());
+	startJobs();
+}
+
+int BackgroundImageLoader::nextItemIndex() const
+{
+	ScribusView* view = m_doc->view();
+	if (view == nullptr)
+		return 0;
+	QRectF visible = view->visibleCanvasRect();
+	QPointF center = visible.center();
+	int best = 0;
+	double bestDistance = -1.0;
+	for (int i = 0; i < m_pending.count(); ++i)
+	{
+		const PageItem* item = m_pending.at(i);
+		if (item == nullptr)
+			return i;
+		QRectF bounds = item->getVisualBoundingRect();
+		if (bounds.intersects(visible))
+			return i;
+		QPointF delta = bounds.center() - center;
+		double distance = delta.x() * delta.x() + delta.y() * delta.y();
+		if ((bestDistance < 0.0) || (distance < bestDistance))
+		{
+			best = i;
+			bestDistance = distance;
+		}
+	}
+	return best;
+}
+
+void BackgroundImageLoader::startJobs()
+{
+	while (!m_pending.isEmpty() && m_running.count() < m_maxThreads)
+	{
+		QPointer<PageItem> item = m_pending.takeAt(nextItemIndex());
+		if (item.isNull())
+		{
+			++m_done;
+			continue;
+		}
+		QSharedPointer<ImageLoadJob> job(item->createImageLoadJob(item->Pfile));
+		if (!ImageLoadQueue::fitsBudget(m_bytesInFlight, job->expectedBytes(), m_memoryBudget, m_running.count()))
+		{
+			m_pending.prepend(item);
+			break;
+		}
+		RunningJob running;
+		running.item = item;
+		running.job = job;
+		running.key = job->key();
+		// load one of the jobs which must stay in this thread now and come back for the others
+		if (!job->canRunInThread())
+		{
+			if (job->decode())
+				job->process();
+			applyJob(running);
+			if (!m_startScheduled)
+			{
+				m_startScheduled = true;
+				QTimer::singleShot(0, this, SLOT(start()));
+			}
+			return;
+		}
+		int id = m_nextJobId++;
+		m_running.insert(id, running);
+		m_bytesInFlight += job->expectedBytes();
+		QThreadPool::globalInstance()->start(new ImageLoadTask(job.data(), id, m_results));
+	}
+	if (!isBusy() && (m_total > 0))
+	{
+		m_done = 0;
+		m_total = 0;
+		emit finished();
+	}
+}
+
+void BackgroundImageLoader::applyFinished(const QList<int>& ids)
+{
+	for (int id : ids)
+	{
+		RunningJob running = m_running.take(id);
+		m_bytesInFlight -= running.job->expectedBytes();
+		applyJob(running);
+	}
+}
+
+void BackgroundImageLoader::applyJob(const RunningJob& running)
+{
+	++m_done;
+	if (running.item)
+		finishItem(running.item, *running.job);
+
+	// Other frames showing the same picture take it over
+	if (!running.key.isEmpty())
+	{
+		for (int i = m_pending.count() - 1; i >= 0; --i)
+		{
+			PageItem* item = m_pending.at(i);
+			if ((item == nullptr) || (item->Pfile != running.job->fileName))
+				continue;
+			QScopedPointer<ImageLoadJob> job(item->createImageLoadJob(item->Pfile));
+			if (job->key() != running.key)
+				continue;
+			job->adoptResult(*running.job);
+			m_pending.removeAt(i);
+			++m_done;
+			finishItem(item, *job);
+		}
+	}
+	emit progress(m_done, m_total);
+}
+
+void BackgroundImageLoader::finishItem(PageItem* item, ImageLoadJob& job)
+{
+	// Like after loading the picture in the file loader, the offsets stored in the document win
+	double imageXOffset = item->imageXOffset();
+	double imageYOffset = item->imageYOffset();
+	QString clipPath = job.usedPath;
+	item->imageLoadPending = false;
+	bool loaded = item->finishImageLoad(job, true);
+	if (m_doc->hasGUI())
+	{
+		if (loaded)
+			ScCore->fileWatcher->addFile(item->Pfile);
+		else
+			ScCore->fileWatcher->addDir(QFileInfo(item->Pfile).absolutePath());
+	}
+	if (loaded)
+	{
+		item->setImageXYOffset(imageXOffset, imageYOffset);
+		if (item->pixm.imgInfo.PDSpathData.contains(clipPath))
+		{
+			item->imageClip = item->pixm.imgInfo.PDSpathData[clipPath].copy();
+			item->pixm.imgInfo.usedPath = clipPath;
+			QTransform cl;
+			cl.translate(item->imageXOffset() * item->imageXScale(), item->imageYOffset() * item->imageYScale());
+			cl.scale(item->imageXScale(), item->imageYScale());
+			item->imageClip.map(cl);
+		}
+	}
+	item->update();
+}
+
+void BackgroundImageLoader::waitForRunningJobs()
+{
+	while (!m_running.isEmpty())
+	{
+		const QList<int> finished = m_results->wait();
+		for (int id : finished)
+		{
+			RunningJob running = m_running.take(id);
+			m_bytesInFlight -= running.job->expectedBytes();
+		}
+	}
+}
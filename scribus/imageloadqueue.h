@@ -0,0 +1,192 @@
+/*
+For general Scribus (>=1.3.2) copyright and licensing information please refer
+to the COPYING file provided with the program. Following this notice may exist
+a copyright and/or license notice that predates the release of Scribus 1.3.2
+for which a new license (GPL+exception) is in place.
+*/
+
+#ifndef IMAGELOADQUEUE_H
+#define IMAGELOADQUEUE_H
+
+#include <functional>
+
+#include <QHash>
+#include <QList>
+#include <QObject>
+#include <QPointer>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+
+#include "scribusapi.h"
+#include "cmsettings.h"
+#include "sccolor.h"
+#include "scimage.h"
+#include "scimagecacheproxy.h"
+
+class ImageLoadResults;
+class PageItem;
+class ScribusDoc;
+
+/**
+  * @brief The part of loading the picture of an image frame which does not touch the frame.
+  *
+  * A job is created by PageItem::createImageLoadJob() and applied by
+  * PageItem::finishImageLoad(), both in the GUI thread. In between,
+  * decode() and process() run in a worker thread if canRunInThread()
+  * says so. The color management settings are detached from the document
+  * when the job is created. Color effects convert their colors with the
+  * document's transforms, so jobs using them run in the GUI thread, as do
+  * PDF and PostScript files.
+  */
+class SCRIBUS_API ImageLoadJob
+{
+public:
+	ImageLoadJob(ScribusDoc* doc, const QString& fileName, const QString& profile, eRenderIntent intent);
+	virtual ~ImageLoadJob() = default;
+
+	/// Loads the picture from the image cache or from the file
+	virtual bool decode();
+	/// Applies the image effects, creates the low resolution preview and updates the image cache
+	virtual void process();
+	/// Takes over the result of another job which loaded the same picture with the same settings
+	void adoptResult(const ImageLoadJob& other);
+
+	/// Jobs with the same non empty key produce the same picture
+	QString key() const;
+	/// Memory the decoded picture is expected to need, in bytes
+	qint64 expectedBytes() const { return m_expectedBytes; }
+	/// Ghostscript renders to fixed temporary file names and color effects read the document, other jobs may run in any thread
+	bool canRunInThread() const { return isRaster && !effects.useColorEffect(); }
+
+	QString fileName;
+	ScImage image;
+	CMSettings cms;
+	ScImageCacheProxy cache;
+	int gsResolution { 72 };
+	int lowResType { 1 };
+	QString usedPath;
+	ScImageEffectList effects;
+	QString effectsModifier;
+	ColorList colors;
+	bool isRaster { true };
+	bool showMessages { false };
+	/// The embedded picture could not be read from the document's image store
+	bool storeMissing { false };
+	bool viewAsPreview { false };
+	int previewVisual { 0 };
+
+	bool success { false };
+	bool fromCache { false };
+	int origWidth { 0 };
+	int origHeight { 0 };
+
+protected:
+	friend class PageItem;
+	qint64 m_expectedBytes { 0 };
+};
+
+/**
+  * @brief Reloads the pictures of many image frames on the global thread pool.
+  *
+  * Frames showing the same file with the same settings are only loaded once
+  * and share the resulting image. Pictures are loaded while the memory
+  * expected for the pictures in flight stays within the budget; one picture
+  * is always loaded, whatever its size. PDF and PostScript files are
+  * rendered in the calling thread. Loaded pictures are applied to their
+  * frames in the calling thread, which must be the GUI thread.
+  */
+class SCRIBUS_API ImageLoadQueue
+{
+public:
+	/// Called after each frame with the number of frames done, returning false cancels the remaining frames
+	typedef std::function<bool(int done, int total)> ProgressFunction;
+	/// Called in the calling thread for each job done, returning false cancels the jobs not started yet
+	typedef std::function<bool(int index, ImageLoadJob& job)> FinishFunction;
+
+	explicit ImageLoadQueue(qint64 memoryBudget);
+
+	void addItem(PageItem* item);
+	int count() const { return m_items.count(); }
+
+	/// Reloads all added frames and returns the number of frames whose picture could be loaded
+	int run(const ProgressFunction& progress = ProgressFunction());
+
+	/// For each key, the index of the first equal key, empty keys are never equal
+	static QList<int> groupByKey(const QStringList& keys);
+	/// Whether a job expecting to need bytes may start while running jobs expect bytesInFlight
+	static bool fitsBudget(qint64 bytesInFlight, qint64 bytes, qint64 memoryBudget, int running);
+	/// Runs the jobs within the memory budget, of jobs with equal keys only the first one is run and the others adopt its result.
+	/// Jobs are dropped once finish was called for them.
+	static void runJobs(QList< QSharedPointer<ImageLoadJob> > jobs, qint64 memoryBudget, int maxThreads, const FinishFunction& finish);
+
+private:
+	QList<PageItem*> m_items;
+	qint64 m_memoryBudget;
+};
+
+/**
+  * @brief Loads the pictures of image frames in the background after a document was opened.
+  *
+  * Frames added to the loader show a placeholder until their picture is
+  * there. Pictures are loaded on the global thread pool once the document
+  * has finished loading, those closest to the visible part of the view
+  * first, within the same memory budget as ImageLoadQueue. Frames showing
+  * the same picture share it.
+  */
+class SCRIBUS_API BackgroundImageLoader : public QObject
+{
+	Q_OBJECT
+
+public:
+	explicit BackgroundImageLoader(ScribusDoc* doc);
+	~BackgroundImageLoader() override;
+
+	/// Defers loading the picture of a frame, loading starts by itself when the document is loaded
+	void addItem(PageItem* item);
+	/// Forgets a frame, a picture being loaded for it is dropped
+	void removeItem(PageItem* item);
+	bool isBusy() const { return !m_pending.isEmpty() || !m_running.isEmpty(); }
+
+	/// Drops the frames whose picture is not loaded yet, they keep their placeholder
+	void cancel();
+	/// Loads all remaining pictures before returning
+	void finish();
+
+signals:
+	void progress(int done, int total);
+	void finished();
+
+private slots:
+	void start();
+	void applyResults();
+
+private:
+	struct RunningJob
+	{
+		QPointer<PageItem> item;
+		QSharedPointer<ImageLoadJob> job;
+		QString key;
+	};
+
+	int nextItemIndex() const;
+	void startJobs();
+	void applyFinished(const QList<int>& ids);
+	void applyJob(const RunningJob& running);
+	void finishItem(PageItem* item, ImageLoadJob& job);
+	void waitForRunningJobs();
+
+	ScribusDoc* m_doc;
+	ImageLoadResults* m_results;
+	QList< QPointer<PageItem> > m_pending;
+	QHash<int, RunningJob> m_running;
+	qint64 m_memoryBudget;
+	qint64 m_bytesInFlight { 0 };
+	int m_maxThreads;
+	int m_nextJobId { 0 };
+	int m_done { 0 };
+	int m_total { 0 };
+	bool m_startScheduled { false };
+};
+
+#endif
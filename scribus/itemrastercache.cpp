@@ -0,0 +1,88 @@
+/*
+ For general Scribus (>=1.3.2) copyright and licensing information please refer
+ to the COPYING file provided with the program. Following this notice may exist
+ a copyright and/or license notice that predates the release of Scribus 1.3.2
+ for which a new license (GPL+exception) is in place.
+ */
+
+#include "itemrastercache.h"
+
+ItemRasterCache::ItemRasterCache(qint64 maxBytes) :
+	m_maxBytes(qMax<qint64>(0, maxBytes))
+{
+}
+
+void ItemRasterCache::setMaxBytes(qint64 maxBytes)
+{
+	m_maxBytes = qMax<qint64>(0, maxBytes);
+	evict(0);
+}
+
+bool ItemRasterCache::find(quint64 revision, uint state, QImage& image, QPoint& position)
+{
+	Key key = { revision, state };
+	auto it = m_entries.find(key);
+	if (it == m_entries.end())
+		return false;
+	it->lastUse = ++m_useCounter;
+	image = it->image;
+	position = it->position;
+	return true;
+}
+
+bool ItemRasterCache::insert(quint64 revision, uint state, const QImage& image, QPoint position, const QRectF& canvasRect)
+{
+	qint64 imageBytes = image.sizeInBytes();
+	if (imageBytes > m_maxBytes)
+		return false;
+	Key key = { revision, state };
+	auto it = m_entries.find(key);
+	if (it != m_entries.end())
+	{
+		m_bytes -= it->image.sizeInBytes();
+		m_entries.erase(it);
+	}
+	evict(imageBytes);
+	Entry& entry = m_entries[key];
+	entry.image = image;
+	entry.position = position;
+	entry.canvasRect = canvasRect;
+	entry.lastUse = ++m_useCounter;
+	m_bytes += imageBytes;
+	return true;
+}
+
+void ItemRasterCache::invalidate(const QRectF& canvasRect)
+{
+	for (auto it = m_entries.begin(); it != m_entries.end(); )
+	{
+		if (it->canvasRect.intersects(canvasRect))
+		{
+			m_bytes -= it->image.sizeInBytes();
+			it = m_entries.erase(it);
+		}
+		else
+			++it;
+	}
+}
+
+void ItemRasterCache::clear()
+{
+	m_entries.clear();
+	m_bytes = 0;
+}
+
+void ItemRasterCache::evict(qint64 neededBytes)
+{
+	while (!m_entries.isEmpty() && (m_bytes + neededBytes > m_maxBytes))
+	{
+		auto oldest = m_entries.begin();
+		for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+		{
+			if (it->lastUse < oldest->lastUse)
+				oldest = it;
+		}
+		m_bytes -= oldest->image.sizeInBytes();
+		m_entries.erase(oldest);
+	}
+}
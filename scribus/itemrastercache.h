@@ -0,0 +1,72 @@
+/*
+ For general Scribus (>=1.3.2) copyright and licensing information please refer
+ to the COPYING file provided with the program. Following this notice may exist
+ a copyright and/or license notice that predates the release of Scribus 1.3.2
+ for which a new license (GPL+exception) is in place.
+ */
+
+#ifndef ITEMRASTERCACHE_H
+#define ITEMRASTERCACHE_H
+
+#include <QHash>
+#include <QImage>
+#include <QPoint>
+#include <QRectF>
+
+#include "scribusapi.h"
+
+/**
+  Cache of rasterized page items, used by the canvas to blit complex items
+  which did not change instead of drawing them again.
+
+  Entries are identified by the render revision of the item, which is unique
+  across all items and changes whenever the item is reported as changed, and
+  by a hash of the state the item was drawn with (zoom, sub-pixel position,
+  preview and color management settings). The total size of the images is
+  kept below a budget by dropping the least recently used entries.
+ */
+class SCRIBUS_API ItemRasterCache
+{
+public:
+	explicit ItemRasterCache(qint64 maxBytes = 64 * 1024 * 1024);
+
+	void setMaxBytes(qint64 maxBytes);
+	qint64 maxBytes() const { return m_maxBytes; }
+
+	/// Returns the image of an item and its position in device pixels
+	bool find(quint64 revision, uint state, QImage& image, QPoint& position);
+	/// Adds an image unless it alone exceeds the budget, canvasRect is the area it covers in document coordinates
+	bool insert(quint64 revision, uint state, const QImage& image, QPoint position, const QRectF& canvasRect);
+
+	/// Drops the images which overlap the given rectangle in document coordinates
+	void invalidate(const QRectF& canvasRect);
+	void clear();
+	int count() const { return m_entries.count(); }
+	qint64 bytes() const { return m_bytes; }
+
+private:
+	struct Key
+	{
+		quint64 revision;
+		uint state;
+		bool operator==(const Key& other) const { return revision == other.revision && state == other.state; }
+	};
+	friend uint qHash(const Key& key, uint seed) { return qHash(key.revision, seed) ^ key.state; }
+
+	struct Entry
+	{
+		QImage image;
+		QPoint position;
+		QRectF canvasRect;
+		quint64 lastUse { 0 };
+	};
+
+	void evict(qint64 neededBytes);
+
+	QHash<Key, Entry> m_entries;
+	qint64 m_maxBytes;
+	qint64 m_bytes { 0 };
+	quint64 m_useCounter { 0 };
+};
+
+#endif
@@ -23,9 +23,11 @@ for which a new license (GPL+exception) is in place.
 
 #include "pageitem.h"
 
+#include <QAtomicInteger>
 #include <QDebug>
 #include <QFileInfo>
 #include <QFont>
+#include <QImageReader>
 #include <QMessageBox>
 #include <QPainter>
 #include <QPen>
@@ -35,6 +37,7 @@ for which a new license (GPL+exception) is in place.
 #include <QRegExp>
 #include <QRegion>
 #include <QRegularExpression>
+#include <QScopedPointer>
 #include <cairo.h>
 #include <cassert>
 #include <qdrawutil.h>
@@ -45,8 +48,10 @@ for which a new license (GPL+exception) is in place.
 #include "canvasmode.h"
 #include "cmsettings.h"
 #include "colorblind.h"
+#include "commonstrings.h"
 #include "desaxe/saxXML.h"
 #include "iconmanager.h"
+#include "imageloadqueue.h"
 #include "marks.h"
 #include "pageitem_arc.h"
 #include "pageitem_group.h"
@@ -59,6 +64,7 @@ for which a new license (GPL+exception) is in place.
 #include "pageitem_textframe.h"
 #include "prefsmanager.h"
 #include "resourcecollection.h"
+#include "scblobstore.h"
 #include "scclocale.h"
 #include "sccolorengine.h"
 #include "scimagecacheproxy.h"
@@ -78,6 +84,7 @@ for which a new license (GPL+exception) is in place.
 #include "ui/contentpalette.h"
 #include "ui/guidemanager.h"
 #include "ui/propertiespalette.h"
+#include "ui/scmessagebox.h"
 #include "undomanager.h"
 #include "undostate.h"
 #include "units.h"
@@ -92,6 +99,8 @@ for which a new license (GPL+exception) is in place.
 
 using namespace std;
 
+static QAtomicInteger<quint64> renderRevisionCounter(0);
+
 PageItem::PageItem(const PageItem & other)
 	: QObject(other.parent()),
 	 UndoObject(other),
@@ -374,6 +383,7 @@ PageItem::PageItem(const PageItem & other)
 	
 	uniqueNr = m_Doc->TotalItems;
 	invalid = true;
+	newRenderRevision();
 	if (other.isInlineImage)
 	{
 		QFileInfo inlFi(Pfile);
@@ -383,6 +393,7 @@ PageItem::PageItem(const PageItem & other)
 		tempFile->open();
 		QString fileName = getLongPathName(tempFile->fileName());
 		tempFile->close();
+		ScBlobStore::materialize(Pfile);
 		copyFile(Pfile, fileName);
 		Pfile = fileName;
 		delete tempFile;
@@ -522,6 +533,7 @@ PageItem::PageItem(ScribusDoc *doc, ItemType newType, double x, double y, double
 	}
 	
 	uniqueNr = m_Doc->TotalItems;
+	newRenderRevision();
 	setUName(m_itemName);
 	m_annotation.setBorderColor(outline);
 
@@ -703,7 +715,10 @@ PageItem::PageItem(ScribusDoc *doc, ItemType newType, double x, double y, double
 PageItem::~PageItem()
 {
 	if ((isTempFile) && (!Pfile.isEmpty()))
-		QFile::remove(Pfile);
+	{
+		if (releaseTempFile(Pfile))
+			ScBlobStore::discard(Pfile);
+	}
 	//remove marks
 
 	if (isTextFrame())
@@ -751,6 +766,7 @@ bool PageItem::isTableCell() const
 void PageItem::setXPos(const double newXPos, bool drawingOnly)
 {
 	m_xPos = newXPos;
+	boundsChanged();
 	if (drawingOnly || m_Doc->isLoading())
 		return;
 	checkChanges();
@@ -759,6 +775,7 @@ void PageItem::setXPos(const double newXPos, bool drawingOnly)
 void PageItem::setYPos(const double newYPos, bool drawingOnly)
 {
 	m_yPos = newYPos;
+	boundsChanged();
 	if (drawingOnly || m_Doc->isLoading())
 		return;
 	checkChanges();
@@ -768,6 +785,7 @@ void PageItem::setXYPos(const double newXPos, const double newYPos, bool drawing
 {
 	m_xPos = newXPos;
 	m_yPos = newYPos;
+	boundsChanged();
 	if (drawingOnly || m_Doc->isLoading())
 		return;
 	checkChanges();
@@ -802,6 +820,7 @@ void PageItem::moveBy(const double dX, const double dY, bool drawingOnly)
 		gYpos += dY;
 		BoundingY += dY;
 	}
+	boundsChanged();
 	if (drawingOnly || m_Doc->isLoading())
 		return;
 	moveWelded(dX, dY);
@@ -811,6 +830,7 @@ void PageItem::moveBy(const double dX, const double dY, bool drawingOnly)
 void PageItem::setWidth(double newWidth)
 {
 	m_width = newWidth;
+	boundsChanged();
 	updateConstants();
 	if (m_Doc->isLoading())
 		return;
@@ -820,6 +840,7 @@ void PageItem::setWidth(double newWidth)
 void PageItem::setHeight(double newHeight)
 {
 	m_height = newHeight;
+	boundsChanged();
 	updateConstants();
 	if (m_Doc->isLoading())
 		return;
@@ -830,6 +851,7 @@ void PageItem::setWidthHeight(double newWidth, double newHeight, bool drawingOnl
 {
 	m_width = newWidth;
 	m_height = newHeight;
+	boundsChanged();
 	updateConstants();
 	if (drawingOnly)
 		return;
@@ -840,6 +862,7 @@ void PageItem::setWidthHeight(const double newWidth, const double newHeight)
 {
 	m_width = newWidth;
 	m_height = newHeight;
+	boundsChanged();
 	updateConstants();
 	if (m_Doc->isLoading())
 		return;
@@ -854,6 +877,7 @@ void PageItem::resizeBy(const double dH, const double dW)
 		m_width += dH;
 	if (dW != 0.0)
 		m_height += dW;
+	boundsChanged();
 	updateConstants();
 	if (m_Doc->isLoading())
 		return;
@@ -869,6 +893,7 @@ void PageItem::setRotation(const double newRotation, bool drawingOnly)
 		m_rotation += 360.0;
 	while (m_rotation > 360.0)
 		m_rotation -= 360.0;
+	boundsChanged();
 	if (drawingOnly || m_Doc->isLoading())
 		return;
 	rotateWelded(dR, oldRot);
@@ -884,6 +909,7 @@ void PageItem::rotateBy(const double dR)
 		m_rotation += 360.0;
 	while (m_rotation > 360.0)
 		m_rotation -= 360.0;
+	boundsChanged();
 	if (m_Doc->isLoading())
 		return;
 	checkChanges();
@@ -1595,6 +1621,12 @@ void PageItem::setCornerRadius(double newRadius)
 
 
 
+// Gives the item a revision no other item state had before, so cached renderings of it are dropped
+void PageItem::newRenderRevision()
+{
+	m_renderRevision = ++renderRevisionCounter;
+}
+
 /** Paints the item.
     CHANGE: cullingArea is in doc coordinates!
  */
@@ -2412,6 +2444,7 @@ void PageItem::setItemName(const QString& newName)
 		return;
 	QString oldName = m_itemName;
 	m_itemName = generateUniqueCopyName(newName);
+	m_Doc->itemNameIndex().itemRenamed(this, oldName);
 	AutoName=false;
 	if (UndoManager::undoEnabled())
 	{
@@ -3902,6 +3935,7 @@ void PageItem::setLineWidth(double newWidth)
 	}
 	m_oldLineWidth=m_lineWidth;
 	m_lineWidth = newWidth;
+	boundsChanged();
 }
 
 void PageItem::setLineEnd(Qt::PenCapStyle newStyle)
@@ -7260,6 +7294,7 @@ void PageItem::restoreShapeType(SimpleState *state, bool isUndo)
 		ClipEdited = (FrameType == 0 || FrameType == 1);
 	}
 	Clip = flattenPath(PoLine,Segments);
+	boundsChanged();
 }
 
 void PageItem::restoreLayer(SimpleState *state, bool isUndo)
@@ -8450,6 +8485,7 @@ void PageItem::SetFrameShape(int count, const double *vals)
 	}
 	Clip = flattenPath(PoLine, Segments);
 	ClipEdited = true;
+	boundsChanged();
 }
 
 void PageItem::SetRectFrame()
@@ -8511,6 +8547,7 @@ void PageItem::SetFrameRound()
 	Clip = flattenPath(PoLine, Segments);
 	ClipEdited = false;
 	FrameType = 2;
+	boundsChanged();
 }
 
 QTransform PageItem::getGroupTransform() const
@@ -9134,13 +9171,13 @@ bool PageItem::mouseWithinItem(int x, int y, double scale) const
 	return transRect.contains(x, y);
 }
 
-QString PageItem::getImageEffectsModifier() const
+QString PageItem::getImageEffectsModifier(const ScImageEffectList& effects)
 {
 	bool first = true;
 	QString buffer;
 	QTextStream ts(&buffer);
-	ScImageEffectList::const_iterator i = effectsInUse.begin();
-	while (i != effectsInUse.end())
+	ScImageEffectList::const_iterator i = effects.begin();
+	while (i != effects.end())
 	{
 		if (first)
 			first = false;
@@ -9158,158 +9195,32 @@ bool PageItem::loadImage(const QString& filename, const bool reload, const int g
 	useImage |= (isAnnotation() && annotation().UseIcons());
 	if (!useImage)
 		return false;
-	QFileInfo fi(filename);
-	QString clPath(pixm.imgInfo.usedPath);
-	pixm.imgInfo.valid = false;
-	pixm.imgInfo.clipPath.clear();
-	pixm.imgInfo.PDSpathData.clear();
-	pixm.imgInfo.layerInfo.clear();
-	pixm.imgInfo.usedPath.clear();
-	imageClip.resize(0);
-	int lowResTypeBack = pixm.imgInfo.lowResType;
-	int gsRes = gsResolution;
-	if (gsResolution == -1) //If it wasn't supplied, get it from PrefsManager.
-		gsRes = PrefsManager::instance().gsResolution();
-	bool dummy;
-
-	CMSettings cms(m_Doc, ImageProfile, ImageIntent);
-	cms.setUseEmbeddedProfile(UseEmbedded);
-	cms.allowSoftProofing(true);
-
-	ScImageCacheProxy imgcache(filename);
-	imgcache.addModifier("lowResType", QString::number(pixm.imgInfo.lowResType));
-	if (!effectsInUse.isEmpty())
-		imgcache.addModifier("effectsInUse", getImageEffectsModifier());
-
-	bool fromCache = false;
-	if (!pixm.loadPicture(imgcache, fromCache, pixm.imgInfo.actualPageNumber, cms, ScImage::RGBData, gsRes, &dummy, showMsg))
-	{
-		Pfile = fi.absoluteFilePath();
-		imageIsAvailable = false;
-		return false;
-	}
-
-	QString ext = fi.suffix().toLower();
-	if (UndoManager::undoEnabled() && !reload)
+	QScopedPointer<ImageLoadJob> job(createImageLoadJob(filename, gsResolution, showMsg));
+	if (job->decode() && !job->fromCache)
 	{
-		ScItemState<ScImageEffectList> *is = new ScItemState<ScImageEffectList>(Um::GetImage, filename, Um::IGetImage);
-		is->set("GET_IMAGE");
-		is->set("OLD_IMAGE_PATH", Pfile);
-		is->set("NEW_IMAGE_PATH", filename);
-		is->set("FLIPPH",imageFlippedH());
-		is->set("FLIPPV",imageFlippedV());
-		is->set("SCALING",ScaleType);
-		is->set("ASPECT",AspectRatio);
-		is->set("XOFF",imageXOffset());
-		is->set("XSCALE",imageXScale());
-		is->set("YOFF",imageYOffset());
-		is->set("YSCALE",imageYScale());
-		is->set("FILLT", fillTransparency());
-		is->set("LINET", lineTransparency());
-		is->setItem(effectsInUse);
-		undoManager->action(this, is);
-	}
-	double xres = pixm.imgInfo.xres;
-	double yres = pixm.imgInfo.yres;
-	imageIsAvailable = true;
-		
-	if (Pfile != filename)
-	{
-		oldLocalScX = m_imageXScale = 72.0 / xres;
-		oldLocalScY = m_imageYScale = 72.0 / yres;
-		oldLocalX = m_imageXOffset = 0;
-		oldLocalY = m_imageYOffset = 0;
-		if ((m_Doc->itemToolPrefs().imageUseEmbeddedPath) && (!pixm.imgInfo.clipPath.isEmpty()))
-		{
-			pixm.imgInfo.usedPath = pixm.imgInfo.clipPath;
-			clPath = pixm.imgInfo.clipPath;
-			if (pixm.imgInfo.PDSpathData.contains(clPath))
-			{
-				imageClip = pixm.imgInfo.PDSpathData[clPath].copy();
-				pixm.imgInfo.usedPath = clPath;
-				QTransform cl;
-				cl.translate(m_imageXOffset*m_imageXScale, m_imageYOffset*m_imageYScale);
-				cl.scale(m_imageXScale, m_imageYScale);
-				imageClip.map(cl);
-			}
-		}
-	}
-		
-	Pfile = fi.absoluteFilePath();
-	if (reload && pixm.imgInfo.PDSpathData.contains(clPath))
-	{
-		imageClip = pixm.imgInfo.PDSpathData[clPath].copy();
-		pixm.imgInfo.usedPath = clPath;
-		QTransform cl;
-		cl.translate(m_imageXOffset*m_imageXScale, m_imageYOffset*m_imageYScale);
-		cl.scale(m_imageXScale, m_imageYScale);
-		imageClip.map(cl);
-	}
-	BBoxX = pixm.imgInfo.BBoxX;
-	BBoxH = pixm.imgInfo.BBoxH;
-	if (fromCache)
-	{
-		OrigW = imgcache.getInfo("OrigW").toInt();
-		OrigH = imgcache.getInfo("OrigH").toInt();
-	}
-	else
-	{
-		OrigW = pixm.width();
-		OrigH = pixm.height();
-		imgcache.addInfo("OrigW", QString::number(OrigW));
-		imgcache.addInfo("OrigH", QString::number(OrigH));
-	}
-
-	isRaster = !(extensionIndicatesPDF(ext) || extensionIndicatesEPSorPS(ext));
-	if (!isRaster)
-	{
-		effectsInUse.clear();
-		imgcache.delModifier("effectsInUse");
-	}
-
-	UseEmbedded = pixm.imgInfo.isEmbedded;
-	if (pixm.imgInfo.isEmbedded)
-		ImageProfile = "Embedded " + pixm.imgInfo.profileName;
-	else
-		ImageProfile = pixm.imgInfo.profileName;
-	if (!pixm.imgInfo.embeddedProfileName.isEmpty())
-		EmbeddedProfile = "Embedded " + pixm.imgInfo.embeddedProfileName;
-	else
-		EmbeddedProfile.clear();
-
-	adjustPictScale();
-
-	// #12408 : we set the old* variables to avoid creation of unwanted undo states
-	// when user perform actions such as double clicking image. We might want to
-	// create an undo transaction in this function if this does not work properly.
-	oldLocalScX = m_imageXScale;
-	oldLocalScY = m_imageYScale;
-
-	if (imageIsAvailable && !fromCache)
-	{
-		if ((pixm.imgInfo.colorspace == ColorSpaceDuotone) && (pixm.imgInfo.duotoneColors.count() != 0) && (!reload))
+		if ((job->image.imgInfo.colorspace == ColorSpaceDuotone) && (job->image.imgInfo.duotoneColors.count() != 0) && (!reload))
 		{
 			QString efVal = "";
-			for (int cc = 0; cc < pixm.imgInfo.duotoneColors.count(); cc++)
+			for (int cc = 0; cc < job->image.imgInfo.duotoneColors.count(); cc++)
 			{
-				if (!m_Doc->PageColors.contains(pixm.imgInfo.duotoneColors[cc].Name))
-					m_Doc->PageColors.insert(pixm.imgInfo.duotoneColors[cc].Name, pixm.imgInfo.duotoneColors[cc].Color);
-				efVal += pixm.imgInfo.duotoneColors[cc].Name + "\n";
+				if (!m_Doc->PageColors.contains(job->image.imgInfo.duotoneColors[cc].Name))
+					m_Doc->PageColors.insert(job->image.imgInfo.duotoneColors[cc].Name, job->image.imgInfo.duotoneColors[cc].Color);
+				efVal += job->image.imgInfo.duotoneColors[cc].Name + "\n";
 			}
 			m_Doc->scMW()->propertiesPalette->updateColorList();
 			m_Doc->scMW()->contentPalette->updateColorList();
 			struct ImageEffect ef;
-			if (pixm.imgInfo.duotoneColors.count() == 1)
+			if (job->image.imgInfo.duotoneColors.count() == 1)
 			{
 				efVal += "100";
 				ef.effectCode = ImageEffect::EF_COLORIZE;
 				ef.effectParameters = efVal;
 			}
-			else if (pixm.imgInfo.duotoneColors.count() == 2)
+			else if (job->image.imgInfo.duotoneColors.count() == 2)
 			{
 				efVal += "100 100";
 				QString tmp;
-				FPointArray Vals = pixm.imgInfo.duotoneColors[0].Curve;
+				FPointArray Vals = job->image.imgInfo.duotoneColors[0].Curve;
 				tmp.setNum(Vals.size());
 				efVal += " "+tmp;
 				for (int p = 0; p < Vals.size(); p++)
@@ -9318,7 +9229,7 @@ bool PageItem::loadImage(const QString& filename, const bool reload, const int g
 					efVal += QString(" %1 %2").arg(pv.x()).arg(pv.y());
 				}
 				efVal += " 0";
-				Vals = pixm.imgInfo.duotoneColors[1].Curve;
+				Vals = job->image.imgInfo.duotoneColors[1].Curve;
 				tmp.setNum(Vals.size());
 				efVal += " "+tmp;
 				for (int p = 0; p < Vals.size(); p++)
@@ -9330,11 +9241,11 @@ bool PageItem::loadImage(const QString& filename, const bool reload, const int g
 				ef.effectCode = ImageEffect::EF_DUOTONE;
 				ef.effectParameters = efVal;
 			}
-			else if (pixm.imgInfo.duotoneColors.count() == 3)
+			else if (job->image.imgInfo.duotoneColors.count() == 3)
 			{
 				efVal += "100 100 100";
 				QString tmp;
-				FPointArray Vals = pixm.imgInfo.duotoneColors[0].Curve;
+				FPointArray Vals = job->image.imgInfo.duotoneColors[0].Curve;
 				tmp.setNum(Vals.size());
 				efVal += " "+tmp;
 				for (int p = 0; p < Vals.size(); p++)
@@ -9343,7 +9254,7 @@ bool PageItem::loadImage(const QString& filename, const bool reload, const int g
 					efVal += QString(" %1 %2").arg(pv.x()).arg(pv.y());
 				}
 				efVal += " 0";
-				Vals = pixm.imgInfo.duotoneColors[1].Curve;
+				Vals = job->image.imgInfo.duotoneColors[1].Curve;
 				tmp.setNum(Vals.size());
 				efVal += " "+tmp;
 				for (int p = 0; p < Vals.size(); p++)
@@ -9352,7 +9263,7 @@ bool PageItem::loadImage(const QString& filename, const bool reload, const int g
 					efVal += QString(" %1 %2").arg(pv.x()).arg(pv.y());
 				}
 				efVal += " 0";
-				Vals = pixm.imgInfo.duotoneColors[2].Curve;
+				Vals = job->image.imgInfo.duotoneColors[2].Curve;
 				tmp.setNum(Vals.size());
 				efVal += " "+tmp;
 				for (int p = 0; p < Vals.size(); p++)
@@ -9364,11 +9275,11 @@ bool PageItem::loadImage(const QString& filename, const bool reload, const int g
 				ef.effectCode = ImageEffect::EF_TRITONE;
 				ef.effectParameters = efVal;
 			}
-			else if (pixm.imgInfo.duotoneColors.count() == 4)
+			else if (job->image.imgInfo.duotoneColors.count() == 4)
 			{
 				efVal += "100 100 100 100";
 				QString tmp;
-				FPointArray Vals = pixm.imgInfo.duotoneColors[0].Curve;
+				FPointArray Vals = job->image.imgInfo.duotoneColors[0].Curve;
 				tmp.setNum(Vals.size());
 				efVal += " "+tmp;
 				for (int p = 0; p < Vals.size(); p++)
@@ -9377,7 +9288,7 @@ bool PageItem::loadImage(const QString& filename, const bool reload, const int g
 					efVal += QString(" %1 %2").arg(pv.x()).arg(pv.y());
 				}
 				efVal += " 0";
-				Vals = pixm.imgInfo.duotoneColors[1].Curve;
+				Vals = job->image.imgInfo.duotoneColors[1].Curve;
 				tmp.setNum(Vals.size());
 				efVal += " "+tmp;
 				for (int p = 0; p < Vals.size(); p++)
@@ -9386,7 +9297,7 @@ bool PageItem::loadImage(const QString& filename, const bool reload, const int g
 					efVal += QString(" %1 %2").arg(pv.x()).arg(pv.y());
 				}
 				efVal += " 0";
-				Vals = pixm.imgInfo.duotoneColors[2].Curve;
+				Vals = job->image.imgInfo.duotoneColors[2].Curve;
 				tmp.setNum(Vals.size());
 				efVal += " "+tmp;
 				for (int p = 0; p < Vals.size(); p++)
@@ -9395,7 +9306,7 @@ bool PageItem::loadImage(const QString& filename, const bool reload, const int g
 					efVal += QString(" %1 %2").arg(pv.x()).arg(pv.y());
 				}
 				efVal += " 0";
-				Vals = pixm.imgInfo.duotoneColors[3].Curve;
+				Vals = job->image.imgInfo.duotoneColors[3].Curve;
 				tmp.setNum(Vals.size());
 				efVal += " "+tmp;
 				for (int p = 0; p < Vals.size(); p++)
@@ -9407,57 +9318,161 @@ bool PageItem::loadImage(const QString& filename, const bool reload, const int g
 				ef.effectCode = ImageEffect::EF_QUADTONE;
 				ef.effectParameters = efVal;
 			}
-			effectsInUse.append(ef);
-			imgcache.addModifier("effectsInUse", getImageEffectsModifier());
-		}
-		pixm.applyEffect(effectsInUse, m_Doc->PageColors, false);
-//		if (reload)
-			pixm.imgInfo.lowResType = lowResTypeBack;
-		if (pixm.imgInfo.lowResType != 0)
-		{
-			double scaling = pixm.imgInfo.xres / 36.0;
-			if (pixm.imgInfo.lowResType == 1)
-				scaling = pixm.imgInfo.xres / 72.0;
-			// Prevent exagerately large images when using low res preview modes
-			uint pixels = qRound(pixm.width() * pixm.height() / (scaling * scaling));
-			if (pixels > 3000000)
-			{
-				double ratio = pixels / 3000000.0;
-				scaling *= sqrt(ratio);
-			}
-			if (pixm.createLowRes(scaling))
-			{
-				pixm.imgInfo.lowResScale = scaling;
-				pixm.saveCache(imgcache);
-			}
-			else
-				pixm.imgInfo.lowResScale = 1.0;
+			job->effects.append(ef);
+			job->cache.addModifier("effectsInUse", getImageEffectsModifier(job->effects));
+			job->colors = m_Doc->PageColors;
 		}
 	}
-	if (imageIsAvailable && m_Doc->viewAsPreview)
+	job->process();
+	return finishImageLoad(*job, reload);
+}
+
+ImageLoadJob* PageItem::createImageLoadJob(const QString& filename, int gsResolution, bool showMsg)
+{
+	bool storeMissing = isInlineImage && !ScBlobStore::materialize(filename);
+	ImageLoadJob* job = new ImageLoadJob(m_Doc, filename, ImageProfile, ImageIntent);
+	job->storeMissing = storeMissing;
+	job->image.imgInfo = pixm.imgInfo;
+	job->image.imgInfo.valid = false;
+	job->image.imgInfo.clipPath.clear();
+	job->image.imgInfo.PDSpathData.clear();
+	job->image.imgInfo.layerInfo.clear();
+	job->image.imgInfo.usedPath.clear();
+	job->m_expectedBytes = pixm.sizeInBytes();
+	if (job->m_expectedBytes == 0)
 	{
-		VisionDefectColor defect;
-		QColor tmpC;
-		int h = pixm.qImagePtr()->height();
-		int w = pixm.qImagePtr()->width();
-		int r, g, b, a;
-		QRgb *s;
-		QRgb rgb;
-		for (int yi=0; yi < h; ++yi)
-		{
-			s = (QRgb*)(pixm.qImagePtr()->scanLine( yi ));
-			for (int xi = 0; xi < w; ++xi)
+		// Nothing loaded yet, guess from the file header
+		QSize size = QImageReader(filename).size();
+		if (size.isValid())
+			job->m_expectedBytes = qint64(size.width()) * size.height() * 4;
+	}
+	job->usedPath = pixm.imgInfo.usedPath;
+	job->lowResType = pixm.imgInfo.lowResType;
+	job->gsResolution = gsResolution;
+	if (gsResolution == -1) //If it wasn't supplied, get it from PrefsManager.
+		job->gsResolution = PrefsManager::instance().gsResolution();
+	job->showMessages = showMsg;
+
+	job->cms.setUseEmbeddedProfile(UseEmbedded);
+	job->cms.allowSoftProofing(true);
+
+	job->effects = effectsInUse;
+	job->effectsModifier = getImageEffectsModifier(effectsInUse);
+	job->colors = m_Doc->PageColors;
+	job->cache.addModifier("lowResType", QString::number(pixm.imgInfo.lowResType));
+	if (!effectsInUse.isEmpty())
+		job->cache.addModifier("effectsInUse", job->effectsModifier);
+
+	QString ext = QFileInfo(filename).suffix().toLower();
+	job->isRaster = !(extensionIndicatesPDF(ext) || extensionIndicatesEPSorPS(ext));
+	job->viewAsPreview = m_Doc->viewAsPreview;
+	job->previewVisual = m_Doc->previewVisual;
+	// the job may be decoded in another thread, which must not read the document's settings meanwhile
+	job->cms.detachFromDocument();
+	return job;
+}
+
+bool PageItem::finishImageLoad(ImageLoadJob& job, bool reload)
+{
+	const QString& filename = job.fileName;
+	QFileInfo fi(filename);
+	QString clPath(job.usedPath);
+	imageClip.resize(0);
+	if (!job.success)
+	{
+		pixm.imgInfo.valid = false;
+		pixm.imgInfo.clipPath.clear();
+		pixm.imgInfo.PDSpathData.clear();
+		pixm.imgInfo.layerInfo.clear();
+		pixm.imgInfo.usedPath.clear();
+		Pfile = fi.absoluteFilePath();
+		imageIsAvailable = false;
+		if (job.storeMissing && job.showMessages && ScCore->usingGUI())
+			ScMessageBox::warning(m_Doc->scMW(), CommonStrings::trWarning,
+								  tr("The embedded image of %1 could not be read. The image store (.blobs file) next to the document is missing or damaged.").arg(itemName()));
+		return false;
+	}
+
+	if (UndoManager::undoEnabled() && !reload)
+	{
+		ScItemState<ScImageEffectList> *is = new ScItemState<ScImageEffectList>(Um::GetImage, filename, Um::IGetImage);
+		is->set("GET_IMAGE");
+		is->set("OLD_IMAGE_PATH", Pfile);
+		is->set("NEW_IMAGE_PATH", filename);
+		is->set("FLIPPH",imageFlippedH());
+		is->set("FLIPPV",imageFlippedV());
+		is->set("SCALING",ScaleType);
+		is->set("ASPECT",AspectRatio);
+		is->set("XOFF",imageXOffset());
+		is->set("XSCALE",imageXScale());
+		is->set("YOFF",imageYOffset());
+		is->set("YSCALE",imageYScale());
+		is->set("FILLT", fillTransparency());
+		is->set("LINET", lineTransparency());
+		is->setItem(effectsInUse);
+		undoManager->action(this, is);
+	}
+	pixm = job.image;
+	effectsInUse = job.effects;
+	double xres = pixm.imgInfo.xres;
+	double yres = pixm.imgInfo.yres;
+	imageIsAvailable = true;
+		
+	if (Pfile != filename)
+	{
+		oldLocalScX = m_imageXScale = 72.0 / xres;
+		oldLocalScY = m_imageYScale = 72.0 / yres;
+		oldLocalX = m_imageXOffset = 0;
+		oldLocalY = m_imageYOffset = 0;
+		if ((m_Doc->itemToolPrefs().imageUseEmbeddedPath) && (!pixm.imgInfo.clipPath.isEmpty()))
+		{
+			pixm.imgInfo.usedPath = pixm.imgInfo.clipPath;
+			clPath = pixm.imgInfo.clipPath;
+			if (pixm.imgInfo.PDSpathData.contains(clPath))
 			{
-				rgb = *s;
-				tmpC.setRgb(rgb);
-				tmpC = defect.convertDefect(tmpC, m_Doc->previewVisual);
-				a = qAlpha(rgb);
-				tmpC.getRgb(&r, &g, &b);
-				*s = qRgba(r, g, b, a);
-				s++;
+				imageClip = pixm.imgInfo.PDSpathData[clPath].copy();
+				pixm.imgInfo.usedPath = clPath;
+				QTransform cl;
+				cl.translate(m_imageXOffset*m_imageXScale, m_imageYOffset*m_imageYScale);
+				cl.scale(m_imageXScale, m_imageYScale);
+				imageClip.map(cl);
 			}
 		}
 	}
+		
+	Pfile = fi.absoluteFilePath();
+	if (reload && pixm.imgInfo.PDSpathData.contains(clPath))
+	{
+		imageClip = pixm.imgInfo.PDSpathData[clPath].copy();
+		pixm.imgInfo.usedPath = clPath;
+		QTransform cl;
+		cl.translate(m_imageXOffset*m_imageXScale, m_imageYOffset*m_imageYScale);
+		cl.scale(m_imageXScale, m_imageYScale);
+		imageClip.map(cl);
+	}
+	BBoxX = pixm.imgInfo.BBoxX;
+	BBoxH = pixm.imgInfo.BBoxH;
+	OrigW = job.origWidth;
+	OrigH = job.origHeight;
+	isRaster = job.isRaster;
+
+	UseEmbedded = pixm.imgInfo.isEmbedded;
+	if (pixm.imgInfo.isEmbedded)
+		ImageProfile = "Embedded " + pixm.imgInfo.profileName;
+	else
+		ImageProfile = pixm.imgInfo.profileName;
+	if (!pixm.imgInfo.embeddedProfileName.isEmpty())
+		EmbeddedProfile = "Embedded " + pixm.imgInfo.embeddedProfileName;
+	else
+		EmbeddedProfile.clear();
+
+	adjustPictScale();
+
+	// #12408 : we set the old* variables to avoid creation of unwanted undo states
+	// when user perform actions such as double clicking image. We might want to
+	// create an undo transaction in this function if this does not work properly.
+	oldLocalScX = m_imageXScale;
+	oldLocalScY = m_imageYScale;
 	return true;
 }
 
@@ -9792,6 +9807,12 @@ void PageItem::setRedrawBounding()
 	BoundingH = bh - BoundingY;
 	if (asLine())
 		BoundingH = qMax(BoundingH, 1.0);
+	boundsChanged();
+}
+
+void PageItem::boundsChanged()
+{
+	m_Doc->itemIndex().itemChanged(this);
 }
 
 void PageItem::updateGradientVectors()
@@ -9836,6 +9857,7 @@ void PageItem::setPolyClip(int up, int down)
 {
 	if (PoLine.size() < 3)
 		return;
+	boundsChanged();
 	double rot;
 	int upval = up;
 	int downval = down;
@@ -10083,6 +10105,8 @@ void PageItem::updateClip(bool updateWelded)
 {
 	if (m_Doc->appMode == modeDrawBezierLine)
 		return;
+	// the index picks up the new clip on its next query
+	boundsChanged();
 	if (ContourLine.empty())
 		ContourLine = PoLine.copy();
 //	int ph = static_cast<int>(qMax(1.0, lineWidth() / 2.0));
@@ -10446,9 +10470,10 @@ void PageItem::makeImageExternal(const QString& path)
 	if ((isTempFile) && (isInlineImage) && (!path.isEmpty()))
 	{
 		QString oldF = Pfile;
+		ScBlobStore::materialize(Pfile);
 		copyFile(Pfile, path);
 		Pfile = path;
-		QFile::remove(oldF);
+		releaseTempFile(oldF);
 		isInlineImage = false;
 		isTempFile = false;
 	}
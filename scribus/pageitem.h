@@ -58,6 +58,7 @@ for which a new license (GPL+exception) is in place.
 #include "scconfig.h"
 #endif
 
+class ImageLoadJob;
 class QFrame;
 class QGridLayout;
 class QRegion;
@@ -299,6 +300,8 @@ public: // Start public functions
 	 */
 	QRect getRedrawBounding(double viewScale) const;
 	void setRedrawBounding();
+	/// Tells the document the bounding box of this item changed
+	void boundsChanged();
 	void setPolyClip(int up, int down = 0);
 	void updatePolyClip();
 	//added switch for not updating welded items - used by notes frames with automatic size adjusted
@@ -405,6 +408,10 @@ public: // Start public functions
 
 	/// invalidates current layout information
 	virtual void invalidateLayout() { invalid = true; }
+	/// revision of the item's appearance, unique across all items, for caches of its rendering
+	quint64 renderRevision() const { return m_renderRevision; }
+	/// gives the item a new render revision, call when its appearance changed
+	void newRenderRevision();
 	/// creates valid layout information
 	virtual void layout() {}
 	 ///< tests if a character is displayed by this frame
@@ -1224,6 +1231,17 @@ public: // Start public functions
 	 * @return True if load succeeded
 	 */
 	virtual bool loadImage(const QString& filename, bool reload, int gsResolution=-1, bool showMsg = false);
+	/**
+	 * @brief Prepares loading an image the way loadImage() does, the job can then be run in another thread
+	 * @return A new job owned by the caller
+	 * @sa ImageLoadQueue
+	 */
+	ImageLoadJob* createImageLoadJob(const QString& filename, int gsResolution = -1, bool showMsg = false);
+	/**
+	 * @brief Applies the picture loaded by a job created by createImageLoadJob() to the item
+	 * @return True if the picture could be loaded
+	 */
+	bool finishImageLoad(ImageLoadJob& job, bool reload);
 
 	/**
 	 * @brief Connect the item's signals to the GUI, primarily the Properties palette, also some to ScMW
@@ -1346,6 +1364,7 @@ public:	// Start public variables
 	bool OverrideCompressionQuality {false};
 	int CompressionQualityIndex {0};
 	bool imageIsAvailable {false}; ///< Flag to hold image file availability
+	bool imageLoadPending {false}; ///< The image is still being loaded by a BackgroundImageLoader
 	int OrigW {0};
 	int OrigH {0};
 	double BBoxX {0.0}; ///< Bounding Box-X
@@ -1883,14 +1902,15 @@ protected: // Start protected variables
 
 private:	// Start private functions
 	/**
-	 * @brief Helper method to create a modifier string from the current image effects list.
+	 * @brief Helper method to create a modifier string from an image effects list.
 	 * @sa loadImage()
 	 */
-	QString getImageEffectsModifier() const;
+	static QString getImageEffectsModifier(const ScImageEffectList& effects);
 
 			// End private functions
 
 private:	// Start private variables
+	quint64 m_renderRevision {0};
 			// End private variables
 
 
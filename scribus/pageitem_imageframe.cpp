@@ -38,6 +38,7 @@ for which a new license (GPL+exception) is in place.
 #include "pageitem.h"
 #include "pageitem_imageframe.h"
 #include "prefsmanager.h"
+#include "scblobstore.h"
 #include "scraction.h"
 #include "scpage.h"
 #include "scpaths.h"
@@ -52,6 +53,7 @@ for which a new license (GPL+exception) is in place.
 #include "undotransaction.h"
 #include "util_formats.h"
 #include "util_color.h"
+#include "util_file.h"
 #include "util.h"
 
 
@@ -93,6 +95,19 @@ void PageItem_ImageFrame::DrawObj_Item(ScPainter *p, const QRectF& /*e*/)
 			p->drawLine(FPoint(0, m_height), FPoint(m_width, 0));
 		}
 	}
+	else if (imageLoadPending)
+	{
+		// The image is being loaded in the background, draw a grey cross meanwhile
+		if ((drawFrame()) && (m_Doc->guidesPrefs().framesShown))
+		{
+			p->setPen(Qt::gray, 1, Qt::SolidLine, Qt::FlatCap, Qt::MiterJoin);
+			p->drawLine(FPoint(0, 0), FPoint(m_width, m_height));
+			p->drawLine(FPoint(0, m_height), FPoint(m_width, 0));
+			const QFont &font = QApplication::font();
+			p->setFont(PrefsManager::instance().appPrefs.fontPrefs.AvailFonts.findFont(font.family(), QFontInfo(font).styleName()), font.pointSizeF());
+			p->drawText(QRectF(0.0, 0.0, m_width, m_height), tr("Loading...") + "\n" + QFileInfo(Pfile).fileName());
+		}
+	}
 	else if ((!m_imageVisible) || (!imageIsAvailable))
 	{
 		//If we are missing our image, draw a red cross in the frame
@@ -249,7 +264,10 @@ void PageItem_ImageFrame::clearContents()
 	setLineTransparency(0.0);
 	imageClip.resize(0);
 	if ((isTempFile) && (!Pfile.isEmpty()))
-		QFile::remove(Pfile);
+	{
+		if (releaseTempFile(Pfile))
+			ScBlobStore::discard(Pfile);
+	}
 	isTempFile = false;
 	isInlineImage = false;
 	//				emit UpdtObj(Doc->currentPage->pageNr(), ItemNr);
@@ -141,7 +141,9 @@ void PageItem_NoteFrame::setNoteStyle(NotesStyle *nStyle, PageItem_TextFrame* ma
 		m_masterFrame = master;
 	itemText.clear();
 
+	QString oldName = m_itemName;
 	m_itemName = generateUniqueCopyName(m_nstyle->isEndNotes() ? "Endnote frame " + m_nstyle->name() : "Footnote frame " + m_nstyle->name(), false);
+	m_Doc->itemNameIndex().itemRenamed(this, oldName);
 	setUName(m_itemName);
 
 	//set default style for note frame
@@ -59,6 +59,7 @@ for which a new license (GPL+exception) is in place.
 #include "text/screenpainter.h"
 #include "text/textshaper.h"
 #include "text/shapedtext.h"
+#include "text/shapedtextcache.h"
 #include "text/shapedtextfeed.h"
 #include "textnote.h"
 #include "ui/guidemanager.h"
@@ -96,6 +97,11 @@ void PageItem_TextFrame::init()
 	verticalAlign = 0;
 	incompleteLines = 0;
 	maxY = 0.0;
+	m_layoutReusable = false;
+	m_layoutTextVersion = 0;
+	m_layoutFirstChar = 0;
+	m_layoutMaxChars = 0;
+	m_layoutCheckedEnd = 0;
 	connect(&itemText,SIGNAL(changed(int,int)), this, SLOT(slotInvalidateLayout(int,int)));
 }
 
@@ -1097,6 +1103,8 @@ bool PageItem_TextFrame::moveLinesFromPreviousFrame ()
 		return false;
 	if (!prev->incompleteLines)
 		return false;   // no incomplete lines - nothing to do
+	// whatever happens below changes the layout state of prev
+	prev->m_layoutReusable = false;
 	int pos = textLayout.endOfFrame() - 1;
 	QChar lastChar = itemText.text (pos);
 	// qDebug()<<"pos is"<<pos<<", length is"<<itemText.length()<<", incomplete is "<<prev->incompleteLines;
@@ -1211,6 +1219,7 @@ void PageItem_TextFrame::layout()
 	}
 	if (invalid && m_backBox == nullptr)
 		firstChar = 0;
+	m_layoutReusable = false;
 
 //	qDebug() << QString("textframe(%1,%2): len=%3, start relayout at %4").arg(m_xPos).arg(m_yPos).arg(itemText.length()).arg(firstInFrame());
 	QPoint pt1, pt2;
@@ -1278,6 +1287,7 @@ void PageItem_TextFrame::layout()
 			next->firstChar = itLen;
 			next->m_maxChars = itLen;
 			next->textLayout.clear();
+			next->m_layoutReusable = false;
 			next = dynamic_cast<PageItem_TextFrame*>(next->nextInChain());
 		}
 		// TODO layout() shouldn't delete any frame here, as it breaks any loop
@@ -1302,28 +1312,12 @@ void PageItem_TextFrame::layout()
 	if ((itLen != 0)) // || (NextBox != nullptr))
 	{
 		// determine layout area
-		m_availableRegion = calcAvailableRegion();
+		m_availableRegion = calcLayoutRegion();
 		if (m_availableRegion.isEmpty())
 		{
 			m_maxChars = firstInFrame();
 			goto NoRoom;
 		}
-
-		if (imageFlippedH() || imageFlippedV())
-		{
-			QTransform matrix;
-			if (imageFlippedH())
-			{
-				matrix.translate(m_width, 0);
-				matrix.scale(-1, 1);
-			}
-			if (imageFlippedV())
-			{
-				matrix.translate(0, m_height);
-				matrix.scale(1, -1);
-			}
-			m_availableRegion = matrix.map(m_availableRegion);
-		}
 		
 		// update Bullet & number list if any.
 		if (itemText.hasTextMarks() || itemText.hasBulletOrNum() ||  itemText.marksCountChanged())
@@ -1331,10 +1325,11 @@ void PageItem_TextFrame::layout()
 			updateBulletsNum();
 			itemText.resetMarksCountChanged();
 		}
+		itemText.updateMarkCharStyles();
 
 		ITextContext* context = this;
 		//TextShaper textShaper(this, itemText, firstInFrame());
-		ShapedTextFeed shapedText(&itemText, firstInFrame(), context);
+		ShapedTextFeed shapedText(&itemText, firstInFrame(), context, itemText.shapedTextCache());
 
 		QList<GlyphCluster> glyphClusters; // = textShaper.shape();
 		// std::sort(glyphClusters.begin(), glyphClusters.end(), logicalGlyphRunComp);
@@ -2905,16 +2900,8 @@ void PageItem_TextFrame::layout()
 		}
 		UndoManager::instance()->setUndoEnabled(true);
 	}
-	if (m_nextBox != nullptr)
-	{
-		PageItem_TextFrame * nextFrame = dynamic_cast<PageItem_TextFrame*>(m_nextBox);
-		while (nextFrame)
-		{
-			nextFrame->invalid   = true;
-			nextFrame->firstChar = m_maxChars;
-			nextFrame = dynamic_cast<PageItem_TextFrame*>(nextFrame->m_nextBox);
-		}
-	}
+	rememberLayout();
+	invalidateNextFrames();
 	itemText.blockSignals(false);
 //	qDebug("textframe: len=%d, done relayout", itemText.length());
 	return;
@@ -2967,13 +2954,9 @@ NoRoom:
 			if (m_Doc->appMode == modeEdit)
 				next->itemText.setCursorPosition( qMax(nCP, signed(m_maxChars)) );
 		}
-		while (next)
-		{
-			next->invalid   = true;
-			next->firstChar = m_maxChars;
-			next = dynamic_cast<PageItem_TextFrame*>(next->m_nextBox);
-		}
 	}
+	rememberLayout();
+	invalidateNextFrames();
 //	qDebug("textframe: len=%d, done relayout (no room %d)", itemText.length(), MaxChars);
 	itemText.blockSignals(false);
 }
@@ -3028,6 +3011,165 @@ void PageItem_TextFrame::slotInvalidateLayout(int firstItem, int /*endItem*/)
 	}
 }
 
+bool PageItem_TextFrame::LayoutInputs::operator==(const LayoutInputs& other) const
+{
+	return region == other.region
+		&& width == other.width
+		&& height == other.height
+		&& pageYPos == other.pageYPos
+		&& columns == other.columns
+		&& columnGap == other.columnGap
+		&& marginLeft == other.marginLeft
+		&& marginTop == other.marginTop
+		&& marginRight == other.marginRight
+		&& marginBottom == other.marginBottom
+		&& firstLineOffset == other.firstLineOffset
+		&& verticalAlign == other.verticalAlign
+		&& lineCorr == other.lineCorr
+		&& baselineGrid == other.baselineGrid
+		&& baselineOffset == other.baselineOffset
+		&& autoLineSpacing == other.autoLineSpacing
+		&& paragraphStylesVersion == other.paragraphStylesVersion
+		&& charStylesVersion == other.charStylesVersion;
+}
+
+QRegion PageItem_TextFrame::calcLayoutRegion()
+{
+	QRegion region = calcAvailableRegion();
+	if (region.isEmpty() || !(imageFlippedH() || imageFlippedV()))
+		return region;
+
+	QTransform matrix;
+	if (imageFlippedH())
+	{
+		matrix.translate(m_width, 0);
+		matrix.scale(-1, 1);
+	}
+	if (imageFlippedV())
+	{
+		matrix.translate(0, m_height);
+		matrix.scale(1, -1);
+	}
+	return matrix.map(region);
+}
+
+PageItem_TextFrame::LayoutInputs PageItem_TextFrame::layoutInputs()
+{
+	LayoutInputs inputs;
+	inputs.region = calcLayoutRegion();
+	inputs.width = m_width;
+	inputs.height = m_height;
+	inputs.pageYPos = m_yPos;
+	if ((OwnPage != -1) && (OwnPage < m_Doc->Pages->count()))
+		inputs.pageYPos -= m_Doc->Pages->at(OwnPage)->yOffset();
+	inputs.columns = m_columns;
+	inputs.columnGap = m_columnGap;
+	inputs.marginLeft = m_textDistanceMargins.left();
+	inputs.marginTop = m_textDistanceMargins.top();
+	inputs.marginRight = m_textDistanceMargins.right();
+	inputs.marginBottom = m_textDistanceMargins.bottom();
+	inputs.firstLineOffset = static_cast<int>(m_firstLineOffset);
+	inputs.verticalAlign = verticalAlign;
+	if (lineColor() != CommonStrings::None)
+		inputs.lineCorr = m_lineWidth / 2.0;
+	inputs.baselineGrid = m_Doc->guidesPrefs().valueBaselineGrid;
+	inputs.baselineOffset = m_Doc->guidesPrefs().offsetBaselineGrid;
+	inputs.autoLineSpacing = m_Doc->typographicPrefs().autoLineSpacing;
+	inputs.paragraphStylesVersion = m_Doc->paragraphStyles().version();
+	inputs.charStylesVersion = m_Doc->charStyles().version();
+	return inputs;
+}
+
+void PageItem_TextFrame::rememberLayout()
+{
+	m_layoutReusable = !isNoteFrame() && OnMasterPage.isEmpty();
+	if (!m_layoutReusable)
+		return;
+	m_layoutTextVersion = itemText.version();
+	m_layoutFirstChar = firstChar;
+	m_layoutMaxChars = m_maxChars;
+	// where this frame ends depends on whether the following lines fit,
+	// so the text up to the end of the next paragraph counts as well
+	int checkedEnd = m_maxChars;
+	if (checkedEnd < itemText.length())
+		checkedEnd = itemText.nextParagraph(checkedEnd);
+	if (checkedEnd < itemText.length())
+		checkedEnd = itemText.nextParagraph(checkedEnd);
+	m_layoutCheckedEnd = qMin(checkedEnd + 1, itemText.length());
+	m_layoutInputs = layoutInputs();
+}
+
+bool PageItem_TextFrame::reuseLayout(int newFirstChar)
+{
+	if (!m_layoutReusable || !OnMasterPage.isEmpty() || isNoteFrame())
+		return false;
+	// bullets, numbers, marks and notes get updated by layout() itself
+	if (itemText.hasTextMarks() || itemText.hasBulletOrNum() || itemText.marksCountChanged())
+		return false;
+	if (!m_Doc->notesList().isEmpty() || m_Doc->notesChanged())
+		return false;
+	PageItem_TextFrame* prev = dynamic_cast<PageItem_TextFrame*>(m_backBox);
+	if (prev && prev->incompleteLines)
+		return false;
+
+	int first = m_layoutFirstChar;
+	int end = m_layoutCheckedEnd;
+	if (!itemText.mapUnchangedRange(m_layoutTextVersion, first, end))
+		return false;
+	if (first != newFirstChar)
+		return false;
+	int delta = first - m_layoutFirstChar;
+	int maxChars = m_layoutMaxChars + delta;
+	if ((maxChars > itemText.length()) || (end > itemText.length()))
+		return false;
+	// inline objects and page numbers can change without the text being edited
+	for (int i = first; i < maxChars; ++i)
+	{
+		QChar ch = itemText.text(i);
+		if ((ch == SpecialChars::OBJECT) || (ch == SpecialChars::PAGENUMBER) || (ch == SpecialChars::PAGECOUNT))
+			return false;
+	}
+	LayoutInputs inputs = layoutInputs();
+	if (!(inputs == m_layoutInputs))
+		return false;
+
+	if (delta != 0)
+	{
+		textLayout.shiftChars(delta);
+		for (int i = 0; i < incompletePositions.count(); ++i)
+			incompletePositions[i] += delta;
+	}
+	firstChar = first;
+	m_maxChars = maxChars;
+	m_availableRegion = inputs.region;
+	invalid = false;
+
+	m_layoutTextVersion = itemText.version();
+	m_layoutFirstChar = first;
+	m_layoutMaxChars = maxChars;
+	m_layoutCheckedEnd = end;
+	return true;
+}
+
+void PageItem_TextFrame::invalidateNextFrames()
+{
+	int nextFirstChar = m_maxChars;
+	PageItem_TextFrame* next = dynamic_cast<PageItem_TextFrame*>(m_nextBox);
+	// an edit in this frame usually doesn't move the start of the next ones,
+	// in which case their layout stays valid and the chain converges here
+	while (next && next->reuseLayout(nextFirstChar))
+	{
+		nextFirstChar = next->m_maxChars;
+		next = dynamic_cast<PageItem_TextFrame*>(next->m_nextBox);
+	}
+	while (next)
+	{
+		next->invalid   = true;
+		next->firstChar = nextFirstChar;
+		next = dynamic_cast<PageItem_TextFrame*>(next->m_nextBox);
+	}
+}
+
 bool PageItem_TextFrame::isValidChainFromBegin()
 {
 	if (invalid)
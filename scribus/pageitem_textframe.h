@@ -123,6 +123,47 @@ private:
 	QRectF m_origAnnotPos;
 	void updateBulletsNum();
 
+	// Everything besides the text itself which the layout of a frame depends on
+	struct LayoutInputs
+	{
+		QRegion region;
+		double width { 0.0 };
+		double height { 0.0 };
+		double pageYPos { 0.0 };
+		int columns { 0 };
+		double columnGap { 0.0 };
+		double marginLeft { 0.0 };
+		double marginTop { 0.0 };
+		double marginRight { 0.0 };
+		double marginBottom { 0.0 };
+		int firstLineOffset { 0 };
+		int verticalAlign { 0 };
+		double lineCorr { 0.0 };
+		double baselineGrid { 0.0 };
+		double baselineOffset { 0.0 };
+		int autoLineSpacing { 0 };
+		int paragraphStylesVersion { 0 };
+		int charStylesVersion { 0 };
+
+		bool operator==(const LayoutInputs& other) const;
+	};
+	// State of the last complete layout, used to keep it if text was only edited in other frames of the chain
+	bool m_layoutReusable;
+	uint m_layoutTextVersion;
+	int m_layoutFirstChar;
+	int m_layoutMaxChars;
+	int m_layoutCheckedEnd;
+	LayoutInputs m_layoutInputs;
+
+	QRegion calcLayoutRegion();
+	LayoutInputs layoutInputs();
+	void rememberLayout();
+	// Keeps the current layout if it would not change when laid out from newFirstChar.
+	// It is all or nothing: a frame whose own text changed is laid out again from its first char
+	bool reuseLayout(int newFirstChar);
+	// Called at the end of layout(): next frames start where this one ends
+	void invalidateNextFrames();
+
 private slots:
 	void slotInvalidateLayout(int firstItem, int endItem);
 
@@ -0,0 +1,249 @@
+/*
+For general Scribus (>=1.3.2) copyright and licensing information please refer
+to the COPYING file provided with the program. Following this notice may exist
+a copyright and/or license notice that predates the release of Scribus 1.3.2
+for which a new license (GPL+exception) is in place.
+*/
+
+#include <algorithm>
+#include <cmath>
+
+#include <QPolygonF>
+#include <QTransform>
+
+#include "pageitem.h"
+#include "pageitemindex.h"
+
+namespace
+{
+	// a bit less than half an A4 page
+	const double cellSize = 256.0;
+	// items covering more cells than this go into the large list
+	const int maxCellsPerItem = 256;
+
+	inline quint64 cellKey(int x, int y)
+	{
+		return (quint64(quint32(x)) << 32) | quint64(quint32(y));
+	}
+
+	// unlike QRectF::intersects() this also accepts rects of zero width or height
+	inline bool touches(const QRectF& a, const QRectF& b)
+	{
+		return a.left() <= b.right() && b.left() <= a.right() && a.top() <= b.bottom() && b.top() <= a.bottom();
+	}
+}
+
+PageItemIndex::PageItemIndex()
+{
+}
+
+QRectF PageItemIndex::indexRect(PageItem* item)
+{
+	// the union of everything used to test items for hits, selection and drawing
+	QRectF rect = item->getBoundingRect();
+	rect |= item->getVisualBoundingRect();
+	rect |= item->getCurrentBoundingRect(item->lineWidth());
+	if (item->Clip.size() > 0)
+		rect |= item->getTransform().map(QPolygonF(item->Clip)).boundingRect();
+	return rect.adjusted(-1.0, -1.0, 1.0, 1.0);
+}
+
+QList<PageItem*> PageItemIndex::itemsIn(const QList<PageItem*>* list, const QRectF& area)
+{
+	QList<PageItem*> result;
+	if (list->isEmpty())
+		return result;
+	Grid& grid = validGrid(list);
+	QVector<QPair<int, PageItem*> > found;
+	if (!collect(grid, list, area.normalized(), found))
+	{
+		// a found item moved inside the list or left it
+		rebuild(grid, list);
+		found.clear();
+		collect(grid, list, area.normalized(), found);
+	}
+	std::sort(found.begin(), found.end());
+	result.reserve(found.count());
+	for (const auto& entry : qAsConst(found))
+		result.append(entry.second);
+	return result;
+}
+
+bool PageItemIndex::collect(Grid& grid, const QList<PageItem*>* list, const QRectF& area, QVector<QPair<int, PageItem*> >& found)
+{
+	QSet<PageItem*> candidates;
+	int x1, y1, x2, y2;
+	bool useCells = cellRange(area, x1, y1, x2, y2);
+	if (useCells && (qint64(x2 - x1 + 1) * qint64(y2 - y1 + 1) > grid.cells.count()))
+		useCells = false;
+	if (!useCells)
+	{
+		// looking at all cells would be slower than looking at all items
+		for (auto it = grid.rects.constBegin(); it != grid.rects.constEnd(); ++it)
+		{
+			if (touches(it.value(), area))
+				candidates.insert(it.key());
+		}
+	}
+	else
+	{
+		for (int x = x1; x <= x2; ++x)
+		{
+			for (int y = y1; y <= y2; ++y)
+			{
+				auto cell = grid.cells.constFind(cellKey(x, y));
+				if (cell == grid.cells.constEnd())
+					continue;
+				for (PageItem* item : cell.value())
+				{
+					if (touches(grid.rects.value(item), area))
+						candidates.insert(item);
+				}
+			}
+		}
+		for (PageItem* item : qAsConst(grid.large))
+		{
+			if (touches(grid.rects.value(item), area))
+				candidates.insert(item);
+		}
+	}
+
+	found.reserve(candidates.count());
+	for (PageItem* item : qAsConst(candidates))
+	{
+		int position = grid.positions.value(item, -1);
+		if (list->value(position) != item)
+			return false;
+		found.append(qMakePair(position, item));
+	}
+	return true;
+}
+
+void PageItemIndex::itemChanged(PageItem* item)
+{
+	for (auto it = m_grids.begin(); it != m_grids.end(); ++it)
+	{
+		if (it.value().rects.contains(item))
+			it.value().dirty.insert(item);
+	}
+}
+
+void PageItemIndex::clear()
+{
+	m_grids.clear();
+}
+
+PageItemIndex::Grid& PageItemIndex::validGrid(const QList<PageItem*>* list)
+{
+	Grid& grid = m_grids[list];
+	int count = list->count();
+	if ((grid.generation != m_generation) || (grid.count == 0) || (count < grid.count) || (list->at(grid.count - 1) != grid.last))
+	{
+		// items were removed, inserted or replaced
+		rebuild(grid, list);
+		return grid;
+	}
+
+	// items were appended, or nothing changed at all
+	for (int i = grid.count; i < count; ++i)
+	{
+		PageItem* item = list->at(i);
+		QRectF oldRect = grid.rects.value(item);
+		if (grid.rects.contains(item))
+			remove(grid, item, oldRect);
+		insert(grid, item, indexRect(item));
+		grid.positions.insert(item, i);
+		grid.dirty.remove(item);
+	}
+	grid.count = count;
+	grid.last = list->last();
+
+	// items which are no longer at their position may be deleted, rebuild instead of touching them
+	for (PageItem* item : qAsConst(grid.dirty))
+	{
+		if (list->value(grid.positions.value(item, -1)) != item)
+		{
+			rebuild(grid, list);
+			return grid;
+		}
+	}
+	for (PageItem* item : qAsConst(grid.dirty))
+	{
+		QRectF newRect = indexRect(item);
+		QRectF oldRect = grid.rects.value(item);
+		if (newRect == oldRect)
+			continue;
+		remove(grid, item, oldRect);
+		insert(grid, item, newRect);
+	}
+	grid.dirty.clear();
+	return grid;
+}
+
+void PageItemIndex::rebuild(Grid& grid, const QList<PageItem*>* list)
+{
+	grid.cells.clear();
+	grid.large.clear();
+	grid.rects.clear();
+	grid.positions.clear();
+	grid.dirty.clear();
+	for (int i = 0; i < list->count(); ++i)
+	{
+		PageItem* item = list->at(i);
+		insert(grid, item, indexRect(item));
+		grid.positions.insert(item, i);
+	}
+	grid.count = list->count();
+	grid.last = list->isEmpty() ? nullptr : list->last();
+	grid.generation = m_generation;
+}
+
+void PageItemIndex::insert(Grid& grid, PageItem* item, const QRectF& rect)
+{
+	grid.rects.insert(item, rect);
+	int x1, y1, x2, y2;
+	if (!cellRange(rect, x1, y1, x2, y2) || (qint64(x2 - x1 + 1) * qint64(y2 - y1 + 1) > maxCellsPerItem))
+	{
+		grid.large.append(item);
+		return;
+	}
+	for (int x = x1; x <= x2; ++x)
+		for (int y = y1; y <= y2; ++y)
+			grid.cells[cellKey(x, y)].append(item);
+}
+
+void PageItemIndex::remove(Grid& grid, PageItem* item, const QRectF& rect)
+{
+	grid.rects.remove(item);
+	int x1, y1, x2, y2;
+	if (!cellRange(rect, x1, y1, x2, y2) || (qint64(x2 - x1 + 1) * qint64(y2 - y1 + 1) > maxCellsPerItem))
+	{
+		grid.large.removeOne(item);
+		return;
+	}
+	for (int x = x1; x <= x2; ++x)
+	{
+		for (int y = y1; y <= y2; ++y)
+		{
+			auto cell = grid.cells.find(cellKey(x, y));
+			if (cell == grid.cells.end())
+				continue;
+			cell.value().removeOne(item);
+			if (cell.value().isEmpty())
+				grid.cells.erase(cell);
+		}
+	}
+}
+
+bool PageItemIndex::cellRange(const QRectF& rect, int& x1, int& y1, int& x2, int& y2) const
+{
+	// keep clear of overflows, anything that far out is handled as large
+	const double limit = cellSize * 1.0e6;
+	if (!(std::abs(rect.left()) < limit && std::abs(rect.right()) < limit && std::abs(rect.top()) < limit && std::abs(rect.bottom()) < limit))
+		return false;
+	x1 = static_cast<int>(std::floor(rect.left() / cellSize));
+	x2 = static_cast<int>(std::floor(rect.right() / cellSize));
+	y1 = static_cast<int>(std::floor(rect.top() / cellSize));
+	y2 = static_cast<int>(std::floor(rect.bottom() / cellSize));
+	return true;
+}
@@ -0,0 +1,78 @@
+/*
+For general Scribus (>=1.3.2) copyright and licensing information please refer
+to the COPYING file provided with the program. Following this notice may exist
+a copyright and/or license notice that predates the release of Scribus 1.3.2
+for which a new license (GPL+exception) is in place.
+*/
+
+#ifndef PAGEITEMINDEX_H
+#define PAGEITEMINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QRectF>
+#include <QSet>
+#include <QVector>
+
+#include "scribusapi.h"
+
+class PageItem;
+
+/**
+ * Spatial index over the items of a document, so that hit-testing, rubber band
+ * selection and drawing only have to look at items near the area they care about.
+ *
+ * Each item list (doc items, master items) gets a uniform grid of cells in canvas
+ * coordinates. An item is entered into every cell its bounding box touches; items
+ * which cover a large part of the canvas are kept aside and always returned.
+ *
+ * PageItem reports geometry changes with itemChanged(), those items are moved to their
+ * new cells on the next query. Items appended to a list are added on the next query.
+ * Other changes to a list are noticed from its count and last item, from listChanged()
+ * which ScribusDoc calls when it replaces or reorders items, or when a found item is no
+ * longer at its recorded position; they rebuild the grid of that list.
+ */
+class SCRIBUS_API PageItemIndex
+{
+public:
+	PageItemIndex();
+
+	/// Items of list whose bounding box may intersect area, in the order of list
+	QList<PageItem*> itemsIn(const QList<PageItem*>* list, const QRectF& area);
+
+	/// The bounding box of item changed
+	void itemChanged(PageItem* item);
+	/// Items of a list were replaced or moved around, rebuild all grids on the next query
+	void listChanged() { ++m_generation; }
+	void clear();
+
+	/// Canvas area covered by item as used by the index
+	static QRectF indexRect(PageItem* item);
+
+private:
+	struct Grid
+	{
+		QHash<quint64, QVector<PageItem*> > cells;
+		QVector<PageItem*> large;
+		QHash<PageItem*, QRectF> rects;
+		/// Position of the items in the list, checked before use
+		QHash<PageItem*, int> positions;
+		QSet<PageItem*> dirty;
+		/// Last item of the list at the last query, only compared, never dereferenced
+		PageItem* last { nullptr };
+		int count { 0 };
+		uint generation { 0 };
+	};
+
+	QHash<const QList<PageItem*>*, Grid> m_grids;
+	uint m_generation { 0 };
+
+	Grid& validGrid(const QList<PageItem*>* list);
+	void rebuild(Grid& grid, const QList<PageItem*>* list);
+	bool collect(Grid& grid, const QList<PageItem*>* list, const QRectF& area, QVector<QPair<int, PageItem*> >& found);
+	void insert(Grid& grid, PageItem* item, const QRectF& rect);
+	void remove(Grid& grid, PageItem* item, const QRectF& rect);
+	bool cellRange(const QRectF& rect, int& x1, int& y1, int& x2, int& y2) const;
+};
+
+#endif
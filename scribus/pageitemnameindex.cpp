@@ -0,0 +1,244 @@
+/*
+For general Scribus (>=1.3.2) copyright and licensing information please refer
+to the COPYING file provided with the program. Following this notice may exist
+a copyright and/or license notice that predates the release of Scribus 1.3.2
+for which a new license (GPL+exception) is in place.
+*/
+
+#include "pageitem.h"
+#include "pageitemnameindex.h"
+
+namespace {
+
+/// Walks list and its groups, true if matches() holds for one of the items
+template<class Predicate>
+bool anyItem(const QList<PageItem*>* list, Predicate matches)
+{
+	QList<const QList<PageItem*>*> lists;
+	lists.append(list);
+	while (!lists.isEmpty())
+	{
+		const QList<PageItem*>* items = lists.takeLast();
+		for (const PageItem* item : *items)
+		{
+			if (matches(item))
+				return true;
+			if (item->isGroup())
+				lists.append(&item->groupItemList);
+		}
+	}
+	return false;
+}
+
+}
+
+PageItemNameIndex::PageItemNameIndex()
+{
+}
+
+PageItem* PageItemNameIndex::find(const QList<PageItem*>* list, const QString& name)
+{
+	if (name.isEmpty() || list->isEmpty())
+		return nullptr;
+	Table& table = validTable(list);
+	auto it = table.names.constFind(name);
+	if (it != table.names.constEnd())
+	{
+		PageItem* item = it.value().item;
+		if (item && (item->itemName() == name) && isListed(table, list, item, true))
+			return item;
+	}
+	else if (!anyItem(list, [&name](const PageItem* item) { return item->itemName() == name; }))
+		return nullptr;
+
+	// the entry is out of date, or the item was put into a group without changing the list
+	rebuild(table, list);
+	return table.names.value(name).item;
+}
+
+PageItem* PageItemNameIndex::find(const QList<PageItem*>* list, uint uniqueNr)
+{
+	if (list->isEmpty())
+		return nullptr;
+	Table& table = validTable(list);
+	auto it = table.ids.constFind(uniqueNr);
+	if (it != table.ids.constEnd())
+	{
+		PageItem* item = it.value().item;
+		if (item && (item->uniqueNr == uniqueNr) && isListed(table, list, item, true))
+			return item;
+	}
+	else if (!anyItem(list, [uniqueNr](const PageItem* item) { return item->uniqueNr == uniqueNr; }))
+		return nullptr;
+
+	rebuild(table, list);
+	return table.ids.value(uniqueNr).item;
+}
+
+QList<PageItem*> PageItemNameIndex::items(const QList<PageItem*>* list)
+{
+	QList<PageItem*> result;
+	if (list->isEmpty())
+		return result;
+	Table& table = validTable(list);
+	result.reserve(table.all.count());
+	bool stale = false;
+	for (const QPointer<PageItem>& item : qAsConst(table.all))
+	{
+		if (!item || !isListed(table, list, item, false))
+		{
+			stale = true;
+			break;
+		}
+		result.append(item);
+	}
+	if (!stale)
+		return result;
+
+	// something was removed or moved since the last rebuild
+	rebuild(table, list);
+	result.clear();
+	for (const QPointer<PageItem>& item : qAsConst(table.all))
+		result.append(item);
+	return result;
+}
+
+void PageItemNameIndex::itemRenamed(PageItem* item, const QString& oldName)
+{
+	for (auto it = m_tables.begin(); it != m_tables.end(); ++it)
+	{
+		Table& table = it.value();
+		auto id = table.ids.constFind(item->uniqueNr);
+		if ((id == table.ids.constEnd()) || (id.value().item != item))
+			continue;
+		if (table.duplicateNames)
+		{
+			// another item may have been hidden behind the old name
+			table.count = 0;
+			continue;
+		}
+		int depth = id.value().depth;
+		auto old = table.names.find(oldName);
+		if ((old != table.names.end()) && (old.value().item == item))
+			table.names.erase(old);
+		insert(table, item, depth);
+	}
+}
+
+void PageItemNameIndex::clear()
+{
+	m_tables.clear();
+}
+
+PageItemNameIndex::Table& PageItemNameIndex::validTable(const QList<PageItem*>* list)
+{
+	Table& table = m_tables[list];
+	int count = list->count();
+	if ((table.count > 0) && (table.count <= count) && table.last && (list->at(table.count - 1) == table.last))
+	{
+		// items were appended, or nothing changed at all
+		for (int i = table.count; i < count; ++i)
+			insertTree(table, list->at(i), i);
+	}
+	else if ((table.count > count) && (count > 0) && table.last && (list->last() == table.last))
+	{
+		// items were only removed, their entries fail the checks in find()
+	}
+	else
+	{
+		rebuild(table, list);
+		return table;
+	}
+	table.count = count;
+	table.last = list->isEmpty() ? nullptr : list->last();
+	return table;
+}
+
+void PageItemNameIndex::rebuild(Table& table, const QList<PageItem*>* list)
+{
+	table.names.clear();
+	table.ids.clear();
+	table.positions.clear();
+	table.all.clear();
+	table.duplicateNames = false;
+	for (int i = 0; i < list->count(); ++i)
+		insertTree(table, list->at(i), i);
+	table.count = list->count();
+	table.last = list->isEmpty() ? nullptr : list->last();
+}
+
+void PageItemNameIndex::insertTree(Table& table, PageItem* topItem, int position)
+{
+	table.positions.insert(topItem, position);
+	insert(table, topItem, 0);
+	if (!topItem->isGroup())
+		return;
+
+	QList<PageItem*> groups;
+	groups.append(topItem);
+	QList<int> depths;
+	depths.append(0);
+	while (!groups.isEmpty())
+	{
+		PageItem* group = groups.takeLast();
+		int depth = depths.takeLast() + 1;
+		for (PageItem* item : qAsConst(group->groupItemList))
+		{
+			insert(table, item, depth);
+			if (item->isGroup())
+			{
+				groups.append(item);
+				depths.append(depth);
+			}
+		}
+	}
+}
+
+void PageItemNameIndex::insert(Table& table, PageItem* item, int depth)
+{
+	Entry entry;
+	entry.item = item;
+	entry.depth = depth;
+
+	auto name = table.names.find(item->itemName());
+	if (name == table.names.end())
+		table.names.insert(item->itemName(), entry);
+	else if (name.value().item != item)
+	{
+		if (name.value().item)
+			table.duplicateNames = true;
+		if (!name.value().item || (name.value().depth > depth))
+			name.value() = entry;
+	}
+
+	auto id = table.ids.find(item->uniqueNr);
+	if (id == table.ids.end())
+	{
+		table.ids.insert(item->uniqueNr, entry);
+		table.all.append(entry.item);
+	}
+	else if (id.value().item != item)
+	{
+		if (!id.value().item || (id.value().depth > depth))
+			id.value() = entry;
+		table.all.append(entry.item);
+	}
+}
+
+bool PageItemNameIndex::isListed(Table& table, const QList<PageItem*>* list, PageItem* item, bool allowSearch)
+{
+	PageItem* topItem = topLevelItem(item);
+	if (topItem == nullptr)
+		return false;
+	auto position = table.positions.constFind(topItem);
+	if ((position != table.positions.constEnd()) && (list->value(position.value()) == topItem))
+		return true;
+	if (!allowSearch)
+		return false;
+	// items in front of it were removed or reordered
+	int index = list->indexOf(topItem);
+	if (index < 0)
+		return false;
+	table.positions.insert(topItem, index);
+	return true;
+}
@@ -0,0 +1,97 @@
+/*
+For general Scribus (>=1.3.2) copyright and licensing information please refer
+to the COPYING file provided with the program. Following this notice may exist
+a copyright and/or license notice that predates the release of Scribus 1.3.2
+for which a new license (GPL+exception) is in place.
+*/
+
+#ifndef PAGEITEMNAMEINDEX_H
+#define PAGEITEMNAMEINDEX_H
+
+#include <QHash>
+#include <QList>
+#include <QPointer>
+#include <QString>
+
+#include "scribusapi.h"
+
+class PageItem;
+
+/**
+ * Index from item names to the items of a document, so that looking up an item
+ * by name does not have to walk the item lists and groups.
+ *
+ * Each item list (doc items, master items) gets its own tables, which hold the
+ * items of the list and all items inside their groups. Where several items share
+ * a name, the least deeply nested one is found, top level items before group members.
+ *
+ * Items appended to a list are picked up on the next query, other changes to a
+ * list are noticed by looking at its count and last item and rebuild the tables.
+ * PageItem reports renames with itemRenamed(). A hit is checked against the
+ * list and the groups it is in before it is returned, so items which were deleted,
+ * moved out of the list or moved in and out of groups never come back as stale
+ * results, even when they still point to their former group. Groups change without
+ * the list noticing, e.g. when undo puts an item back into its group, so a miss is
+ * confirmed by walking the list and rebuilds the tables if the item is there after all.
+ * Misses cost as much as a search without the index, hits are found in constant time.
+ */
+class SCRIBUS_API PageItemNameIndex
+{
+public:
+	PageItemNameIndex();
+
+	/// The item named name in list or in one of its groups, nullptr if there is none
+	PageItem* find(const QList<PageItem*>* list, const QString& name);
+	/// The item with the given uniqueNr in list or in one of its groups, nullptr if there is none
+	PageItem* find(const QList<PageItem*>* list, uint uniqueNr);
+	bool contains(const QList<PageItem*>* list, const QString& name) { return find(list, name) != nullptr; }
+	/// All items of list and of its groups, in no particular order
+	QList<PageItem*> items(const QList<PageItem*>* list);
+
+	/// item was renamed from oldName, item->itemName() is the new name
+	void itemRenamed(PageItem* item, const QString& oldName);
+	void clear();
+
+	/// The top level item of item, nullptr if a group on the way does not hold the item below it
+	template<class Item>
+	static Item* topLevelItem(Item* item)
+	{
+		while (item->Parent != nullptr)
+		{
+			// items taken out of a group, e.g. deleted with undo or replaced, keep their Parent
+			if (!item->Parent->groupItemList.contains(item))
+				return nullptr;
+			item = item->Parent;
+		}
+		return item;
+	}
+
+private:
+	struct Entry
+	{
+		QPointer<PageItem> item;
+		int depth { 0 };
+	};
+
+	struct Table
+	{
+		QHash<QString, Entry> names;
+		QHash<uint, Entry> ids;
+		/// Position of the top level items in the list, checked before use
+		QHash<const PageItem*, int> positions;
+		QList<QPointer<PageItem> > all;
+		QPointer<PageItem> last;
+		int count { 0 };
+		bool duplicateNames { false };
+	};
+
+	QHash<const QList<PageItem*>*, Table> m_tables;
+
+	Table& validTable(const QList<PageItem*>* list);
+	void rebuild(Table& table, const QList<PageItem*>* list);
+	void insertTree(Table& table, PageItem* topItem, int position);
+	void insert(Table& table, PageItem* item, int depth);
+	bool isListed(Table& table, const QList<PageItem*>* list, PageItem* item, bool allowSearch);
+};
+
+#endif
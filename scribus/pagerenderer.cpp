@@ -0,0 +1,362 @@
+/*
+For general Scribus (>=1.3.2) copyright and licensing information please refer
+to the COPYING file provided with the program. Following this notice may exist
+a copyright and/or license notice that predates the release of Scribus 1.3.2
+for which a new license (GPL+exception) is in place.
+*/
+
+#include <QPointer>
+
+#include "appmodes.h"
+#include "pagerenderer.h"
+#include "pageitem_group.h"
+#include "pageitemiterator.h"
+#include "sclayer.h"
+#include "scpage.h"
+#include "scpainter.h"
+#include "scribusdoc.h"
+
+PageRenderer::PageRenderer(ScribusDoc* doc, int pageNr, double scale, PageToPixmapFlags flags) :
+	m_doc(doc),
+	m_page(doc->DocPages.at(pageNr)),
+	m_scale(scale),
+	m_flags(flags)
+{
+	m_clipX = static_cast<int>(m_page->xOffset() * m_scale);
+	m_clipY = static_cast<int>(m_page->yOffset() * m_scale);
+	int clipw = qRound(m_page->width() * m_scale);
+	int cliph = qRound(m_page->height() * m_scale);
+	if ((clipw > 0) && (cliph > 0))
+		m_size = QSize(clipw, cliph);
+
+	// Pictures still loading in the background would be drawn as placeholders
+	if (!m_flags.testFlag(Pixmap_DontReloadImages))
+		m_doc->finishPictLoading();
+
+	m_oldAppMode = m_doc->appMode;
+	m_oldFramesShown = m_doc->guidesPrefs().framesShown;
+	m_oldShowControls = m_doc->guidesPrefs().showControls;
+	m_oldDrawAsPreview = m_doc->drawAsPreview;
+	m_oldMasterPageMode = m_doc->masterPageMode();
+	m_oldLoading = m_doc->isLoading();
+	m_oldCurrentPage = m_doc->currentPage();
+
+	// Text frames draw their selection in edit mode, tables their handles in table edit mode
+	m_doc->appMode = modeNormal;
+	m_doc->guidesPrefs().framesShown = false;
+	m_doc->guidesPrefs().showControls = false;
+	if ((m_doc->cmsSettings().CMSinUse) && (m_doc->cmsSettings().GamutCheck))
+	{
+		m_gamutCheckDisabled = true;
+		m_doc->cmsSettings().GamutCheck = false;
+		m_doc->enableCMS(true);
+	}
+	m_doc->drawAsPreview = true;
+	m_doc->setMasterPageMode(false);
+	m_doc->setLoading(true);
+	m_doc->setCurrentPage(m_page);
+}
+
+PageRenderer::~PageRenderer()
+{
+	restorePictures();
+	if (m_gamutCheckDisabled)
+	{
+		m_doc->cmsSettings().GamutCheck = true;
+		m_doc->enableCMS(true);
+	}
+	m_doc->drawAsPreview = m_oldDrawAsPreview;
+	m_doc->guidesPrefs().framesShown = m_oldFramesShown;
+	m_doc->guidesPrefs().showControls = m_oldShowControls;
+	m_doc->setMasterPageMode(m_oldMasterPageMode);
+	m_doc->setCurrentPage(m_oldCurrentPage);
+	m_doc->setLoading(m_oldLoading);
+	m_doc->appMode = m_oldAppMode;
+}
+
+double PageRenderer::scaleForSize(const ScPage* page, int maxSize)
+{
+	double sx = maxSize / page->width();
+	double sy = maxSize / page->height();
+	return qMin(sx, sy);
+}
+
+int PageRenderer::bandHeight(const QSize& imageSize, qint64 maxBytes)
+{
+	if (imageSize.isEmpty())
+		return 0;
+	qint64 rowBytes = qint64(imageSize.width()) * 4;
+	qint64 rows = maxBytes / rowBytes;
+	return static_cast<int>(qBound<qint64>(1, rows, imageSize.height()));
+}
+
+QImage PageRenderer::renderBand(int top, int height)
+{
+	if (!isValid() || (top < 0) || (top >= m_size.height()))
+		return QImage();
+	height = qMin(height, m_size.height() - top);
+	if (height <= 0)
+		return QImage();
+	QImage image(m_size.width(), height, QImage::Format_ARGB32_Premultiplied);
+	if (image.isNull())
+		return image;
+	image.fill(qRgba(0, 0, 0, 0));
+
+	loadFullResolutionPictures();
+
+	// Pixel position of the band in the coordinates ScribusView::PageToPixmap() draws the whole page in
+	int bandX = m_clipX;
+	int bandY = m_clipY + top;
+	ScPainter* painter = new ScPainter(&image, image.width(), image.height(), 1.0, 0);
+	if (m_flags & Pixmap_DrawBackground)
+		painter->clear(m_doc->paperColor());
+	else if (m_flags & Pixmap_DrawWhiteBackground)
+		painter->clear(QColor(255, 255, 255));
+	painter->translate(-bandX, -bandY);
+	painter->setFillMode(ScPainter::Solid);
+	if (m_flags & Pixmap_DrawFrame)
+	{
+		painter->setPen(Qt::black, 1, Qt::SolidLine, Qt::FlatCap, Qt::MiterJoin);
+		painter->setBrush(m_doc->paperColor());
+		painter->drawRect(m_clipX, m_clipY, m_size.width(), m_size.height());
+	}
+	painter->beginLayer(1.0, 0);
+	painter->setZoomFactor(m_scale);
+
+	// Items touching the band only by their antialiased edge must be drawn in both bands
+	QRectF cullingArea(bandX / m_scale, bandY / m_scale, image.width() / m_scale, height / m_scale);
+	cullingArea.adjust(-1.0, -1.0, 1.0, 1.0);
+
+	ScLayer layer;
+	layer.isViewable = false;
+	int layerCount = m_doc->layerCount();
+	for (int layerLevel = 0; layerLevel < layerCount; ++layerLevel)
+	{
+		m_doc->Layers.levelToLayer(layer, layerLevel);
+		drawMasterItems(painter, layer, cullingArea);
+		drawPageItems(painter, layer, cullingArea, false);
+		drawPageItems(painter, layer, cullingArea, true);
+	}
+	painter->endLayer();
+	painter->end();
+	delete painter;
+
+	return image;
+}
+
+void PageRenderer::loadFullResolutionPictures()
+{
+	if (m_picturesLoaded)
+		return;
+	m_picturesLoaded = true;
+	if (m_flags.testFlag(Pixmap_DontReloadImages))
+		return;
+
+	QList<PageItem*> itemList = m_page->FromMaster;
+	while (itemList.count() > 0)
+	{
+		PageItem* currItem = itemList.takeFirst();
+		if (currItem->isGroup())
+		{
+			itemList = currItem->getChildren() + itemList;
+			continue;
+		}
+		reloadPicture(currItem);
+	}
+
+	QRectF cullingArea(m_clipX / m_scale, m_clipY / m_scale, qRound(m_size.width() / m_scale + 0.5), qRound(m_size.height() / m_scale + 0.5));
+	itemList = *(m_doc->Items);
+	while (itemList.count() > 0)
+	{
+		PageItem* currItem = itemList.takeFirst();
+		if (currItem->isGroup())
+		{
+			itemList = currItem->getChildren() + itemList;
+			continue;
+		}
+		double w = currItem->visualWidth();
+		double h = currItem->visualHeight();
+		double x = -currItem->visualLineWidth() / 2.0;
+		double y = -currItem->visualLineWidth() / 2.0;
+		QRectF boundingRect = currItem->getTransform().mapRect(QRectF(x, y, w, h));
+		if (!cullingArea.intersects(boundingRect.adjusted(0.0, 0.0, 1.0, 1.0)))
+			continue;
+		reloadPicture(currItem);
+	}
+}
+
+void PageRenderer::reloadPicture(PageItem* item)
+{
+	if (!item->isImageFrame() || !item->imageIsAvailable)
+		return;
+	if (item->pixm.imgInfo.lowResType == 0)
+		return;
+	m_changedPictures.append(qMakePair(item, item->pixm.imgInfo.lowResType));
+	item->pixm.imgInfo.lowResType = 0;
+	int fho = item->imageFlippedH();
+	int fvo = item->imageFlippedV();
+	double imgX = item->imageXOffset();
+	double imgY = item->imageYOffset();
+	m_doc->loadPict(item->Pfile, item, true);
+	item->setImageFlippedH(fho);
+	item->setImageFlippedV(fvo);
+	item->setImageXOffset(imgX);
+	item->setImageYOffset(imgY);
+}
+
+void PageRenderer::restorePictures()
+{
+	for (int i = 0; i < m_changedPictures.count(); ++i)
+	{
+		PageItem* item = m_changedPictures.at(i).first;
+		item->pixm.imgInfo.lowResType = m_changedPictures.at(i).second;
+		int fho = item->imageFlippedH();
+		int fvo = item->imageFlippedV();
+		double imgX = item->imageXOffset();
+		double imgY = item->imageYOffset();
+		m_doc->loadPict(item->Pfile, item, true);
+		item->setImageFlippedH(fho);
+		item->setImageFlippedV(fvo);
+		item->setImageXOffset(imgX);
+		item->setImageYOffset(imgY);
+	}
+	m_changedPictures.clear();
+}
+
+/**
+  draws the master page items of a layer, as Canvas::DrawMasterItems() does in preview mode
+ */
+void PageRenderer::drawMasterItems(ScPainter* painter, const ScLayer& layer, const QRectF& cullingArea)
+{
+	if (!layer.isPrintable || !layer.isViewable)
+		return;
+	if (m_page->masterPageNameEmpty())
+		return;
+	if (m_page->FromMaster.count() <= 0)
+		return;
+
+	ScPage* Mp = m_doc->MasterPages.at(m_doc->MasterNames[m_page->masterPageName()]);
+	int layerCount = m_doc->layerCount();
+	bool ownLayer = (layerCount > 1) && ((layer.blendMode != 0) || (layer.transparency != 1.0)) && (!layer.outlineMode);
+	if (ownLayer)
+		painter->beginLayer(layer.transparency, layer.blendMode);
+	int pageFromMasterCount = m_page->FromMaster.count();
+	for (int a = 0; a < pageFromMasterCount; ++a)
+	{
+		PageItem* currItem = m_page->FromMaster.at(a);
+		if (currItem->m_layerID != layer.ID)
+			continue;
+		if ((currItem->OwnPage != -1) && (currItem->OwnPage != static_cast<int>(Mp->pageNr())))
+			continue;
+		if (!currItem->printEnabled())
+			continue;
+		double oldX = currItem->xPos();
+		double oldY = currItem->yPos();
+		double oldBX = currItem->BoundingX;
+		double oldBY = currItem->BoundingY;
+		if (!currItem->ChangedMasterItem)
+		{
+			//Hack to not check for undo changes, indicate drawing only
+			currItem->moveBy(-Mp->xOffset() + m_page->xOffset(), -Mp->yOffset() + m_page->yOffset(), true);
+			currItem->BoundingX = oldBX - Mp->xOffset() + m_page->xOffset();
+			currItem->BoundingY = oldBY - Mp->yOffset() + m_page->yOffset();
+		}
+		// Page numbers in text frames need the number of the page the item is drawn on
+		currItem->savedOwnPage = currItem->OwnPage;
+		currItem->OwnPage = m_page->pageNr();
+		if (currItem->isGroup())
+		{
+			PageItem_Group *groupItem = currItem->asGroupFrame();
+			PageItemIterator itemIt(groupItem->groupItemList, PageItemIterator::IterateInGroups);
+			for ( ; *itemIt; ++itemIt)
+			{
+				PageItem* item = *itemIt;
+				item->savedOwnPage = currItem->OwnPage;
+				item->OwnPage = m_page->pageNr();
+			}
+		}
+		if (cullingArea.intersects(currItem->getBoundingRect().adjusted(0.0, 0.0, 1.0, 1.0)))
+		{
+			currItem->invalidateLayout();
+			currItem->DrawObj(painter, cullingArea);
+			currItem->DrawObj_Decoration(painter);
+		}
+		if (currItem->isGroup())
+		{
+			PageItem_Group *groupItem = currItem->asGroupFrame();
+			PageItemIterator itemIt(groupItem->groupItemList, PageItemIterator::IterateInGroups);
+			for ( ; *itemIt; ++itemIt)
+			{
+				PageItem* item = *itemIt;
+				item->OwnPage = item->savedOwnPage;
+			}
+		}
+		currItem->OwnPage = currItem->savedOwnPage;
+		if (!currItem->ChangedMasterItem)
+		{
+			//Hack to not check for undo changes, indicate drawing only
+			currItem->setXYPos(oldX, oldY, true);
+			currItem->BoundingX = oldBX;
+			currItem->BoundingY = oldBY;
+		}
+	}
+	if (ownLayer)
+		painter->endLayer();
+}
+
+/**
+  draws the page items of a layer, as Canvas::DrawPageItems() does in preview mode
+ */
+void PageRenderer::drawPageItems(ScPainter* painter, const ScLayer& layer, const QRectF& cullingArea, bool notesFramesPass)
+{
+	if (!layer.isPrintable || !layer.isViewable)
+		return;
+	if (m_doc->Items->count() <= 0)
+		return;
+
+	int layerCount = m_doc->layerCount();
+	bool ownLayer = (layerCount > 1) && ((layer.blendMode != 0) || (layer.transparency != 1.0)) && (!layer.outlineMode);
+	if (ownLayer)
+		painter->beginLayer(layer.transparency, layer.blendMode);
+
+	// Notes frames are only complete once the text frames referring to them are laid out
+	if (!notesFramesPass && !m_doc->notesList().isEmpty())
+	{
+		const QList<PageItem*> itemsToLayout = m_doc->itemIndex().itemsIn(m_doc->Items, cullingArea);
+		for (PageItem* currItem : itemsToLayout)
+		{
+			if (!currItem->isTextFrame() || currItem->isNoteFrame() || !currItem->invalid)
+				continue;
+			if ((currItem->m_layerID != layer.ID) || !currItem->printEnabled())
+				continue;
+			if (!currItem->OnMasterPage.isEmpty() && (currItem->OnMasterPage != m_page->pageName()))
+				continue;
+			if (cullingArea.intersects(currItem->getBoundingRect().adjusted(0.0, 0.0, 1.0, 1.0)))
+				currItem->layout();
+		}
+	}
+	// Laying out text may delete notes frames, which are dropped from the list then
+	const QList<PageItem*> itemsInArea = m_doc->itemIndex().itemsIn(m_doc->Items, cullingArea);
+	QList<QPointer<PageItem> > itemsToDraw;
+	for (PageItem* item : itemsInArea)
+		itemsToDraw.append(item);
+	for (int it = 0; it < itemsToDraw.count(); ++it)
+	{
+		PageItem* currItem = itemsToDraw.at(it);
+		if (currItem == nullptr)
+			continue;
+		if (notesFramesPass != currItem->isNoteFrame())
+			continue;
+		if ((currItem->m_layerID != layer.ID) || !currItem->printEnabled())
+			continue;
+		if (!currItem->OnMasterPage.isEmpty() && (currItem->OnMasterPage != m_page->pageName()))
+			continue;
+		if (cullingArea.intersects(currItem->getBoundingRect().adjusted(0.0, 0.0, 1.0, 1.0)))
+		{
+			currItem->DrawObj(painter, cullingArea);
+			currItem->DrawObj_Decoration(painter);
+		}
+	}
+	if (ownLayer)
+		painter->endLayer();
+}
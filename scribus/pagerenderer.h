@@ -0,0 +1,96 @@
+/*
+For general Scribus (>=1.3.2) copyright and licensing information please refer
+to the COPYING file provided with the program. Following this notice may exist
+a copyright and/or license notice that predates the release of Scribus 1.3.2
+for which a new license (GPL+exception) is in place.
+*/
+
+#ifndef PAGERENDERER_H
+#define PAGERENDERER_H
+
+#include <QImage>
+#include <QList>
+#include <QPair>
+#include <QRectF>
+#include <QSize>
+
+#include "scribusapi.h"
+#include "scribusstructs.h"
+
+class PageItem;
+class ScLayer;
+class ScPage;
+class ScPainter;
+class ScribusDoc;
+
+/**
+  * @brief Renders a document page to images without going through ScribusView.
+  *
+  * The page is drawn with ScPainter the same way ScribusView::PageToPixmap()
+  * does, but without changing the view or its canvas, so it also works for
+  * documents which are not shown. The page can be rendered in horizontal
+  * bands of any height, so that huge pages never need to be held in memory
+  * at once.
+  *
+  * While the renderer exists, the document is in the state needed for
+  * rendering: frames and controls are hidden, pictures are loaded in full
+  * resolution and the rendered page is the current page. The previous state
+  * is restored by the destructor. As drawing items lays out text and moves
+  * master page items around, a renderer must only be used in the GUI thread.
+  */
+class SCRIBUS_API PageRenderer
+{
+public:
+	/// Prepares rendering page pageNr at scale pixels per point
+	PageRenderer(ScribusDoc* doc, int pageNr, double scale, PageToPixmapFlags flags = Pixmap_DrawBackground);
+	~PageRenderer();
+
+	PageRenderer(const PageRenderer&) = delete;
+	PageRenderer& operator=(const PageRenderer&) = delete;
+
+	/// Size of the image of the whole page
+	QSize size() const { return m_size; }
+	bool isValid() const { return !m_size.isEmpty(); }
+
+	/**
+	 * Renders the rows top to top + height - 1 of the page image, returns a null image if out of memory.
+	 * Bands must be rendered one after the other: each band moves the master page items onto the
+	 * page and back, and drawing text shares the glyph caches of the fonts.
+	 */
+	QImage renderBand(int top, int height);
+	/// Renders the whole page in one image
+	QImage renderPage() { return renderBand(0, m_size.height()); }
+
+	/// The scale at which the longer side of page is maxSize pixels long, as used by ScribusView::PageToPixmap()
+	static double scaleForSize(const ScPage* page, int maxSize);
+	/// Height of the bands to render an image of the given size in, so that a band needs at most maxBytes
+	static int bandHeight(const QSize& imageSize, qint64 maxBytes);
+
+private:
+	void loadFullResolutionPictures();
+	void restorePictures();
+	void reloadPicture(PageItem* item);
+	void drawMasterItems(ScPainter* painter, const ScLayer& layer, const QRectF& cullingArea);
+	void drawPageItems(ScPainter* painter, const ScLayer& layer, const QRectF& cullingArea, bool notesFramesPass);
+
+	ScribusDoc* m_doc;
+	ScPage* m_page;
+	double m_scale;
+	PageToPixmapFlags m_flags;
+	QSize m_size;
+	int m_clipX { 0 };
+	int m_clipY { 0 };
+	bool m_picturesLoaded { false };
+	QList<QPair<PageItem*, int> > m_changedPictures;
+
+	int m_oldAppMode;
+	bool m_oldFramesShown;
+	bool m_oldShowControls;
+	bool m_oldDrawAsPreview;
+	bool m_oldMasterPageMode;
+	bool m_oldLoading;
+	bool m_gamutCheckDisabled { false };
+	ScPage* m_oldCurrentPage;
+};
+
+#endif
@@ -70,6 +70,7 @@ for which a new license (GPL+exception) is in place.
 #include "prefsmanager.h"
 #include "sccolor.h"
 #include "sccolorengine.h"
+#include "sccontentstream.h"
 #include "scfonts.h"
 #include "text/textlayoutpainter.h"
 #include "fonts/cff.h"
@@ -107,15 +108,16 @@ using namespace TableUtils;
 
 static inline QByteArray FToStr(double c)
 {
-	double v = c;
-	if (fabs(c) < 0.0000001)
-		v = 0.0;
-	return QByteArray::number(v, 'f', 5);
+	return ScContentStream::number(c);
 }
 
 static inline QByteArray TransformToStr(const QTransform& tr)
 {
-	return FToStr(tr.m11()) + " " + FToStr(tr.m12()) + " " + FToStr(tr.m21()) + " " + FToStr(tr.m22()) + " " + FToStr(tr.dx()) + " " + FToStr(tr.dy());
+	QByteArray str;
+	str.reserve(64);
+	ScContentStream(str) << tr;
+	str.chop(1);
+	return str;
 }
 
 class PdfPainter: public TextLayoutPainter
@@ -133,7 +135,11 @@ class PdfPainter: public TextLayoutPainter
 
 	QByteArray transformToStr(const QTransform& tr) const
 	{
-		return FToStr(tr.m11()) + " " + FToStr(-tr.m12()) + " " + FToStr(-tr.m21()) + " " + FToStr(tr.m22()) + " " + FToStr(tr.dx()) + " " + FToStr(-tr.dy());
+		QByteArray str;
+		str.reserve(64);
+		ScContentStream(str) << tr.m11() << -tr.m12() << -tr.m21() << tr.m22() << tr.dx() << -tr.dy();
+		str.chop(1);
+		return str;
 	}
 
 public:
@@ -311,11 +317,12 @@ public:
 				FPoint np;
 				if (outline.size() > 3)
 				{
+					ScContentStream cs(m_pathBuffer);
 					for (int poi = 0; poi < outline.size() - 3; poi += 4)
 					{
 						if (outline.isMarker(poi))
 						{
-							m_pathBuffer += "h\n";
+							cs << "h\n";
 							nPath = true;
 							continue;
 						}
@@ -323,16 +330,16 @@ public:
 						if (nPath)
 						{
 							np = outline.point(poi);
-							m_pathBuffer += FToStr(np.x()) + " " + FToStr(-np.y()) + " m\n";
+							cs << np.x() << -np.y() << "m\n";
 							nPath = false;
 						}
 
 						np = outline.point(poi + 1);
-						m_pathBuffer += FToStr(np.x()) + " " + FToStr(-np.y()) + " ";
+						cs << np.x() << -np.y();
 						np = outline.point(poi + 3);
-						m_pathBuffer += FToStr(np.x()) + " " + FToStr(-np.y()) + " ";
+						cs << np.x() << -np.y();
 						np = outline.point(poi + 2);
-						m_pathBuffer += FToStr(np.x()) + " " + FToStr(-np.y()) + " c\n";
+						cs << np.x() << -np.y() << "c\n";
 					}
 				}
 				m_pathBuffer += "h s\n";
@@ -401,11 +408,12 @@ public:
 					FPoint np;
 					if (outline.size() > 3)
 					{
+						ScContentStream cs(m_pathBuffer);
 						for (int poi = 0; poi < outline.size() - 3; poi += 4)
 						{
 							if (outline.isMarker(poi))
 							{
-								m_pathBuffer += "h\n";
+								cs << "h\n";
 								nPath = true;
 								continue;
 							}
@@ -413,16 +421,16 @@ public:
 							if (nPath)
 							{
 								np = outline.point(poi);
-								m_pathBuffer += FToStr(np.x()) + " " + FToStr(-np.y()) + " m\n";
+								cs << np.x() << -np.y() << "m\n";
 								nPath = false;
 							}
 
 							np = outline.point(poi + 1);
-							m_pathBuffer += FToStr(np.x()) + " " + FToStr(-np.y()) + " ";
+							cs << np.x() << -np.y();
 							np = outline.point(poi + 3);
-							m_pathBuffer += FToStr(np.x()) + " " + FToStr(-np.y()) + " ";
+							cs << np.x() << -np.y();
 							np = outline.point(poi + 2);
-							m_pathBuffer += FToStr(np.x()) + " " + FToStr(-np.y()) + " c\n";
+							cs << np.x() << -np.y() << "c\n";
 						}
 					}
 					m_pathBuffer += "h s\n";
@@ -749,13 +757,11 @@ static QByteArray blendMode(int code)
 	}
 }
 
-QByteArray PDFLibCore::EncStream(const QByteArray & in, PdfId ObjNum)
+void PDFLibCore::writeStreamData(const QByteArray& data, PdfId objNr)
 {
-	if (in.length() < 1)
-		return QByteArray();
-	if (!Options.Encrypt)
-		return in;
-	return writer.encryptBytes(in, ObjNum);
+	PutDoc("stream\n");
+	EncodeArrayToStream(data, objNr);
+	PutDoc("\nendstream");
 }
 
 QByteArray PDFLibCore::EncString(const QByteArray & in, PdfId ObjNum)
@@ -805,38 +811,26 @@ bool PDFLibCore::EncodeArrayToStream(const QByteArray& in, PdfId ObjNum)
 	return (writer.getOutStream().status() == QDataStream::Ok);
 }
 
-int PDFLibCore::WriteImageToStream(ScImage& image, PdfId ObjNum, ColorSpaceEnum format, bool precal)
+bool PDFLibCore::WriteImageToStream(ScImage& image, ScStreamFilter* filter, ColorSpaceEnum format, bool precal)
 {
-	bool fromCmyk, succeed = false;
-	int  bytesWritten = 0;
-
-	ScStreamFilter* rc4Encode = writer.openStreamFilter(Options.Encrypt, ObjNum);
-	if (rc4Encode->openFilter())
+	bool fromCmyk;
+	switch (format)
 	{
-		switch (format)
-		{
-			case ColorSpaceMonochrome :
-				fromCmyk = !Options.UseRGB && !Options.isGrayscale && !(doc.HasCMS && Options.UseProfiles2);
-				succeed = image.writeMonochromeDataToFilter(rc4Encode, fromCmyk); break;
-			case ColorSpaceGray :
-				succeed = image.writeGrayDataToFilter(rc4Encode, precal); break;
-			case ColorSpaceCMYK :
-				succeed = image.writeCMYKDataToFilter(rc4Encode); break;
-			default :
-				succeed = image.writeRGBDataToFilter(rc4Encode); break;
-		}
-		succeed &= rc4Encode->closeFilter();
-		bytesWritten = rc4Encode->writtenToStream();
-		delete rc4Encode;
+		case ColorSpaceMonochrome :
+			fromCmyk = !Options.UseRGB && !Options.isGrayscale && !(doc.HasCMS && Options.UseProfiles2);
+			return image.writeMonochromeDataToFilter(filter, fromCmyk);
+		case ColorSpaceGray :
+			return image.writeGrayDataToFilter(filter, precal);
+		case ColorSpaceCMYK :
+			return image.writeCMYKDataToFilter(filter);
+		default :
+			return image.writeRGBDataToFilter(filter);
 	}
-	return (succeed ? bytesWritten : 0);
 }
 
-int PDFLibCore::WriteJPEGImageToStream(ScImage& image, const QString& fn, PdfId ObjNum, int quality, ColorSpaceEnum format,
+bool PDFLibCore::WriteJPEGImageToStream(ScImage& image, const QString& fn, ScStreamFilter* filter, int quality, ColorSpaceEnum format,
 										 bool sameFile, bool precal)
 {
-	bool succeed = true;
-	int  bytesWritten = 0;
 	QFileInfo fInfo(fn);
 	QString   ext = fInfo.suffix().toLower();
 	QString   jpgFileName, tmpFile;
@@ -851,55 +845,11 @@ int PDFLibCore::WriteJPEGImageToStream(ScImage& image, const QString& fn, PdfId
 			jpgFileName = tmpFile;
 	}
 	if (jpgFileName.isEmpty())
-		return 0;
-	if (Options.Encrypt)
-	{
-		succeed = false;
-		ScStreamFilter* rc4Encode = writer.openStreamFilter(true, ObjNum);
-		if (rc4Encode->openFilter())
-		{
-			succeed  = copyFileToFilter(jpgFileName, *rc4Encode);
-			succeed &= rc4Encode->closeFilter();
-			bytesWritten = rc4Encode->writtenToStream();
-		}
-		delete rc4Encode;
-	}
-	else
-	{
-		succeed &= copyFileToStream(jpgFileName, writer.getOutStream());
-		QFileInfo jpgInfo(jpgFileName);
-		bytesWritten = jpgInfo.size();
-	}
+		return false;
+	bool succeed = copyFileToFilter(jpgFileName, *filter);
 	if (!tmpFile.isEmpty() && QFile::exists(tmpFile))
 		QFile::remove(tmpFile);
-	return (succeed ? bytesWritten : 0);
-}
-
-int PDFLibCore::WriteFlateImageToStream(ScImage& image, PdfId ObjNum, ColorSpaceEnum format, bool precal)
-{
-	bool fromCmyk, succeed = false;
-	int  bytesWritten = 0;
-	ScStreamFilter* rc4Encode = writer.openStreamFilter(Options.Encrypt, ObjNum);
-	ScFlateEncodeFilter flateEncode(rc4Encode);
-	if (flateEncode.openFilter())
-	{
-		switch (format)
-		{
-			case ColorSpaceMonochrome :
-				fromCmyk = !Options.UseRGB && !Options.isGrayscale && !(doc.HasCMS && Options.UseProfiles2);
-				succeed = image.writeMonochromeDataToFilter(&flateEncode, fromCmyk); break;
-			case ColorSpaceGray :
-				succeed = image.writeGrayDataToFilter(&flateEncode, precal); break;
-			case ColorSpaceCMYK :
-				succeed = image.writeCMYKDataToFilter(&flateEncode); break;
-			default :
-				succeed = image.writeRGBDataToFilter(&flateEncode); break;
-		}
-		succeed &= flateEncode.closeFilter();
-		bytesWritten = flateEncode.writtenToStream();
-	}
-	delete rc4Encode;
-	return (succeed ? bytesWritten : 0);
+	return succeed;
 }
 
 bool PDFLibCore::PDF_Begin_Doc(const QString& fn, SCFonts &AllFonts, const QMap<QString, QMap<uint, QString> >& DocFonts, BookmarkView* vi)
@@ -1378,24 +1328,25 @@ PdfFont PDFLibCore::PDF_WriteType3Font(const QByteArray& name, ScFace& face, con
 			mat.scale(100.0, -100.0);
 			gly.map(mat);
 			gly.translate(0, 1000);
+			ScContentStream cs(fon);
 			for (int poi = 0; poi < gly.size() - 3; poi += 4)
 			{
 				if (gly.isMarker(poi))
 				{
-					fon += "h\n";
+					cs << "h\n";
 					nPath = true;
 					continue;
 				}
 				if (nPath)
 				{
 					np = gly.point(poi);
-					fon += FToStr(np.x()) + " " + FToStr(np.y()) + " m\n";
+					cs << np.x() << np.y() << "m\n";
 					nPath = false;
 				}
 				np = gly.point(poi + 1);
 				np1 = gly.point(poi + 3);
 				np2 = gly.point(poi + 2);
-				fon += FToStr(np.x()) + " " + FToStr(np.y()) + " " + FToStr(np1.x()) + " " + FToStr(np1.y()) + " " + FToStr(np2.x()) + " " + FToStr(np2.y()) + " c\n";
+				cs << np.x() << np.y() << np1.x() << np1.y() << np2.x() << np2.y() << "c\n";
 			}
 			fon += useNonZeroRule? "h f\n" : "h f*\n";
 			np = getMinClipF(&gly);
@@ -1424,7 +1375,8 @@ PdfFont PDFLibCore::PDF_WriteType3Font(const QByteArray& name, ScFace& face, con
 		PutDoc("<< /Length " + Pdf::toPdf(fon.length() + 1));
 		if (Options.Compress)
 			PutDoc("\n/Filter /FlateDecode");
-		PutDoc("\n>>\nstream\n" + EncStream(fon, charProcObject) + "\nendstream");
+		PutDoc("\n>>\n");
+		writeStreamData(fon, charProcObject);
 		writer.endObj(charProcObject);
 
 		// #15449 : in some cases we cannot retrieve glyph names for all glyphs we need
@@ -1586,26 +1538,25 @@ PdfFont PDFLibCore::PDF_WriteGlyphsAsXForms(const QByteArray& fontName, ScFace&
 			QTransform mat;
 			mat.scale(0.1, 0.1);
 			gly.map(mat);
+			ScContentStream cs(fon);
 			for (int poi = 0; poi < gly.size() - 3; poi += 4)
 			{
 				if (gly.isMarker(poi))
 				{
-					fon += "h\n";
+					cs << "h\n";
 					nPath = true;
 					continue;
 				}
 				if (nPath)
 				{
 					np = gly.point(poi);
-					fon += FToStr(np.x()) + " " + FToStr(-np.y()) + " m\n";
+					cs << np.x() << -np.y() << "m\n";
 					nPath = false;
 				}
 				np = gly.point(poi + 1);
 				np1 = gly.point(poi + 3);
 				np2 = gly.point(poi + 2);
-				fon += FToStr(np.x()) + " " + FToStr(-np.y()) + " " +
-				FToStr(np1.x()) + " " + FToStr(-np1.y()) + " " +
-				FToStr(np2.x()) + " " + FToStr(-np2.y()) + " c\n";
+				cs << np.x() << -np.y() << np1.x() << -np1.y() << np2.x() << -np2.y() << "c\n";
 			}
 			fon += useNonZeroRule? "h f\n" : "h f*\n";
 			np = getMinClipF(&gly);
@@ -1631,7 +1582,8 @@ PdfFont PDFLibCore::PDF_WriteGlyphsAsXForms(const QByteArray& fontName, ScFace&
 		PutDoc("/Length " + Pdf::toPdf(fon.length() + 1));
 		if (Options.Compress)
 			PutDoc("\n/Filter /FlateDecode");
-		PutDoc(" >>\nstream\n" + EncStream(fon, fontGlyphXForm) + "\nendstream");
+		PutDoc(" >>\n");
+		writeStreamData(fon, fontGlyphXForm);
 		writer.endObj(fontGlyphXForm);
 		pageData.XObjects[fontName + "_gl" + Pdf::toPdf(gid)] = fontGlyphXForm;
 	}
@@ -2223,7 +2175,8 @@ PdfId PDFLibCore::PDF_EmbedType1AsciiFontObject(const QByteArray& fon)
 		PutDoc("/Length3 " + Pdf::toPdf(fon.length() - len2) + "\n");
 	if (Options.Compress)
 		PutDoc("/Filter /FlateDecode\n");
-	PutDoc(">>\nstream\n" + EncStream(fon2, embeddedFontObject) + "\nendstream");
+	PutDoc(">>\n");
+	writeStreamData(fon2, embeddedFontObject);
 	writer.endObj(embeddedFontObject);
 	return embeddedFontObject;
 }
@@ -2272,7 +2225,8 @@ PdfId PDFLibCore::PDF_EmbedType1BinaryFontObject(const QByteArray& bb)
 	PutDoc("/Length3 " + Pdf::toPdf(len3) + "\n");
 	if (Options.Compress)
 		PutDoc("/Filter /FlateDecode\n");
-	PutDoc(">>\nstream\n" + EncStream(fon,embeddedFontObject) + "\nendstream");
+	PutDoc(">>\n");
+	writeStreamData(fon, embeddedFontObject);
 	writer.endObj(embeddedFontObject);
 	return embeddedFontObject;
 }
@@ -2526,7 +2480,8 @@ void PDFLibCore::PDF_Begin_Colors()
 			PutDoc("/Domain [0.0 1.0]\n");
 			PutDoc("/Range [0.0 1.0 0.0 1.0 0.0 1.0 0.0 1.0]\n");
 			PutDoc("/Length " + Pdf::toPdf(colorDesc.length() + 1) + "\n");
-			PutDoc(">>\nstream\n" + EncStream(colorDesc, separationFunction) + "\nendstream");
+			PutDoc(">>\n");
+			writeStreamData(colorDesc, separationFunction);
 			writer.endObj(separationFunction);
 			PdfId separationColorspace = writer.newObject();
 			writer.startObj(separationColorspace);
@@ -3281,7 +3236,8 @@ bool PDFLibCore::PDF_TemplatePage(const ScPage* pag, bool)
 			PutDoc("/Length " + Pdf::toPdf(Content.length() + 1));
 			if (Options.Compress)
 				PutDoc("\n/Filter /FlateDecode");
-			PutDoc(" >>\nstream\n" + EncStream(Content, templateObject) + "\nendstream");
+			PutDoc(" >>\n");
+			writeStreamData(Content, templateObject);
 			writer.endObj(templateObject);
 				
 			int pIndex = doc.MasterPages.indexOf((ScPage* const) pag) + 1;
@@ -3733,9 +3689,8 @@ void PDFLibCore::writeXObject(uint objNr, const QByteArray& dictionary, const QB
 	writer.startObj(objNr);
 	PutDoc("<<");
 	PutDoc(dictionary);
-	PutDoc(">>\nstream\n");
-	EncodeArrayToStream(stream, objNr);
-	PutDoc("\nendstream");
+	PutDoc(">>\n");
+	writeStreamData(stream, objNr);
 	writer.endObj(objNr);
 }
 
@@ -3907,7 +3862,8 @@ bool PDFLibCore::PDF_ProcessMasterElements(const ScLayer& layer, const ScPage* p
 		PutDoc("/Length " + QByteArray::number(content.length() + 1));
 		if (Options.Compress)
 			PutDoc("\n/Filter /FlateDecode");
-		PutDoc(" >>\nstream\n" + EncStream(content, formObject) + "\nendstream");
+		PutDoc(" >>\n");
+		writeStreamData(content, formObject);
 		writer.endObj(formObject);
 		QByteArray name = ResNam + QByteArray::number(ResCount);
 		ResCount++;
@@ -3986,7 +3942,8 @@ bool PDFLibCore::PDF_ProcessPageElements(const ScLayer& layer, const ScPage* pag
 		PutDoc("/Length " + Pdf::toPdf(inh.length() + 1));
 		if (Options.Compress)
 			PutDoc("\n/Filter /FlateDecode");
-		PutDoc(" >>\nstream\n" + EncStream(inh, formObject) + "\nendstream");
+		PutDoc(" >>\n");
+		writeStreamData(inh, formObject);
 		writer.endObj(formObject);
 		QByteArray name = Pdf::toPdfDocEncoding(layer.Name.simplified().replace(QRegExp("[\\s\\/\\{\\[\\]\\}\\<\\>\\(\\)\\%]"), "_")) + Pdf::toPdf(layer.ID) + Pdf::toPdf(PNr);
 		pageData.XObjects[name] = formObject;
@@ -4047,7 +4004,8 @@ QByteArray PDFLibCore::Write_FormXObject(QByteArray &data, PageItem *controlItem
 	PutDoc("/Length " + QByteArray::number(data.length() + 1));
 	if (Options.Compress)
 		PutDoc("\n/Filter /FlateDecode");
-	PutDoc(" >>\nstream\n" + EncStream(data, formObject) + "\nendstream");
+	PutDoc(" >>\n");
+	writeStreamData(data, formObject);
 	writer.endObj(formObject);
 	QByteArray name = ResNam + QByteArray::number(ResCount);
 	ResCount++;
@@ -4136,7 +4094,8 @@ QByteArray PDFLibCore::Write_TransparencyGroup(double trans, int blend, QByteArr
 	PutDoc("/Length " + Pdf::toPdf(data.length() + 1));
 	if (Options.Compress)
 		PutDoc("\n/Filter /FlateDecode");
-	PutDoc(" >>\nstream\n" + EncStream(data, formObject) + "\nendstream");
+	PutDoc(" >>\n");
+	writeStreamData(data, formObject);
 	writer.endObj(formObject);
 	QByteArray name = ResNam + Pdf::toPdf(ResCount);
 	ResCount++;
@@ -4205,16 +4164,10 @@ QByteArray PDFLibCore::PDF_PutSoftShadow(PageItem* ite)
 	PutDoc("/Height " + Pdf::toPdf(img.height()) + "\n");
 	PutDoc("/ColorSpace /DeviceGray\n");
 	PutDoc("/BitsPerComponent 8\n");
-	uint lengthObj = writer.newObject();
-	PutDoc("/Length " + Pdf::toPdf(lengthObj) + " 0 R\n");
-	PutDoc("/Filter /FlateDecode\n");
-	PutDoc(">>\nstream\n");
-	int bytesWritten = WriteFlateImageToStream(img, maskObj, ColorSpaceGray, false);
-	PutDoc("\nendstream");
+	ScStreamFilter* maskStream = writer.startStream(maskObj, true, Options.Encrypt);
+	WriteImageToStream(img, maskStream, ColorSpaceGray, false);
+	writer.endStream(maskObj);
 	writer.endObj(maskObj);
-	writer.startObj(lengthObj);
-	PutDoc("    " + Pdf::toPdf(bytesWritten));
-	writer.endObj(lengthObj);
 
 	const ScColor& shadowColor = doc.PageColors[ite->softShadowColor()];
 	QByteArray colstr = SetColor(ite->softShadowColor(), ite->softShadowShade());
@@ -4262,7 +4215,8 @@ QByteArray PDFLibCore::PDF_PutSoftShadow(PageItem* ite)
 		PutDoc("/Filter /FlateDecode\n");
 	}
 	PutDoc("/Length " + Pdf::toPdf(softMaskGroupData.length()) + "\n");
-	PutDoc(">>stream\n" + EncStream(softMaskGroupData, softMaskGroupObj) + "\nendstream");
+	PutDoc(">>");
+	writeStreamData(softMaskGroupData, softMaskGroupObj);
 	writer.endObj(softMaskGroupObj);
 
 	PdfId softMaskObj = writer.newObject();
@@ -5952,89 +5906,17 @@ QByteArray PDFLibCore::SetGradientColor(const QString& farbe, double Shade)
 
 QByteArray PDFLibCore::SetClipPath(const PageItem *ite, bool poly)
 {
-	QByteArray tmp;
-	FPoint np, np1, np2, np3, np4, firstP;
-	bool nPath = true;
-	bool first = true;
-	if (ite->PoLine.size() <= 3)
-		return tmp;
-
-	for (int poi=0; poi<ite->PoLine.size() - 3; poi += 4)
-	{
-		if (ite->PoLine.isMarker(poi))
-		{
-			nPath = true;
-			continue;
-		}
-		if (nPath)
-		{
-			np = ite->PoLine.point(poi);
-			if ((!first) && (poly) && (np4 == firstP))
-				tmp += "h\n";
-			tmp += FToStr(np.x()) + " " + FToStr(-np.y()) + " m\n";
-			nPath = false;
-			first = false;
-			firstP = np;
-			np4 = np;
-		}
-		np = ite->PoLine.point(poi);
-		np1 = ite->PoLine.point(poi+1);
-		np2 = ite->PoLine.point(poi+3);
-		np3 = ite->PoLine.point(poi+2);
-		if ((np == np1) && (np2 == np3))
-			tmp += FToStr(np3.x()) + " " + FToStr(-np3.y()) + " l\n";
-		else
-		{
-			tmp += FToStr(np1.x()) + " " + FToStr(-np1.y()) + " ";
-			tmp += FToStr(np2.x()) + " " + FToStr(-np2.y()) + " ";
-			tmp += FToStr(np3.x()) + " " + FToStr(-np3.y()) + " c\n";
-		}
-		np4 = np3;
-	}
-	return tmp;
+	return SetClipPathArray(&ite->PoLine, poly);
 }
 
 QByteArray PDFLibCore::SetClipPathArray(const FPointArray *ite, bool poly)
 {
 	QByteArray tmp;
-	FPoint np, np1, np2, np3, np4, firstP;
-	bool nPath = true;
-	bool first = true;
 	if (ite->size() <= 3)
 		return tmp;
-
-	for (int poi=0; poi<ite->size() - 3; poi += 4)
-	{
-		if (ite->isMarker(poi))
-		{
-			nPath = true;
-			continue;
-		}
-		if (nPath)
-		{
-			np = ite->point(poi);
-			if ((!first) && (poly) && (np4 == firstP))
-				tmp += "h\n";
-			tmp += FToStr(np.x()) + " " + FToStr(-np.y()) + " m\n";
-			nPath = false;
-			first = false;
-			firstP = np;
-			np4 = np;
-		}
-		np = ite->point(poi);
-		np1 = ite->point(poi+1);
-		np2 = ite->point(poi+3);
-		np3 = ite->point(poi+2);
-		if ((np == np1) && (np2 == np3))
-			tmp += FToStr(np3.x()) + " " + FToStr(-np3.y()) + " l\n";
-		else
-		{
-			tmp += FToStr(np1.x()) + " " + FToStr(-np1.y()) + " ";
-			tmp += FToStr(np2.x()) + " " + FToStr(-np2.y()) + " ";
-			tmp += FToStr(np3.x()) + " " + FToStr(-np3.y()) + " c\n";
-		}
-		np4 = np3;
-	}
+	// A path takes about a dozen bytes per point
+	tmp.reserve(ite->size() * 12);
+	ScContentStream(tmp).appendPath(*ite, ScContentStream::pdfOperators, poly);
 	return tmp;
 }
 
@@ -6044,12 +5926,13 @@ QByteArray PDFLibCore::SetClipPathImage(const PageItem *ite)
 	if (ite->imageClip.size() <= 3)
 		return tmp;
 
+	ScContentStream cs(tmp);
 	bool nPath = true;
 	for (int poi=0; poi<ite->imageClip.size() - 3; poi += 4)
 	{
 		if (ite->imageClip.isMarker(poi))
 		{
-			tmp += "h\n";
+			cs << "h\n";
 			nPath = true;
 			continue;
 		}
@@ -6057,7 +5940,7 @@ QByteArray PDFLibCore::SetClipPathImage(const PageItem *ite)
 		if (nPath)
 		{
 			np = ite->imageClip.point(poi);
-			tmp += FToStr(np.x()) + " " + FToStr(-np.y()) + " m\n";
+			cs << np.x() << -np.y() << "m\n";
 			nPath = false;
 		}
 		np = ite->imageClip.point(poi);
@@ -6065,13 +5948,9 @@ QByteArray PDFLibCore::SetClipPathImage(const PageItem *ite)
 		np2 = ite->imageClip.point(poi+3);
 		np3 = ite->imageClip.point(poi+2);
 		if ((np == np1) && (np2 == np3))
-			tmp += FToStr(np3.x()) + " " + FToStr(-np3.y()) + " l\n";
+			cs << np3.x() << -np3.y() << "l\n";
 		else
-		{
-			tmp += FToStr(np1.x()) + " " + FToStr(-np1.y()) + " ";
-			tmp += FToStr(np2.x()) + " " + FToStr(-np2.y()) + " ";
-			tmp += FToStr(np3.x()) + " " + FToStr(-np3.y()) + " c\n";
-		}
+			cs << np1.x() << -np1.y() << np2.x() << -np2.y() << np3.x() << -np3.y() << "c\n";
 	}
 	return tmp;
 }
@@ -6327,7 +6206,8 @@ QByteArray PDFLibCore::PDF_TransparenzFill(PageItem *currItem)
 		PutDoc("/Length " + Pdf::toPdf(stre.length()) + "\n");
 		if (Options.Compress)
 			PutDoc("/Filter /FlateDecode\n");
-		PutDoc(">>\nstream\n" + EncStream(stre, formObject) + "\nendstream");
+		PutDoc(">>\n");
+		writeStreamData(stre, formObject);
 		writer.endObj(formObject);
 		pageData.XObjects[ResNam + Pdf::toPdf(ResCount)] = formObject;
 		ResCount++;
@@ -6389,7 +6269,8 @@ QByteArray PDFLibCore::PDF_TransparenzFill(PageItem *currItem)
 		PutDoc("/Length " + Pdf::toPdf(stre.length()) + "\n");
 		if (Options.Compress)
 			PutDoc("/Filter /FlateDecode\n");
-		PutDoc(">>\nstream\n" + EncStream(stre, formObject) + "\nendstream");
+		PutDoc(">>\n");
+		writeStreamData(stre, formObject);
 		writer.endObj(formObject);
 		pageData.XObjects[ResNam + Pdf::toPdf(ResCount)] = formObject;
 		ResCount++;
@@ -6656,7 +6537,8 @@ bool PDFLibCore::PDF_PatternFillStroke(QByteArray& output, PageItem *currItem, i
 	PutDoc("/Length " + Pdf::toPdf(tmp2.length()));
 	if (Options.Compress)
 		PutDoc("\n/Filter /FlateDecode");
-	PutDoc(" >>\nstream\n" + EncStream(tmp2, patObject) + "\nendstream");
+	PutDoc(" >>\n");
+	writeStreamData(tmp2, patObject);
 	writer.endObj(patObject);
 	Patterns.insert("Pattern" + Pdf::toPdf(patObject), patObject);
 	QByteArray tmp;
@@ -6817,7 +6699,8 @@ bool PDFLibCore::PDF_MeshGradientFill(QByteArray& output, PageItem *c)
 		PutDoc("/Length " + Pdf::toPdf(dat.length()) + "\n");
 		if (Options.Compress)
 			PutDoc("/Filter /FlateDecode\n");
-		PutDoc(">>\nstream\n" + EncStream(dat, shadeObjectT) + "\nendstream");
+		PutDoc(">>\n");
+		writeStreamData(dat, shadeObjectT);
 		writer.endObj(shadeObjectT);
 		
 		PdfId patObject = writer.newObject();
@@ -6851,7 +6734,8 @@ bool PDFLibCore::PDF_MeshGradientFill(QByteArray& output, PageItem *c)
 		PutDoc("/Length " + Pdf::toPdf(stre.length()) + "\n");
 		if (Options.Compress)
 			PutDoc("/Filter /FlateDecode\n");
-		PutDoc(">>\nstream\n" + EncStream(stre, formObject) + "\nendstream");
+		PutDoc(">>\n");
+		writeStreamData(stre, formObject);
 		writer.endObj(shadeObjectT);
 		pageData.XObjects[ResNam + Pdf::toPdf(ResCount)] = formObject;
 		ResCount++;
@@ -6948,7 +6832,8 @@ bool PDFLibCore::PDF_MeshGradientFill(QByteArray& output, PageItem *c)
 	PutDoc("/Length " + Pdf::toPdf(dat.length()) + "\n");
 	if (Options.Compress)
 		PutDoc("/Filter /FlateDecode\n");
-	PutDoc(">>\nstream\n" + EncStream(dat, shadeObject) + "\nendstream");
+	PutDoc(">>\n");
+	writeStreamData(dat, shadeObject);
 	writer.endObj(shadeObject);
 	
 	PdfId patObject = writer.newObject();
@@ -7014,7 +6899,8 @@ bool PDFLibCore::PDF_MeshGradientFill(QByteArray& output, PageItem *c)
 		colorDesc += "}\n";
 		PutDoc("/Range [0 1 0 1 0 1 0 1]\n");
 		PutDoc("/Length " + Pdf::toPdf(colorDesc.length() + 1) + "\n");
-		PutDoc(">>\nstream\n" + EncStream(colorDesc, spotObject) + "\nendstream");
+		PutDoc(">>\n");
+		writeStreamData(colorDesc, spotObject);
 		writer.endObj(spotObject);
 	}
 	QByteArray tmp;
@@ -7148,7 +7034,8 @@ bool PDFLibCore::PDF_PatchMeshGradientFill(QByteArray& output, PageItem *c)
 		PutDoc("/Length " + Pdf::toPdf(dat.length()) + "\n");
 		if (Options.Compress)
 			PutDoc("/Filter /FlateDecode\n");
-		PutDoc(">>\nstream\n" + EncStream(dat, shadeObjectT) + "\nendstream");
+		PutDoc(">>\n");
+		writeStreamData(dat, shadeObjectT);
 		writer.endObj(shadeObjectT);
 		PdfId patObject = writer.newObject();
 		writer.startObj(patObject);
@@ -7181,7 +7068,8 @@ bool PDFLibCore::PDF_PatchMeshGradientFill(QByteArray& output, PageItem *c)
 		PutDoc("/Length " + Pdf::toPdf(stre.length()) + "\n");
 		if (Options.Compress)
 			PutDoc("/Filter /FlateDecode\n");
-		PutDoc(">>\nstream\n" + EncStream(stre, formObject) + "\nendstream");
+		PutDoc(">>\n");
+		writeStreamData(stre, formObject);
 		writer.endObj(formObject);
 		pageData.XObjects[ResNam + Pdf::toPdf(ResCount)] = formObject;
 		ResCount++;
@@ -7276,7 +7164,8 @@ bool PDFLibCore::PDF_PatchMeshGradientFill(QByteArray& output, PageItem *c)
 	PutDoc("/Length " + Pdf::toPdf(dat.length()) + "\n");
 	if (Options.Compress)
 		PutDoc("/Filter /FlateDecode\n");
-	PutDoc(">>\nstream\n" + EncStream(dat, shadeObject) + "\nendstream");
+	PutDoc(">>\n");
+	writeStreamData(dat, shadeObject);
 	writer.endObj(shadeObject);
 	PdfId patObject = writer.newObject();
 	writer.startObj(patObject);
@@ -7341,7 +7230,8 @@ bool PDFLibCore::PDF_PatchMeshGradientFill(QByteArray& output, PageItem *c)
 		colorDesc += "}\n";
 		PutDoc("/Range [0 1 0 1 0 1 0 1]\n");
 		PutDoc("/Length " + Pdf::toPdf(colorDesc.length() + 1) + "\n");
-		PutDoc(">>\nstream\n" + EncStream(colorDesc, spotObject) + "\nendstream");
+		PutDoc(">>\n");
+		writeStreamData(colorDesc, spotObject);
 		writer.endObj(spotObject);
 	}
 	QByteArray tmp;
@@ -7508,7 +7398,8 @@ bool PDFLibCore::PDF_DiamondGradientFill(QByteArray& output, PageItem *c)
 		PutDoc("/Length " + Pdf::toPdf(dat.length()) + "\n");
 		if (Options.Compress)
 			PutDoc("/Filter /FlateDecode\n");
-		PutDoc(">>\nstream\n" + EncStream(dat, shadeObjectT) + "\nendstream");
+		PutDoc(">>\n");
+		writeStreamData(dat, shadeObjectT);
 		writer.endObj(shadeObjectT);
 		PdfId patObject = writer.newObject();
 		writer.startObj(patObject);
@@ -7541,7 +7432,8 @@ bool PDFLibCore::PDF_DiamondGradientFill(QByteArray& output, PageItem *c)
 		PutDoc("/Length " + Pdf::toPdf(stre.length()) + "\n");
 		if (Options.Compress)
 			PutDoc("/Filter /FlateDecode\n");
-		PutDoc(">>\nstream\n" + EncStream(stre, formObject) + "\nendstream");
+		PutDoc(">>\n");
+		writeStreamData(stre, formObject);
 		writer.endObj(formObject);
 		pageData.XObjects[ResNam + Pdf::toPdf(ResCount)] = formObject;
 		ResCount++;
@@ -7709,7 +7601,8 @@ bool PDFLibCore::PDF_DiamondGradientFill(QByteArray& output, PageItem *c)
 	PutDoc("/Length " + Pdf::toPdf(dat.length()) + "\n");
 	if (Options.Compress)
 		PutDoc("/Filter /FlateDecode\n");
-	PutDoc(">>\nstream\n" + EncStream(dat, shadeObject) + "\nendstream");
+	PutDoc(">>\n");
+	writeStreamData(dat, shadeObject);
 	writer.endObj(shadeObject);
 	PdfId patObject = writer.newObject();
 	writer.startObj(patObject);
@@ -7774,7 +7667,8 @@ bool PDFLibCore::PDF_DiamondGradientFill(QByteArray& output, PageItem *c)
 		colorDesc += "}\n";
 		PutDoc("/Range [0 1 0 1 0 1 0 1]\n");
 		PutDoc("/Length " + Pdf::toPdf(colorDesc.length() + 1) + "\n");
-		PutDoc(">>\nstream\n" + EncStream(colorDesc, spotObject) + "\nendstream");
+		PutDoc(">>\n");
+		writeStreamData(colorDesc, spotObject);
 		writer.endObj(spotObject);
 	}
 	QByteArray tmp;
@@ -7871,7 +7765,8 @@ bool PDFLibCore::PDF_TensorGradientFill(QByteArray& output, PageItem *c)
 		PutDoc("/Length " + Pdf::toPdf(dat.length()) + "\n");
 		if (Options.Compress)
 			PutDoc("/Filter /FlateDecode\n");
-		PutDoc(">>\nstream\n" + EncStream(dat, shadeObjectT) + "\nendstream");
+		PutDoc(">>\n");
+		writeStreamData(dat, shadeObjectT);
 		writer.endObj(shadeObjectT);
 		PdfId patObject = writer.newObject();
 		writer.startObj(patObject);
@@ -7904,7 +7799,8 @@ bool PDFLibCore::PDF_TensorGradientFill(QByteArray& output, PageItem *c)
 		PutDoc("/Length " + Pdf::toPdf(stre.length()) + "\n");
 		if (Options.Compress)
 			PutDoc("/Filter /FlateDecode\n");
-		PutDoc(">>\nstream\n" + EncStream(stre, formObject) + "\nendstream");
+		PutDoc(">>\n");
+		writeStreamData(stre, formObject);
 		writer.endObj(formObject);
 		pageData.XObjects[ResNam + Pdf::toPdf(ResCount)] = formObject;
 		ResCount++;
@@ -8029,7 +7925,8 @@ bool PDFLibCore::PDF_TensorGradientFill(QByteArray& output, PageItem *c)
 	PutDoc("/Length " + Pdf::toPdf(dat.length()) + "\n");
 	if (Options.Compress)
 		PutDoc("/Filter /FlateDecode\n");
-	PutDoc(">>\nstream\n" + EncStream(dat, shadeObject) + "\nendstream");
+	PutDoc(">>\n");
+	writeStreamData(dat, shadeObject);
 	writer.endObj(shadeObject);
 	PdfId patObject = writer.newObject();
 	writer.startObj(patObject);
@@ -8094,7 +7991,8 @@ bool PDFLibCore::PDF_TensorGradientFill(QByteArray& output, PageItem *c)
 		colorDesc += "}\n";
 		PutDoc("/Range [0 1 0 1 0 1 0 1]\n");
 		PutDoc("/Length " + Pdf::toPdf(colorDesc.length() + 1) + "\n");
-		PutDoc(">>\nstream\n" + EncStream(colorDesc, spotObject) + "\nendstream");
+		PutDoc(">>\n");
+		writeStreamData(colorDesc, spotObject);
 		writer.endObj(spotObject);
 	}
 	QByteArray tmp;
@@ -8375,7 +8273,8 @@ bool PDFLibCore::PDF_GradientFillStroke(QByteArray& output, PageItem *currItem,
 		PutDoc("/Length " + Pdf::toPdf(stre.length()) + "\n");
 		if (Options.Compress)
 			PutDoc("/Filter /FlateDecode\n");
-		PutDoc(">>\nstream\n" + EncStream(stre, formObject) + "\nendstream");
+		PutDoc(">>\n");
+		writeStreamData(stre, formObject);
 		writer.endObj(formObject);
 		pageData.XObjects[ResNam + Pdf::toPdf(ResCount)] = formObject;
 		ResCount++;
@@ -8548,7 +8447,8 @@ bool PDFLibCore::PDF_GradientFillStroke(QByteArray& output, PageItem *currItem,
 		colorDesc += "}\n";
 		PutDoc("/Range [0 1 0 1 0 1 0 1]\n");
 		PutDoc("/Length " + Pdf::toPdf(colorDesc.length() + 1) + "\n");
-		PutDoc(">>\nstream\n" + EncStream(colorDesc, spotObject) + "\nendstream");
+		PutDoc(">>\n");
+		writeStreamData(colorDesc, spotObject);
 		writer.endObj(spotObject);
 	}
 	QByteArray tmp;
@@ -9688,7 +9588,8 @@ PdfId PDFLibCore::WritePDFStream(const QByteArray& cc, PdfId objId)
 	PutDoc("<< /Length " + Pdf::toPdf(tmp.length()));  // moeglicherweise +1
 	if (Options.Compress)
 		PutDoc("\n/Filter /FlateDecode");
-	PutDoc(" >>\nstream\n" + EncStream(tmp, objId) + "\nendstream");
+	PutDoc(" >>\n");
+	writeStreamData(tmp, objId);
 	writer.endObj(objId);
 	return objId;
 }
@@ -9743,7 +9644,8 @@ void PDFLibCore::PDF_xForm(PdfId objNr, double w, double h, const QByteArray& im
 	writer.write(dict);
 
 	PutDoc("/Length " + Pdf::toPdf(im.length()) + "\n");
-	PutDoc(">>\nstream\n" + EncStream(im, objNr) + "\nendstream");
+	PutDoc(">>\n");
+	writeStreamData(im, objNr);
 	writer.endObj(objNr);
 	pageData.XObjects[ResNam + Pdf::toPdf(ResCount)] = objNr;
 	ResCount++;
@@ -9761,7 +9663,8 @@ void PDFLibCore::PDF_Form(const QByteArray& im) // unused? - av
 	writer.write(dict);
 
 	PutDoc("/Length " + Pdf::toPdf(im.length()) + "\n");
-	PutDoc(">>\nstream\n" + EncStream(im, form) + "\nendstream");
+	PutDoc(">>\n");
+	writeStreamData(im, form);
 	writer.endObj(form);
 }
 
@@ -10724,7 +10627,6 @@ bool PDFLibCore::PDF_Image(PageItem* item, const QString& fn, double sx, double
 			}
 			if (hasGrayProfile && doc.HasCMS && Options.UseProfiles2 && (!hasColorEffect))
 				exportToGrayscale = true;
-			int bytesWritten = 0;
 			// Fixme: outType variable should be set directly in the if/else maze above.
 			ColorSpaceEnum outType;
 			if (img.imgInfo.colorspace == ColorSpaceMonochrome && item->effectsInUse.count() == 0)
@@ -10755,12 +10657,8 @@ bool PDFLibCore::PDF_Image(PageItem* item, const QString& fn, double sx, double
 				PutDoc("/BitsPerComponent 1\n");
 			else
 				PutDoc("/BitsPerComponent 8\n");
-			PdfId lengthObj = writer.newObject();
-			PutDoc("/Length " + Pdf::toPdf(lengthObj) + " 0 R\n");
 			if (cm == PDFOptions::Compression_JPEG)
 				PutDoc("/Filter /DCTDecode\n");
-			else if (cm != PDFOptions::Compression_None)
-				PutDoc("/Filter /FlateDecode\n");
 //			if (exportToCMYK && (cm == PDFOptions::Compression_JPEG))
 //				PutDoc("/Decode [1 0 1 0 1 0 1 0]\n");
 			if (alphaM)
@@ -10770,28 +10668,26 @@ bool PDFLibCore::PDF_Image(PageItem* item, const QString& fn, double sx, double
 				else
 					PutDoc("/Mask " + Pdf::toPdf(maskObj) + " 0 R\n");
 			}
-			PutDoc(">>\nstream\n");
+			// Images go to the file as they are encoded, the data is not kept in memory once more
+			bool deflate = (cm != PDFOptions::Compression_JPEG) && (cm != PDFOptions::Compression_None);
+			ScStreamFilter* imageStream = writer.startStream(imageObj, deflate, Options.Encrypt);
+			bool imageWritten;
 			if (cm == PDFOptions::Compression_JPEG) // Fixme: should not do this with monochrome images?
 			{
 				int quality = item->OverrideCompressionQuality ? item->CompressionQualityIndex : Options.Quality;
 				if (item->OverrideCompressionQuality)
 					jpegUseOriginal = false;
-				bytesWritten = WriteJPEGImageToStream(img, fn, imageObj, quality, outType, jpegUseOriginal, (!hasColorEffect && hasGrayProfile));
+				imageWritten = WriteJPEGImageToStream(img, fn, imageStream, quality, outType, jpegUseOriginal, (!hasColorEffect && hasGrayProfile));
 			}
-			else if (cm == PDFOptions::Compression_ZIP)
-				bytesWritten = WriteFlateImageToStream(img, imageObj, outType, (!hasColorEffect && hasGrayProfile));
 			else
-				bytesWritten = WriteImageToStream(img, imageObj, outType, (!hasColorEffect && hasGrayProfile));
-			PutDoc("\nendstream");
+				imageWritten = WriteImageToStream(img, imageStream, outType, (!hasColorEffect && hasGrayProfile));
+			imageWritten &= writer.endStream(imageObj);
 			writer.endObj(imageObj);
-			if (bytesWritten <= 0)
+			if (!imageWritten)
 			{
 				PDF_Error_ImageWriteFailure(fn);
 				return false;
 			}
-			writer.startObj(lengthObj);
-			PutDoc("    " + Pdf::toPdf(bytesWritten));
-			writer.endObj(lengthObj);
 			pageData.ImgObjects[ResNam + "I" + Pdf::toPdf(ResCount)] = imageObj;
 			ImInfo.ResNum = ResCount;
 			ImInfo.Width = img.width();
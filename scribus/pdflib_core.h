@@ -150,15 +150,13 @@ private:
 	void PDF_Error_MaskLoadFailure(const QString& fileName);
 	void PDF_Error_InsufficientMemory();
 
-	QByteArray EncStream(const QByteArray & in, PdfId ObjNum);
 	QByteArray EncString(const QByteArray & in, PdfId ObjNum);
 	QByteArray EncStringUTF16(const QString & in, PdfId ObjNum);
 
 	bool       EncodeArrayToStream(const QByteArray& in, PdfId ObjNum);
 
-	int     WriteImageToStream(ScImage& image, PdfId ObjNum, ColorSpaceEnum format, bool precal);
-	int     WriteJPEGImageToStream(ScImage& image, const QString& fn, PdfId ObjNum, int quality, ColorSpaceEnum format, bool sameFile, bool precal);
-	int     WriteFlateImageToStream(ScImage& image, PdfId ObjNum, ColorSpaceEnum format, bool precal);
+	bool    WriteImageToStream(ScImage& image, ScStreamFilter* filter, ColorSpaceEnum format, bool precal);
+	bool    WriteJPEGImageToStream(ScImage& image, const QString& fn, ScStreamFilter* filter, int quality, ColorSpaceEnum format, bool sameFile, bool precal);
 
 //	void    CalcOwnerKey(const QString & Owner, const QString & User);
 //	void    CalcUserKey(const QString & User, int Permission);
@@ -198,6 +196,8 @@ private:
 	uint       WritePDFString(const QString& cc);
 	uint       WritePDFString(const QString& cc, PdfId objId);
 	void       writeXObject(uint objNr, const QByteArray& dictionary, const QByteArray& stream);
+	/// Writes the stream keywords and data of object objNr, encrypted in place of a copy when needed
+	void       writeStreamData(const QByteArray& data, PdfId objNr);
 	uint       writeObject(const QByteArray& type, const QByteArray& dictionary);
 	uint       writeGState(QByteArray dictionary) { return writeObject("/ExtGState", dictionary); }
 	uint       writeActions(const Annotation&, uint annotationObj);
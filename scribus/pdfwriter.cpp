@@ -9,9 +9,13 @@ for which a new license (GPL+exception) is in place.
 
 #include "pdfwriter.h"
 #include "rc4.h"
+#include "scstreamfilter_flate.h"
 #include "scstreamfilter_rc4.h"
 #include "util.h"
 
+// Digits reserved for the /Length of streams written with Writer::startStream()
+static const int lengthDigits = 12;
+
 namespace Pdf
 {
 
@@ -506,8 +510,53 @@ namespace Pdf
 		return new ScNullEncodeFilter(&m_outStream);
 	}
 	
+	ScStreamFilter* Writer::startStream(PdfId id, bool compress, bool encrypted)
+	{
+		assert( m_CurrentObj == id && m_streamEncoder == nullptr);
+		if (compress)
+			write("/Filter /FlateDecode\n");
+		write("/Length ");
+		m_streamLengthPos = bytesWritten();
+		// Room for the length, which is written over the spaces when it is known
+		write(QByteArray(lengthDigits, ' '));
+		write("\n>>\nstream\n");
+		m_streamDataPos = bytesWritten();
+		m_streamEncoder = openStreamFilter(encrypted, id);
+		if (compress)
+			m_streamCompressor = new ScFlateEncodeFilter(m_streamEncoder);
+		ScStreamFilter* filter = compress ? m_streamCompressor : m_streamEncoder;
+		m_streamOpen = filter->openFilter();
+		return filter;
+	}
+
+	bool Writer::endStream(PdfId id)
+	{
+		assert( m_CurrentObj == id && m_streamEncoder != nullptr);
+		ScStreamFilter* filter = m_streamCompressor ? m_streamCompressor : m_streamEncoder;
+		bool result = m_streamOpen && filter->closeFilter();
+		deleteStreamFilters();
+		qint64 length = bytesWritten() - m_streamDataPos;
+		write("\nendstream");
+		qint64 endPos = bytesWritten();
+		if (!m_Spool.seek(m_streamLengthPos))
+			return false;
+		write(QByteArray::number(length));
+		m_Spool.seek(endPos);
+		return result && (m_outStream.status() == QDataStream::Ok);
+	}
+
+	void Writer::deleteStreamFilters()
+	{
+		delete m_streamCompressor;
+		delete m_streamEncoder;
+		m_streamCompressor = nullptr;
+		m_streamEncoder = nullptr;
+		m_streamOpen = false;
+	}
+
 	bool Writer::close(bool abortExport)
 	{
+		deleteStreamFilters();
 		bool result = (m_Spool.error() == QFile::NoError);
 
 		m_Spool.close();
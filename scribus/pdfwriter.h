@@ -193,6 +193,18 @@ public:
 	void endObj(PdfId id);
 	void endObjectWithStream(bool encrypted, PdfId id, const QByteArray& streamContent);
 	ScStreamFilter* openStreamFilter(bool encrypted, PdfId objId);
+
+	/**
+	 * Ends the dictionary of object id and starts its stream. Adds /Filter
+	 * /FlateDecode if compress is true and a /Length which is filled in by
+	 * endStream(). Data written to the returned filter is deflated and
+	 * encrypted as requested and goes straight to the file, so that
+	 * streams need not be kept in memory. The filter is owned by the
+	 * writer and valid until endStream().
+	 */
+	ScStreamFilter* startStream(PdfId id, bool compress, bool encrypted);
+	/// Ends the stream started by startStream() and writes its length, returns false on errors
+	bool endStream(PdfId id);
 	
 	
 	// private:
@@ -214,6 +226,15 @@ public:
 private:
 	PdfId m_ObjCounter { 0 };
 	PdfId m_CurrentObj { 0 };
+
+	// Filters of the stream between startStream() and endStream()
+	ScStreamFilter* m_streamEncoder { nullptr };
+	ScStreamFilter* m_streamCompressor { nullptr };
+	bool m_streamOpen { false };
+	qint64 m_streamLengthPos { 0 };
+	qint64 m_streamDataPos { 0 };
+
+	void deleteStreamFilters();
 	
 	QFile m_Spool;
 	QDataStream m_outStream;
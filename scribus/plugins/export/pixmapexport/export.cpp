@@ -14,15 +14,19 @@ for which a new license (GPL+exception) is in place.
 #include <QString>
 #include <QSharedPointer>
 
+#include "imagebandwriter.h"
+#include "pagerenderer.h"
 #include "scribus.h"
 #include "scribusdoc.h"
-#include "scribusview.h"
 #include "scraction.h"
 #include "ui/scmwmenumanager.h"
 #include "util.h"
 #include "commonstrings.h"
 #include "scpaths.h"
 
+// Memory a band of a page may take while it is rendered, PNG and TIFF files are written band by band
+static const qint64 maxBandBytes = 32 * 1024 * 1024;
+
 int scribusexportpixmap_getPluginAPIVersion()
 {
 	return PLUGIN_API_VERSION;
@@ -193,16 +197,7 @@ bool ExportBitmap::exportPage(ScribusDoc* doc, uint pageNr, bool background, boo
 	PageToPixmapFlags flags;
 	if (background)
 		flags |= Pixmap_DrawBackground;
-	QImage im(doc->view()->PageToPixmap(pageNr, qRound(pixmapSize * enlargement * (pageDPI / 72.0) / 100.0), flags));
-	if (im.isNull())
-	{
-		ScMessageBox::warning(doc->scMW(), tr("Save as Image"), tr("Insufficient memory for this image size."));
-		doc->scMW()->setStatusBarInfoText( tr("Insufficient memory for this image size."));
-		return false;
-	}
 	int dpm = qRound(100.0 / 2.54 * pageDPI);
-	im.setDotsPerMeterY(dpm);
-	im.setDotsPerMeterX(dpm);
 	if (QFile::exists(fileName) && !overwrite)
 	{
 		doFileSave = false;
@@ -221,9 +216,54 @@ bool ExportBitmap::exportPage(ScribusDoc* doc, uint pageNr, bool background, boo
 		if (over == QMessageBox::YesToAll)
 			overwrite = true;
 	}
-	if (doFileSave)
-		saved = im.save(fileName, bitmapType.toLocal8Bit().constData(), quality);
-	if (!saved && doFileSave)
+	if (!doFileSave)
+		return false;
+
+	bool outOfMemory = false;
+	{
+		// The page is rendered without the view, so that the view keeps its state.
+		// The document gets its previous state back before any message is shown.
+		PageRenderer renderer(doc, pageNr, PageRenderer::scaleForSize(page, qRound(pixmapSize * enlargement * (pageDPI / 72.0) / 100.0)), flags);
+		outOfMemory = !renderer.isValid();
+		if (!outOfMemory && ImageBandWriter::canWrite(bitmapType))
+		{
+			// Huge pages are never held in memory at once, bands are encoded while the next one is rendered
+			ImageBandWriter writer;
+			int bandHeight = PageRenderer::bandHeight(renderer.size(), maxBandBytes);
+			saved = writer.open(fileName, bitmapType, renderer.size(), dpm, true, quality);
+			for (int top = 0; saved && (top < renderer.size().height()); top += bandHeight)
+			{
+				QImage band(renderer.renderBand(top, bandHeight));
+				if (band.isNull())
+				{
+					outOfMemory = true;
+					writer.abort();
+					break;
+				}
+				saved = writer.writeBand(band);
+			}
+			if (saved)
+				saved = writer.close();
+		}
+		else if (!outOfMemory)
+		{
+			QImage im(renderer.renderPage());
+			outOfMemory = im.isNull();
+			if (!outOfMemory)
+			{
+				im.setDotsPerMeterY(dpm);
+				im.setDotsPerMeterX(dpm);
+				saved = im.save(fileName, bitmapType.toLocal8Bit().constData(), quality);
+			}
+		}
+	}
+	if (outOfMemory)
+	{
+		ScMessageBox::warning(doc->scMW(), tr("Save as Image"), tr("Insufficient memory for this image size."));
+		doc->scMW()->setStatusBarInfoText( tr("Insufficient memory for this image size."));
+		return false;
+	}
+	if (!saved)
 	{
 		ScMessageBox::warning(doc->scMW(), tr("Save as Image"), tr("Error writing the output file(s)."));
 		doc->scMW()->setStatusBarInfoText( tr("Error writing the output file(s)."));
@@ -198,6 +198,7 @@ SVGExPlug::SVGExPlug( ScribusDoc* doc )
 
 bool SVGExPlug::doExport( const QString& fName, SVGOptions &Opts )
 {
+	m_Doc->finishPictLoading();
 	Options = Opts;
 	QFileInfo fiBase(fName);
 
@@ -37,6 +37,7 @@ for which a new license (GPL+exception) is in place.
 #include "pagesize.h"
 #include "prefsmanager.h"
 #include "qtiocompressor.h"
+#include "scblobstore.h"
 #include "scclocale.h"
 #include "scconfig.h"
 #include "sccolorengine.h"
@@ -45,6 +46,7 @@ for which a new license (GPL+exception) is in place.
 #include "scribusdoc.h"
 #include "sctextstream.h"
 #include "scxmlstreamreader.h"
+#include "slaindex.h"
 #include "textnote.h"
 #include "undomanager.h"
 #include "ui/missing.h"
@@ -220,6 +222,41 @@ QIODevice* Scribus150Format::slaReader(const QString & fileName)
 	return ioDevice;
 }
 
+QSharedPointer<const SlaIndex> Scribus150Format::slaIndex(const QString & fileName)
+{
+	QSharedPointer<const SlaIndex> index = SlaIndex::cached(fileName);
+	if (index)
+		return index;
+
+	QScopedPointer<QIODevice> ioDevice(slaReader(fileName));
+	if (ioDevice.isNull())
+		return index;
+	return SlaIndex::build(fileName, ioDevice.data());
+}
+
+QIODevice* Scribus150Format::slaSkeletonReader(const QString & fileName)
+{
+	QSharedPointer<const SlaIndex> index = slaIndex(fileName);
+	if (index)
+		return index->skeletonReader();
+	return slaReader(fileName);
+}
+
+QIODevice* Scribus150Format::slaPageReader(const QString & fileName, int pageNumber, bool Mpage)
+{
+	QSharedPointer<const SlaIndex> index = slaIndex(fileName);
+	if (index)
+	{
+		QScopedPointer<QIODevice> ioDevice(slaReader(fileName));
+		if (ioDevice.isNull())
+			return nullptr;
+		QIODevice* pageDevice = index->pageReader(ioDevice.data(), pageNumber, Mpage);
+		if (pageDevice)
+			return pageDevice;
+	}
+	return slaReader(fileName);
+}
+
 QIODevice* Scribus150Format::paletteReader(const QString & fileName)
 {
 	if (!paletteSupported(nullptr, fileName))
@@ -264,6 +301,7 @@ bool Scribus150Format::loadElements(const QString& data, const QString& fileDir,
 	Yp = Yp_in;
 	GrX = 0.0;
 	GrY = 0.0;
+	m_blobStore.reset();
 
 	QList<PageItem*> TableItems;
 	QList<PageItem*> TableItemsF;
@@ -1603,6 +1641,7 @@ bool Scribus150Format::loadFile(const QString & fileName, const FileFormat & /*
 		setFileReadError();
 		return false;
 	}
+	m_blobStore.reset();
 	QString fileDir = QFileInfo(fileName).absolutePath();
 	int firstPage = 0;
 	int layerToSetActive = 0;
@@ -1684,6 +1723,7 @@ bool Scribus150Format::loadFile(const QString & fileName, const FileFormat & /*
 		}
 		if (tagName == "DOCUMENT")
 		{
+			m_blobStore = ScBlobStore::open(ScBlobStore::storePath(fileName, attrs.valueAsString("BlobStore", "")));
 			readDocAttributes(m_Doc, attrs);
 			layerToSetActive = attrs.valueAsInt("ALAYER", 0);
 			if (m_Doc->pagePositioning() == 0)
@@ -4621,7 +4661,19 @@ bool Scribus150Format::readObject(ScribusDoc* doc, ScXmlStreamReader& reader, co
 	if (newItem->isImageFrame() || newItem->isLatexFrame())
 #endif
 	{
-		if (!newItem->Pfile.isEmpty())
+		bool deferred = false;
+		if (!newItem->Pfile.isEmpty() && (itemKind != PageItem::PatternItem) && !readObjectParams.loadingPage)
+		{
+			// The clip path and layers are applied once the image is loaded
+			deferred = doc->deferPict(newItem);
+			if (deferred)
+			{
+				newItem->pixm.imgInfo.usedPath = clipPath;
+				if (layerFound)
+					newItem->pixm.imgInfo.isRequest = true;
+			}
+		}
+		if (!newItem->Pfile.isEmpty() && !deferred)
 		{
 			double imageXOffset = newItem->imageXOffset();
 			double imageYOffset = newItem->imageYOffset();
@@ -5289,20 +5341,25 @@ PageItem* Scribus150Format::pasteItem(ScribusDoc *doc, ScXmlStreamAttributes& at
 			QByteArray inlineImageData;
 			inlineImageData.append(dat.toUtf8());
 			QString inlineImageExt = attrs.valueAsString("inlineImageExt", "");
+			// Images stored out of line are only read from the blob store once the frame loads its image
+			QByteArray blobHash = attrs.valueAsString("ImageBlob", "").toLatin1();
+			bool fromBlobStore = !blobHash.isEmpty() && m_blobStore && m_blobStore->contains(blobHash);
 			if (inlineF)
 			{
-				if (inlineImageData.size() > 0)
+				if (inlineImageData.size() > 0 || fromBlobStore)
 				{
 					QTemporaryFile *tempFile = new QTemporaryFile(QDir::tempPath() + "/scribus_temp_XXXXXX." + inlineImageExt);
 					tempFile->setAutoRemove(false);
 					tempFile->open();
 					QString fileName = getLongPathName(tempFile->fileName());
 					tempFile->close();
-					inlineImageData = qUncompress(QByteArray::fromBase64(inlineImageData));
 					QFile outFil(fileName);
 					if (outFil.open(QIODevice::WriteOnly))
 					{
-						outFil.write(inlineImageData);
+						if (fromBlobStore)
+							ScBlobStore::defer(fileName, m_blobStore, blobHash);
+						else
+							outFil.write(qUncompress(QByteArray::fromBase64(inlineImageData)));
 						outFil.close();
 						currItem->isInlineImage = true;
 						currItem->Pfile = QDir::fromNativeSeparators(fileName);
@@ -6493,12 +6550,13 @@ bool Scribus150Format::loadPage(const QString & fileName, int pageNumber, bool M
 	notesMasterMarks.clear();
 	notesNSets.clear();
 
-	QScopedPointer<QIODevice> ioDevice(slaReader(fileName));
+	QScopedPointer<QIODevice> ioDevice(slaPageReader(fileName, pageNumber, Mpage));
 	if (ioDevice.isNull())
 	{
 		setFileReadError();
 		return false;
 	}
+	m_blobStore.reset();
 
 	QString fileDir = QFileInfo(fileName).absolutePath();
 	
@@ -6532,6 +6590,8 @@ bool Scribus150Format::loadPage(const QString & fileName, int pageNumber, bool M
 			firstElement = false;
 		}
 
+		if (tagName == "DOCUMENT")
+			m_blobStore = ScBlobStore::open(ScBlobStore::storePath(fileName, attrs.valueAsString("BlobStore", "")));
 		if (tagName == "COLOR" && attrs.valueAsString("NAME") != CommonStrings::None)
 		{
 			QString colorName = attrs.valueAsString("NAME");
@@ -7229,7 +7289,7 @@ bool Scribus150Format::readStyles(const QString& fileName, ScribusDoc* doc, Styl
 	bool firstElement = true;
 	bool success = true;
 
-	QScopedPointer<QIODevice> ioDevice(slaReader(fileName));
+	QScopedPointer<QIODevice> ioDevice(slaSkeletonReader(fileName));
 	if (ioDevice.isNull())
 		return false;
 
@@ -7269,7 +7329,7 @@ bool Scribus150Format::readCharStyles(const QString& fileName, ScribusDoc* doc,
 	bool firstElement = true;
 	//bool success = true;
 
-	QScopedPointer<QIODevice> ioDevice(slaReader(fileName));
+	QScopedPointer<QIODevice> ioDevice(slaSkeletonReader(fileName));
 	if (ioDevice.isNull())
 		return false;
 
@@ -7310,7 +7370,7 @@ bool Scribus150Format::readLineStyles(const QString& fileName, QHash<QString,mul
 	bool firstElement = true;
 	bool success = true;
 
-	QScopedPointer<QIODevice> ioDevice(slaReader(fileName));
+	QScopedPointer<QIODevice> ioDevice(slaSkeletonReader(fileName));
 	if (ioDevice.isNull())
 		return false;
 
@@ -7360,7 +7420,7 @@ bool Scribus150Format::readColors(const QString& fileName, ColorList & colors)
 	bool firstElement = true;
 	bool success = true;
 
-	QScopedPointer<QIODevice> ioDevice(slaReader(fileName));
+	QScopedPointer<QIODevice> ioDevice(slaSkeletonReader(fileName));
 	if (ioDevice.isNull())
 		return false;
 
@@ -7407,6 +7467,15 @@ bool Scribus150Format::readPageCount(const QString& fileName, int *num1, int *nu
 	notesMasterMarks.clear();
 	notesNSets.clear();
 
+	QSharedPointer<const SlaIndex> index = slaIndex(fileName);
+	if (index)
+	{
+		*num1 = index->pageCount();
+		*num2 = index->masterPageNames().count();
+		masterPageNames.append(index->masterPageNames());
+		return true;
+	}
+
 	QScopedPointer<QIODevice> ioDevice(slaReader(fileName));
 	if (ioDevice.isNull())
 		return false;
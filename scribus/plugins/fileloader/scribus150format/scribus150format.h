@@ -18,14 +18,18 @@ for which a new license (GPL+exception) is in place.
 #include <QList>
 #include <QMap>
 #include <QProgressBar>
+#include <QSharedPointer>
 #include <QString>
 
 class QIODevice;
 
 class  ColorList;
+class  ScBlobStore;
+class  ScBlobStoreWriter;
 class  multiLine;
 class  PageItem_NoteFrame;
 class  ScLayer;
+class  SlaIndex;
 class  ScribusDoc;
 //struct ScribusDoc::BookMa;
 class  ScXmlStreamAttributes;
@@ -116,6 +120,12 @@ class PLUGIN_API Scribus150Format : public LoadSavePlugin
 		void registerFormats();
 		
 		QIODevice* slaReader(const QString & fileName);
+		/// Returns the cached index of fileName, building it if needed
+		QSharedPointer<const SlaIndex> slaIndex(const QString & fileName);
+		/// Returns a reader over the document without page objects, for style and color queries
+		QIODevice* slaSkeletonReader(const QString & fileName);
+		/// Returns a reader over the document with only the objects of one page
+		QIODevice* slaPageReader(const QString & fileName, int pageNumber, bool Mpage);
 		QIODevice* paletteReader(const QString & fileName);
 
 		void getStyle(ParagraphStyle& style, ScXmlStreamReader& reader, StyleSet<ParagraphStyle> *docParagraphStyles, ScribusDoc* doc, bool equiv);
@@ -239,6 +249,8 @@ class PLUGIN_API Scribus150Format : public LoadSavePlugin
 
 		QFile aFile;
 		QString clipPath;
+		QSharedPointer<ScBlobStore> m_blobStore;
+		ScBlobStoreWriter* m_blobWriter {nullptr};
 		bool isNewFormat {false};
 		bool layerFound {false};
 		double GrX {0.0};
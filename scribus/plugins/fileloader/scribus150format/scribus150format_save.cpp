@@ -34,6 +34,7 @@ for which a new license (GPL+exception) is in place.
 #include "prefsmanager.h"
 #include "qtiocompressor.h"
 #include "resourcecollection.h"
+#include "scblobstore.h"
 #include "scconfig.h"
 #include "scpaths.h"
 #include "scpattern.h"
@@ -291,13 +292,14 @@ bool Scribus150Format::saveFile(const QString & fileName, const FileFormat & /*
 	long randt = 0;
 	long randn = 1 + (int) (((double) rand() / ((double) RAND_MAX + 1)) * 10000);
 	QString  tmpFileName  = QString("%1.%2").arg(fileName).arg(randn);
-	while (QFile::exists(tmpFileName) && (randt < 100))
+	// The new blob store is named after the temporary file, it must not replace the one in use
+	while ((QFile::exists(tmpFileName) || QFile::exists(ScBlobStore::storePath(tmpFileName))) && (randt < 100))
 	{
 		randn = 1 + (int) (((double) rand() / ((double) RAND_MAX + 1)) * 10000);
 		tmpFileName = QString("%1.%2").arg(fileName).arg(randn);
 		++randt;
 	}
-	if (QFile::exists(tmpFileName))
+	if (QFile::exists(tmpFileName) || QFile::exists(ScBlobStore::storePath(tmpFileName)))
 		return false;
 
 	QScopedPointer<QIODevice> outputFile;
@@ -314,6 +316,21 @@ bool Scribus150Format::saveFile(const QString & fileName, const FileFormat & /*
 	if (!outputFile->open(QIODevice::WriteOnly))
 		return false;
 
+	// Inline images may go to a blob store next to the document instead of base64 attributes.
+	// The store keeps the name it is written under, the document refers to it by that name.
+	QString blobFileName = ScBlobStore::storePath(tmpFileName);
+	ScBlobStoreWriter blobWriter;
+	if (PrefsManager::instance().appPrefs.docSetupPrefs.saveImagesSeparately)
+	{
+		if (!blobWriter.open(blobFileName))
+		{
+			outputFile->close();
+			QFile::remove(tmpFileName);
+			return false;
+		}
+		m_blobWriter = &blobWriter;
+	}
+
 	ScXmlStreamWriter docu;
 	docu.setAutoFormatting(true);
 	docu.setDevice(outputFile.data());
@@ -322,6 +339,8 @@ bool Scribus150Format::saveFile(const QString & fileName, const FileFormat & /*
 	docu.writeAttribute("Version", ScribusAPI::getVersion());
 
 	docu.writeStartElement("DOCUMENT");
+	if (m_blobWriter)
+		docu.writeAttribute("BlobStore", QFileInfo(blobFileName).fileName());
 	docu.writeAttribute("ANZPAGES"    , m_Doc->DocPages.count());
 	docu.writeAttribute("PAGEWIDTH"   , m_Doc->pageWidth());
 	docu.writeAttribute("PAGEHEIGHT"  , m_Doc->pageHeight());
@@ -556,6 +575,15 @@ bool Scribus150Format::saveFile(const QString & fileName, const FileFormat & /*
 		writeSucceed = true;
 	outputFile->close();
 
+	bool useBlobStore = (m_blobWriter != nullptr) && (m_blobWriter->count() > 0);
+	if (m_blobWriter)
+	{
+		writeSucceed &= m_blobWriter->close();
+		m_blobWriter = nullptr;
+	}
+	if ((!writeSucceed || !useBlobStore) && QFile::exists(blobFileName))
+		QFile::remove(blobFileName);
+
 	if (writeSucceed)
 	{
 		if (QFile::exists(fileName))
@@ -567,7 +595,19 @@ bool Scribus150Format::saveFile(const QString & fileName, const FileFormat & /*
 	else if (QFile::exists(tmpFileName))
 		QFile::remove(tmpFileName);
 	if (writeSucceed)
+	{
 		QFile::remove(tmpFileName);
+		// The document has switched to the new store, the old stores can go now.
+		// Images not loaded yet may still have to be read from them first.
+		const QStringList oldBlobFileNames = ScBlobStore::storesOf(fileName);
+		for (const QString& oldBlobFileName : oldBlobFileNames)
+		{
+			if (QFileInfo(oldBlobFileName) == QFileInfo(blobFileName))
+				continue;
+			ScBlobStore::materializeAll(oldBlobFileName);
+			QFile::remove(oldBlobFileName);
+		}
+	}
 #ifdef Q_OS_UNIX
 	if (writeSucceed)
 		QFile::setPermissions(fileName, m_Doc->filePermissions());
@@ -2829,11 +2869,17 @@ void Scribus150Format::SetItemProps(ScXmlStreamWriter& docu, PageItem* item, con
 			docu.writeAttribute("isInlineImage", static_cast<int>(item->isInlineImage));
 			QFileInfo inlFi(item->Pfile);
 			docu.writeAttribute("inlineImageExt", inlFi.suffix());
+			ScBlobStore::materialize(item->Pfile);
 			QFile inFil(item->Pfile);
 			if (inFil.open(QIODevice::ReadOnly))
 			{
-				QByteArray ba = qCompress(inFil.readAll()).toBase64();
-				docu.writeAttribute("ImageData", QString(ba));
+				if (m_blobWriter)
+					docu.writeAttribute("ImageBlob", QString::fromLatin1(m_blobWriter->add(inFil.readAll())));
+				else
+				{
+					QByteArray ba = qCompress(inFil.readAll()).toBase64();
+					docu.writeAttribute("ImageData", QString(ba));
+				}
 				inFil.close();
 			}
 		}
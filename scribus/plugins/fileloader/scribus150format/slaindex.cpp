@@ -0,0 +1,278 @@
+/*
+For general Scribus (>=1.3.2) copyright and licensing information please refer
+to the COPYING file provided with the program. Following this notice may exist
+a copyright and/or license notice that predates the release of Scribus 1.3.2
+for which a new license (GPL+exception) is in place.
+*/
+
+#include "slaindex.h"
+
+#include <QBuffer>
+#include <QFileInfo>
+#include <QList>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QXmlStreamReader>
+
+namespace
+{
+	const int maxCachedIndexes = 4;
+
+	QMutex cacheMutex;
+	QList< QSharedPointer<const SlaIndex> > indexCache;
+
+	// Passes the data of a device on to QXmlStreamReader and holds on to the bytes
+	// read since the last discardBefore(), so that they can be copied to the skeleton
+	// without keeping the whole file in memory. Positions are byte offsets from the
+	// start of the data read.
+	class RecordingDevice : public QIODevice
+	{
+	public:
+		explicit RecordingDevice(QIODevice* source) : m_source(source) { open(QIODevice::ReadOnly | QIODevice::Unbuffered); }
+
+		bool isSequential() const override { return true; }
+		bool atEnd() const override { return m_source->atEnd(); }
+		qint64 bytesAvailable() const override { return m_source->bytesAvailable(); }
+
+		qint64 windowStart() const { return m_windowStart; }
+		qint64 windowEnd() const { return m_windowStart + m_window.size(); }
+		char at(qint64 pos) const { return m_window.at(static_cast<int>(pos - m_windowStart)); }
+		QByteArray mid(qint64 pos, qint64 length) const { return m_window.mid(static_cast<int>(pos - m_windowStart), static_cast<int>(length)); }
+
+		/// Position of the last c at or before pos, -1 if there is none in the held data
+		qint64 lastIndexOf(char c, qint64 pos) const
+		{
+			if (pos < m_windowStart)
+				return -1;
+			int index = m_window.lastIndexOf(c, static_cast<int>(pos - m_windowStart));
+			return (index < 0) ? -1 : m_windowStart + index;
+		}
+
+		void discardBefore(qint64 pos)
+		{
+			int count = static_cast<int>(qMin(pos, windowEnd()) - m_windowStart);
+			if (count <= 0)
+				return;
+			m_window.remove(0, count);
+			m_windowStart += count;
+		}
+
+	protected:
+		qint64 readData(char* data, qint64 maxSize) override
+		{
+			qint64 read = m_source->read(data, maxSize);
+			if (read > 0)
+				m_window.append(data, static_cast<int>(read));
+			return read;
+		}
+		qint64 writeData(const char* /*data*/, qint64 /*maxSize*/) override { return -1; }
+
+	private:
+		QIODevice* m_source;
+		QByteArray m_window;
+		qint64 m_windowStart { 0 };
+	};
+
+	// Converts the increasing character offsets reported by QXmlStreamReader
+	// into byte offsets in the UTF-8 data the reader was fed
+	class Utf8Offsets
+	{
+	public:
+		explicit Utf8Offsets(const RecordingDevice& data) : m_data(data) {}
+
+		qint64 bytePos(qint64 charPos)
+		{
+			const qint64 end = m_data.windowEnd();
+			while (m_charPos < charPos && m_bytePos < end)
+			{
+				uchar c = static_cast<uchar>(m_data.at(m_bytePos));
+				int len = (c < 0x80) ? 1 : ((c < 0xE0) ? 2 : ((c < 0xF0) ? 3 : 4));
+				m_bytePos += len;
+				m_charPos += (len == 4) ? 2 : 1; // 4 byte sequences are UTF-16 surrogate pairs
+			}
+			return qMin(m_bytePos, end);
+		}
+
+	private:
+		const RecordingDevice& m_data;
+		qint64 m_bytePos { 0 };
+		qint64 m_charPos { 0 };
+	};
+
+	bool skipBytes(QIODevice* source, qint64 count)
+	{
+		if (!source->isSequential())
+			return source->seek(source->pos() + count);
+		char buffer[65536];
+		while (count > 0)
+		{
+			qint64 read = source->read(buffer, qMin<qint64>(count, sizeof(buffer)));
+			if (read <= 0)
+				return false;
+			count -= read;
+		}
+		return true;
+	}
+}
+
+QSharedPointer<const SlaIndex> SlaIndex::cached(const QString& fileName)
+{
+	QFileInfo fi(fileName);
+	QString filePath = fi.absoluteFilePath();
+
+	QMutexLocker locker(&cacheMutex);
+	for (int i = 0; i < indexCache.count(); ++i)
+	{
+		QSharedPointer<const SlaIndex> index = indexCache.at(i);
+		if (index->m_fileName != filePath)
+			continue;
+		if (index->m_size == fi.size() && index->m_modified == fi.lastModified())
+			return index;
+		indexCache.removeAt(i);
+		break;
+	}
+	return QSharedPointer<const SlaIndex>();
+}
+
+QSharedPointer<const SlaIndex> SlaIndex::build(const QString& fileName, QIODevice* source)
+{
+	QFileInfo fi(fileName);
+	QSharedPointer<SlaIndex> index(new SlaIndex());
+	index->m_fileName = fi.absoluteFilePath();
+	index->m_size = fi.size();
+	index->m_modified = fi.lastModified();
+
+	int bomLength = (source->peek(3) == "\xEF\xBB\xBF") ? 3 : 0;
+	if ((bomLength > 0) && (source->read(bomLength).size() != bomLength))
+		return QSharedPointer<const SlaIndex>();
+	if (!index->parse(source, bomLength))
+		return QSharedPointer<const SlaIndex>();
+
+	QMutexLocker locker(&cacheMutex);
+	for (int i = 0; i < indexCache.count(); ++i)
+	{
+		if (indexCache.at(i)->m_fileName == index->m_fileName)
+		{
+			indexCache.removeAt(i);
+			break;
+		}
+	}
+	indexCache.prepend(index);
+	while (indexCache.count() > maxCachedIndexes)
+		indexCache.removeLast();
+	return index;
+}
+
+bool SlaIndex::parse(QIODevice* source, int bomLength)
+{
+	RecordingDevice data(source);
+	QXmlStreamReader reader(&data);
+	Utf8Offsets offsets(data);
+	qint64 copiedUpTo = 0;
+	bool firstElement = true;
+
+	while (!reader.atEnd())
+	{
+		QXmlStreamReader::TokenType tType = reader.readNext();
+		if (tType == QXmlStreamReader::StartDocument)
+		{
+			// Byte offsets are only computed for UTF-8
+			QStringRef encoding = reader.documentEncoding();
+			if (!encoding.isEmpty() && encoding.compare(QLatin1String("UTF-8"), Qt::CaseInsensitive) != 0)
+				return false;
+			continue;
+		}
+		if (tType != QXmlStreamReader::StartElement)
+			continue;
+		QStringRef tagName = reader.name();
+		if (firstElement)
+		{
+			if (tagName != QLatin1String("SCRIBUSUTF8NEW"))
+				return false;
+			firstElement = false;
+			continue;
+		}
+		if (tagName == QLatin1String("PAGE"))
+			++m_pageCount;
+		else if (tagName == QLatin1String("MASTERPAGE"))
+		{
+			QString pageName = reader.attributes().value(QLatin1String("NAM")).toString();
+			if (!pageName.isEmpty())
+				m_masterPageNames.append(pageName);
+		}
+		else if (tagName == QLatin1String("PAGEOBJECT") || tagName == QLatin1String("MASTEROBJECT"))
+		{
+			Object object;
+			object.master = (tagName == QLatin1String("MASTEROBJECT"));
+			bool ok = false;
+			int ownPage = reader.attributes().value(QLatin1String("OwnPage")).toInt(&ok);
+			object.ownPage = ok ? ownPage : 0;
+
+			qint64 start = data.lastIndexOf('<', offsets.bytePos(reader.characterOffset()) - 1);
+			reader.skipCurrentElement();
+			if (reader.hasError())
+				return false;
+			qint64 end = offsets.bytePos(reader.characterOffset());
+			// Do not trust offsets which do not land on the element boundaries
+			QByteArray openTag = object.master ? "<MASTEROBJECT" : "<PAGEOBJECT";
+			if (start < copiedUpTo || end <= start || data.at(end - 1) != '>' || data.mid(start, openTag.size()) != openTag)
+				return false;
+
+			m_skeleton.append(data.mid(copiedUpTo, start - copiedUpTo));
+			QByteArray placeholder = openTag + " OwnPage=\"" + QByteArray::number(object.ownPage) + "\"/>";
+			object.sourcePos = bomLength + start;
+			object.sourceLength = static_cast<int>(end - start);
+			object.skeletonPos = m_skeleton.size();
+			object.placeholderLength = placeholder.size();
+			m_skeleton.append(placeholder);
+			m_objects.append(object);
+			copiedUpTo = end;
+			// the object itself is read back from the file when needed
+			data.discardBefore(copiedUpTo);
+		}
+	}
+	if (reader.hasError() || firstElement)
+		return false;
+	m_skeleton.append(data.mid(copiedUpTo, data.windowEnd() - copiedUpTo));
+	m_skeleton.squeeze();
+	return true;
+}
+
+QIODevice* SlaIndex::skeletonReader() const
+{
+	QBuffer* buffer = new QBuffer();
+	buffer->setData(m_skeleton);
+	buffer->open(QIODevice::ReadOnly);
+	return buffer;
+}
+
+QIODevice* SlaIndex::pageReader(QIODevice* source, int pageNumber, bool masterPage) const
+{
+	QByteArray pageData;
+	pageData.reserve(m_skeleton.size());
+	int skeletonPos = 0;
+	qint64 sourcePos = 0;
+	for (const Object& object : m_objects)
+	{
+		pageData.append(m_skeleton.constData() + skeletonPos, object.skeletonPos - skeletonPos);
+		if (object.master == masterPage && object.ownPage == pageNumber)
+		{
+			if (!skipBytes(source, object.sourcePos - sourcePos))
+				return nullptr;
+			QByteArray objectData = source->read(object.sourceLength);
+			if (objectData.size() != object.sourceLength)
+				return nullptr;
+			pageData.append(objectData);
+			sourcePos = object.sourcePos + object.sourceLength;
+		}
+		else
+			pageData.append(m_skeleton.constData() + object.skeletonPos, object.placeholderLength);
+		skeletonPos = object.skeletonPos + object.placeholderLength;
+	}
+	pageData.append(m_skeleton.constData() + skeletonPos, m_skeleton.size() - skeletonPos);
+
+	QBuffer* buffer = new QBuffer();
+	buffer->setData(pageData);
+	buffer->open(QIODevice::ReadOnly);
+	return buffer;
+}
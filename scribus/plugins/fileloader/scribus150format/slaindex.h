@@ -0,0 +1,73 @@
+/*
+For general Scribus (>=1.3.2) copyright and licensing information please refer
+to the COPYING file provided with the program. Following this notice may exist
+a copyright and/or license notice that predates the release of Scribus 1.3.2
+for which a new license (GPL+exception) is in place.
+*/
+#ifndef SLAINDEX_H
+#define SLAINDEX_H
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+#include <QVector>
+
+class QIODevice;
+
+/**
+ * Index of a .sla file built in a single pass, so that the page import
+ * dialogs do not have to parse the whole document again for each query.
+ *
+ * The index keeps a "skeleton" of the document: the original XML with every
+ * PAGEOBJECT and MASTEROBJECT element replaced by an empty element carrying
+ * only its OwnPage attribute. Styles, colors, line styles and page counts
+ * are read from the skeleton, while the objects of a single page are read
+ * back from the file at their recorded byte offsets.
+ *
+ * The file is read once as a stream, only the skeleton and the object
+ * being skipped are held in memory. Indexes are cached per file and
+ * dropped when the file size or modification time changes.
+ */
+class SlaIndex
+{
+public:
+	/// Returns the cached index of fileName if it is still up to date
+	static QSharedPointer<const SlaIndex> cached(const QString& fileName);
+	/// Builds the index of fileName from an open device at its start, caches
+	/// and returns it. Returns a null pointer if the document cannot be indexed.
+	static QSharedPointer<const SlaIndex> build(const QString& fileName, QIODevice* source);
+
+	int pageCount() const { return m_pageCount; }
+	const QStringList& masterPageNames() const { return m_masterPageNames; }
+
+	/// Returns a readable device over the skeleton, owned by the caller
+	QIODevice* skeletonReader() const;
+	/// Returns a readable device over the skeleton with the objects of the given
+	/// page put back, reading them from source, or nullptr on read errors
+	QIODevice* pageReader(QIODevice* source, int pageNumber, bool masterPage) const;
+
+private:
+	struct Object
+	{
+		bool master { false };
+		int  ownPage { 0 };
+		qint64 sourcePos { 0 };
+		int  sourceLength { 0 };
+		int  skeletonPos { 0 };
+		int  placeholderLength { 0 };
+	};
+
+	QString    m_fileName;
+	QDateTime  m_modified;
+	qint64     m_size { 0 };
+	QByteArray m_skeleton;
+	QVector<Object> m_objects;
+	int m_pageCount { 0 };
+	QStringList m_masterPageNames;
+
+	bool parse(QIODevice* source, int bomLength);
+};
+
+#endif
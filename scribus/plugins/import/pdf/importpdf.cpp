@@ -17,7 +17,9 @@ for which a new license (GPL+exception) is in place.
 #include <QList>
 #include <QMimeData>
 #include <QRegExp>
+#include <QSet>
 #include <QStack>
+#include <QThread>
 
 #include <poppler/ErrorCodes.h>
 #include <poppler/GlobalParams.h>
@@ -58,6 +60,7 @@ for which a new license (GPL+exception) is in place.
 #include "util.h"
 #include "util_formats.h"
 #include "util_math.h"
+#include "util_parallel.h"
 
 #include "ui/customfdialog.h"
 #include "ui/missing.h"
@@ -343,6 +346,7 @@ bool PdfPlug::convert(const QString& fn)
 	globalParams->setErrQuiet(gTrue);
 //	globalParams->setPrintCommands(gTrue);
 	QList<OptionalContentGroup*> ocgGroups;
+	QString password;
 	auto pdfDoc = std::unique_ptr<PDFDoc>(new PDFDoc(fname, nullptr, nullptr, nullptr));
 	if (pdfDoc)
 	{
@@ -364,6 +368,7 @@ bool PdfPlug::convert(const QString& fn)
 #endif
 				auto userPW = new GooString(text.toLocal8Bit().data());
 				pdfDoc.reset(new PDFDoc(fname, userPW, userPW, nullptr));
+				password = text;
 				qApp->changeOverrideCursor(QCursor(Qt::WaitCursor));
 			}
 			if ((!pdfDoc) || (pdfDoc->getErrorCode() != errNone))
@@ -448,11 +453,14 @@ bool PdfPlug::convert(const QString& fn)
 			}
 
 			firstPage = pageNs[0];
+			// declared before dev, the device refers to it until it is deleted
+			SlaImageFileCache imageFiles;
 			std::unique_ptr<SlaOutputDev> dev;
 			if (importTextAsVectors)
 				dev.reset(new SlaOutputDev(m_Doc, &m_elements, &m_importedColors, m_importerFlags));
 			else
 				dev.reset(new PdfTextOutputDev(m_Doc, &m_elements, &m_importedColors, m_importerFlags));
+			dev->setImageFileCache(&imageFiles);
 
 			if (dev->isOk())
 			{
@@ -629,8 +637,13 @@ bool PdfPlug::convert(const QString& fn)
 						}
 					}
 					m_Doc->setPageSize("Custom");
+					// Decoding images is most of the work for scanned and image heavy files.
+					// Do it for these pages at once, the loop below then finds the images
+					// in imageFiles and only creates the items, in page order.
+					if ((pageNs.size() > 1) && (parallelThreadCount() > 1))
+						prefetchImages(fn, password, pageNs, &imageFiles);
 				//	m_Doc->pdfOptions().PresentVals.clear();
-					for (size_t i = 0; i < pageNs.size(); ++i)
+					for (size_t i = 0; (i < pageNs.size()) && !m_cancel; ++i)
 					{
 						if (m_progressDialog)
 						{
@@ -931,6 +944,153 @@ QImage PdfPlug::readPreview(int pgNum, int width, int height, int box)
 	return image;
 }
 
+// What prefetching the images of a page saves and what it costs: the image XObjects
+// it decodes on a worker, and the content streams and forms it interprets once more
+struct PrefetchEstimate
+{
+	qint64 imagePixels { 0 };
+	qint64 contentBytes { 0 };
+};
+
+// A compressed content byte stands for several operators, so it is weighted against
+// this many pixels of decoding. This is a rough weight, it only has to keep text and
+// vector pages with a few small images from being interpreted twice.
+static const qint64 pixelsPerContentByte = 16;
+
+static qint64 streamLength(Object& stream)
+{
+	Object length = stream.streamGetDict()->lookup((char*) "Length");
+	return length.isNum() ? static_cast<qint64>(length.getNum()) : 0;
+}
+
+static qint64 contentLength(Page* page)
+{
+	Object contents = page->getContents();
+	if (contents.isStream())
+		return streamLength(contents);
+	qint64 length = 0;
+	if (contents.isArray())
+	{
+		for (int i = 0; i < contents.arrayGetLength(); ++i)
+		{
+			Object part = contents.arrayGet(i);
+			if (part.isStream())
+				length += streamLength(part);
+		}
+	}
+	return length;
+}
+
+// Adds the images, forms and patterns of resources to estimate. Images seen on earlier
+// pages are decoded once only and are not counted again.
+static void estimateResources(Dict* resources, int depth, QSet<int>& seenImages, PrefetchEstimate& estimate)
+{
+	if ((resources == nullptr) || (depth > 8))
+		return;
+	const char* categories[] = { "XObject", "Pattern" };
+	for (const char* category : categories)
+	{
+		Object objects = resources->lookup((char*) category);
+		if (!objects.isDict())
+			continue;
+		Dict* objectDict = objects.getDict();
+		for (int i = 0; i < objectDict->getLength(); ++i)
+		{
+			Object obj = objectDict->getVal(i);
+			if (!obj.isStream())
+				continue;
+			Dict* streamDict = obj.streamGetDict();
+			Object subtype = streamDict->lookup((char*) "Subtype");
+			if (subtype.isName("Image"))
+			{
+				// The import only keeps decoded images it can find again by their reference
+				POPPLER_CONST_075 Object POPPLER_REF ref = objectDict->getValNF(i);
+				if (!ref.isRef() || seenImages.contains(ref.getRef().num))
+					continue;
+				seenImages.insert(ref.getRef().num);
+				Object width = streamDict->lookup((char*) "Width");
+				Object height = streamDict->lookup((char*) "Height");
+				if (width.isNum() && height.isNum())
+					estimate.imagePixels += static_cast<qint64>(width.getNum()) * static_cast<qint64>(height.getNum());
+				continue;
+			}
+			estimate.contentBytes += streamLength(obj);
+			Object streamResources = streamDict->lookup((char*) "Resources");
+			if (streamResources.isDict())
+				estimateResources(streamResources.getDict(), depth + 1, seenImages, estimate);
+		}
+	}
+}
+
+void PdfPlug::prefetchImages(const QString& fn, const QString& password, const std::vector<int>& pages, SlaImageFileCache* imageFiles)
+{
+	// A prefetched page is interpreted twice, once here for its images and once by the import.
+	// That only pays off where decoding the images is the bigger part of the work, as on scans.
+	// Other pages, and pages with inline images only, are left to the import itself.
+	std::vector<int> imagePages;
+	QSet<int> seenImages;
+	for (int pageNr : pages)
+	{
+		Page* page = m_pdfDoc->getPage(pageNr);
+		if (page == nullptr)
+			continue;
+		PrefetchEstimate estimate;
+		estimate.contentBytes = contentLength(page);
+		estimateResources(page->getResourceDict(), 0, seenImages, estimate);
+		if (estimate.imagePixels > pixelsPerContentByte * estimate.contentBytes)
+			imagePages.push_back(pageNr);
+	}
+	if (imagePages.size() < 2)
+		return;
+
+	const int pageCount = static_cast<int>(imagePages.size());
+	int threadCount = qMin(parallelThreadCount(), pageCount);
+	if (m_progressDialog)
+	{
+		m_progressDialog->setLabel("GI", tr("Decoding Images"));
+		m_progressDialog->setProgress("GI", 0, pageCount);
+		qApp->processEvents();
+	}
+	// Pages are handed out one by one, so that the calling thread, which takes part,
+	// keeps the progress and the Cancel button going until the end
+	std::atomic<int> nextPage(0);
+	std::atomic<int> pagesDone(0);
+	// annotations are drawn by the importer itself, their images are not prefetched
+	auto skipAnnotations = [](Annot*, void*) -> GBool { return gFalse; };
+	parallelFor(threadCount, [&](int)
+	{
+		// Poppler documents must not be shared between threads
+#if defined(Q_OS_WIN32) && POPPLER_ENCODED_VERSION >= POPPLER_VERSION_ENCODE(0, 62, 0)
+		auto fname = new GooString(fn.toUtf8().data());
+#else
+		auto fname = new GooString(QFile::encodeName(fn).data());
+#endif
+		GooString* userPW = password.isEmpty() ? nullptr : new GooString(password.toLocal8Bit().data());
+		std::unique_ptr<PDFDoc> pdfDoc(new PDFDoc(fname, userPW, userPW, nullptr));
+		if (!pdfDoc->isOk())
+			return;
+		SlaImagePrefetchDev dev(imageFiles);
+		const bool guiThread = (QThread::currentThread() == thread());
+		for (int i = nextPage++; (i < pageCount) && !m_cancel; i = nextPage++)
+		{
+			pdfDoc->displayPage(&dev, imagePages[i], 72.0, 72.0, 0, gTrue, gFalse, gFalse, nullptr, nullptr, skipAnnotations, nullptr);
+			int done = ++pagesDone;
+			if (guiThread && m_progressDialog)
+			{
+				m_progressDialog->setProgress("GI", done);
+				qApp->processEvents();
+			}
+		}
+	}, threadCount);
+
+	if (m_progressDialog)
+	{
+		m_progressDialog->setLabel("GI", tr("Generating Items"));
+		m_progressDialog->setProgress("GI", 0, static_cast<int>(pages.size()));
+		qApp->processEvents();
+	}
+}
+
 QRectF PdfPlug::getCBox(int box, int pgNum)
 {
 	const PDFRectangle *cBox = nullptr;
@@ -20,7 +20,9 @@ for which a new license (GPL+exception) is in place.
 #include <QString>
 #include <QTextStream>
 
+#include <atomic>
 #include <memory>
+#include <vector>
 
 #include "fpointarray.h"
 #include "importpdfconfig.h"
@@ -37,6 +39,7 @@ class TransactionSettings;
 
 class GooString;
 class PDFDoc;
+class SlaImageFileCache;
 
 //! \brief PDF importer plugin
 class PdfPlug : public QObject
@@ -81,6 +84,8 @@ public:
 private:
 	bool convert(const QString& fn);
 	QRectF getCBox(int box, int pgNum);
+	// Decode the images of image heavy pages on worker threads, each with its own copy of the document
+	void prefetchImages(const QString& fn, const QString& password, const std::vector<int>& pages, SlaImageFileCache* imageFiles);
 	QString UnicodeParsedString(POPPLER_CONST GooString *s1);
 	QString UnicodeParsedString(const std::string& s1);
 	
@@ -88,7 +93,7 @@ private:
 
 	QStringList m_importedColors;
 	
-	bool m_cancel {false};
+	std::atomic<bool> m_cancel {false};
 	bool m_interactive;
 	bool m_noDialogs;
 	MultiProgressDialog *m_progressDialog {nullptr};
@@ -12,11 +12,15 @@ for which a new license (GPL+exception) is in place.
 #include <poppler/FileSpec.h>
 #include <poppler/fofi/FoFiTrueType.h>
 #include <QApplication>
+#include <QCryptographicHash>
 #include <QFile>
+#include <QMutexLocker>
+#include <QTemporaryFile>
 #include "commonstrings.h"
 #include "loadsaveplugin.h"
 #include "sccolorengine.h"
 #include "util.h"
+#include "util_file.h"
 #include "util_math.h"
 #include <tiffio.h>
 
@@ -275,6 +279,129 @@ QString AnoOutputDev::getColor(GfxColorSpace *color_space, POPPLER_CONST_070 Gfx
 	return fNam;
 }
 
+SlaImageFileCache::~SlaImageFileCache()
+{
+	for (const QString& fileName : qAsConst(m_filesByHash))
+		releaseTempFile(fileName);
+}
+
+QString SlaImageFileCache::file(const QString& refKey) const
+{
+	if (refKey.isEmpty())
+		return QString();
+	QMutexLocker locker(&m_mutex);
+	return m_filesByRef.value(refKey);
+}
+
+QString SlaImageFileCache::file(QImage& image, int numColorComponents, const QString& refKey)
+{
+	// many pages often show the same logo or background from different XObjects
+	QCryptographicHash hasher(QCryptographicHash::Sha1);
+	hasher.addData(QByteArray::number(image.width()) + ' ' + QByteArray::number(image.height()) + ' ' + QByteArray::number(static_cast<int>(image.format())) + ' ' + QByteArray::number(numColorComponents));
+	hasher.addData(reinterpret_cast<const char*>(image.constBits()), static_cast<int>(image.sizeInBytes()));
+	QByteArray hash = hasher.result();
+
+	m_mutex.lock();
+	QString fileName = m_filesByHash.value(hash);
+	m_mutex.unlock();
+	if (fileName.isEmpty())
+	{
+		// encode without holding the lock, other threads may be writing images too
+		QString newFileName = writeImage(image, numColorComponents);
+		if (newFileName.isEmpty())
+			return QString();
+		QMutexLocker locker(&m_mutex);
+		fileName = m_filesByHash.value(hash);
+		if (fileName.isEmpty())
+		{
+			fileName = newFileName;
+			m_filesByHash.insert(hash, fileName);
+		}
+		else
+			QFile::remove(newFileName);
+	}
+	if (!refKey.isEmpty())
+	{
+		QMutexLocker locker(&m_mutex);
+		m_filesByRef.insert(refKey, fileName);
+	}
+	return fileName;
+}
+
+QString SlaImageFileCache::writeImage(QImage& image, int numColorComponents) const
+{
+	QString fileName;
+	QTemporaryFile *tempFile = new QTemporaryFile(QDir::tempPath() + ((numColorComponents == 4) ? "/scribus_temp_pdf_XXXXXX.tif" : "/scribus_temp_pdf_XXXXXX.png"));
+	tempFile->setAutoRemove(false);
+	if (tempFile->open())
+	{
+		fileName = getLongPathName(tempFile->fileName());
+		tempFile->close();
+	}
+	delete tempFile;
+	if (fileName.isEmpty())
+		return QString();
+
+	if (numColorComponents == 4)
+	{
+		TIFF* tif = TIFFOpen(fileName.toLocal8Bit().data(), "w");
+		if (tif)
+		{
+			TIFFSetField(tif, TIFFTAG_IMAGEWIDTH, image.width());
+			TIFFSetField(tif, TIFFTAG_IMAGELENGTH, image.height());
+			TIFFSetField(tif, TIFFTAG_BITSPERSAMPLE, 8);
+			TIFFSetField(tif, TIFFTAG_SAMPLESPERPIXEL, 4);
+			TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
+			TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_SEPARATED);
+			TIFFSetField(tif, TIFFTAG_COMPRESSION, COMPRESSION_LZW);
+			for (int y = 0; y < image.height(); ++y)
+			{
+				TIFFWriteScanline(tif, image.scanLine(y), y);
+			}
+			TIFFClose(tif);
+		}
+	}
+	else
+		image.save(fileName, "PNG");
+	return fileName;
+}
+
+void SlaImagePrefetchDev::drawImage(GfxState *state, Object *ref, Stream *str, int width, int height, GfxImageColorMap *colorMap, GBool interpolate, POPPLER_CONST_082 int* maskColors, GBool inlineImg)
+{
+	// inline images are part of the content stream and cannot be shared
+	QString refKey = SlaOutputDev::imageKey(ref, colorMap);
+	if (refKey.isEmpty())
+	{
+		OutputDev::drawImage(state, ref, str, width, height, colorMap, interpolate, maskColors, inlineImg);
+		return;
+	}
+	if (!m_imageFiles->file(refKey).isEmpty())
+		return;
+	QImage image = SlaOutputDev::decodeImage(str, width, height, colorMap, maskColors);
+	if (!image.isNull())
+		m_imageFiles->file(image, colorMap->getNumPixelComps(), refKey);
+}
+
+void SlaImagePrefetchDev::drawSoftMaskedImage(GfxState *state, Object *ref, Stream *str, int width, int height, GfxImageColorMap *colorMap, GBool interpolate, Stream *maskStr, int maskWidth, int maskHeight, GfxImageColorMap *maskColorMap, GBool maskInterpolate)
+{
+	QString refKey = SlaOutputDev::softMaskedImageKey(ref, maskWidth, maskHeight);
+	if (refKey.isEmpty() || !m_imageFiles->file(refKey).isEmpty())
+		return;
+	QImage image = SlaOutputDev::decodeSoftMaskedImage(str, width, height, colorMap, maskStr, maskWidth, maskHeight, maskColorMap);
+	if (!image.isNull())
+		m_imageFiles->file(image, 3, refKey);
+}
+
+void SlaImagePrefetchDev::drawMaskedImage(GfxState *state, Object *ref, Stream *str, int width, int height, GfxImageColorMap *colorMap, GBool interpolate, Stream *maskStr, int maskWidth, int maskHeight, GBool maskInvert, GBool maskInterpolate)
+{
+	QString refKey = SlaOutputDev::maskedImageKey(ref, maskWidth, maskHeight, maskInvert);
+	if (refKey.isEmpty() || !m_imageFiles->file(refKey).isEmpty())
+		return;
+	QImage image = SlaOutputDev::decodeMaskedImage(str, width, height, colorMap, maskStr, maskWidth, maskHeight, maskInvert);
+	if (!image.isNull())
+		m_imageFiles->file(image, colorMap->getNumPixelComps(), refKey);
+}
+
 SlaOutputDev::SlaOutputDev(ScribusDoc* doc, QList<PageItem*> *Elements, QStringList *importedColors, int flags)
 {
 	m_doc = doc;
@@ -2433,6 +2560,14 @@ GBool SlaOutputDev::tilingPatternFill(GfxState *state, Gfx * /*gfx*/, Catalog *c
 void SlaOutputDev::drawImageMask(GfxState *state, Object *ref, Stream *str, int width, int height, GBool invert, GBool interpolate, GBool inlineImg)
 {
 //	qDebug() << "Draw Image Mask";
+	// the mask is painted with the current fill color
+	QString refKey = imageRefKey(ref, QString("mask %1 %2 %3").arg(m_currColorFill).arg(m_currFillShade).arg(invert ? 1 : 0));
+	QString cachedFile = m_imageFiles->file(refKey);
+	if (!cachedFile.isEmpty())
+	{
+		createImageFrame(cachedFile, state);
+		return;
+	}
 	QImage * image = nullptr;
 	int invert_bit;
 	int row_stride;
@@ -2503,7 +2638,7 @@ void SlaOutputDev::drawImageMask(GfxState *state, Object *ref, Stream *str, int
 		}
 	}
 
-	createImageFrame(res, state, 3);
+	createImageFrame(res, state, 3, refKey);
 
 	imgStr->close();
 	delete imgStr;
@@ -2514,6 +2649,50 @@ void SlaOutputDev::drawSoftMaskedImage(GfxState *state, Object *ref, Stream *str
 				   GfxImageColorMap *maskColorMap, GBool maskInterpolate)
 {
 //	qDebug() << "SlaOutputDev::drawSoftMaskedImage Masked Image Components" << colorMap->getNumPixelComps();
+	QString refKey = softMaskedImageKey(ref, maskWidth, maskHeight);
+	QString cachedFile = m_imageFiles->file(refKey);
+	if (!cachedFile.isEmpty())
+	{
+		createImageFrame(cachedFile, state);
+		return;
+	}
+	QImage res = decodeSoftMaskedImage(str, width, height, colorMap, maskStr, maskWidth, maskHeight, maskColorMap);
+	if (!res.isNull())
+		createImageFrame(res, state, 3, refKey);
+}
+
+void SlaOutputDev::drawMaskedImage(GfxState *state, Object *ref, Stream *str,  int width, int height, GfxImageColorMap *colorMap, GBool interpolate, Stream *maskStr, int maskWidth, int maskHeight, GBool maskInvert, GBool maskInterpolate)
+{
+//	qDebug() << "SlaOutputDev::drawMaskedImage";
+	QString refKey = maskedImageKey(ref, maskWidth, maskHeight, maskInvert);
+	QString cachedFile = m_imageFiles->file(refKey);
+	if (!cachedFile.isEmpty())
+	{
+		createImageFrame(cachedFile, state);
+		return;
+	}
+	QImage res = decodeMaskedImage(str, width, height, colorMap, maskStr, maskWidth, maskHeight, maskInvert);
+	if (!res.isNull())
+		createImageFrame(res, state, colorMap->getNumPixelComps(), refKey);
+}
+
+void SlaOutputDev::drawImage(GfxState *state, Object *ref, Stream *str, int width, int height, GfxImageColorMap *colorMap, GBool interpolate, POPPLER_CONST_082 int* maskColors, GBool inlineImg)
+{
+//	qDebug() << "SlaOutputDev::drawImage Image Components" << colorMap->getNumPixelComps() << "Mask" << maskColors;
+	QString refKey = imageKey(ref, colorMap);
+	QString cachedFile = m_imageFiles->file(refKey);
+	if (!cachedFile.isEmpty())
+	{
+		createImageFrame(cachedFile, state);
+		return;
+	}
+	QImage image = decodeImage(str, width, height, colorMap, maskColors);
+	if (!image.isNull())
+		createImageFrame(image, state, colorMap->getNumPixelComps(), refKey);
+}
+
+QImage SlaOutputDev::decodeSoftMaskedImage(Stream *str, int width, int height, GfxImageColorMap *colorMap, Stream *maskStr, int maskWidth, int maskHeight, GfxImageColorMap *maskColorMap)
+{
 	ImageStream * imgStr = new ImageStream(str, width, colorMap->getNumPixelComps(), colorMap->getBits());
 	imgStr->reset();
 	unsigned int *dest = nullptr;
@@ -2531,7 +2710,7 @@ void SlaOutputDev::drawSoftMaskedImage(GfxState *state, Object *ref, Stream *str
 		delete imgStr;
 		delete[] buffer;
 		delete image;
-		return;
+		return QImage();
 	}
 	ImageStream *mskStr = new ImageStream(maskStr, maskWidth, maskColorMap->getNumPixelComps(), maskColorMap->getBits());
 	mskStr->reset();
@@ -2582,18 +2761,16 @@ void SlaOutputDev::drawSoftMaskedImage(GfxState *state, Object *ref, Stream *str
 		}
 	}
 
-	createImageFrame(res, state, 3);
-
 	delete imgStr;
 	delete[] buffer;
 	delete image;
 	delete mskStr;
 	delete[] mbuffer;
+	return res;
 }
 
-void SlaOutputDev::drawMaskedImage(GfxState *state, Object *ref, Stream *str,  int width, int height, GfxImageColorMap *colorMap, GBool interpolate, Stream *maskStr, int maskWidth, int maskHeight, GBool maskInvert, GBool maskInterpolate)
+QImage SlaOutputDev::decodeMaskedImage(Stream *str, int width, int height, GfxImageColorMap *colorMap, Stream *maskStr, int maskWidth, int maskHeight, GBool maskInvert)
 {
-//	qDebug() << "SlaOutputDev::drawMaskedImage";
 	ImageStream * imgStr = new ImageStream(str, width, colorMap->getNumPixelComps(), colorMap->getBits());
 	imgStr->reset();
 	unsigned int *dest = nullptr;
@@ -2611,7 +2788,7 @@ void SlaOutputDev::drawMaskedImage(GfxState *state, Object *ref, Stream *str,  i
 		delete imgStr;
 		delete[] buffer;
 		delete image;
-		return;
+		return QImage();
 	}
 	ImageStream *mskStr = new ImageStream(maskStr, maskWidth, 1, 1);
 	mskStr->reset();
@@ -2651,27 +2828,29 @@ void SlaOutputDev::drawMaskedImage(GfxState *state, Object *ref, Stream *str,  i
 		}
 	}
 
-	createImageFrame(res, state, colorMap->getNumPixelComps());
-
 	delete imgStr;
 	delete[] buffer;
 	delete image;
 	delete mskStr;
 	delete[] mbuffer;
+	return res;
 }
 
-void SlaOutputDev::drawImage(GfxState *state, Object *ref, Stream *str, int width, int height, GfxImageColorMap *colorMap, GBool interpolate, POPPLER_CONST_082 int* maskColors, GBool inlineImg)
+QImage SlaOutputDev::decodeImage(Stream *str, int width, int height, GfxImageColorMap *colorMap, POPPLER_CONST_082 int* maskColors)
 {
 	ImageStream * imgStr = new ImageStream(str, width, colorMap->getNumPixelComps(), colorMap->getBits());
-//	qDebug() << "SlaOutputDev::drawImage Image Components" << colorMap->getNumPixelComps() << "Mask" << maskColors;
 	imgStr->reset();
-	QImage* image = nullptr;
+	QImage image(width, height, QImage::Format_ARGB32);
+	if (image.isNull())
+	{
+		delete imgStr;
+		return image;
+	}
 	if (maskColors)
 	{
-		image = new QImage(width, height, QImage::Format_ARGB32);
 		for (int y = 0; y < height; y++)
 		{
-			QRgb *s = (QRgb*)(image->scanLine(y));
+			QRgb *s = (QRgb*)(image.scanLine(y));
 			Guchar *pix = imgStr->getLine();
 			for (int x = 0; x < width; x++)
 			{
@@ -2696,10 +2875,9 @@ void SlaOutputDev::drawImage(GfxState *state, Object *ref, Stream *str, int widt
 	}
 	else
 	{
-		image = new QImage(width, height, QImage::Format_ARGB32);
 		for (int y = 0; y < height; y++)
 		{
-			QRgb *s = (QRgb*)(image->scanLine(y));
+			QRgb *s = (QRgb*)(image.scanLine(y));
 			Guchar *pix = imgStr->getLine();
 			for (int x = 0; x < width; x++)
 			{
@@ -2727,18 +2905,50 @@ void SlaOutputDev::drawImage(GfxState *state, Object *ref, Stream *str, int widt
 			}
 		}
 	}
+	delete imgStr;
+	return image;
+}
 
-	if (image != nullptr && !image->isNull()) {
-		createImageFrame(*image, state, colorMap->getNumPixelComps());
-	}
+QString SlaOutputDev::imageRefKey(Object *ref, const QString& variant)
+{
+	if ((ref == nullptr) || !ref->isRef())
+		return QString();
+	Ref imageRef = ref->getRef();
+	return QString("%1 %2 %3").arg(imageRef.num).arg(imageRef.gen).arg(variant);
+}
 
-	delete imgStr;
-	delete image;
+QString SlaOutputDev::imageKey(Object *ref, GfxImageColorMap *colorMap)
+{
+	return imageRefKey(ref, QString("image %1").arg(colorMap->getNumPixelComps()));
 }
 
-void SlaOutputDev::createImageFrame(QImage& image, GfxState *state, int numColorComponents)
+QString SlaOutputDev::softMaskedImageKey(Object *ref, int maskWidth, int maskHeight)
+{
+	return imageRefKey(ref, QString("softmasked %1 %2").arg(maskWidth).arg(maskHeight));
+}
+
+QString SlaOutputDev::maskedImageKey(Object *ref, int maskWidth, int maskHeight, GBool maskInvert)
+{
+	return imageRefKey(ref, QString("masked %1 %2 %3").arg(maskWidth).arg(maskHeight).arg(maskInvert ? 1 : 0));
+}
+
+void SlaOutputDev::createImageFrame(QImage& image, GfxState *state, int numColorComponents, const QString& refKey)
 {
 //	qDebug() << "SlaOutputDev::createImageFrame";
+	if (inPattern == 0)
+	{
+		// If the visible area of the picture is empty, no item needs to be created.
+		QPainterPath outline = visibleImageArea(state);
+		if (outline.isEmpty() || outline.boundingRect().isNull())
+			return;
+	}
+	QString fileName = m_imageFiles->file(image, numColorComponents, refKey);
+	if (!fileName.isEmpty())
+		createImageFrame(fileName, state);
+}
+
+void SlaOutputDev::createImageFrame(const QString& fileName, GfxState *state)
+{
 	const double *ctm = state->getCTM();
 	double xCoor = m_doc->currentPage()->xOffset();
 	double yCoor = m_doc->currentPage()->yOffset();
@@ -2762,11 +2972,7 @@ void SlaOutputDev::createImageFrame(QImage& image, GfxState *state, int numColor
 
 	// Determine the visible area of the picture after clipping it. If it is empty, no item
 	// needs to be created.
-	QPainterPath outline;
-	outline.addRect(0, 0, 1, 1);
-	outline = m_ctm.map(outline);
-	outline = intersection(outline, m_currentClipPath);
-
+	QPainterPath outline = visibleImageArea(state);
 	if ((inPattern == 0) && (outline.isEmpty() || outline.boundingRect().isNull()))
 		return;
 
@@ -2797,77 +3003,20 @@ void SlaOutputDev::createImageFrame(QImage& image, GfxState *state, int numColor
 		ite->setRotation(-angle);
 	m_doc->adjustItemSize(ite);
 
-	if (numColorComponents == 4)
-	{
-		QTemporaryFile *tempFile = new QTemporaryFile(QDir::tempPath() + "/scribus_temp_pdf_XXXXXX.tif");
-		tempFile->setAutoRemove(false);
-		if (tempFile->open())
-		{
-			QString fileName = getLongPathName(tempFile->fileName());
-			if (!fileName.isEmpty())
-			{
-				tempFile->close();
-				ite->isInlineImage = true;
-				ite->isTempFile = true;
-				ite->AspectRatio = false;
-				ite->ScaleType   = false;
-				TIFF* tif = TIFFOpen(fileName.toLocal8Bit().data(), "w");
-				if (tif)
-				{
-					TIFFSetField(tif, TIFFTAG_IMAGEWIDTH, image.width());
-					TIFFSetField(tif, TIFFTAG_IMAGELENGTH, image.height());
-					TIFFSetField(tif, TIFFTAG_BITSPERSAMPLE, 8);
-					TIFFSetField(tif, TIFFTAG_SAMPLESPERPIXEL, 4);
-					TIFFSetField(tif, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
-					TIFFSetField(tif, TIFFTAG_PHOTOMETRIC, PHOTOMETRIC_SEPARATED);
-					TIFFSetField(tif, TIFFTAG_COMPRESSION, COMPRESSION_LZW);
-					for (int y = 0; y < image.height(); ++y)
-					{
-						TIFFWriteScanline(tif, image.scanLine(y), y);
-					}
-					TIFFClose(tif);
-					m_doc->loadPict(fileName, ite);
-				}
-				m_Elements->append(ite);
-				if (m_groupStack.count() != 0)
-				{
-					m_groupStack.top().Items.append(ite);
-					applyMask(ite);
-				}
-			}
-			else
-				m_doc->Items->removeAll(ite);
-		}
-		delete tempFile;
-	}
-	else
+	// the file stays until the import and every frame showing it are done with it
+	shareTempFile(fileName);
+	ite->isInlineImage = true;
+	ite->isTempFile = true;
+	ite->AspectRatio = false;
+	ite->ScaleType   = false;
+	m_doc->loadPict(fileName, ite);
+	m_Elements->append(ite);
+	if (m_groupStack.count() != 0)
 	{
-		QTemporaryFile *tempFile = new QTemporaryFile(QDir::tempPath() + "/scribus_temp_pdf_XXXXXX.png");
-		tempFile->setAutoRemove(false);
-		if (tempFile->open())
-		{
-			QString fileName = getLongPathName(tempFile->fileName());
-			if (!fileName.isEmpty())
-			{
-				tempFile->close();
-				ite->isInlineImage = true;
-				ite->isTempFile = true;
-				ite->AspectRatio = false;
-				ite->ScaleType   = false;
-				image.save(fileName, "PNG");
-				m_doc->loadPict(fileName, ite);
-				m_Elements->append(ite);
-				if (m_groupStack.count() != 0)
-				{
-					m_groupStack.top().Items.append(ite);
-					applyMask(ite);
-				}
-			}
-			else
-				m_doc->Items->removeAll(ite);
-		}
-		delete tempFile;
+		m_groupStack.top().Items.append(ite);
+		applyMask(ite);
 	}
+
 	if (inPattern == 0)
 	{
 		outline.translate(xCoor - ite->xPos(), yCoor - ite->yPos());
@@ -2888,6 +3037,16 @@ void SlaOutputDev::createImageFrame(QImage& image, GfxState *state, int numColor
 	}
 }
 
+QPainterPath SlaOutputDev::visibleImageArea(GfxState *state)
+{
+	const double *ctm = state->getCTM();
+	QTransform imageCtm(ctm[0], ctm[1], ctm[2], ctm[3], ctm[4], ctm[5]);
+	QPainterPath outline;
+	outline.addRect(0, 0, 1, 1);
+	outline = imageCtm.map(outline);
+	return intersection(outline, m_currentClipPath);
+}
+
 void SlaOutputDev::beginMarkedContent(POPPLER_CONST char *name, Object *dictRef)
 {
 	mContent mSte;
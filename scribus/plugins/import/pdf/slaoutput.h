@@ -11,7 +11,9 @@ for which a new license (GPL+exception) is in place.
 #include <QColor>
 #include <QBrush>
 #include <QDebug>
+#include <QHash>
 #include <QImage>
+#include <QMutex>
 #include <QPen>
 #include <QList>
 #include <QSizeF>
@@ -156,6 +158,56 @@ private:
 
 
 
+//------------------------------------------------------------------------
+// SlaImageFileCache
+//------------------------------------------------------------------------
+
+// Temporary image files of an import by XObject and by content. Frames showing the
+// same image share one file. Files can be added from several threads at once.
+class SlaImageFileCache
+{
+public:
+	SlaImageFileCache() {}
+	~SlaImageFileCache();
+
+	// The file of the image XObject refKey, see SlaOutputDev::imageRefKey(), empty if it was not decoded yet
+	QString file(const QString& refKey) const;
+	// Write image to a temporary file, unless an identical image was written before,
+	// and remember the file for refKey
+	QString file(QImage& image, int numColorComponents, const QString& refKey = QString());
+
+private:
+	QString writeImage(QImage& image, int numColorComponents) const;
+
+	mutable QMutex m_mutex;
+	QHash<QString, QString> m_filesByRef;
+	QHash<QByteArray, QString> m_filesByHash;
+};
+
+//------------------------------------------------------------------------
+// SlaImagePrefetchDev
+//------------------------------------------------------------------------
+
+// Decodes the image XObjects of pages into a SlaImageFileCache and ignores
+// everything else. Used on worker threads, each with its own PDFDoc, so that
+// SlaOutputDev finds the images of the pages already decoded.
+class SlaImagePrefetchDev : public OutputDev
+{
+public:
+	SlaImagePrefetchDev(SlaImageFileCache* imageFiles) : m_imageFiles(imageFiles) {}
+
+	GBool upsideDown() override { return gTrue; }
+	GBool useDrawChar() override { return gFalse; }
+	GBool interpretType3Chars() override { return gFalse; }
+
+	void drawImage(GfxState *state, Object *ref, Stream *str, int width, int height, GfxImageColorMap *colorMap, GBool interpolate, POPPLER_CONST_082 int* maskColors, GBool inlineImg) override;
+	void drawSoftMaskedImage(GfxState *state, Object *ref, Stream *str, int width, int height, GfxImageColorMap *colorMap, GBool interpolate, Stream *maskStr, int maskWidth, int maskHeight, GfxImageColorMap *maskColorMap, GBool maskInterpolate) override;
+	void drawMaskedImage(GfxState *state, Object *ref, Stream *str, int width, int height, GfxImageColorMap *colorMap, GBool interpolate, Stream *maskStr, int maskWidth, int maskHeight, GBool maskInvert, GBool maskInterpolate) override;
+
+private:
+	SlaImageFileCache* m_imageFiles;
+};
+
 class SlaOutputDev : public OutputDev
 {
 public:
@@ -175,6 +227,8 @@ public:
 	void applyTextStyle(PageItem* ite, const QString& fontName, const QString& textColor, double fontSize);
 	void handleActions(PageItem* ite, AnnotWidget *ano);
 	void startDoc(PDFDoc *doc, XRef *xrefA, Catalog *catA);
+	// Use imageFiles, which must outlive the device, instead of a cache of its own
+	void setImageFileCache(SlaImageFileCache *imageFiles) { m_imageFiles = imageFiles; }
 
 	GBool isOk() { return gTrue; }
 	GBool upsideDown() override { return gTrue; }
@@ -259,6 +313,18 @@ public:
 				   int maskWidth, int maskHeight,
 				   GBool maskInvert, GBool maskInterpolate) override; // { qDebug() << "Draw Masked Image"; }
 
+	// Decoding of the images passed to the functions above, a null image on failure.
+	// These do not touch the device and are shared with SlaImagePrefetchDev.
+	static QImage decodeImage(Stream *str, int width, int height, GfxImageColorMap *colorMap, POPPLER_CONST_082 int* maskColors);
+	static QImage decodeSoftMaskedImage(Stream *str, int width, int height, GfxImageColorMap *colorMap, Stream *maskStr, int maskWidth, int maskHeight, GfxImageColorMap *maskColorMap);
+	static QImage decodeMaskedImage(Stream *str, int width, int height, GfxImageColorMap *colorMap, Stream *maskStr, int maskWidth, int maskHeight, GBool maskInvert);
+
+	// Identifies the image XObject ref decoded in the given way, empty for inline images
+	static QString imageRefKey(Object *ref, const QString& variant);
+	static QString imageKey(Object *ref, GfxImageColorMap *colorMap);
+	static QString softMaskedImageKey(Object *ref, int maskWidth, int maskHeight);
+	static QString maskedImageKey(Object *ref, int maskWidth, int maskHeight, GBool maskInvert);
+
 	//----- transparency groups and soft masks
 	void beginTransparencyGroup(GfxState *state, POPPLER_CONST_070 double *bbox, GfxColorSpace * /*blendingColorSpace*/, GBool /*isolated*/, GBool /*knockout*/, GBool /*forSoftMask*/) override;
 	void paintTransparencyGroup(GfxState *state, POPPLER_CONST_070 double *bbox) override;
@@ -335,7 +401,13 @@ private:
 	// intersect it with the clipping path and create a new pageitem for it.
 	void createFillItem(GfxState *state, Qt::FillRule fillRule);
 
-	void createImageFrame(QImage& image, GfxState *state, int numColorComponents);
+	// Create an image frame showing image. refKey, see imageRefKey(), lets later
+	// occurrences of the same image XObject skip decoding.
+	void createImageFrame(QImage& image, GfxState *state, int numColorComponents, const QString& refKey = QString());
+	// Create an image frame showing an image file of the image file cache
+	void createImageFrame(const QString& fileName, GfxState *state);
+	// The part of the unit square mapped by the ctm which is not clipped away
+	QPainterPath visibleImageArea(GfxState *state);
 
 	bool pathIsClosed { false };
 	QVector<double> DashValues;
@@ -384,6 +456,10 @@ private:
 #else
 	FormPageWidgets *m_formWidgets {nullptr};
 #endif
+	// Temporary image files of the import, either m_defaultImageFiles or a cache
+	// shared with the threads set by setImageFileCache()
+	SlaImageFileCache m_defaultImageFiles;
+	SlaImageFileCache *m_imageFiles { &m_defaultImageFiles };
 	QHash<QString, QList<int> > m_radioMap;
 	QHash<int, PageItem*> m_radioButtons;
 	int m_actPage { 1 };
@@ -6,6 +6,7 @@ for which a new license (GPL+exception) is in place.
 */
 #include "cmdmisc.h"
 #include "cmdutil.h"
+#include "objbatch.h"
 
 #include "qbuffer.h"
 #include "qpixmap.h"
@@ -31,6 +32,11 @@ PyObject *scribus_setredraw(PyObject* /* self */, PyObject* args)
 	Py_RETURN_NONE;
 }
 
+PyObject *scribus_batch(PyObject* /* self */)
+{
+	return PyObject_CallObject((PyObject *) &Batch_Type, nullptr);
+}
+
 PyObject *scribus_getfontnames(PyObject* /* self */)
 {
 	int cc2 = 0;
@@ -840,5 +846,6 @@ void cmdmiscdocwarnings()
 	  << scribus_setlayertransparency__doc__
 	  << scribus_setlayervisible__doc__ 
 	  << scribus_setredraw__doc__  
+	  << scribus_batch__doc__
 	  << scribus_xfontnames__doc__;
 }
@@ -25,6 +25,25 @@ setRedraw(True) in a finally: clause at the top level of your script.\n\
 /*! Enable/disable page redrawing. */
 PyObject *scribus_setredraw(PyObject * /*self*/, PyObject* args);
 
+/*! docstring */
+PyDoc_STRVAR(scribus_batch__doc__,
+QT_TR_NOOP("batch() -> Batch\n\
+\n\
+Returns a context manager for making many changes to the document at once:\n\
+\n\
+    with scribus.batch():\n\
+        ...\n\
+\n\
+Inside the with block redrawing is disabled and all changes become a single\n\
+undo action. Relayouts and redraws requested by the changed items are collected\n\
+and done once when the block is left, also when it is left by an exception.\n\
+Unlike setRedraw(False), nothing has to be restored afterwards.\n\
+\n\
+May raise NoDocOpenError when the block is entered without an open document.\n\
+"));
+/*! Context manager which groups a series of changes. */
+PyObject *scribus_batch(PyObject * /*self*/);
+
 /*! docstring */
 PyDoc_STRVAR(scribus_getfontnames__doc__,
 QT_TR_NOOP("getFontNames() -> list\n\
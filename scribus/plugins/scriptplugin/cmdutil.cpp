@@ -61,18 +61,9 @@ PageItem *GetItem(const QString& name)
 {
 	ScribusDoc* currentDoc = ScCore->primaryMainWindow()->doc;
 	if (!name.isEmpty())
-	{
-		for (int i = 0; i < currentDoc->Items->count(); ++i)
-		{
-			if (currentDoc->Items->at(i)->itemName() == name)
-				return currentDoc->Items->at(i);
-		}
-	}
-	else
-	{
-		if (currentDoc->m_Selection->count() != 0)
-			return currentDoc->m_Selection->itemAt(0);
-	}
+		return currentDoc->itemNameIndex().find(currentDoc->Items, name);
+	if (currentDoc->m_Selection->count() != 0)
+		return currentDoc->m_Selection->itemAt(0);
 	return nullptr;
 }
 
@@ -118,11 +109,9 @@ PageItem* getPageItemByName(const QString& name)
 	}
 
 	ScribusDoc* currentDoc = ScCore->primaryMainWindow()->doc;
-	for (int i = 0; i < currentDoc->Items->count(); ++i)
-	{
-		if (name == currentDoc->Items->at(i)->itemName())
-			return currentDoc->Items->at(i);
-	}
+	PageItem* item = currentDoc->itemNameIndex().find(currentDoc->Items, name);
+	if (item)
+		return item;
 
 	PyErr_SetString(NoValidObjectError, QString("Object not found").toLocal8Bit().constData());
 	return nullptr;
@@ -140,12 +129,7 @@ bool ItemExists(const QString& name)
 		return false;
 
 	ScribusDoc* currentDoc = ScCore->primaryMainWindow()->doc;
-	for (int i = 0; i < currentDoc->Items->count(); ++i)
-	{
-		if (name == currentDoc->Items->at(i)->itemName())
-			return true;
-	}
-	return false;
+	return currentDoc->itemNameIndex().contains(currentDoc->Items, name);
 }
 
 /*!
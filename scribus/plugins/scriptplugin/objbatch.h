@@ -0,0 +1,35 @@
+/*
+For general Scribus (>=1.3.2) copyright and licensing information please refer
+to the COPYING file provided with the program. Following this notice may exist
+a copyright and/or license notice that predates the release of Scribus 1.3.2
+for which a new license (GPL+exception) is in place.
+*/
+#ifndef OBJBATCH_H
+#define OBJBATCH_H
+
+// Pulls in <Python.h> first
+#include "cmdvar.h"
+
+extern PyTypeObject Batch_Type;
+
+// docstrings
+PyDoc_STRVAR(batch__doc__,"Batch of document changes\n\
+\n\
+Class Batch() is a context manager for scripts which make many changes\n\
+to a document. While a batch is open, redrawing is disabled, all changes\n\
+are recorded as one undo action, and the relayout and redraw requests of\n\
+the changed items are collected. On leaving the batch every changed text\n\
+frame is laid out once and the document is redrawn once. Batches can be\n\
+nested, only the outermost one has an effect. See also batch().\n\
+Example:\n\
+with scribus.batch():\n\
+    for i in range(1000):\n\
+        f = scribus.createText(10, 10 + i, 50, 10)\n\
+        scribus.setText('Item %d' % i, f)");
+
+PyDoc_STRVAR(batch_enter__doc__, "__enter__() -> Batch\n\nStarts the batch.");
+PyDoc_STRVAR(batch_exit__doc__, "__exit__(type, value, traceback) -> bool\n\nEnds the batch. Exceptions are passed on.");
+
+#define Batch_Check(op) ((op)->ob_type == &Batch_Type)
+
+#endif /* OBJBATCH_H */
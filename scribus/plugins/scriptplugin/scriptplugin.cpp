@@ -41,6 +41,7 @@ for which a new license (GPL+exception) is in place.
 #include "cmdstyle.h"
 #include "guiapp.h"
 #include "iconmanager.h"
+#include "objbatch.h"
 #include "objimageexport.h"
 #include "objpdffile.h"
 #include "objprinter.h"
@@ -287,6 +288,7 @@ PyMethodDef scribus_methods[] = {
 	// 2004/10/03 pv - aliases with common Python syntax - ClassName methodName
 	// 2004-11-06 cr - move aliasing to dynamically generated wrapper functions, sort methoddef
 	{const_cast<char*>("applyMasterPage"), scribus_applymasterpage, METH_VARARGS, tr(scribus_applymasterpage__doc__)},
+	{const_cast<char*>("batch"), (PyCFunction)scribus_batch, METH_NOARGS, tr(scribus_batch__doc__)},
 	{const_cast<char*>("changeColor"), scribus_setcolor, METH_VARARGS, tr(scribus_setcolor__doc__)},
 	{const_cast<char*>("changeColorCMYK"), scribus_setcolorcmyk, METH_VARARGS, tr(scribus_setcolorcmyk__doc__)},
 	{const_cast<char*>("changeColorCMYKFloat"), scribus_setcolorcmykfloat, METH_VARARGS, tr(scribus_setcolorcmykfloat__doc__)},
@@ -672,6 +674,7 @@ PyObject* PyInit_scribus(void)
 	PyType_Ready(&Printer_Type);
 	PyType_Ready(&PDFfile_Type);
 	PyType_Ready(&ImageExport_Type);
+	PyType_Ready(&Batch_Type);
 
 	m = PyModule_Create(&scribus_module_def);
 
@@ -687,6 +690,10 @@ PyObject* PyInit_scribus(void)
 	PyModule_AddObject(m, (char*) "ImageExport", (PyObject *) &ImageExport_Type);
 	if (result != 0)
 		qDebug("scriptplugin: Could not create scribus.ImageExport module");
+	Py_INCREF(&Batch_Type);
+	result = PyModule_AddObject(m, (char*) "Batch", (PyObject *) &Batch_Type);
+	if (result != 0)
+		qDebug("scriptplugin: Could not create scribus.Batch module");
 	d = PyModule_GetDict(m);
 
 	// Set up the module exceptions
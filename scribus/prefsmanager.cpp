@@ -263,6 +263,8 @@ void PrefsManager::initDefaults()
 	appPrefs.displayPrefs.showPageShadow = true;
 	appPrefs.displayPrefs.showVerifierWarningsOnCanvas = true;
 	appPrefs.displayPrefs.showAutosaveClockOnCanvas = false;
+	appPrefs.displayPrefs.itemRasterCacheEnabled = true;
+	appPrefs.displayPrefs.itemRasterCacheSizeMiB = 64;
 	appPrefs.displayPrefs.frameColor = QColor(Qt::red);
 	appPrefs.displayPrefs.frameNormColor = QColor(Qt::black);
 	appPrefs.displayPrefs.frameGroupColor = QColor(Qt::darkCyan);
@@ -334,6 +336,7 @@ void PrefsManager::initDefaults()
 	appPrefs.docSetupPrefs.AutoSaveCount = 1;
 	appPrefs.docSetupPrefs.AutoSaveKeep = false;
 	appPrefs.docSetupPrefs.saveCompressed = false;
+	appPrefs.docSetupPrefs.saveImagesSeparately = false;
 	appPrefs.docSetupPrefs.AutoSaveLocation = true;
 	appPrefs.docSetupPrefs.AutoSaveDir = "";
 	appPrefs.miscPrefs.saveEmergencyFile = true;
@@ -526,6 +529,8 @@ void PrefsManager::initDefaults()
 	appPrefs.imageCachePrefs.maxCacheSizeMiB = 1000;
 	appPrefs.imageCachePrefs.maxCacheEntries = 1000;
 	appPrefs.imageCachePrefs.compressionLevel = 1;
+	appPrefs.imageCachePrefs.loadMemoryMiB = 1024;
+	appPrefs.imageCachePrefs.backgroundLoading = false;
 	appPrefs.activePageSizes.clear();
 	appPrefs.activePageSizes << "A4" << "Letter";
 
@@ -1419,6 +1424,7 @@ bool PrefsManager::writePref(const QString& filePath)
 	deDocumentSetup.setAttribute("AutoSaveLoc", static_cast<int>(appPrefs.docSetupPrefs.AutoSaveLocation));
 	deDocumentSetup.setAttribute("AutoSaveDir", appPrefs.docSetupPrefs.AutoSaveDir);
 	deDocumentSetup.setAttribute("SaveCompressed", static_cast<int>(appPrefs.docSetupPrefs.saveCompressed));
+	deDocumentSetup.setAttribute("SaveImagesSeparately", static_cast<int>(appPrefs.docSetupPrefs.saveImagesSeparately));
 	deDocumentSetup.setAttribute("BleedTop", ScCLocale::toQStringC(appPrefs.docSetupPrefs.bleeds.top()));
 	deDocumentSetup.setAttribute("BleedLeft", ScCLocale::toQStringC(appPrefs.docSetupPrefs.bleeds.left()));
 	deDocumentSetup.setAttribute("BleedRight", ScCLocale::toQStringC(appPrefs.docSetupPrefs.bleeds.right()));
@@ -1504,6 +1510,8 @@ bool PrefsManager::writePref(const QString& filePath)
 	deDisplay.setAttribute("DisplayScale", ScCLocale::toQStringC(appPrefs.displayPrefs.displayScale, 8));
 	deDisplay.setAttribute("ShowVerifierWarningsOnCanvas", static_cast<int>(appPrefs.displayPrefs.showVerifierWarningsOnCanvas));
 	deDisplay.setAttribute("ShowAutosaveClockOnCanvas", static_cast<int>(appPrefs.displayPrefs.showAutosaveClockOnCanvas));
+	deDisplay.setAttribute("ItemRasterCache", static_cast<int>(appPrefs.displayPrefs.itemRasterCacheEnabled));
+	deDisplay.setAttribute("ItemRasterCacheSize", appPrefs.displayPrefs.itemRasterCacheSizeMiB);
 	deDisplay.setAttribute("ToolTips", static_cast<int>(appPrefs.displayPrefs.showToolTips));
 	deDisplay.setAttribute("ShowMouseCoordinates", static_cast<int>(appPrefs.displayPrefs.showMouseCoordinates));
 	elem.appendChild(deDisplay);
@@ -1944,6 +1952,8 @@ bool PrefsManager::writePref(const QString& filePath)
 	icElem.setAttribute("MaximumCacheSizeMiB", appPrefs.imageCachePrefs.maxCacheSizeMiB);
 	icElem.setAttribute("MaximumCacheEntries", appPrefs.imageCachePrefs.maxCacheEntries);
 	icElem.setAttribute("CompressionLevel", appPrefs.imageCachePrefs.compressionLevel);
+	icElem.setAttribute("LoadMemoryMiB", appPrefs.imageCachePrefs.loadMemoryMiB);
+	icElem.setAttribute("BackgroundLoading", appPrefs.imageCachePrefs.backgroundLoading);
 	elem.appendChild(icElem);
 	// active page sizes
 	QDomElement apsElem = docu.createElement("ActivePageSizes");
@@ -2062,6 +2072,7 @@ bool PrefsManager::readPref(const QString& filePath)
 			appPrefs.docSetupPrefs.AutoSaveLocation = static_cast<bool>(dc.attribute("AutoSaveLoc", "1").toInt());
 			appPrefs.docSetupPrefs.AutoSaveDir = dc.attribute("AutoSaveDir", "");
 			appPrefs.docSetupPrefs.saveCompressed = static_cast<bool>(dc.attribute("SaveCompressed", "0").toInt());
+			appPrefs.docSetupPrefs.saveImagesSeparately = static_cast<bool>(dc.attribute("SaveImagesSeparately", "0").toInt());
 			appPrefs.docSetupPrefs.bleeds.setTop(ScCLocale::toDoubleC(dc.attribute("BleedTop"), 0.0));
 			appPrefs.docSetupPrefs.bleeds.setLeft(ScCLocale::toDoubleC(dc.attribute("BleedLeft"), 0.0));
 			appPrefs.docSetupPrefs.bleeds.setRight(ScCLocale::toDoubleC(dc.attribute("BleedRight"), 0.0));
@@ -2103,6 +2114,8 @@ bool PrefsManager::readPref(const QString& filePath)
 			appPrefs.displayPrefs.displayScale = qRound(ScCLocale::toDoubleC(dc.attribute("DisplayScale"), appPrefs.displayPrefs.displayScale)*72)/72.0;
 			appPrefs.displayPrefs.showVerifierWarningsOnCanvas = static_cast<bool>(dc.attribute("ShowVerifierWarningsOnCanvas", "1").toInt());
 			appPrefs.displayPrefs.showAutosaveClockOnCanvas = static_cast<bool>(dc.attribute("ShowAutosaveClockOnCanvas", "0").toInt());
+			appPrefs.displayPrefs.itemRasterCacheEnabled = static_cast<bool>(dc.attribute("ItemRasterCache", "1").toInt());
+			appPrefs.displayPrefs.itemRasterCacheSizeMiB = qBound(8, dc.attribute("ItemRasterCacheSize", "64").toInt(), 4096);
 			appPrefs.displayPrefs.showToolTips = static_cast<bool>(dc.attribute("ToolTips", "1").toInt());
 			appPrefs.displayPrefs.showMouseCoordinates = static_cast<bool>(dc.attribute("ShowMouseCoordinates", "1").toInt());
 		}
@@ -2754,6 +2767,8 @@ bool PrefsManager::readPref(const QString& filePath)
 			appPrefs.imageCachePrefs.maxCacheSizeMiB = dc.attribute("MaximumCacheSizeMiB", "1000").toInt();
 			appPrefs.imageCachePrefs.maxCacheEntries = dc.attribute("MaximumCacheEntries", "1000").toInt();
 			appPrefs.imageCachePrefs.compressionLevel = dc.attribute("CompressionLevel", "1").toInt();
+			appPrefs.imageCachePrefs.loadMemoryMiB = qMax(64, dc.attribute("LoadMemoryMiB", "1024").toInt());
+			appPrefs.imageCachePrefs.backgroundLoading = static_cast<bool>(dc.attribute("BackgroundLoading", "0").toInt());
 		}
 		// active page sizes
 		if (dc.tagName() == "ActivePageSizes")
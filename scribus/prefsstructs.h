@@ -162,6 +162,7 @@ struct DocumentSetupPrefs
 	bool AutoSaveLocation;
 	QString AutoSaveDir;
 	bool saveCompressed;
+	bool saveImagesSeparately; //! Store inline images in a blob file next to the document
 };
 
 //Guides
@@ -369,6 +370,8 @@ struct DisplayPrefs
 	double displayScale; //! Display scale, typically used to set the scale of the display to 100% of real values.
 	bool showVerifierWarningsOnCanvas; //! Show preflight verifier warnings on canvas
 	bool showAutosaveClockOnCanvas; //! Show autosave countdown on canvas
+	bool itemRasterCacheEnabled; //! Keep rendered images of complex items for redrawing them
+	int itemRasterCacheSizeMiB; //! Maximum size of the rendered item images of a view in MiB
 };
 
 struct ExternalToolsPrefs
@@ -465,6 +468,8 @@ struct ImageCachePrefs
 	int maxCacheSizeMiB;  //!< Maximum total size of image cache in MiB
 	int maxCacheEntries;  //!< Maximum number of cache entries
 	int compressionLevel; //!< Cache image compression level (see QImage)
+	int loadMemoryMiB;    //!< Maximum memory used by images being reloaded in parallel, in MiB
+	bool backgroundLoading; //!< Load the images of a document in the background after opening it
 };
 
 struct ApplicationPrefs
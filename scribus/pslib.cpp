@@ -46,6 +46,7 @@ for which a new license (GPL+exception) is in place.
 #include "prefsmanager.h"
 #include "scclocale.h"
 #include "sccolorengine.h"
+#include "sccontentstream.h"
 #include "scfonts.h"
 #include "scribusapp.h"
 #include "scribusdoc.h"
@@ -253,6 +254,7 @@ PSLib::PSLib(ScribusDoc* doc, PrintOptions &options, OutputFormat outputFmt, Col
 {
 	Options = options;
 	Creator = ScribusAPI::getVersionScribus();
+	m_streamBuffer.reserve(4096);
 
 	CMYKColorF cmykValues;
 	double c, m, y, k;
@@ -332,7 +334,8 @@ PSLib::PSLib(ScribusDoc* doc, PrintOptions &options, OutputFormat outputFmt, Col
 			uint gid = ig.key();
 			FPointArray glyphOutline = face.glyphOutline(gid);
 
-			FontDesc += "/G" + IToStr(gid) + " { newpath\n";
+			QByteArray glyphDesc = "/G" + QByteArray::number(gid) + " { newpath\n";
+			ScContentStream cs(glyphDesc, numberDecimals);
 			FPoint np, np1, np2;
 			bool nPath = true;
 			if (glyphOutline.size() > 3)
@@ -341,25 +344,24 @@ PSLib::PSLib(ScribusDoc* doc, PrintOptions &options, OutputFormat outputFmt, Col
 				{
 					if (glyphOutline.isMarker(poi))
 					{
-						FontDesc += "cl\n";
+						cs << "cl\n";
 						nPath = true;
 						continue;
 					}
 					if (nPath)
 					{
 						np = glyphOutline.point(poi);
-						FontDesc += ToStr(np.x()) + " " + ToStr(-np.y()) + " m\n";
+						cs << np.x() << -np.y() << "m\n";
 						nPath = false;
 					}
 					np = glyphOutline.point(poi + 1);
 					np1 = glyphOutline.point(poi + 3);
 					np2 = glyphOutline.point(poi + 2);
-					FontDesc += ToStr(np.x()) + " " + ToStr(-np.y()) + " " +
-							ToStr(np1.x()) + " " + ToStr(-np1.y()) + " " +
-							ToStr(np2.x()) + " " + ToStr(-np2.y()) + " cu\n";
+					cs << np.x() << -np.y() << np1.x() << -np1.y() << np2.x() << -np2.y() << "cu\n";
 				}
 			}
-			FontDesc += "cl\n} bind def\n";
+			cs << "cl\n} bind def\n";
+			FontDesc += QString::fromLatin1(glyphDesc);
 		}
 		FontDesc += "end\n";
 		FontSubsetMap.insert(face.scName(), encodedName);
@@ -491,8 +493,7 @@ void PSLib::WriteASCII85Bytes(const unsigned char* array, int length)
 
 QString PSLib::ToStr(double c) const
 {
-	QString cc;
-	return cc.setNum(c);
+	return QString::fromLatin1(ScContentStream::number(c, numberDecimals));
 }
 
 QString PSLib::IToStr(int c) const
@@ -503,8 +504,10 @@ QString PSLib::IToStr(int c) const
 
 QString PSLib::MatrixToStr(double m11, double m12, double m21, double m22, double x, double y) const
 {
-	QString cc("[%1 %2 %3 %4 %5 %6]");
-	return  cc.arg(m11).arg(m12).arg(m21).arg(m22).arg(x).arg(y);
+	QByteArray cc("[");
+	ScContentStream(cc, numberDecimals) << m11 << m12 << m21 << m22 << x << y;
+	cc[cc.size() - 1] = ']';
+	return QString::fromLatin1(cc);
 }
 
 void PSLib::PS_set_Info(const QString& art, const QString& was)
@@ -1030,17 +1033,23 @@ void PSLib::PS_end_page()
 
 void PSLib::PS_curve(double x1, double y1, double x2, double y2, double x3, double y3)
 {
-	PutStream(ToStr(x1) + " " + ToStr(y1) + " " + ToStr(x2) + " " + ToStr(y2) + " " + ToStr(x3) + " " + ToStr(y3) + " cu\n");
+	m_streamBuffer.resize(0);
+	ScContentStream(m_streamBuffer, numberDecimals) << x1 << y1 << x2 << y2 << x3 << y3 << "cu\n";
+	PutStream(m_streamBuffer, false);
 }
 
 void PSLib::PS_moveto(double x, double y)
 {
-	PutStream(ToStr(x) + " " + ToStr(y) + " m\n");
+	m_streamBuffer.resize(0);
+	ScContentStream(m_streamBuffer, numberDecimals) << x << y << "m\n";
+	PutStream(m_streamBuffer, false);
 }
 
 void PSLib::PS_lineto(double x, double y)
 {
-	PutStream(ToStr(x) + " " + ToStr(y) + " li\n");
+	m_streamBuffer.resize(0);
+	ScContentStream(m_streamBuffer, numberDecimals) << x << y << "li\n";
+	PutStream(m_streamBuffer, false);
 }
 
 void PSLib::PS_closepath()
@@ -4247,40 +4256,12 @@ void PSLib::GetBleeds(ScPage* page, double& left, double& right, double& bottom,
 
 void PSLib::SetClipPath(const FPointArray &points, bool poly)
 {
-	FPoint np, np1, np2, np3, np4, firstP;
-	bool nPath = true;
-	bool first = true;
 	if (points.size() <= 3)
 		return;
-
-	for (int poi=0; poi < points.size() - 3; poi += 4)
-	{
-		if (points.isMarker(poi))
-		{
-			nPath = true;
-			continue;
-		}
-		if (nPath)
-		{
-			np = points.point(poi);
-			if ((!first) && (poly) && (np4 == firstP))
-				PS_closepath();
-			PS_moveto(np.x(), -np.y());
-			nPath = false;
-			first = false;
-			firstP = np;
-			np4 = np;
-		}
-		np = points.point(poi);
-		np1 = points.point(poi + 1);
-		np2 = points.point(poi + 3);
-		np3 = points.point(poi + 2);
-		if ((np == np1) && (np2 == np3))
-			PS_lineto(np3.x(), -np3.y());
-		else
-			PS_curve(np1.x(), -np1.y(), np2.x(), -np2.y(), np3.x(), -np3.y());
-		np4 = np3;
-	}
+	// The whole path is written at once, keeping the buffer for the next path
+	m_streamBuffer.resize(0);
+	ScContentStream(m_streamBuffer, numberDecimals).appendPath(points, ScContentStream::postScriptOperators, poly);
+	PutStream(m_streamBuffer, false);
 }
 
 void PSLib::SetPathAndClip(const FPointArray &path, bool clipRule)
@@ -72,6 +72,9 @@ class SCRIBUS_API PSLib : public QObject
 			OutputEPS = 1
 		};
 
+		/// Digits after the decimal point of numbers in the output
+		static const int numberDecimals = 5;
+
 		PSLib(ScribusDoc* doc, PrintOptions &options, OutputFormat outputFmt, ColorList *docColors = nullptr);
 		virtual ~PSLib();
 
@@ -191,6 +194,8 @@ class SCRIBUS_API PSLib : public QObject
 		QMap<QString, QString> FontSubsetMap;
 		QFile Spool;
 		QDataStream spoolStream;
+		/// Scratch buffer of path operators, reserved once so that clearing it keeps its memory
+		QByteArray m_streamBuffer;
 		int  Plate { -1 };
 		bool DoSep { false };
 		bool fillRule { true };
@@ -0,0 +1,222 @@
+/*
+For general Scribus (>=1.3.2) copyright and licensing information please refer
+to the COPYING file provided with the program. Following this notice may exist
+a copyright and/or license notice that predates the release of Scribus 1.3.2
+for which a new license (GPL+exception) is in place.
+*/
+
+#include "scblobstore.h"
+
+#include <QCryptographicHash>
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QPair>
+#include <QRegExp>
+
+namespace
+{
+	const char blobStoreMagic[] = "SCRIBUSBLOBS";
+	const int  blobStoreMagicLength = 12;
+	const quint32 blobStoreVersion = 1;
+
+	struct DeferredBlob
+	{
+		QSharedPointer<ScBlobStore> store;
+		QByteArray hash;
+	};
+
+	QMutex deferredMutex;
+	QHash<QString, DeferredBlob> deferredBlobs;
+}
+
+QString ScBlobStore::storePath(const QString& documentPath, const QString& storeName)
+{
+	if (storeName.isEmpty())
+		return storePath(documentPath);
+	// Only a file name is stored, the store always lies next to the document
+	return QDir(QFileInfo(documentPath).absolutePath()).filePath(QFileInfo(storeName).fileName());
+}
+
+QStringList ScBlobStore::storesOf(const QString& documentPath)
+{
+	QStringList stores;
+	if (QFile::exists(storePath(documentPath)))
+		stores.append(storePath(documentPath));
+	// Saves name their store after the temporary file, the document name followed by a number
+	QFileInfo documentInfo(documentPath);
+	QRegExp storeName(QRegExp::escape(documentInfo.fileName()) + "\\.\\d+\\.blobs");
+	const QStringList entries = documentInfo.absoluteDir().entryList(QStringList() << documentInfo.fileName() + ".*.blobs", QDir::Files);
+	for (const QString& entry : entries)
+	{
+		if (storeName.exactMatch(entry))
+			stores.append(storePath(documentPath, entry));
+	}
+	return stores;
+}
+
+QSharedPointer<ScBlobStore> ScBlobStore::open(const QString& fileName)
+{
+	QSharedPointer<ScBlobStore> store;
+	QFile file(fileName);
+	if (!file.open(QIODevice::ReadOnly))
+		return store;
+	if (file.read(blobStoreMagicLength) != QByteArray(blobStoreMagic))
+		return store;
+
+	QDataStream ds(&file);
+	quint32 version = 0;
+	quint64 indexOffset = 0;
+	ds >> version >> indexOffset;
+	if (version != blobStoreVersion || !file.seek(indexOffset))
+		return store;
+
+	store.reset(new ScBlobStore());
+	store->m_fileName = fileName;
+	quint32 count = 0;
+	ds >> count;
+	for (quint32 i = 0; i < count && ds.status() == QDataStream::Ok; ++i)
+	{
+		QByteArray hash;
+		quint64 offset = 0;
+		quint64 length = 0;
+		ds >> hash >> offset >> length;
+		Entry entry;
+		entry.offset = offset;
+		entry.length = length;
+		store->m_entries.insert(hash, entry);
+	}
+	if (ds.status() != QDataStream::Ok)
+		store.reset();
+	return store;
+}
+
+bool ScBlobStore::read(const QByteArray& hash, QByteArray& data) const
+{
+	auto it = m_entries.constFind(hash);
+	if (it == m_entries.constEnd())
+		return false;
+	QFile file(m_fileName);
+	if (!file.open(QIODevice::ReadOnly) || !file.seek(it->offset))
+		return false;
+	QByteArray compressed = file.read(it->length);
+	if (compressed.size() != it->length)
+		return false;
+	data = qUncompress(compressed);
+	return !data.isEmpty();
+}
+
+void ScBlobStore::defer(const QString& targetPath, const QSharedPointer<ScBlobStore>& store, const QByteArray& hash)
+{
+	DeferredBlob blob;
+	blob.store = store;
+	blob.hash = hash;
+	QMutexLocker locker(&deferredMutex);
+	deferredBlobs.insert(targetPath, blob);
+}
+
+bool ScBlobStore::materialize(const QString& path)
+{
+	DeferredBlob blob;
+	{
+		QMutexLocker locker(&deferredMutex);
+		if (deferredBlobs.isEmpty())
+			return true;
+		auto it = deferredBlobs.constFind(path);
+		if (it == deferredBlobs.constEnd())
+			return true;
+		blob = it.value();
+	}
+
+	// The payload stays deferred on errors, so that later calls fail again
+	// instead of handing out the empty target file
+	QByteArray data;
+	if (!blob.store->read(blob.hash, data))
+		return false;
+	QFile outFile(path);
+	if (!outFile.open(QIODevice::WriteOnly))
+		return false;
+	bool success = (outFile.write(data) == data.size());
+	outFile.close();
+	if (success)
+	{
+		QMutexLocker locker(&deferredMutex);
+		deferredBlobs.remove(path);
+	}
+	return success;
+}
+
+void ScBlobStore::materializeAll(const QString& storeFileName)
+{
+	QStringList paths;
+	{
+		QMutexLocker locker(&deferredMutex);
+		for (auto it = deferredBlobs.constBegin(); it != deferredBlobs.constEnd(); ++it)
+		{
+			if (it.value().store->m_fileName == storeFileName)
+				paths.append(it.key());
+		}
+	}
+	for (const QString& path : qAsConst(paths))
+		materialize(path);
+}
+
+void ScBlobStore::discard(const QString& path)
+{
+	QMutexLocker locker(&deferredMutex);
+	deferredBlobs.remove(path);
+}
+
+ScBlobStoreWriter::~ScBlobStoreWriter()
+{
+	if (m_file.isOpen())
+		m_file.close();
+}
+
+bool ScBlobStoreWriter::open(const QString& fileName)
+{
+	m_entries.clear();
+	m_order.clear();
+	m_file.setFileName(fileName);
+	if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+		return false;
+	m_file.write(blobStoreMagic, blobStoreMagicLength);
+	QDataStream ds(&m_file);
+	// The index offset is patched in close()
+	ds << blobStoreVersion << quint64(0);
+	return (ds.status() == QDataStream::Ok);
+}
+
+QByteArray ScBlobStoreWriter::add(const QByteArray& data)
+{
+	QByteArray hash = QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex();
+	if (m_entries.contains(hash))
+		return hash;
+	QByteArray compressed = qCompress(data);
+	qint64 offset = m_file.pos();
+	m_file.write(compressed);
+	m_entries.insert(hash, qMakePair(offset, qint64(compressed.size())));
+	m_order.append(hash);
+	return hash;
+}
+
+bool ScBlobStoreWriter::close()
+{
+	if (!m_file.isOpen())
+		return false;
+	qint64 indexOffset = m_file.pos();
+	QDataStream ds(&m_file);
+	ds << quint32(m_order.count());
+	for (const QByteArray& hash : qAsConst(m_order))
+	{
+		const QPair<qint64, qint64>& entry = m_entries[hash];
+		ds << hash << quint64(entry.first) << quint64(entry.second);
+	}
+	m_file.seek(blobStoreMagicLength + sizeof(quint32));
+	ds << quint64(indexOffset);
+	bool success = (ds.status() == QDataStream::Ok) && (m_file.error() == QFile::NoError);
+	m_file.close();
+	return success;
+}
@@ -0,0 +1,103 @@
+/*
+For general Scribus (>=1.3.2) copyright and licensing information please refer
+to the COPYING file provided with the program. Following this notice may exist
+a copyright and/or license notice that predates the release of Scribus 1.3.2
+for which a new license (GPL+exception) is in place.
+*/
+
+#ifndef SCBLOBSTORE_H
+#define SCBLOBSTORE_H
+
+#include <QByteArray>
+#include <QFile>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QSharedPointer>
+#include <QString>
+#include <QStringList>
+
+#include "scribusapi.h"
+
+/**
+  * @brief Side store for the binary payloads of a document, such as inline images.
+  *
+  * Instead of embedding each payload in the XML as a base64 attribute, the
+  * document references it by the SHA-1 hash of its content and the data lives
+  * compressed in a separate file next to the document. Identical payloads are
+  * stored only once.
+  *
+  * File layout: the "SCRIBUSBLOBS" magic, a version and the offset of the
+  * index, followed by the compressed payloads and the index itself, which
+  * lists hash, offset and length of every payload.
+  *
+  * Each save writes a new store under its own name, which the document
+  * names in its BlobStore attribute. Replacing the document switches to
+  * the new store at once, the old store is only removed afterwards.
+  */
+class SCRIBUS_API ScBlobStore
+{
+public:
+	/// Path of the blob store belonging to a document file
+	static QString storePath(const QString& documentPath) { return documentPath + ".blobs"; }
+	/// Path of the blob store a document names, the default one if storeName is empty
+	static QString storePath(const QString& documentPath, const QString& storeName);
+	/// Paths of all blob stores saves of a document file may have left next to it
+	static QStringList storesOf(const QString& documentPath);
+
+	/// Opens a blob store for reading, only its index is loaded. Returns
+	/// a null pointer if the file does not exist or is not a blob store.
+	static QSharedPointer<ScBlobStore> open(const QString& fileName);
+
+	bool contains(const QByteArray& hash) const { return m_entries.contains(hash); }
+	/// Reads and uncompresses the payload with the given hash
+	bool read(const QByteArray& hash, QByteArray& data) const;
+
+	/**
+	 * Defers writing the payload with the given hash to targetPath until
+	 * materialize() is called for that path, so that a document can be
+	 * opened without reading payloads nobody asks for.
+	 */
+	static void defer(const QString& targetPath, const QSharedPointer<ScBlobStore>& store, const QByteArray& hash);
+	/// Writes the deferred payload of path, if any. Returns false if the store
+	/// is missing or truncated or the target cannot be written.
+	static bool materialize(const QString& path);
+	/// Writes all deferred payloads of the given store file, before it gets replaced
+	static void materializeAll(const QString& storeFileName);
+	/// Forgets a deferred payload whose target is not needed anymore
+	static void discard(const QString& path);
+
+private:
+	struct Entry
+	{
+		qint64 offset { 0 };
+		qint64 length { 0 };
+	};
+
+	QString m_fileName;
+	QHash<QByteArray, Entry> m_entries;
+};
+
+/**
+  * @brief Writes a ScBlobStore file, payloads are added as the document is saved.
+  */
+class SCRIBUS_API ScBlobStoreWriter
+{
+public:
+	ScBlobStoreWriter() = default;
+	~ScBlobStoreWriter();
+
+	bool open(const QString& fileName);
+	/// Adds a payload unless an identical one was already added and returns its hash
+	QByteArray add(const QByteArray& data);
+	/// Writes the index and closes the file
+	bool close();
+	int count() const { return m_entries.count(); }
+
+private:
+	QFile m_file;
+	QHash<QByteArray, QPair<qint64, qint64> > m_entries;
+	QList<QByteArray> m_order;
+};
+
+#endif
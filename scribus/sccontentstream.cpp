@@ -0,0 +1,135 @@
+/*
+For general Scribus (>=1.3.2) copyright and licensing information please refer
+to the COPYING file provided with the program. Following this notice may exist
+a copyright and/or license notice that predates the release of Scribus 1.3.2
+for which a new license (GPL+exception) is in place.
+*/
+
+#include <cmath>
+
+#include <QTransform>
+
+#include "sccontentstream.h"
+#include "fpointarray.h"
+
+const ScContentStream::PathOperators ScContentStream::pdfOperators = { "m\n", "l\n", "c\n", "h\n" };
+const ScContentStream::PathOperators ScContentStream::postScriptOperators = { "m\n", "li\n", "cu\n", "cl\n" };
+
+static const double decimalScales[] = { 1.0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7, 1e8, 1e9 };
+static const qint64 integerScales[] = { 1, 10, 100, 1000, 10000, 100000, 1000000, 10000000, 100000000, 1000000000 };
+
+// Writes the digits of n backwards, ending at end, and returns the position of the first digit
+static char* writeDigits(char* end, quint64 n)
+{
+	do
+	{
+		*--end = char('0' + n % 10);
+		n /= 10;
+	} while (n != 0);
+	return end;
+}
+
+void ScContentStream::appendNumber(QByteArray& buffer, double value, int decimals)
+{
+	decimals = qBound(0, decimals, 9);
+	double scaled = value * decimalScales[decimals];
+	// Beyond 2^53 doubles are integers anyway, the test is false for NaN as well
+	if (!(std::fabs(scaled) < 9.0e15))
+	{
+		buffer += QByteArray::number(value, 'f', decimals);
+		return;
+	}
+	qint64 n = std::llround(scaled);
+	if (n == 0)
+	{
+		buffer += '0';
+		return;
+	}
+
+	char text[32];
+	char* end = text + sizeof(text);
+	char* pos = end;
+	quint64 magnitude = (n < 0) ? quint64(-n) : quint64(n);
+	quint64 integerPart = magnitude / integerScales[decimals];
+	quint64 fraction = magnitude % integerScales[decimals];
+	if (fraction != 0)
+	{
+		int digits = decimals;
+		while (fraction % 10 == 0)
+		{
+			fraction /= 10;
+			--digits;
+		}
+		char* first = writeDigits(pos, fraction);
+		// Leading zeros of the fraction
+		while (end - first < digits)
+			*--first = '0';
+		pos = first;
+		*--pos = '.';
+	}
+	pos = writeDigits(pos, integerPart);
+	if (n < 0)
+		*--pos = '-';
+	buffer.append(pos, int(end - pos));
+}
+
+QByteArray ScContentStream::number(double value, int decimals)
+{
+	QByteArray text;
+	appendNumber(text, value, decimals);
+	return text;
+}
+
+ScContentStream& ScContentStream::operator<<(int value)
+{
+	char text[16];
+	char* end = text + sizeof(text);
+	char* pos = writeDigits(end, (value < 0) ? quint64(-qint64(value)) : quint64(value));
+	if (value < 0)
+		*--pos = '-';
+	m_buffer.append(pos, int(end - pos));
+	m_buffer += ' ';
+	return *this;
+}
+
+ScContentStream& ScContentStream::operator<<(const QTransform& matrix)
+{
+	return *this << matrix.m11() << matrix.m12() << matrix.m21() << matrix.m22() << matrix.dx() << matrix.dy();
+}
+
+void ScContentStream::appendPath(const FPointArray& points, const PathOperators& ops, bool closeSubpaths)
+{
+	if (points.size() <= 3)
+		return;
+	FPoint np, np1, np2, np3, np4, firstP;
+	bool nPath = true;
+	bool first = true;
+	for (int poi = 0; poi < points.size() - 3; poi += 4)
+	{
+		if (points.isMarker(poi))
+		{
+			nPath = true;
+			continue;
+		}
+		if (nPath)
+		{
+			np = points.point(poi);
+			if ((!first) && (closeSubpaths) && (np4 == firstP))
+				*this << ops.closePath;
+			*this << np.x() << -np.y() << ops.moveTo;
+			nPath = false;
+			first = false;
+			firstP = np;
+			np4 = np;
+		}
+		np = points.point(poi);
+		np1 = points.point(poi + 1);
+		np2 = points.point(poi + 3);
+		np3 = points.point(poi + 2);
+		if ((np == np1) && (np2 == np3))
+			*this << np3.x() << -np3.y() << ops.lineTo;
+		else
+			*this << np1.x() << -np1.y() << np2.x() << -np2.y() << np3.x() << -np3.y() << ops.curveTo;
+		np4 = np3;
+	}
+}
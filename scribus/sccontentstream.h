@@ -0,0 +1,79 @@
+/*
+For general Scribus (>=1.3.2) copyright and licensing information please refer
+to the COPYING file provided with the program. Following this notice may exist
+a copyright and/or license notice that predates the release of Scribus 1.3.2
+for which a new license (GPL+exception) is in place.
+*/
+#ifndef SCCONTENTSTREAM_H
+#define SCCONTENTSTREAM_H
+
+#include <QByteArray>
+
+#include "scribusapi.h"
+
+class FPointArray;
+class QTransform;
+
+/**
+  Builder for PDF and PostScript content streams.
+
+  Numbers are written locale independent in fixed point notation with
+  trailing zeros dropped, straight into the buffer the builder appends to,
+  so that writing paths and matrices does not allocate a temporary string
+  for each number.
+
+  Numbers are followed by a space, operators are written as given:
+  @code
+  ScContentStream cs(buffer);
+  cs << x << -y << "m\n";
+  @endcode
+ */
+class SCRIBUS_API ScContentStream
+{
+public:
+	/// Operators used by appendPath()
+	struct PathOperators
+	{
+		const char* moveTo;
+		const char* lineTo;
+		const char* curveTo;
+		const char* closePath;
+	};
+	static const PathOperators pdfOperators;
+	static const PathOperators postScriptOperators;
+
+	explicit ScContentStream(QByteArray& buffer, int decimals = 5) : m_buffer(buffer), m_decimals(decimals) {}
+
+	/**
+	 * Appends value rounded to at most decimals digits after the decimal
+	 * point, decimals being 0 to 9, without trailing zeros. Values rounding
+	 * to zero are written as "0". Values too large for fixed point output
+	 * and non finite values are formatted by QByteArray::number().
+	 */
+	static void appendNumber(QByteArray& buffer, double value, int decimals = 5);
+	/// Returns value formatted as by appendNumber()
+	static QByteArray number(double value, int decimals = 5);
+
+	ScContentStream& operator<<(double value) { appendNumber(m_buffer, value, m_decimals); m_buffer += ' '; return *this; }
+	ScContentStream& operator<<(int value);
+	ScContentStream& operator<<(const char* str) { m_buffer += str; return *this; }
+	ScContentStream& operator<<(const QByteArray& str) { m_buffer += str; return *this; }
+	/// Appends the six values m11 m12 m21 m22 dx dy of matrix
+	ScContentStream& operator<<(const QTransform& matrix);
+
+	/**
+	 * Appends points as a path with the y axis flipped. Subpaths ending at
+	 * their start point are closed if closeSubpaths is true, except for the
+	 * last one which is left to the caller.
+	 */
+	void appendPath(const FPointArray& points, const PathOperators& ops, bool closeSubpaths = true);
+
+	QByteArray& buffer() { return m_buffer; }
+	int decimals() const { return m_decimals; }
+
+private:
+	QByteArray& m_buffer;
+	int m_decimals;
+};
+
+#endif
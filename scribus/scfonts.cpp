@@ -33,6 +33,7 @@ for which a new license (GPL+exception) is in place.
 #endif
 #include <QString>
 #include <QTextCodec>
+#include <QVector>
 
 #include <cstdlib>
 #include <vector>
@@ -50,6 +51,7 @@ for which a new license (GPL+exception) is in place.
 
 #include "scribuscore.h"
 #include "scribusdoc.h"
+#include "util_parallel.h"
 #ifdef Q_OS_LINUX
 #include <X11/X.h>
 #include <X11/Xlib.h>
@@ -87,6 +89,7 @@ SCFonts::SCFonts()
 
 void SCFonts::updateFontMap()
 {
+	++m_generation;
 	fontMap.clear();
 	SCFontsIterator it( *this );
 	for ( ; it.hasNext(); it.next())
@@ -124,16 +127,19 @@ void SCFonts::addPath(QString p)
 }
 
 void SCFonts::addScalableFonts(const QString &path, const QString& DocName)
+{
+	QList<FontFile> files;
+	collectFontFiles(path, files, !DocName.isEmpty());
+	addFontFiles(files, DocName);
+}
+
+void SCFonts::collectFontFiles(const QString &path, QList<FontFile>& files, bool forDocument)
 {
 	//Make sure this is not empty or we will scan the whole drive on *nix
 	//QString()+/ is / of course.
 	if (path.isEmpty())
 		return;
-	FT_Library library = nullptr;
 	QString pathfile, fullpath;
-//	bool error;
-//	error =
-	FT_Init_FreeType( &library );
 	QString pathname(path);
 	if ( !pathname.endsWith("/") )
 		pathname += "/";
@@ -141,6 +147,8 @@ void SCFonts::addScalableFonts(const QString &path, const QString& DocName)
 	QDir d(pathname, "*", QDir::Name, QDir::Dirs | QDir::Files | QDir::Readable);
 	if ((d.exists()) && (d.count() != 0))
 	{
+		QCoreApplication::processEvents();
+
 		for (uint i = 0; i < d.count(); ++i)
 		{
 			// readdir may return . or .., which we don't want to recurse
@@ -152,8 +160,6 @@ void SCFonts::addScalableFonts(const QString &path, const QString& DocName)
 			if (!fi.exists())      // Sanity check for broken Symlinks
 				continue;
 			
-			QCoreApplication::processEvents();
-			
 			bool symlink = fi.isSymLink();
 			if (symlink)
 			{
@@ -182,8 +188,8 @@ void SCFonts::addScalableFonts(const QString &path, const QString& DocName)
 					if (fullpath2.startsWith(pathfile2))
 						continue;
 				}
-				if (DocName.isEmpty())
-					addScalableFonts(pathfile);
+				if (!forDocument)
+					collectFontFiles(pathfile, files, forDocument);
 				continue;
 			}
 			QString ext = fi.suffix().toLower();
@@ -192,19 +198,16 @@ void SCFonts::addScalableFonts(const QString &path, const QString& DocName)
 				ext = ext2;
 			if ((ext == "ttc") || (ext == "dfont") || (ext == "pfa") || (ext == "pfb") || (ext == "ttf") || (ext == "otf"))
 			{
-				addScalableFont(pathfile, library, DocName);
+				files.append({ pathfile, QString() });
 			}
 #ifdef Q_OS_MAC
-			else if (ext.isEmpty() && DocName.isEmpty())
+			else if (ext.isEmpty() && !forDocument)
 			{
-				bool error = addScalableFont(pathfile, library, DocName);
-				if (error)
-					error = addScalableFont(pathfile + "/..namedfork/rsrc",library, DocName);
+				files.append({ pathfile, pathfile + "/..namedfork/rsrc" });
 			}
 #endif				
 		}
 	}
-	FT_Done_FreeType(library);
 }
 
 
@@ -558,8 +561,8 @@ ScFace SCFonts::loadScalableFont(const QString &filename)
 		charcode = FT_Get_Next_Char(face, charcode, &gindex);
 	}
 
-	// Warning: code below is also present in addScalableFont, so if you do
-	// any modification here, think also about modifying code in addScalableFont
+	// Warning: code below is also present in probeFontFile, so if you do
+	// any modification here, think also about modifying code in probeFontFile
 	int faceIndex = 0;
 	QString fam(getFamilyName(face));
 	QStringList features(getFontFeatures(face));
@@ -631,91 +634,97 @@ ScFace SCFonts::loadScalableFont(const QString &filename)
 
 static QString getFtError(int code)
 {
+	// Filled once, fonts are checked from several threads at a time
+	static const QHash<int, QString> ftErrors = []()
+	{
+		QHash<int, QString> errors;
 #undef FTERRORS_H_
-#define FT_ERRORDEF(e, v, s) ftErrors[e] = s;
-	static QHash<int, QString> ftErrors;
+#define FT_ERRORDEF(e, v, s) errors[e] = s;
 #include FT_ERRORS_H
 #undef FT_ERRORDEF
+		return errors;
+	}();
 
-	if (ftErrors.contains(code))
-		return ftErrors.value(code);
-	return QString();
+	return ftErrors.value(code);
 }
 
-// Load a single font into the library from the passed filename. Returns true on error.
-bool SCFonts::addScalableFont(const QString& filename, FT_Library &library, const QString& DocName)
+static QString getStyleName(const FT_Face face)
 {
-	static bool firstRun;
-	bool Subset = false;
-	char buf[128];
-	QString glyName = "";
-	ScFace::FontFormat format;
-	ScFace::FontType   type;
-	FT_Face         face = nullptr;
-	struct testCache foCache;
-	QFileInfo fic(filename);
-	QDateTime lastMod = fic.lastModified();
-	QTime lastModTime = lastMod.time();
-	if (lastModTime.msec() != 0)  //Sometime file time is stored with precision up to msecs
-	{
-		lastModTime.setHMS(lastModTime.hour(), lastModTime.minute(), lastModTime.second());
-		lastMod.setTime(lastModTime);
-	}
-	foCache.isOK = false;
-	foCache.isChecked = true;
-	foCache.lastMod = lastMod;
-	if (m_checkedFonts.count() == 0)
+	QString sty(face->style_name);
+	if ((sty == "Regular" && face->style_flags != 0) || sty.isEmpty())
 	{
-		firstRun = true;
-		ScCore->setSplashStatus( QObject::tr("Creating Font Cache") );
+		switch (face->style_flags)
+		{
+			case 0:
+				sty = "Regular";
+				break;
+			case 1:
+				sty = "Italic";
+				break;
+			case 2:
+				sty = "Bold";
+				break;
+			case 3:
+				sty = "Bold Italic";
+				break;
+			default:
+				break;
+		}
 	}
+	return sty;
+}
+
+/**
+ * Opens a font file and reads everything needed to create its faces into entry.
+ * The glyphs are only loaded one by one if checkGlyphs is set. As this only uses
+ * the passed library, it may run in several threads at once with a library each.
+ */
+static void probeFontFile(const QString& filename, FT_Library library, bool checkGlyphs, ScFontIndexEntry& entry)
+{
+	entry.isOK = false;
+	entry.facesKnown = true;
+	entry.error.clear();
+	entry.faces.clear();
+
+	FT_Face face = nullptr;
 	FT_Error error = FT_New_Face( library, QFile::encodeName(filename), 0, &face );
 	if (error || (face == nullptr))
 	{
 		if (face != nullptr)
 			FT_Done_Face(face);
-		m_checkedFonts.insert(filename, foCache);
-		addRejectedFont(filename, QObject::tr("Font is broken: \"%1\"").arg(getFtError(error)));
-		if (m_showFontInfo)
-			sDebug(QObject::tr("Font %1 is broken, discarding it. Error message: \"%2\"").arg(filename, getFtError(error)));
-		return true;
+		entry.error = QObject::tr("Font is broken: \"%1\"").arg(getFtError(error));
+		return;
 	}
 	if (face->family_name == nullptr)
 	{
-		addRejectedFont(filename, QObject::tr("Failed to load font: font family unspecified"));
-		if (m_showFontInfo)
-			sDebug(QObject::tr("Failed to load font %1 - font family unspecified").arg(filename));
+		entry.error = QObject::tr("Failed to load font: font family unspecified");
 		FT_Done_Face(face);
-		m_checkedFonts.insert(filename, foCache);
-		return true;
+		return;
 	}
+	ScFace::FontFormat format;
+	ScFace::FontType   type;
 	getFontFormat(face, format, type);
 	if (format == ScFace::UNKNOWN_FORMAT) 
 	{
-		addRejectedFont(filename, QObject::tr("Failed to load font: font type unknown"));
-		if (m_showFontInfo)
-			sDebug(QObject::tr("Failed to load font %1 - font type unknown").arg(filename));
+		entry.error = QObject::tr("Failed to load font: font type unknown");
 		FT_Done_Face(face);
-		m_checkedFonts.insert(filename, foCache);
-		return true;
+		return;
 	}
 	// Some fonts such as Noto ColorEmoji are in fact bitmap fonts
 	// and do not provide a valid value for units_per_EM
 	if (face->units_per_EM == 0)
 	{
-		addRejectedFont(filename, QObject::tr("Failed to load font: font is not scalable"));
-		if (m_showFontInfo)
-			sDebug(QObject::tr("Failed to load font %1 - font is not scalable").arg(filename));
+		entry.error = QObject::tr("Failed to load font: font is not scalable");
 		FT_Done_Face(face);
-		m_checkedFonts.insert(filename, foCache);
-		return true;
+		return;
 	}
 	bool HasNames = FT_HAS_GLYPH_NAMES(face);
+	bool Subset = false;
 
-	if (!m_checkedFonts.contains(filename))
+	if (checkGlyphs)
 	{
-		if (!firstRun)
-			ScCore->setSplashStatus( QObject::tr("New Font found, checking...") );
+		char buf[128];
+		QString glyName = "";
 		FT_UInt gindex = 0;
 		FT_ULong charcode = FT_Get_First_Char( face, &gindex );
 		while ( gindex != 0 )
@@ -723,17 +732,13 @@ bool SCFonts::addScalableFont(const QString& filename, FT_Library &library, cons
 			error = FT_Load_Glyph(face, gindex, FT_LOAD_NO_SCALE | FT_LOAD_NO_BITMAP);
 			if (error)
 			{
-				auto errorMessage = QObject::tr("Font %1 has broken glyph %2 (charcode U+%3). Error message: \"%4\"")
+				entry.error = QObject::tr("Font %1 has broken glyph %2 (charcode U+%3). Error message: \"%4\"")
 							   .arg(filename)
 							   .arg(gindex)
 							   .arg(charcode, 4, 16, QChar('0'))
 							   .arg(getFtError(error));
-				addRejectedFont(filename, errorMessage);
-				if (m_showFontInfo)
-					sDebug(errorMessage);
 				FT_Done_Face(face);
-				m_checkedFonts.insert(filename, foCache);
-				return true;
+				return;
 			}
 			FT_Get_Glyph_Name(face, gindex, buf, 128);
 			QString newName(buf);
@@ -745,97 +750,134 @@ bool SCFonts::addScalableFont(const QString& filename, FT_Library &library, cons
 			glyName = newName;
 			charcode = FT_Get_Next_Char( face, charcode, &gindex );
 		}
-		foCache.isOK = true;
-		m_checkedFonts.insert(filename, foCache);
 	}
-	else
+	entry.isOK = true;
+	entry.format = format;
+
+	// Warning: code below is also present in loadScalableFont, so if you do
+	// any modification here, think also about modifying code in loadScalableFont
+	int faceIndex = 0;
+	while (!error)
 	{
-		auto& checkedFont = m_checkedFonts[filename];
-		if (!checkedFont.isOK)
-		{
-			checkedFont.isChecked = true;
-			FT_Done_Face(face);
-			return true;
-		}
-		if (checkedFont.lastMod != foCache.lastMod)
+		ScFontIndexFace faceInfo;
+		faceInfo.family = getFamilyName(face);
+		faceInfo.features = getFontFeatures(face);
+		faceInfo.style = getStyleName(face);
+		const char* psName = FT_Get_Postscript_Name(face);
+		if (psName)
+			faceInfo.psName = QString(psName);
+		else if (faceInfo.style.isEmpty())
+			faceInfo.psName = faceInfo.family;
+		else
+			faceInfo.psName = faceInfo.family + " " + faceInfo.style;
+		faceInfo.faceIndex = faceIndex;
+		ScFace::FontType subType = (format == ScFace::TTCF) ? ScFace::TTF : ScFace::UNKNOWN_TYPE;
+		if ((format == ScFace::SFNT) || (format == ScFace::TTCF) || (format == ScFace::TYPE42))
+			getSubFontType(face, subType);
+		faceInfo.type = subType;
+		faceInfo.hasGlyphNames = HasNames;
+		faceInfo.subset = Subset || (face->num_glyphs > 2048);
+		entry.faces.append(faceInfo);
+
+		if ((++faceIndex) >= face->num_faces)
+			break;
+		FT_Done_Face(face);
+		face = nullptr;
+		error = FT_New_Face(library, QFile::encodeName(filename), faceIndex, &face);
+	}
+
+	if (face != nullptr)
+		FT_Done_Face(face);
+}
+
+void SCFonts::addFontFiles(const QList<FontFile>& files, const QString& DocName)
+{
+	// Look up all files first, only those missing from the index have to be opened
+	QVector<ScFontIndexEntry> entries(files.count());
+	QVector<int> toProbe;
+	QVector<bool> checkGlyphs;
+	for (int i = 0; i < files.count(); ++i)
+	{
+		const QString& filename = files.at(i).path;
+		QFileInfo fi(filename);
+		qint64 size = fi.size();
+		qint64 modified = fi.lastModified().toSecsSinceEpoch();
+		const ScFontIndexEntry* cached = m_fontIndex.find(filename, size, modified);
+		m_checkedFonts.insert(filename);
+		// Fonts known to be broken and known faces are taken from the index,
+		// fonts checked by older versions only need their faces read again
+		if (cached && (cached->facesKnown || !cached->isOK))
 		{
-			ScCore->setSplashStatus( QObject::tr("Modified Font found, checking...") );
-			FT_UInt gindex = 0;
-			FT_ULong charcode = FT_Get_First_Char( face, &gindex );
-			while ( gindex != 0 )
-			{
-				error = FT_Load_Glyph(face, gindex, FT_LOAD_NO_SCALE | FT_LOAD_NO_BITMAP);
-				if (error)
-				{
-					auto errorMessage = QObject::tr("Font %1 has broken glyph %2 (charcode U+%3). Error message: \"%4\"")
-								   .arg(filename)
-								   .arg(gindex)
-								   .arg(charcode, 4, 16, QChar('0'))
-								   .arg(getFtError(error));
-					addRejectedFont(filename, errorMessage);
-					if (m_showFontInfo)
-						sDebug(errorMessage);
-					FT_Done_Face(face);
-					m_checkedFonts.insert(filename, foCache);
-					return true;
-				}
-				FT_Get_Glyph_Name(face, gindex, buf, 128);
-				QString newName(buf);
-				if (newName == glyName)
-				{
-					HasNames = false;
-					Subset = true;
-				}
-				glyName = newName;
-				charcode = FT_Get_Next_Char( face, charcode, &gindex );
-			}
-			foCache.isOK = true;
-			checkedFont = foCache;
+			entries[i] = *cached;
+			continue;
 		}
+		entries[i].size = size;
+		entries[i].modified = modified;
+		toProbe.append(i);
+		checkGlyphs.append(cached == nullptr);
+	}
+
+	if (!toProbe.isEmpty())
+	{
+		if (m_fontIndex.isEmpty())
+			ScCore->setSplashStatus( QObject::tr("Creating Font Cache") );
 		else
+			ScCore->setSplashStatus( QObject::tr("New Font found, checking...") );
+		// FreeType libraries must not be shared between threads, so every worker gets one
+		int workers = qMin(toProbe.count(), parallelThreadCount());
+		ScFontIndexEntry* probed = entries.data();
+		parallelFor(workers, [&](int worker)
 		{
-			checkedFont.isOK = true;
-			checkedFont.isChecked = true;
+			FT_Library library = nullptr;
+			if (FT_Init_FreeType( &library ))
+				return;
+			for (int j = worker; j < toProbe.count(); j += workers)
+				probeFontFile(files.at(toProbe.at(j)).path, library, checkGlyphs.at(j), probed[toProbe.at(j)]);
+			FT_Done_FreeType(library);
+		}, workers);
+		for (int i : qAsConst(toProbe))
+		{
+			// Files stay unknown if FreeType could not be initialized for them
+			if (entries.at(i).facesKnown)
+				m_fontIndex.insert(files.at(i).path, entries.at(i));
 		}
 	}
 
-	// Warning: code below is also present in loadScalableFont, so if you do
-	// any modification here, think also about modifying code in loadScalableFont
-	int faceIndex = 0;
-	while (!error)
+	// Faces are added in the order of the files, so that the same fonts win duplicates as before
+	for (int i = 0; i < files.count(); ++i)
+	{
+		bool error = addScalableFont(files.at(i).path, entries.at(i), DocName);
+		if (error && !files.at(i).fallbackPath.isEmpty())
+			addFontFiles({ { files.at(i).fallbackPath, QString() } }, DocName);
+	}
+	++m_generation;
+}
+
+// Load the checked faces of a single font file into the library. Returns true on error.
+bool SCFonts::addScalableFont(const QString& filename, const ScFontIndexEntry& entry, const QString& DocName)
+{
+	if (!entry.isOK)
 	{
-		QString fam(getFamilyName(face));
-		QStringList features(getFontFeatures(face));
-		QString sty(face->style_name);
-		if ((sty == "Regular" && face->style_flags != 0) || sty.isEmpty())
+		// Fonts which failed a check of older versions come without a message
+		if (!entry.error.isEmpty())
 		{
-			switch (face->style_flags)
-			{
-				case 0:
-					sty = "Regular";
-					break;
-				case 1:
-					sty = "Italic";
-					break;
-				case 2:
-					sty = "Bold";
-					break;
-				case 3:
-					sty = "Bold Italic";
-					break;
-				default:
-					break;
-			}
+			addRejectedFont(filename, entry.error);
+			if (m_showFontInfo)
+				sDebug(entry.error);
 		}
+		return true;
+	}
+
+	for (const ScFontIndexFace& faceInfo : entry.faces)
+	{
+		int faceIndex = faceInfo.faceIndex;
+		QString fam(faceInfo.family);
+		QString sty(faceInfo.style);
+		const QStringList& features = faceInfo.features;
 		QString fullName(fam);
 		if (!sty.isEmpty())
 			fullName += " " + sty;
-		const char* psName = FT_Get_Postscript_Name(face);
-		QString qpsName;
-		if (psName)
-			qpsName = QString(psName);
-		else
-			qpsName = fullName;
+		const QString& qpsName = faceInfo.psName;
 		ScFace t;
 		if (contains(fullName))
 		{
@@ -850,59 +892,38 @@ bool SCFonts::addScalableFont(const QString& filename, FT_Library &library, cons
 		t = (*this)[fullName];
 		if (t.isNone())
 		{
-			switch (format) 
+			switch (entry.format) 
 			{
 				case ScFace::PFA:
 					t = ScFace(new ScFace_PFA(fam, sty, "", fullName, qpsName, filename, faceIndex, features));
-					t.subset(Subset);
 					break;
 				case ScFace::PFB:
 					t = ScFace(new ScFace_PFB(fam, sty, "", fullName, qpsName, filename, faceIndex, features));
-					t.subset(Subset);
 					break;
 				case ScFace::SFNT:
+				case ScFace::TYPE42:
 					t = ScFace(new ScFace_ttf(fam, sty, "", fullName, qpsName, filename, faceIndex, features));
-					getSubFontType(face, t.m_m->typeCode);
-					t.subset(Subset);
+					t.m_m->typeCode = static_cast<ScFace::FontType>(faceInfo.type);
 					break;
 				case ScFace::TTCF:
 					t = ScFace(new ScFace_ttf(fam, sty, "", fullName, qpsName, filename, faceIndex, features));
 					t.m_m->formatCode = ScFace::TTCF;
-					t.m_m->typeCode = ScFace::TTF;
-					getSubFontType(face, t.m_m->typeCode);
-					t.subset(Subset);
-					break;
-				case ScFace::TYPE42:
-					t = ScFace(new ScFace_ttf(fam, sty, "", fullName, qpsName, filename, faceIndex, features));
-					getSubFontType(face, t.m_m->typeCode);
-					t.subset(Subset);
+					t.m_m->typeCode = static_cast<ScFace::FontType>(faceInfo.type);
 					break;
 				default:
 				/* catching any types not handled above to silence compiler */
 					break;
 			}
 			insert(fullName, t);
-			t.m_m->hasGlyphNames = HasNames;
+			t.m_m->hasGlyphNames = faceInfo.hasGlyphNames;
 			t.embedPs(true);
 			t.usable(true);
 			t.m_m->status = ScFace::UNKNOWN;
-			if (face->num_glyphs > 2048)
-				t.subset(true);
+			t.subset(faceInfo.subset);
 			t.m_m->forDocument = DocName;
 			//setBestEncoding(face); //AV
 			if (m_showFontInfo)
 				sDebug(QObject::tr("Font %1 loaded from %2(%3)").arg(t.psName(), filename).arg(faceIndex + 1));
-
-/*
-//debug
-			QByteArray bb;
-			t->rawData(bb);
-			QFile dump(QString("/tmp/fonts/%1-%2").arg(fullName, psName));
-			dump.open(IO_WriteOnly);
-			QDataStream os(&dump);
-			os.writeRawBytes(bb.data(), bb.size());
-			dump.close();
-*/
 		}
 		else 
 		{
@@ -913,16 +934,9 @@ bool SCFonts::addScalableFont(const QString& filename, FT_Library &library, cons
 				break;
 			}
 		}
-		if ((++faceIndex) >= face->num_faces)
-			break;
-		FT_Done_Face(face);
-		face = nullptr;
-		error = FT_New_Face(library, QFile::encodeName(filename), faceIndex, &face);
-	} //while
-	
-	if (face != nullptr)
-		FT_Done_Face(face);
-	return error && faceIndex == 0;
+	}
+
+	return entry.faces.isEmpty();
 }
 
 void SCFonts::removeFont(const QString& name)
@@ -949,6 +963,7 @@ const ScFace& SCFonts::findFont(const QString& fontname, ScribusDoc *doc)
 			replFont = prefsManager.appPrefs.fontPrefs.GFontSub[fontname];
 		ScFace repl = (*this)[replFont].mkReplacementFor(fontname, doc ? doc->documentFileName() : QString());
 		insert(fontname, repl);
+		++m_generation;
 	}
 	else if ( doc && !doc->UsedFonts.contains(fontname) )
 	{
@@ -989,6 +1004,7 @@ void SCFonts::setSubstitutions(const QMap<QString,QString>& substitutes, Scribus
 		if (font.isReplacement())
 		{
 			font.chReplacementTo(const_cast<ScFace&>(findFont(it.value(), doc)), doc->documentFileName());
+			++m_generation;
 		}
 	}
 }
@@ -996,7 +1012,7 @@ void SCFonts::setSubstitutions(const QMap<QString,QString>& substitutes, Scribus
 
 #ifdef HAVE_FONTCONFIG
 // Use Fontconfig to locate and load fonts.
-void SCFonts::addFontconfigFonts()
+void SCFonts::collectFontconfigFonts(QList<FontFile>& files)
 {
 	// All-in-one library setup. Perhaps this should be in
 	// the SCFonts constructor.
@@ -1012,7 +1028,7 @@ void SCFonts::addFontconfigFonts()
 	FcObjectSet* os = FcObjectSetBuild (FC_FILE, (char *) nullptr);
 	if (!os)
 	{
-		qFatal("SCFonts::addFontconfigFonts() FcObjectSet* os failed to build object set");
+		qFatal("SCFonts::collectFontconfigFonts() FcObjectSet* os failed to build object set");
 		return;
 	}
 	// Now ask fontconfig to retrieve info as specified in 'os' about fonts
@@ -1020,17 +1036,13 @@ void SCFonts::addFontconfigFonts()
 	FcFontSet* fs = FcFontList(config, pat, os);
 	if (!fs)
 	{
-		qFatal("SCFonts::addFontconfigFonts() FcFontSet* fs failed to create font list");
+		qFatal("SCFonts::collectFontconfigFonts() FcFontSet* fs failed to create font list");
 		return;
 	}
 	FcConfigDestroy(config);
 	FcObjectSetDestroy(os);
 	FcPatternDestroy(pat);
-	// Create the Freetype library
-//	bool error;
-	FT_Library library = nullptr;
-	FT_Init_FreeType( &library );
-	// Now iterate over the font files and load them
+	// Now iterate over the font files, they are loaded together with the others
 	for (int i = 0; i < fs->nfont; i++)
 	{
 		FcChar8 *file = nullptr;
@@ -1038,7 +1050,7 @@ void SCFonts::addFontconfigFonts()
 		{
 			if (m_showFontInfo)
 				sDebug(QObject::tr("Loading font %1 (found using fontconfig)").arg(QString((char*)file)));
-			addScalableFont(QString((char*)file), library, "");
+			files.append({ QString((char*)file), QString() });
 		}
 		else
 			if (m_showFontInfo)
@@ -1048,13 +1060,12 @@ void SCFonts::addFontconfigFonts()
 				sDebug(errorMessage);
 			}
 	}
-	FT_Done_FreeType(library);
 	FcFontSetDestroy(fs);
 }
 
 #elif defined(Q_OS_WIN32)
 
-void SCFonts::addRegistryFonts()
+void SCFonts::collectRegistryFonts(QList<FontFile>& files)
 {
 	const QStringList keys = { QStringLiteral("HKEY_LOCAL_MACHINE\\SOFTWARE\\Microsoft\\Windows NT\\CurrentVersion\\Fonts"),
 		                       QStringLiteral("HKEY_CURRENT_USER\\SOFTWARE\\Microsoft\\Windows NT\\CurrentVersion\\Fonts"),
@@ -1065,9 +1076,6 @@ void SCFonts::addRegistryFonts()
 	                         };
 	QSet<QString> foundFonts;
 
-	FT_Library library = nullptr;
-	FT_Init_FreeType( &library );
-
 	for (const auto key : keys)
 	{
 		const QSettings fontRegistry(key, QSettings::NativeFormat);
@@ -1111,15 +1119,13 @@ void SCFonts::addRegistryFonts()
 			if ((ext == "ttc") || (ext == "dfont") || (ext == "pfa") || (ext == "pfb") || (ext == "ttf") || (ext == "otf"))
 			{
 				foundFonts.insert(fontPath);
-				addScalableFont(fontPath, library, QString());
+				files.append({ fontPath, QString() });
 			}
 		}
 	}
-
-	FT_Done_FreeType(library);
 }
 
-void SCFonts::addType1RegistryFonts()
+void SCFonts::collectType1RegistryFonts(QList<FontFile>& files)
 {
 	const QStringList keys = { QStringLiteral("HKEY_LOCAL_MACHINE\\SOFTWARE\\Microsoft\\Windows NT\\CurrentVersion\\Type 1 Installer\\Type 1 Fonts"),
 		                       QStringLiteral("HKEY_CURRENT_USER\\SOFTWARE\\Microsoft\\Windows NT\\CurrentVersion\\Type 1 Installer\\Type 1 Fonts"),
@@ -1130,9 +1136,6 @@ void SCFonts::addType1RegistryFonts()
 	                         };
 	QSet<QString> foundFonts;
 
-	FT_Library library = nullptr;
-	FT_Init_FreeType( &library );
-
 	for (const auto key : keys)
 	{
 		const QSettings fontRegistry(key, QSettings::NativeFormat);
@@ -1188,14 +1191,12 @@ void SCFonts::addType1RegistryFonts()
 				if ((ext == "pfa") || (ext == "pfb"))
 				{
 					foundFonts.insert(fontPath);
-					addScalableFont(fontPath, library, QString());
+					files.append({ fontPath, QString() });
 					break;
 				}
 			}
 		}
 	}
-
-	FT_Done_FreeType(library);
 }
 
 #endif
@@ -1219,7 +1220,10 @@ void SCFonts::readFontCache(const QString& pf)
 	if (fir.exists())
 		fr.remove();
 	m_checkedFonts.clear();
-	struct testCache foCache;
+	if (m_fontIndex.read(ScFontIndex::fileName(pf)))
+		return;
+
+	// No font index yet, take over the fonts checked by older versions
 	QDomDocument docu("fontcacherc");
 	QFile f(pf + "/checkfonts150.xml");
 	if (!f.open(QIODevice::ReadOnly))
@@ -1244,10 +1248,10 @@ void SCFonts::readFontCache(const QString& pf)
 		QDomElement dc = DOC.toElement();
 		if (dc.tagName()=="Font")
 		{
-			foCache.isChecked = false;
+			ScFontIndexEntry foCache;
 			foCache.isOK = static_cast<bool>(dc.attribute("Status", "1").toInt());
-			foCache.lastMod = QDateTime::fromString(dc.attribute("Modified"), Qt::ISODate);
-			m_checkedFonts.insert(dc.attribute("File"), foCache);
+			foCache.modified = QDateTime::fromString(dc.attribute("Modified"), Qt::ISODate).toSecsSinceEpoch();
+			m_fontIndex.insert(dc.attribute("File"), foCache);
 		}
 		DOC = DOC.nextSibling();
 	}
@@ -1261,37 +1265,22 @@ void SCFonts::writeFontCache()
 
 void SCFonts::writeFontCache(const QString& pf)
 {
-	QDomDocument docu("fontcacherc");
-	QString st="<CachedFonts></CachedFonts>";
-
-	docu.setContent(st);
-	QDomElement elem = docu.documentElement();
-	for (auto it = m_checkedFonts.cbegin(); it != m_checkedFonts.cend(); ++it)
+	QStringList vanished;
+	const QHash<QString, ScFontIndexEntry>& entries = m_fontIndex.entries();
+	for (auto it = entries.cbegin(); it != entries.cend(); ++it)
 	{
-		const auto& checkedFont = it.value();
-
-		bool saveItem = checkedFont.isChecked;
-		if (!checkedFont.isChecked) // Font might be located in another local Scribus font folder
-			saveItem = QFile::exists(it.key());
-		if (!saveItem)
-			continue;
-
-		QDomElement fosu = docu.createElement("Font");
-		fosu.setAttribute("File", it.key());
-		fosu.setAttribute("Status", static_cast<int>(checkedFont.isOK));
-		fosu.setAttribute("Modified", checkedFont.lastMod.toString(Qt::ISODate));
-		elem.appendChild(fosu);
+		// Font might be located in another local Scribus font folder
+		if (!m_checkedFonts.contains(it.key()) && !QFile::exists(it.key()))
+			vanished.append(it.key());
 	}
+	for (const QString& fontPath : qAsConst(vanished))
+		m_fontIndex.remove(fontPath);
 
-	ScCore->setSplashStatus( QObject::tr("Writing updated Font Cache") );
-
-	QFile file(pf + "/checkfonts150.xml");
-	if (!file.open(QIODevice::WriteOnly))
+	// An unchanged index is not written again
+	if (!m_fontIndex.isModified())
 		return;
-	QTextStream s(&file);
-	s.setCodec("UTF-8");
-	s << docu.toString();
-	file.close();
+	ScCore->setSplashStatus( QObject::tr("Writing updated Font Cache") );
+	m_fontIndex.write(ScFontIndex::fileName(pf));
 }
 
 void SCFonts::getFonts(const QString& pf, bool showFontInfo)
@@ -1302,39 +1291,56 @@ void SCFonts::getFonts(const QString& pf, bool showFontInfo)
 	ScCore->setSplashStatus( QObject::tr("Searching for Fonts") );
 	addUserPath(pf);
 
+	// All font files are collected first, so that those not in the font index are checked together
+	QList<FontFile> files;
+
 	// Search the system paths
 	QStringList ftDirs = ScPaths::systemFontDirs();
 	for (int i = 0; i < ftDirs.count(); i++)
-		addScalableFonts( ftDirs[i] );
+		collectFontFiles(ftDirs[i], files, false);
 
 #ifdef Q_OS_WIN32
 	// Search fonts outside system paths using Windows Registry
-	addRegistryFonts();
-	addType1RegistryFonts();
+	collectRegistryFonts(files);
+	collectType1RegistryFonts(files);
 #endif
 
 	// Search Scribus font path
 	if (!ScPaths::instance().fontDir().isEmpty() && QDir(ScPaths::instance().fontDir()).exists())
-		addScalableFonts( ScPaths::instance().fontDir() );
+		collectFontFiles(ScPaths::instance().fontDir(), files, false);
 
 	//Add downloaded user fonts
 	QString userFontDir(ScPaths::userFontDir(false));
 	if (QDir(userFontDir).exists())
-		addScalableFonts( userFontDir );
+		collectFontFiles(userFontDir, files, false);
 
 // if fontconfig is there, it does all the work
 #if HAVE_FONTCONFIG
 	// Search fontconfig paths
 	QStringList::iterator fpi, fpend = m_fontPaths.end();
 	for (fpi = m_fontPaths.begin() ; fpi != fpend; ++fpi) 
-		addScalableFonts(*fpi);
-	addFontconfigFonts();
+		collectFontFiles(*fpi, files, false);
+	collectFontconfigFonts(files);
 #else
 	// add user and X11 fonts:
 	QStringList::iterator fpi, fpend = m_fontPaths.end();
 	for (fpi = m_fontPaths.begin() ; fpi != fpend; ++fpi) 
-		addScalableFonts(*fpi);
+		collectFontFiles(*fpi, files, false);
 #endif
+
+	// Files found several times only need to be loaded once
+	QSet<QString> found;
+	QList<FontFile> uniqueFiles;
+	uniqueFiles.reserve(files.count());
+	for (const FontFile& file : qAsConst(files))
+	{
+		if (found.contains(file.path))
+			continue;
+		found.insert(file.path);
+		uniqueFiles.append(file);
+	}
+	addFontFiles(uniqueFiles, QString());
+
 	updateFontMap();
 	writeFontCache(pf);
 }
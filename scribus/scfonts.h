@@ -14,10 +14,12 @@ for which a new license (GPL+exception) is in place.
 #include <QMap>
 #include <QVector>
 #include <QPair>
+#include <QSet>
 #include <QString>
 #include <QStringList>
 
 #include "fonts/scface.h"
+#include "fonts/scfontindex.h"
 #include "fpointarray.h"
 #include "scconfig.h"
 #include "scribusapi.h"
@@ -56,6 +58,8 @@ class SCRIBUS_API SCFonts : public QMap<QString,ScFace>
 		void removeFont(const QString& name);
 		/// Write checked fonts file
 		void writeFontCache();
+		/// Changes whenever faces are added, removed, disabled or replaced
+		uint generation() const { return m_generation; }
 
 		/// maps family name to face variants
 		QMap<QString, QStringList> fontMap;
@@ -64,25 +68,34 @@ class SCRIBUS_API SCFonts : public QMap<QString,ScFace>
 	private:
 		void readFontCache(const QString& pf);
 		void writeFontCache(const QString& pf);
+		struct FontFile
+		{
+			QString path;
+			/// Tried instead if path is no usable font, used for the resource forks of Mac fonts
+			QString fallbackPath;
+		};
+
 		void addPath(QString p);
-		bool addScalableFont(const QString& filename, FT_Library &library, const QString& DocName);
+		/// Appends the font files found in path to files, in subdirectories too unless forDocument is set
+		void collectFontFiles(const QString& path, QList<FontFile>& files, bool forDocument);
+		/// Adds the faces of files in their order, files missing from the font index are checked in parallel
+		void addFontFiles(const QList<FontFile>& files, const QString& DocName);
+		/// Adds the faces of a checked font file. Returns true if the file has no usable face.
+		bool addScalableFont(const QString& filename, const ScFontIndexEntry& entry, const QString& DocName);
 		void addRejectedFont(const QString& fontPath, const QString& message);
 		void addUserPath(const QString& pf);
 #ifdef HAVE_FONTCONFIG
-		void addFontconfigFonts();
+		void collectFontconfigFonts(QList<FontFile>& files);
 #elif defined(Q_OS_WIN32)
-		void addRegistryFonts();
-		void addType1RegistryFonts();
+		void collectRegistryFonts(QList<FontFile>& files);
+		void collectType1RegistryFonts(QList<FontFile>& files);
 #endif
 		QStringList m_fontPaths;
 
-		struct testCache
-		{
-			bool isOK;
-			bool isChecked;
-			QDateTime lastMod;
-		};
-		QMap<QString, testCache> m_checkedFonts;
+		ScFontIndex m_fontIndex;
+		/// Files looked up in the font index in this session
+		QSet<QString> m_checkedFonts;
+		uint m_generation { 0 };
 
 	protected:
 		bool m_showFontInfo { false };
@@ -8,6 +8,7 @@ for which a new license (GPL+exception) is in place.
 #include <cassert>
 #include <cmath>
 #include <cstdlib>
+#include <cstring>
 #include <memory>
 #include <csetjmp>
 
@@ -16,6 +17,8 @@ for which a new license (GPL+exception) is in place.
 #include <QImageReader>
 #include <QMessageBox>
 #include <QList>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QScopedPointer>
 
 #include "cmsettings.h"
@@ -25,6 +28,7 @@ for which a new license (GPL+exception) is in place.
 #include "scclocale.h"
 #include "sccolorengine.h"
 #include "scimagecacheproxy.h"
+#include "scimagekernels.h"
 #include "scstreamfilter.h"
 #include "scimage.h"
 #include "scpaths.h"
@@ -35,6 +39,7 @@ for which a new license (GPL+exception) is in place.
 #include "util_color.h"
 #include "util_formats.h"
 #include "util_ghostscript.h"
+#include "util_parallel.h"
 
 #include "imagedataloaders/scimgdataloader_gimp.h"
 #ifdef GMAGICK_FOUND
@@ -56,6 +61,12 @@ for which a new license (GPL+exception) is in place.
 
 using namespace std;
 
+// Images may be reloaded from several threads at once, see ImageLoadQueue
+static QMutex imageCacheMutex;
+
+// Byte of a pixel in memory which holds alpha, or black in CMYK images
+static const int alphaByte = (Q_BYTE_ORDER == Q_LITTLE_ENDIAN) ? 3 : 0;
+
 ScImage::ScImage(const QImage & image) : QImage(image)
 {
 	initialize();
@@ -384,323 +395,14 @@ void ScImage::solarize(double factor, bool cmyk)
 	applyCurve(curveTable, cmyk);
 }
 
-// Stack Blur Algorithm by Mario Klingemann <mario@quasimondo.com>
 void ScImage::blur(int radius)
 {
-	if (radius < 1) {
-		return;
-	}
-
-	QRgb *pix = (QRgb*) bits();
-	int w   = width();
-	int h   = height();
-	int wm  = w - 1;
-	int hm  = h - 1;
-	int wh  = w * h;
-	int div = radius + radius + 1;
-
-	int *r = new int[wh];
-	int *g = new int[wh];
-	int *b = new int[wh];
-	int *a = new int[wh];
-	int rsum, gsum, bsum, asum, x, y, i, yp, yi, yw;
-	QRgb p;
-	int *vmin = new int[qMax(w, h)];
-
-	int divsum = (div + 1) >> 1;
-	divsum *= divsum;
-	int *dv = new int[256*divsum];
-	for (i = 0; i < 256 * divsum; ++i) {
-		dv[i] = (i / divsum);
-	}
-
-	yw = yi = 0;
-
-	int **stack = new int*[div];
-	for (int i = 0; i < div; ++i) {
-		stack[i] = new int[4];
-	}
-
-	int stackpointer;
-	int stackstart;
-	int *sir;
-	int rbs;
-	int r1 = radius + 1;
-	int routsum, goutsum, boutsum, aoutsum;
-	int rinsum, ginsum, binsum, ainsum;
-
-	for (y = 0; y < h; ++y)
-	{
-		rinsum = ginsum = binsum = ainsum
-			= routsum = goutsum = boutsum = aoutsum
-			= rsum = gsum = bsum = asum = 0;
-		for (i = -radius; i <= radius; ++i)
-		{
-			p = pix[yi + qMin(wm, qMax(i, 0))];
-			sir = stack[i + radius];
-			sir[0] = qRed(p);
-			sir[1] = qGreen(p);
-			sir[2] = qBlue(p);
-			sir[3] = qAlpha(p);
-
-			rbs = r1 - abs(i);
-			rsum += sir[0] * rbs;
-			gsum += sir[1] * rbs;
-			bsum += sir[2] * rbs;
-			asum += sir[3] * rbs;
-
-			if (i > 0)
-			{
-				rinsum += sir[0];
-				ginsum += sir[1];
-				binsum += sir[2];
-				ainsum += sir[3];
-			}
-			else
-			{
-				routsum += sir[0];
-				goutsum += sir[1];
-				boutsum += sir[2];
-				aoutsum += sir[3];
-			}
-		}
-		stackpointer = radius;
-
-		for (x=0; x < w; ++x)
-		{
-			r[yi] = dv[rsum];
-			g[yi] = dv[gsum];
-			b[yi] = dv[bsum];
-			a[yi] = dv[asum];
-
-			rsum -= routsum;
-			gsum -= goutsum;
-			bsum -= boutsum;
-			asum -= aoutsum;
-
-			stackstart = stackpointer - radius + div;
-			sir = stack[stackstart % div];
-
-			routsum -= sir[0];
-			goutsum -= sir[1];
-			boutsum -= sir[2];
-			aoutsum -= sir[3];
-
-			if (y == 0)
-			{
-				vmin[x] = qMin(x + radius + 1, wm);
-			}
-			p = pix[yw + vmin[x]];
-
-			sir[0] = qRed(p);
-			sir[1] = qGreen(p);
-			sir[2] = qBlue(p);
-			sir[3] = qAlpha(p);
-
-			rinsum += sir[0];
-			ginsum += sir[1];
-			binsum += sir[2];
-			ainsum += sir[3];
-
-			rsum += rinsum;
-			gsum += ginsum;
-			bsum += binsum;
-			asum += ainsum;
-
-			stackpointer = (stackpointer+1)%div;
-			sir = stack[(stackpointer)%div];
-
-			routsum += sir[0];
-			goutsum += sir[1];
-			boutsum += sir[2];
-			aoutsum += sir[3];
-
-			rinsum -= sir[0];
-			ginsum -= sir[1];
-			binsum -= sir[2];
-			ainsum -= sir[3];
-
-			++yi;
-		}
-		yw += w;
-	}
-	for (x=0; x < w; ++x)
-	{
-		rinsum = ginsum = binsum = ainsum
-			= routsum = goutsum = boutsum = aoutsum
-			= rsum = gsum = bsum = asum = 0;
-
-		yp =- radius * w;
-
-		for (i=-radius; i <= radius; ++i)
-		{
-			yi = qMax(0, yp) + x;
-
-			sir = stack[i + radius];
-
-			sir[0] = r[yi];
-			sir[1] = g[yi];
-			sir[2] = b[yi];
-			sir[3] = a[yi];
-
-			rbs = r1 - abs(i);
-
-			rsum += r[yi]*rbs;
-			gsum += g[yi]*rbs;
-			bsum += b[yi]*rbs;
-			asum += a[yi]*rbs;
-
-			if (i > 0)
-			{
-				rinsum += sir[0];
-				ginsum += sir[1];
-				binsum += sir[2];
-				ainsum += sir[3];
-			}
-			else
-			{
-				routsum += sir[0];
-				goutsum += sir[1];
-				boutsum += sir[2];
-				aoutsum += sir[3];
-			}
-
-			if (i < hm)
-			{
-				yp += w;
-			}
-		}
-
-		yi = x;
-		stackpointer = radius;
-
-		for (y=0; y < h; ++y)
-		{
-			pix[yi] = qRgba(dv[rsum], dv[gsum], dv[bsum], dv[asum]);
-
-			rsum -= routsum;
-			gsum -= goutsum;
-			bsum -= boutsum;
-			asum -= aoutsum;
-
-			stackstart = stackpointer-radius+div;
-			sir = stack[stackstart%div];
-
-			routsum -= sir[0];
-			goutsum -= sir[1];
-			boutsum -= sir[2];
-			aoutsum -= sir[3];
-
-			if (x==0)
-			{
-				vmin[y] = qMin(y + r1,hm)*w;
-			}
-			p = x + vmin[y];
-
-			sir[0] = r[p];
-			sir[1] = g[p];
-			sir[2] = b[p];
-			sir[3] = a[p];
-
-			rinsum += sir[0];
-			ginsum += sir[1];
-			binsum += sir[2];
-			ainsum += sir[3];
-
-			rsum += rinsum;
-			gsum += ginsum;
-			bsum += binsum;
-			asum += ainsum;
-
-			stackpointer = (stackpointer + 1) % div;
-			sir = stack[stackpointer];
-
-			routsum += sir[0];
-			goutsum += sir[1];
-			boutsum += sir[2];
-			aoutsum += sir[3];
-
-			rinsum -= sir[0];
-			ginsum -= sir[1];
-			binsum -= sir[2];
-			ainsum -= sir[3];
-
-			yi += w;
-		}
-	}
-	delete [] r;
-	delete [] g;
-	delete [] b;
-	delete [] a;
-	delete [] vmin;
-	delete [] dv;
-
-	for (int i = 0; i < div; ++i)
-	{
-		delete [] stack[i];
-	}
-	delete [] stack;
+	ScImageKernels::blur(*this, radius);
 }
 
 bool ScImage::convolveImage(QImage *dest, const unsigned int order, const double *kernel)
 {
-	double red, green, blue, alpha;
-	const double *k;
-	unsigned int *q;
-	int x, y, mx, my, sx, sy;
-	long i;
-	int mcx, mcy;
-	long widthk = order;
-	if ((widthk % 2) == 0)
-		return false;
-	double *normal_kernel = (double *)malloc(widthk*widthk*sizeof(double));
-	if (!normal_kernel)
-		return false;
-	*dest = QImage(width(), height(), QImage::Format_ARGB32);
-	double normalize = 0.0;
-	for (i=0; i < (widthk * widthk); i++)
-		normalize += kernel[i];
-	if (fabs(normalize) <= 1.0e-12)
-		normalize = 1.0;
-	normalize = 1.0 / normalize;
-	for (i = 0; i < (widthk * widthk); i++)
-		normal_kernel[i] = normalize*kernel[i];
-	for (y = 0; y < dest->height(); ++y)
-	{
-		sy = y - (widthk / 2);
-		q = (unsigned int *) dest->scanLine(y);
-		for (x = 0; x < dest->width(); ++x)
-		{
-			k = normal_kernel;
-			red = green = blue = alpha = 0;
-			sy = y - (widthk / 2);
-			for (mcy = 0; mcy < widthk; ++mcy, ++sy)
-			{
-				my = sy < 0 ? 0 : sy > height() - 1 ? height() - 1 : sy;
-				sx = x + (-widthk / 2);
-				for (mcx=0; mcx < widthk; ++mcx, ++sx)
-				{
-					mx = sx < 0 ? 0 : sx > width()-1 ? width()-1 : sx;
-					int px = pixel(mx, my);
-					red += (*k)*(qRed(px) * 257);
-					green += (*k)*(qGreen(px) * 257);
-					blue += (*k)*(qBlue(px) * 257);
-					alpha += (*k)*(qAlpha(px) * 257);
-					++k;
-				}
-			}
-			red = red < 0 ? 0 : red > 65535 ? 65535 : red + 0.5;
-			green = green < 0 ? 0 : green > 65535 ? 65535 : green + 0.5;
-			blue = blue < 0 ? 0 : blue > 65535 ? 65535 : blue + 0.5;
-			alpha = alpha < 0 ? 0 : alpha > 65535 ? 65535 : alpha + 0.5;
-			*q++ = qRgba((unsigned char)(red / 257UL),
-			             (unsigned char)(green / 257UL),
-			             (unsigned char)(blue / 257UL),
-			             (unsigned char)(alpha / 257UL));
-		}
-	}
-	free(normal_kernel);
-	return(true);
+	return ScImageKernels::convolve(*this, *dest, order, kernel);
 }
 
 int ScImage::getOptimalKernelWidth(double radius, double sigma)
@@ -752,20 +454,14 @@ void ScImage::sharpen(double radius, double sigma)
 		}
 	}
 	kernel[i / 2] = (-2.0) * normalize;
-	convolveImage(&dest, widthk, kernel);
+	bool convolved = convolveImage(&dest, widthk, kernel);
 	free(kernel);
+	if (!convolved)
+		return;
 
+	int rowLength = qMin(dest.bytesPerLine(), bytesPerLine());
 	for (int yi = 0; yi < dest.height(); ++yi)
-	{
-		QRgb *s = (QRgb*) dest.scanLine(yi);
-		QRgb *d = (QRgb*) scanLine(yi);
-		for (int xi = 0; xi < dest.width(); ++xi)
-		{
-			(*d) = (*s);
-			s++;
-			d++;
-		}
-	}
+		memcpy(scanLine(yi), dest.constScanLine(yi), rowLength);
 }
 
 void ScImage::contrast(int contrastValue, bool cmyk)
@@ -806,49 +502,27 @@ void ScImage::doGraduate(FPointArray curve, bool cmyk, bool linear)
 
 void ScImage::applyCurve(const QVector<int>& curveTable, bool cmyk)
 {
-	int h = height();
-	int w = width();
-	QRgb *s;
-	QRgb r;
-	int c, m, y, k;
-	unsigned char *p;
-	for (int yi=0; yi < h; ++yi)
+	uchar tables[4][256];
+	for (int i = 0; i < 256; ++i)
 	{
-		s = (QRgb*)(scanLine( yi ));
-		for (int xi=0; xi < w; ++xi)
+		if (cmyk)
 		{
-			r = *s;
-			if (cmyk)
-			{
-				p = (unsigned char *) s;
-				p[0] = 255 - curveTable[255 - p[0]];
-				p[1] = 255 - curveTable[255 - p[1]];
-				p[2] = 255 - curveTable[255 - p[2]];
-				p[3] = 255 - curveTable[255 - p[3]];
-			}
-			else
-			{
-				c = curveTable[qRed(r)];
-				m = curveTable[qGreen(r)];
-				y = curveTable[qBlue(r)];
-				k = qAlpha(r);
-				*s = qRgba(c, m, y, k);
-			}
-			s++;
+			tables[0][i] = tables[1][i] = tables[2][i] = tables[3][i] = 255 - curveTable[255 - i];
+			continue;
 		}
+		// Curves apply to red, green and blue, alpha is kept
+		uchar value = curveTable[i];
+		for (int b = 0; b < 4; ++b)
+			tables[b][i] = (b == alphaByte) ? i : value;
 	}
+	ScImageKernels::mapBytes(*this, &tables[0][0]);
 }
 
 void ScImage::colorize(ScribusDoc* doc, ScColor color, int shade, bool cmyk)
 {
-	int h = height();
-	int w = width();
 	int cc, cm, cy, ck;
 	int hu, sa, v;
-	ScColor tmp2;
 	QColor tmpR;
-	QRgb *s;
-	QRgb r;
 	double k;
 	int cc2, cm2, cy2, k2;
 	if (cmyk)
@@ -864,35 +538,30 @@ void ScImage::colorize(ScribusDoc* doc, ScColor color, int shade, bool cmyk)
 		ScColorEngine::getShadeColorRGB(color, doc, rgbCol, shade);
 		rgbCol.getValues(cc, cm, cy);
 	}
-	for (int yi = 0; yi < h; ++yi)
+	// The result only depends on the luminance of a pixel, so it is computed once per luminance
+	QRgb table[256];
+	for (int l = 0; l < 256; ++l)
 	{
-		s = (QRgb*)(scanLine( yi ));
-		for (int xi = 0; xi < w; ++xi)
+		if (cmyk)
 		{
-			r = *s;
-			if (cmyk)
-			{
-				k = qMin(qRound(0.3 * qRed(r) + 0.59 * qGreen(r) + 0.11 * qBlue(r) + qAlpha(r)), 255) / 255.0;
-				*s = qRgba(qMin(qRound(cc*k), 255), qMin(qRound(cm*k), 255), qMin(qRound(cy*k), 255), qMin(qRound(ck*k), 255));
-			}
-			else
-			{
-				k2 = 255 - qMin(qRound(0.3 * qRed(r) + 0.59 * qGreen(r) + 0.11 * qBlue(r)), 255);
-				tmpR.setRgb(cc, cm, cy);
-				tmpR.getHsv(&hu, &sa, &v);
-				tmpR.setHsv(hu, sa * k2 / 255, 255 - ((255 - v) * k2 / 255));
-				tmpR.getRgb(&cc2, &cm2, &cy2);
-				*s = qRgba(cc2, cm2, cy2, qAlpha(r));
-			}
-			s++;
+			k = l / 255.0;
+			table[l] = qRgba(qMin(qRound(cc*k), 255), qMin(qRound(cm*k), 255), qMin(qRound(cy*k), 255), qMin(qRound(ck*k), 255));
+		}
+		else
+		{
+			k2 = 255 - l;
+			tmpR.setRgb(cc, cm, cy);
+			tmpR.getHsv(&hu, &sa, &v);
+			tmpR.setHsv(hu, sa * k2 / 255, 255 - ((255 - v) * k2 / 255));
+			tmpR.getRgb(&cc2, &cm2, &cy2);
+			table[l] = qRgb(cc2, cm2, cy2);
 		}
 	}
+	ScImageKernels::mapLuminance(*this, table, cmyk);
 }
 
 void ScImage::duotone(ScribusDoc* doc, ScColor color1, int shade1, FPointArray curve1, bool lin1, ScColor color2, int shade2, FPointArray curve2, bool lin2, bool cmyk)
 {
-	int h = height();
-	int w = width();
 	int c, c1, m, m1, y, y1, k, k1;
 	int cn, c1n, mn, m1n, yn, y1n, kn, k1n;
 	uchar cb;
@@ -913,42 +582,34 @@ void ScImage::duotone(ScribusDoc* doc, ScColor color1, int shade1, FPointArray c
 	{
 		curveTable2[x] = qMin(255, qMax(0, qRound(getCurveYValue(curve2, x / 255.0, lin2) * 255)));
 	}
-	for (int yi=0; yi < h; ++yi)
-	{
-		QRgb * s = (QRgb*)(scanLine( yi ));
-		for (int xi=0; xi < w; ++xi)
+	// The result only depends on the luminance of a pixel, so it is computed once per luminance
+	QRgb table[256];
+	for (int l = 0; l < 256; ++l)
+	{
+		cb = cmyk ? l : 255 - l;
+		cn = qMin((c * curveTable1[(int)cb]) >> 8, 255);
+		mn = qMin((m * curveTable1[(int)cb]) >> 8, 255);
+		yn = qMin((y * curveTable1[(int)cb]) >> 8, 255);
+		kn = qMin((k * curveTable1[(int)cb]) >> 8, 255);
+		c1n = qMin((c1 * curveTable1[(int)cb]) >> 8, 255);
+		m1n = qMin((m1 * curveTable2[(int)cb]) >> 8, 255);
+		y1n = qMin((y1 * curveTable2[(int)cb]) >> 8, 255);
+		k1n = qMin((k1 * curveTable2[(int)cb]) >> 8, 255);
+		ScColor col = ScColor(qMin(cn + c1n, 255), qMin(mn + m1n, 255), qMin(yn + y1n, 255), qMin(kn + k1n, 255));
+		if (cmyk)
+			col.getCMYK(&cn, &mn, &yn, &kn);
+		else
 		{
-			QRgb r = *s;
-			if (cmyk)
-				cb = qMin(qRound(0.3 * qRed(r) + 0.59 * qGreen(r) + 0.11 * qBlue(r) + qAlpha(r)), 255);
-			else
-				cb = 255 - qMin(qRound(0.3 * qRed(r) + 0.59 * qGreen(r) + 0.11 * qBlue(r)), 255);
-			cn = qMin((c * curveTable1[(int)cb]) >> 8, 255);
-			mn = qMin((m * curveTable1[(int)cb]) >> 8, 255);
-			yn = qMin((y * curveTable1[(int)cb]) >> 8, 255);
-			kn = qMin((k * curveTable1[(int)cb]) >> 8, 255);
-			c1n = qMin((c1 * curveTable1[(int)cb]) >> 8, 255);
-			m1n = qMin((m1 * curveTable2[(int)cb]) >> 8, 255);
-			y1n = qMin((y1 * curveTable2[(int)cb]) >> 8, 255);
-			k1n = qMin((k1 * curveTable2[(int)cb]) >> 8, 255);
-			ScColor col = ScColor(qMin(cn + c1n, 255), qMin(mn + m1n, 255), qMin(yn + y1n, 255), qMin(kn + k1n, 255));
-			if (cmyk)
-				col.getCMYK(&cn, &mn, &yn, &kn);
-			else
-			{
-				col.getRawRGBColor(&cn, &mn, &yn);
-				kn = qAlpha(r);
-			}
-			*s = qRgba(cn, mn, yn, kn);
-			s++;
+			col.getRawRGBColor(&cn, &mn, &yn);
+			kn = 0;
 		}
+		table[l] = qRgba(cn, mn, yn, kn);
 	}
+	ScImageKernels::mapLuminance(*this, table, cmyk);
 }
 
 void ScImage::tritone(ScribusDoc* doc, ScColor color1, int shade1, FPointArray curve1, bool lin1, ScColor color2, int shade2, FPointArray curve2, bool lin2, ScColor color3, int shade3, const FPointArray& curve3, bool lin3, bool cmyk)
 {
-	int h = height();
-	int w = width();
 	int c, c1, c2, m, m1, m2, y, y1, y2, k, k1, k2;
 	int cn, c1n, c2n, mn, m1n, m2n, yn, y1n, y2n, kn, k1n, k2n;
 	uchar cb;
@@ -977,46 +638,38 @@ void ScImage::tritone(ScribusDoc* doc, ScColor color1, int shade1, FPointArray c
 	{
 		curveTable3[x] = qMin(255, qMax(0, qRound(getCurveYValue(curve2, x / 255.0, lin3) * 255)));
 	}
-	for (int yi = 0; yi < h; ++yi)
-	{
-		QRgb * s = (QRgb*)(scanLine( yi ));
-		for (int xi = 0; xi < w; ++xi)
+	// The result only depends on the luminance of a pixel, so it is computed once per luminance
+	QRgb table[256];
+	for (int l = 0; l < 256; ++l)
+	{
+		cb = cmyk ? l : 255 - l;
+		cn = qMin((c * curveTable1[(int)cb]) >> 8, 255);
+		mn = qMin((m * curveTable1[(int)cb]) >> 8, 255);
+		yn = qMin((y * curveTable1[(int)cb]) >> 8, 255);
+		kn = qMin((k * curveTable1[(int)cb]) >> 8, 255);
+		c1n = qMin((c1 * curveTable2[(int)cb]) >> 8, 255);
+		m1n = qMin((m1 * curveTable2[(int)cb]) >> 8, 255);
+		y1n = qMin((y1 * curveTable2[(int)cb]) >> 8, 255);
+		k1n = qMin((k1 * curveTable2[(int)cb]) >> 8, 255);
+		c2n = qMin((c2 * curveTable3[(int)cb]) >> 8, 255);
+		m2n = qMin((m2 * curveTable3[(int)cb]) >> 8, 255);
+		y2n = qMin((y2 * curveTable3[(int)cb]) >> 8, 255);
+		k2n = qMin((k2 * curveTable3[(int)cb]) >> 8, 255);
+		ScColor col = ScColor(qMin(cn+c1n+c2n, 255), qMin(mn+m1n+m2n, 255), qMin(yn+y1n+y2n, 255), qMin(kn+k1n+k2n, 255));
+		if (cmyk)
+			col.getCMYK(&cn, &mn, &yn, &kn);
+		else
 		{
-			QRgb r = *s;
-			if (cmyk)
-				cb = qMin(qRound(0.3 * qRed(r) + 0.59 * qGreen(r) + 0.11 * qBlue(r) + qAlpha(r)), 255);
-			else
-				cb = 255 - qMin(qRound(0.3 * qRed(r) + 0.59 * qGreen(r) + 0.11 * qBlue(r)), 255);
-			cn = qMin((c * curveTable1[(int)cb]) >> 8, 255);
-			mn = qMin((m * curveTable1[(int)cb]) >> 8, 255);
-			yn = qMin((y * curveTable1[(int)cb]) >> 8, 255);
-			kn = qMin((k * curveTable1[(int)cb]) >> 8, 255);
-			c1n = qMin((c1 * curveTable2[(int)cb]) >> 8, 255);
-			m1n = qMin((m1 * curveTable2[(int)cb]) >> 8, 255);
-			y1n = qMin((y1 * curveTable2[(int)cb]) >> 8, 255);
-			k1n = qMin((k1 * curveTable2[(int)cb]) >> 8, 255);
-			c2n = qMin((c2 * curveTable3[(int)cb]) >> 8, 255);
-			m2n = qMin((m2 * curveTable3[(int)cb]) >> 8, 255);
-			y2n = qMin((y2 * curveTable3[(int)cb]) >> 8, 255);
-			k2n = qMin((k2 * curveTable3[(int)cb]) >> 8, 255);
-			ScColor col = ScColor(qMin(cn+c1n+c2n, 255), qMin(mn+m1n+m2n, 255), qMin(yn+y1n+y2n, 255), qMin(kn+k1n+k2n, 255));
-			if (cmyk)
-				col.getCMYK(&cn, &mn, &yn, &kn);
-			else
-			{
-				col.getRawRGBColor(&cn, &mn, &yn);
-				kn = qAlpha(r);
-			}
-			*s = qRgba(cn, mn, yn, kn);
-			s++;
+			col.getRawRGBColor(&cn, &mn, &yn);
+			kn = 0;
 		}
+		table[l] = qRgba(cn, mn, yn, kn);
 	}
+	ScImageKernels::mapLuminance(*this, table, cmyk);
 }
 
 void ScImage::quadtone(ScribusDoc* doc, ScColor color1, int shade1, FPointArray curve1, bool lin1, ScColor color2, int shade2, FPointArray curve2, bool lin2, ScColor color3, int shade3, FPointArray curve3, bool lin3, ScColor color4, int shade4, FPointArray curve4, bool lin4, bool cmyk)
 {
-	int h = height();
-	int w = width();
 	int c, c1, c2, c3, m, m1, m2, m3, y, y1, y2, y3, k, k1, k2, k3;
 	int cn, c1n, c2n, c3n, mn, m1n, m2n, m3n, yn, y1n, y2n, y3n, kn, k1n, k2n, k3n;
 	uchar cb;
@@ -1053,103 +706,73 @@ void ScImage::quadtone(ScribusDoc* doc, ScColor color1, int shade1, FPointArray
 	{
 		curveTable4[x] = qMin(255, qMax(0, qRound(getCurveYValue(curve4, x / 255.0, lin4) * 255)));
 	}
-	for (int yi=0; yi < h; ++yi)
-	{
-		QRgb * s = (QRgb*)(scanLine( yi ));
-		for (int xi = 0; xi < w; ++xi)
+	// The result only depends on the luminance of a pixel, so it is computed once per luminance
+	QRgb table[256];
+	for (int l = 0; l < 256; ++l)
+	{
+		cb = cmyk ? l : 255 - l;
+		cn = qMin((c * curveTable1[(int)cb]) >> 8, 255);
+		mn = qMin((m * curveTable1[(int)cb]) >> 8, 255);
+		yn = qMin((y * curveTable1[(int)cb]) >> 8, 255);
+		kn = qMin((k * curveTable1[(int)cb]) >> 8, 255);
+		c1n = qMin((c1 * curveTable2[(int)cb]) >> 8, 255);
+		m1n = qMin((m1 * curveTable2[(int)cb]) >> 8, 255);
+		y1n = qMin((y1 * curveTable2[(int)cb]) >> 8, 255);
+		k1n = qMin((k1 * curveTable2[(int)cb]) >> 8, 255);
+		c2n = qMin((c2 * curveTable3[(int)cb]) >> 8, 255);
+		m2n = qMin((m2 * curveTable3[(int)cb]) >> 8, 255);
+		y2n = qMin((y2 * curveTable3[(int)cb]) >> 8, 255);
+		k2n = qMin((k2 * curveTable3[(int)cb]) >> 8, 255);
+		c3n = qMin((c3 * curveTable4[(int)cb]) >> 8, 255);
+		m3n = qMin((m3 * curveTable4[(int)cb]) >> 8, 255);
+		y3n = qMin((y3 * curveTable4[(int)cb]) >> 8, 255);
+		k3n = qMin((k3 * curveTable4[(int)cb]) >> 8, 255);
+		ScColor col = ScColor(qMin(cn+c1n+c2n+c3n, 255), qMin(mn+m1n+m2n+m3n, 255), qMin(yn+y1n+y2n+y3n, 255), qMin(kn+k1n+k2n+k3n, 255));
+		if (cmyk)
+			col.getCMYK(&cn, &mn, &yn, &kn);
+		else
 		{
-			QRgb r = *s;
-			if (cmyk)
-				cb = qMin(qRound(0.3 * qRed(r) + 0.59 * qGreen(r) + 0.11 * qBlue(r) + qAlpha(r)), 255);
-			else
-				cb = 255 - qMin(qRound(0.3 * qRed(r) + 0.59 * qGreen(r) + 0.11 * qBlue(r)), 255);
-			cn = qMin((c * curveTable1[(int)cb]) >> 8, 255);
-			mn = qMin((m * curveTable1[(int)cb]) >> 8, 255);
-			yn = qMin((y * curveTable1[(int)cb]) >> 8, 255);
-			kn = qMin((k * curveTable1[(int)cb]) >> 8, 255);
-			c1n = qMin((c1 * curveTable2[(int)cb]) >> 8, 255);
-			m1n = qMin((m1 * curveTable2[(int)cb]) >> 8, 255);
-			y1n = qMin((y1 * curveTable2[(int)cb]) >> 8, 255);
-			k1n = qMin((k1 * curveTable2[(int)cb]) >> 8, 255);
-			c2n = qMin((c2 * curveTable3[(int)cb]) >> 8, 255);
-			m2n = qMin((m2 * curveTable3[(int)cb]) >> 8, 255);
-			y2n = qMin((y2 * curveTable3[(int)cb]) >> 8, 255);
-			k2n = qMin((k2 * curveTable3[(int)cb]) >> 8, 255);
-			c3n = qMin((c3 * curveTable4[(int)cb]) >> 8, 255);
-			m3n = qMin((m3 * curveTable4[(int)cb]) >> 8, 255);
-			y3n = qMin((y3 * curveTable4[(int)cb]) >> 8, 255);
-			k3n = qMin((k3 * curveTable4[(int)cb]) >> 8, 255);
-			ScColor col = ScColor(qMin(cn+c1n+c2n+c3n, 255), qMin(mn+m1n+m2n+m3n, 255), qMin(yn+y1n+y2n+y3n, 255), qMin(kn+k1n+k2n+k3n, 255));
-			if (cmyk)
-				col.getCMYK(&cn, &mn, &yn, &kn);
-			else
-			{
-				col.getRawRGBColor(&cn, &mn, &yn);
-				kn = qAlpha(r);
-			}
-			*s = qRgba(cn, mn, yn, kn);
-			s++;
+			col.getRawRGBColor(&cn, &mn, &yn);
+			kn = 0;
 		}
+		table[l] = qRgba(cn, mn, yn, kn);
 	}
+	ScImageKernels::mapLuminance(*this, table, cmyk);
 }
 
 void ScImage::invert(bool cmyk)
 {
-	int h = height();
-	int w = width();
-	unsigned char *p;
-	QRgb * s;
-	unsigned char c, m, y, k;
-	for (int yi = 0; yi < h; ++yi)
+	if (cmyk)
 	{
-		s = (QRgb*)(scanLine( yi ));
-		for (int xi = 0; xi < w; ++xi)
-		{
-			if (cmyk)
-			{
-				p = (unsigned char *) s;
-				c = 255 - qMin(255, p[0] + p[3]);
-				m = 255 - qMin(255, p[1] + p[3]);
-				y = 255 - qMin(255, p[2] + p[3]);
-				k = qMin(qMin(c, m), y);
-				p[0] = c - k;
-				p[1] = m - k;
-				p[2] = y - k;
-				p[3] = k;
-			}
-			else
-				*s ^= 0x00ffffff;
-			s++;
-		}
+		ScImageKernels::mapPixels(*this, [](QRgb s) {
+			unsigned char *p = (unsigned char *) &s;
+			unsigned char c = 255 - qMin(255, p[0] + p[3]);
+			unsigned char m = 255 - qMin(255, p[1] + p[3]);
+			unsigned char y = 255 - qMin(255, p[2] + p[3]);
+			unsigned char k = qMin(qMin(c, m), y);
+			p[0] = c - k;
+			p[1] = m - k;
+			p[2] = y - k;
+			p[3] = k;
+			return s;
+		});
+		return;
 	}
+	uchar tables[4][256];
+	for (int i = 0; i < 256; ++i)
+	{
+		for (int b = 0; b < 4; ++b)
+			tables[b][i] = (b == alphaByte) ? i : 255 - i;
+	}
+	ScImageKernels::mapBytes(*this, &tables[0][0]);
 }
 
 void ScImage::toGrayscale(bool cmyk)
 {
-	int h = height();
-	int w = width();
-	int k;
-	QRgb * s;
-	QRgb r;
-	for (int yi = 0; yi < h; ++yi)
-	{
-		s = (QRgb*)(scanLine( yi ));
-		for (int xi = 0; xi < w; ++xi)
-		{
-			r = *s;
-			if (cmyk)
-			{
-				k = qMin(qRound(0.3 * qRed(r) + 0.59 * qGreen(r) + 0.11 * qBlue(r) + qAlpha(r)), 255);
-				*s = qRgba(0, 0, 0, k);
-			}
-			else
-			{
-				k = qMin(qRound(0.3 * qRed(r) + 0.59 * qGreen(r) + 0.11 * qBlue(r)), 255);
-				*s = qRgba(k, k, k, qAlpha(r));
-			}
-			s++;
-		}
-	}
+	QRgb table[256];
+	for (int k = 0; k < 256; ++k)
+		table[k] = cmyk ? qRgba(0, 0, 0, k) : qRgb(k, k, k);
+	ScImageKernels::mapLuminance(*this, table, cmyk);
 }
 
 void ScImage::swapRGBA()
@@ -2206,7 +1829,7 @@ bool ScImage::loadPicture(ScImageCacheProxy & cache, bool & fromCache, int page,
 {
 	if (cache.enabled())
 	{
-		ScColorMgmtEngine engine(cmSettings.doc() ? cmSettings.doc()->colorEngine : ScCore->defaultEngine);
+		ScColorMgmtEngine engine(cmSettings.colorEngine());
 		cache.addModifier("cmEngineID", QString::number(engine.engineID()));
 		cache.addModifier("cmEngineDescription", engine.description());
 		cache.addModifier("useEmbeddedProfile", QString::number(static_cast<int>(cmSettings.useEmbeddedProfile())));
@@ -2221,6 +1844,7 @@ bool ScImage::loadPicture(ScImageCacheProxy & cache, bool & fromCache, int page,
 		addProfileToCacheModifiers(cache, "monitor", cmSettings.monitorProfile());
 		addProfileToCacheModifiers(cache, "printer", cmSettings.printerProfile());
 
+		QMutexLocker locker(&imageCacheMutex);
 		fromCache = imgInfo.lowResType != 0 && cache.canUseCachedImage() && cache.load(*this) && imgInfo.deserialize(cache);
 
 		if (fromCache)
@@ -2237,6 +1861,7 @@ bool ScImage::loadPicture(ScImageCacheProxy & cache, bool & fromCache, int page,
 
 bool ScImage::saveCache(ScImageCacheProxy & cache)
 {
+	QMutexLocker locker(&imageCacheMutex);
 	return cache.enabled() && imgInfo.serialize(cache) && cache.save(*this);
 }
 
@@ -2379,50 +2004,50 @@ bool ScImage::loadPicture(const QString & fn, int page, const CMSettings& cmSett
 	{
 		if ((embeddedProfile.size() > 0 ) && (cmSettings.useEmbeddedProfile()))
 		{
-			inputProf = cmSettings.doc()->colorEngine.openProfileFromMem(embeddedProfile);
+			inputProf = cmSettings.colorEngine().openProfileFromMem(embeddedProfile);
 		//	inputProfIsEmbedded = true;
 		}
 		else
 		{
 			QString profilePath;
 			//CB If this is null, customfiledialog/picsearch/ScPreview might be sending it
-			Q_ASSERT(cmSettings.doc()!=nullptr);
+			Q_ASSERT(cmSettings.doc() != nullptr || cmSettings.isDetached());
 			if (isCMYK)
 			{
-				if (ScCore->InputProfilesCMYK.contains(cmSettings.profileName()) && (cmSettings.profileName() != cmSettings.doc()->cmsSettings().DefaultImageCMYKProfile))
+				if (ScCore->InputProfilesCMYK.contains(cmSettings.profileName()) && (cmSettings.profileName() != cmSettings.defaultImageCMYKProfile()))
 				{
 					imgInfo.profileName = cmSettings.profileName();
 				//	inputProfIsEmbedded = true;
 					profilePath = ScCore->InputProfilesCMYK[imgInfo.profileName];
-					inputProf =  cmSettings.doc()->colorEngine.openProfileFromFile(profilePath);
+					inputProf =  cmSettings.colorEngine().openProfileFromFile(profilePath);
 				}
 				else
 				{
-					inputProf = cmSettings.doc()->DocInputImageCMYKProf;
-					imgInfo.profileName = cmSettings.doc()->cmsSettings().DefaultImageCMYKProfile;
+					inputProf = cmSettings.inputImageCMYKProfile();
+					imgInfo.profileName = cmSettings.defaultImageCMYKProfile();
 				//	inputProfIsEmbedded = false;
 				}
 			}
 			else if (bilevel && (reqType == CMYKData))
 				inputProf = nullptr; // Workaround to map directly gray to K channel
-			else if (ScCore->InputProfiles.contains(cmSettings.profileName()) && (cmSettings.profileName() != cmSettings.doc()->cmsSettings().DefaultImageRGBProfile))
+			else if (ScCore->InputProfiles.contains(cmSettings.profileName()) && (cmSettings.profileName() != cmSettings.defaultImageRGBProfile()))
 			{
 				imgInfo.profileName = cmSettings.profileName();
 				profilePath = ScCore->InputProfiles[imgInfo.profileName];
 			//	inputProfIsEmbedded = true;
-				inputProf = cmSettings.doc()->colorEngine.openProfileFromFile(profilePath);
+				inputProf = cmSettings.colorEngine().openProfileFromFile(profilePath);
 			}
 			else
 			{
-				inputProf = cmSettings.doc()->DocInputImageRGBProf;
-				imgInfo.profileName = cmSettings.doc()->cmsSettings().DefaultImageRGBProfile;
+				inputProf = cmSettings.inputImageRGBProfile();
+				imgInfo.profileName = cmSettings.defaultImageRGBProfile();
 			//	inputProfIsEmbedded = false;
 			}
 		}
 	}
 	else if ((cmSettings.useColorManagement() && embeddedProfile.size() > 0) && (cmSettings.useEmbeddedProfile()))
 	{
-		inputProf = cmSettings.doc()->colorEngine.openProfileFromMem(embeddedProfile);
+		inputProf = cmSettings.colorEngine().openProfileFromMem(embeddedProfile);
 	//	inputProfIsEmbedded = true;
 	}
 	else if (cmSettings.colorManagementAllowed() && isCMYK)
@@ -2435,7 +2060,7 @@ bool ScImage::loadPicture(const QString & fn, int page, const CMSettings& cmSett
 	ScColorProfile printerProf = cmSettings.printerProfile() ? cmSettings.printerProfile() : ScCore->defaultCMYKProfile;
 	if (cmSettings.colorManagementAllowed() && inputProf && screenProf && printerProf)
 	{
-		ScColorMgmtEngine engine(cmSettings.doc() ? cmSettings.doc()->colorEngine : ScCore->defaultEngine);
+		ScColorMgmtEngine engine(cmSettings.colorEngine());
 		eColorFormat inputProfFormat  = pDataLoader->pixelFormat();
 		eColorFormat outputProfFormat = Format_YMCK_8;
 		eColorSpaceType inputProfColorSpace  = inputProf.colorSpace();
@@ -2545,41 +2170,63 @@ bool ScImage::loadPicture(const QString & fn, int page, const CMSettings& cmSett
 				// JG : this line overwrite image profile info and should not be needed here!!!!
 				// imgInfo = pDataLoader->imageInfoRecord();
 			}
-			uchar* ptr2 = nullptr;
-			for (int i = 0; i < height(); i++)
-			{
-				uchar* ptr = scanLine(i);
-				ptr2 = pDataLoader->useRawImage() ? pDataLoader->r_image.scanLine(i) : nullptr;
-				if ((inputProfFormat == Format_GRAY_8) && (outputProfColorSpace != ColorSpace_Cmyk))
+			// Rows are transformed in bands, the bands in parallel when the transform allows it
+			const bool useRawImage = pDataLoader->useRawImage();
+			const int w = width();
+			const int h = height();
+			uchar* bits = this->bits();
+			const int bpl = bytesPerLine();
+			uchar* rawBits = useRawImage ? pDataLoader->r_image.bits() : nullptr;
+			const int rawBpl = useRawImage ? (pDataLoader->r_image.width() * pDataLoader->r_image.channels()) : 0;
+			const bool grayInput = (inputProfFormat == Format_GRAY_8);
+			const bool flattenAlpha = !inputCSpace.hasAlphaChannel() && outputCSpace.hasAlphaChannel();
+			// FIXME not valid if input or output colorspace are not 8bit / channels
+			const bool copyAlpha = useRawImage && inputCSpace.hasAlphaChannel() && outputCSpace.hasAlphaChannel();
+			const int bandRows = qMax(1, 65536 / qMax(1, w));
+			const int bands = (h + bandRows - 1) / bandRows;
+			auto transformBand = [&](int band) {
+				int firstRow = band * bandRows;
+				int rows = qMin(bandRows, h - firstRow);
+				uchar* ptr = bits + firstRow * bpl;
+				uchar* ptr2 = rawBits ? (rawBits + firstRow * rawBpl) : nullptr;
+				int inBpl = ptr2 ? rawBpl : bpl;
+				if (grayInput && (outputProfColorSpace != ColorSpace_Cmyk))
 				{
-					unsigned char* ucs = ptr2 ? (ptr2 + 1) : (ptr + 1);
-					unsigned char* uc = new unsigned char[width()];
-					for (int uci = 0; uci < width(); ++uci)
+					// Gray input is taken from the second byte of each pixel into one buffer per band
+					QVector<uchar> gray(w * rows);
+					uchar* uc = gray.data();
+					for (int i = 0; i < rows; ++i)
 					{
-						uc[uci] = *ucs;
-						ucs += 4;
+						const uchar* ucs = (ptr2 ? (ptr2 + i * rawBpl) : (ptr + i * bpl)) + 1;
+						for (int uci = 0; uci < w; ++uci, ucs += 4)
+							*uc++ = *ucs;
 					}
-					xform.apply(uc, ptr, width());
-					delete[] uc;
+					xform.apply(gray.data(), ptr, w, rows, w, bpl);
 				}
-				else if ((inputProfFormat == Format_GRAY_8) && (outputProfColorSpace == ColorSpace_Cmyk))
+				else if (grayInput && (outputProfColorSpace == ColorSpace_Cmyk))
 				{
-					unsigned char  value;
-					unsigned char* ucs = ptr2 ? ptr2 : ptr;
-					unsigned char* uc  = ptr;
-					for (int uci = 0; uci < width(); ++uci, uc += 4)
+					for (int i = 0; i < rows; ++i)
 					{
-						value = 255 - *(ucs + 1);
-						uc[0] = uc[1] = uc[2] = 0;
-						uc[3] = value;
-						ucs += 4;
+						const uchar* ucs = ptr2 ? (ptr2 + i * rawBpl) : (ptr + i * bpl);
+						uchar* uc = ptr + i * bpl;
+						for (int uci = 0; uci < w; ++uci, uc += 4, ucs += 4)
+						{
+							uchar value = 255 - *(ucs + 1);
+							uc[0] = uc[1] = uc[2] = 0;
+							uc[3] = value;
+						}
 					}
 				}
 				else
 				{
-					inputCSpace.convert(outputCSpace, (eRenderIntent) 0, 0, ptr2 ? ptr2 : ptr, ptr, width(), &xform);
+					xform.apply(ptr2 ? ptr2 : ptr, ptr, w, rows, inBpl, bpl);
+					if (flattenAlpha)
+					{
+						for (int i = 0; i < rows; ++i)
+							outputCSpace.flattenAlpha(ptr + i * bpl, w);
+					}
 				}
-				if (pDataLoader->useRawImage())
+				if (copyAlpha)
 				{
 					// This might fix Bug #6328, please test.
 					/*if (outputProfColorSpace != ColorSpace_Cmyk && bilevel)
@@ -2594,16 +2241,15 @@ bool ScImage::loadPicture(const QString & fn, int page, const CMSettings& cmSett
 							ptr2 += 4;
 						}
 					}*/
-					// FIXME not valid if input or output colorspace are not 8bit / channels
-					if (inputCSpace.hasAlphaChannel() && outputCSpace.hasAlphaChannel())
+					uint inputAlphaI  = inputCSpace.alphaIndex();
+					uint outputAlphaI = outputCSpace.alphaIndex();
+					uint inputBytes   = inputCSpace.bytesPerChannel()  * inputCSpace.numChannels();
+					uint outputBytes  = outputCSpace.bytesPerChannel() * outputCSpace.numChannels();
+					for (int i = 0; i < rows; ++i)
 					{
-						uint inputAlphaI  = inputCSpace.alphaIndex();
-						uint outputAlphaI = outputCSpace.alphaIndex();
-						uint inputBytes   = inputCSpace.bytesPerChannel()  * inputCSpace.numChannels();
-						uint outputBytes  = outputCSpace.bytesPerChannel() * outputCSpace.numChannels();
-						uchar* in  = ptr2 + inputAlphaI  * inputCSpace.bytesPerChannel();
-						uchar* out = ptr  + outputAlphaI * outputCSpace.bytesPerChannel();
-						for (int j = 0; j < width(); ++j)
+						const uchar* in = ptr2 + i * rawBpl + inputAlphaI  * inputCSpace.bytesPerChannel();
+						uchar* out = ptr + i * bpl + outputAlphaI * outputCSpace.bytesPerChannel();
+						for (int j = 0; j < w; ++j)
 						{
 							*out = *in;
 							in  += inputBytes;
@@ -2611,6 +2257,13 @@ bool ScImage::loadPicture(const QString & fn, int page, const CMSettings& cmSett
 						}
 					}
 				}
+			};
+			if (xform.isReentrant())
+				parallelFor(bands, transformBand);
+			else
+			{
+				for (int band = 0; band < bands; ++band)
+					transformBand(band);
 			}
 		}
 	}
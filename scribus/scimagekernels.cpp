@@ -0,0 +1,338 @@
+/*
+For general Scribus (>=1.3.2) copyright and licensing information please refer
+to the COPYING file provided with the program. Following this notice may exist
+a copyright and/or license notice that predates the release of Scribus 1.3.2
+for which a new license (GPL+exception) is in place.
+*/
+
+#include <cmath>
+#include <cstdlib>
+
+#include <QVector>
+
+#include "scimagekernels.h"
+
+// SSE2 is part of every x86-64 CPU, so no runtime detection is needed
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#define SCIMAGEKERNELS_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+	/*
+	 * Sums of the four bytes of pixels as used by the stack blur, byte n of
+	 * the pixel value in lane n. The lanes of the SSE2 version are added
+	 * and subtracted at once.
+	 */
+#ifdef SCIMAGEKERNELS_SSE2
+	struct PixelSum
+	{
+		__m128i v;
+
+		static PixelSum zero() { return { _mm_setzero_si128() }; }
+		static PixelSum fromPixel(QRgb p)
+		{
+			__m128i z = _mm_setzero_si128();
+			return { _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(int(p)), z), z) };
+		}
+		PixelSum& operator+=(const PixelSum& other) { v = _mm_add_epi32(v, other.v); return *this; }
+		PixelSum& operator-=(const PixelSum& other) { v = _mm_sub_epi32(v, other.v); return *this; }
+		// SSE2 has no 32 bit multiplication, this is only used when a line starts
+		PixelSum scaled(int factor) const
+		{
+			alignas(16) int s[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(s), v);
+			return { _mm_set_epi32(s[3] * factor, s[2] * factor, s[1] * factor, s[0] * factor) };
+		}
+		QRgb divided(const uchar* dv) const
+		{
+			alignas(16) int s[4];
+			_mm_store_si128(reinterpret_cast<__m128i*>(s), v);
+			return QRgb(dv[s[0]]) | (QRgb(dv[s[1]]) << 8) | (QRgb(dv[s[2]]) << 16) | (QRgb(dv[s[3]]) << 24);
+		}
+	};
+#else
+	struct PixelSum
+	{
+		int c[4];
+
+		static PixelSum zero() { return { { 0, 0, 0, 0 } }; }
+		static PixelSum fromPixel(QRgb p)
+		{
+			return { { int(p & 0xff), int((p >> 8) & 0xff), int((p >> 16) & 0xff), int(p >> 24) } };
+		}
+		PixelSum& operator+=(const PixelSum& other)
+		{
+			for (int i = 0; i < 4; ++i)
+				c[i] += other.c[i];
+			return *this;
+		}
+		PixelSum& operator-=(const PixelSum& other)
+		{
+			for (int i = 0; i < 4; ++i)
+				c[i] -= other.c[i];
+			return *this;
+		}
+		PixelSum scaled(int factor) const
+		{
+			return { { c[0] * factor, c[1] * factor, c[2] * factor, c[3] * factor } };
+		}
+		QRgb divided(const uchar* dv) const
+		{
+			return QRgb(dv[c[0]]) | (QRgb(dv[c[1]]) << 8) | (QRgb(dv[c[2]]) << 16) | (QRgb(dv[c[3]]) << 24);
+		}
+	};
+#endif
+}
+
+// Stack Blur Algorithm by Mario Klingemann <mario@quasimondo.com>
+// Blurs one row or column of count pixels, src and dst are different buffers
+static void blurLine(const QRgb* src, int srcStride, QRgb* dst, int dstStride, int count, int radius, const uchar* dv, PixelSum* stack)
+{
+	int last = count - 1;
+	int div = radius + radius + 1;
+	int r1 = radius + 1;
+	PixelSum sum = PixelSum::zero();
+	PixelSum inSum = PixelSum::zero();
+	PixelSum outSum = PixelSum::zero();
+	for (int i = -radius; i <= radius; ++i)
+	{
+		PixelSum& sir = stack[i + radius];
+		sir = PixelSum::fromPixel(src[qMin(last, qMax(i, 0)) * srcStride]);
+		sum += sir.scaled(r1 - abs(i));
+		if (i > 0)
+			inSum += sir;
+		else
+			outSum += sir;
+	}
+
+	int stackpointer = radius;
+	for (int x = 0; x < count; ++x)
+	{
+		dst[x * dstStride] = sum.divided(dv);
+		sum -= outSum;
+
+		PixelSum& sir = stack[(stackpointer - radius + div) % div];
+		outSum -= sir;
+		sir = PixelSum::fromPixel(src[qMin(x + r1, last) * srcStride]);
+		inSum += sir;
+		sum += inSum;
+
+		stackpointer = (stackpointer + 1) % div;
+		const PixelSum& next = stack[stackpointer];
+		outSum += next;
+		inSum -= next;
+	}
+}
+
+void ScImageKernels::blur(QImage& image, int radius)
+{
+	if ((radius < 1) || image.isNull() || (image.depth() != 32))
+		return;
+
+	int w = image.width();
+	int h = image.height();
+	int stride = image.bytesPerLine() / 4;
+	QRgb* pix = reinterpret_cast<QRgb*>(image.bits());
+	int div = radius + radius + 1;
+	int divsum = (div + 1) >> 1;
+	divsum *= divsum;
+	QVector<uchar> dvTable(256 * divsum);
+	for (int i = 0; i < dvTable.count(); ++i)
+		dvTable[i] = i / divsum;
+	const uchar* dv = dvTable.constData();
+
+	// The results of the horizontal pass fit into bytes, one buffer of pixels holds them
+	QVector<QRgb> horizontal(w * h);
+	QRgb* tmp = horizontal.data();
+	forEachStripe(h, w, [&](int first, int end) {
+		QVector<PixelSum> stack(div);
+		for (int y = first; y < end; ++y)
+			blurLine(pix + y * stride, 1, tmp + y * w, 1, w, radius, dv, stack.data());
+	});
+	forEachStripe(w, h, [&](int first, int end) {
+		QVector<PixelSum> stack(div);
+		for (int x = first; x < end; ++x)
+			blurLine(tmp + x, w, pix + x, stride, h, radius, dv, stack.data());
+	});
+}
+
+bool ScImageKernels::convolve(const QImage& image, QImage& dest, int order, const double* kernel)
+{
+	int widthk = order;
+	if ((widthk % 2) == 0)
+		return false;
+	int w = image.width();
+	int h = image.height();
+	dest = QImage(w, h, QImage::Format_ARGB32);
+	if (dest.isNull())
+		return false;
+	// Read pixels as QImage::pixel() would return them
+	const QImage src = (image.format() == QImage::Format_ARGB32) ? image : image.convertToFormat(QImage::Format_ARGB32);
+
+	QVector<double> normalKernel(widthk * widthk);
+	double normalize = 0.0;
+	for (int i = 0; i < (widthk * widthk); i++)
+		normalize += kernel[i];
+	if (fabs(normalize) <= 1.0e-12)
+		normalize = 1.0;
+	normalize = 1.0 / normalize;
+	for (int i = 0; i < (widthk * widthk); i++)
+		normalKernel[i] = normalize * kernel[i];
+
+	// Source column of each kernel position, edge pixels are repeated
+	QVector<int> columns(w + widthk - 1);
+	for (int i = 0; i < columns.count(); ++i)
+		columns[i] = qBound(0, i - widthk / 2, w - 1);
+
+	const int* xIndex = columns.constData();
+	const double* k0 = normalKernel.constData();
+	uchar* destBits = dest.bits();
+	int destBpl = dest.bytesPerLine();
+	forEachStripe(h, w * widthk * widthk, [&](int first, int end) {
+		// Source rows converted to doubles, channels in the order of the bytes of the pixel value: blue, green, red, alpha.
+		// The rows around an output row are different modulo widthk, so each one has its own slot.
+		QVector<double> rowData(widthk * w * 4);
+		QVector<int> slotRows(widthk, -1);
+		QVector<const double*> rows(widthk);
+		for (int y = first; y < end; ++y)
+		{
+			for (int mcy = 0; mcy < widthk; ++mcy)
+			{
+				int sy = qBound(0, y - widthk / 2 + mcy, h - 1);
+				int slot = sy % widthk;
+				double* data = rowData.data() + slot * w * 4;
+				if (slotRows[slot] != sy)
+				{
+					const QRgb* s = reinterpret_cast<const QRgb*>(src.constScanLine(sy));
+					for (int x = 0; x < w; ++x)
+					{
+						data[4 * x] = qBlue(s[x]) * 257;
+						data[4 * x + 1] = qGreen(s[x]) * 257;
+						data[4 * x + 2] = qRed(s[x]) * 257;
+						data[4 * x + 3] = qAlpha(s[x]) * 257;
+					}
+					slotRows[slot] = sy;
+				}
+				rows[mcy] = data;
+			}
+			QRgb* q = reinterpret_cast<QRgb*>(destBits + y * destBpl);
+			for (int x = 0; x < w; ++x)
+			{
+				double c[4];
+				const double* k = k0;
+#ifdef SCIMAGEKERNELS_SSE2
+				__m128d bg = _mm_setzero_pd();
+				__m128d ra = _mm_setzero_pd();
+				for (int mcy = 0; mcy < widthk; ++mcy)
+				{
+					const double* row = rows.at(mcy);
+					for (int mcx = 0; mcx < widthk; ++mcx, ++k)
+					{
+						const double* p = row + 4 * xIndex[x + mcx];
+						__m128d kk = _mm_set1_pd(*k);
+						bg = _mm_add_pd(bg, _mm_mul_pd(kk, _mm_loadu_pd(p)));
+						ra = _mm_add_pd(ra, _mm_mul_pd(kk, _mm_loadu_pd(p + 2)));
+					}
+				}
+				_mm_storeu_pd(c, bg);
+				_mm_storeu_pd(c + 2, ra);
+#else
+				c[0] = c[1] = c[2] = c[3] = 0.0;
+				for (int mcy = 0; mcy < widthk; ++mcy)
+				{
+					const double* row = rows.at(mcy);
+					for (int mcx = 0; mcx < widthk; ++mcx, ++k)
+					{
+						const double* p = row + 4 * xIndex[x + mcx];
+						c[0] += (*k) * p[0];
+						c[1] += (*k) * p[1];
+						c[2] += (*k) * p[2];
+						c[3] += (*k) * p[3];
+					}
+				}
+#endif
+				for (int i = 0; i < 4; ++i)
+					c[i] = c[i] < 0 ? 0 : c[i] > 65535 ? 65535 : c[i] + 0.5;
+				*q++ = qRgba((unsigned char)(c[2] / 257UL),
+				             (unsigned char)(c[1] / 257UL),
+				             (unsigned char)(c[0] / 257UL),
+				             (unsigned char)(c[3] / 257UL));
+			}
+		}
+	});
+	return true;
+}
+
+void ScImageKernels::mapBytes(QImage& image, const uchar* tables)
+{
+	if (image.isNull() || (image.depth() != 32))
+		return;
+	int w = image.width();
+	int bpl = image.bytesPerLine();
+	uchar* bits = image.bits();
+	const uchar* t0 = tables;
+	const uchar* t1 = tables + 256;
+	const uchar* t2 = tables + 512;
+	const uchar* t3 = tables + 768;
+	forEachStripe(image.height(), w, [&](int first, int end) {
+		for (int y = first; y < end; ++y)
+		{
+			uchar* p = bits + y * bpl;
+			for (int x = 0; x < w; ++x, p += 4)
+			{
+				p[0] = t0[p[0]];
+				p[1] = t1[p[1]];
+				p[2] = t2[p[2]];
+				p[3] = t3[p[3]];
+			}
+		}
+	});
+}
+
+namespace
+{
+	// Products of the luminance weights, in double precision as in the former effect loops so that rounding is the same
+	struct LuminanceWeights
+	{
+		double red[256];
+		double green[256];
+		double blue[256];
+
+		LuminanceWeights()
+		{
+			for (int i = 0; i < 256; ++i)
+			{
+				red[i] = 0.3 * i;
+				green[i] = 0.59 * i;
+				blue[i] = 0.11 * i;
+			}
+		}
+	};
+}
+
+void ScImageKernels::mapLuminance(QImage& image, const QRgb* table, bool cmyk)
+{
+	if (image.isNull() || (image.depth() != 32))
+		return;
+	static const LuminanceWeights weights;
+	int w = image.width();
+	int bpl = image.bytesPerLine();
+	uchar* bits = image.bits();
+	forEachStripe(image.height(), w, [&](int first, int end) {
+		for (int y = first; y < end; ++y)
+		{
+			QRgb* s = reinterpret_cast<QRgb*>(bits + y * bpl);
+			for (int x = 0; x < w; ++x, ++s)
+			{
+				QRgb r = *s;
+				double l = weights.red[qRed(r)] + weights.green[qGreen(r)] + weights.blue[qBlue(r)];
+				if (cmyk)
+					*s = table[qMin(qRound(l + qAlpha(r)), 255)];
+				else
+					*s = (table[qMin(qRound(l), 255)] & 0x00ffffff) | (r & 0xff000000);
+			}
+		}
+	});
+}
@@ -0,0 +1,104 @@
+/*
+For general Scribus (>=1.3.2) copyright and licensing information please refer
+to the COPYING file provided with the program. Following this notice may exist
+a copyright and/or license notice that predates the release of Scribus 1.3.2
+for which a new license (GPL+exception) is in place.
+*/
+#ifndef SCIMAGEKERNELS_H
+#define SCIMAGEKERNELS_H
+
+#include <QImage>
+
+#include "scribusapi.h"
+#include "util_parallel.h"
+
+/**
+  Pixel kernels of the ScImage effects.
+
+  The kernels work on 32 bit images, RGB or CMYK as stored by ScImage, and
+  give the same results as the former per pixel loops of ScImage. Images
+  are split into stripes of rows or columns which are processed with
+  parallelFor(). Where it pays off, the inner loops use SSE2 on x86, with a
+  plain C++ fallback elsewhere.
+ */
+class SCRIBUS_API ScImageKernels
+{
+public:
+	/// Stack blur with the given radius, in place
+	static void blur(QImage& image, int radius);
+
+	/**
+	 * Convolves image with a square kernel of order x order values and
+	 * stores the result in dest as Format_ARGB32. The kernel is normalized
+	 * to a sum of 1 first, edge pixels are repeated. Returns false if order
+	 * is even.
+	 */
+	static bool convolve(const QImage& image, QImage& dest, int order, const double* kernel);
+
+	/**
+	 * Replaces each byte of each pixel with its value in a table, the table
+	 * for the n-th byte of a pixel in memory starting at tables + 256 * n.
+	 */
+	static void mapBytes(QImage& image, const uchar* tables);
+
+	/**
+	 * Replaces each pixel with the entry of table at its luminance, computed
+	 * with the weights 0.3, 0.59 and 0.11 for red, green and blue. In CMYK
+	 * images, where the alpha byte holds black, black is added to the
+	 * luminance and the table entry replaces the whole pixel. Otherwise the
+	 * alpha of the pixel is kept.
+	 */
+	static void mapLuminance(QImage& image, const QRgb* table, bool cmyk);
+
+	/// Replaces each pixel p with func(p), func is called from several threads
+	template<typename Func>
+	static void mapPixels(QImage& image, Func func);
+
+private:
+	/// Calls func(first, end) in parallel for stripes of lines covering [0, count), lineLength is the work per line in pixels
+	template<typename Func>
+	static void forEachStripe(int count, int lineLength, Func func);
+};
+
+template<typename Func>
+void ScImageKernels::forEachStripe(int count, int lineLength, Func func)
+{
+	if (count <= 0)
+		return;
+	// Stripes of 64K pixels at least, small images are not worth waking up threads
+	const int minPixels = 65536;
+	int linesPerStripe = qMax(1, minPixels / qMax(1, lineLength));
+	int stripes = (count + linesPerStripe - 1) / linesPerStripe;
+	// More stripes than threads even out stripes which take longer
+	int maxStripes = parallelThreadCount() * 4;
+	if (stripes > maxStripes)
+	{
+		linesPerStripe = (count + maxStripes - 1) / maxStripes;
+		stripes = (count + linesPerStripe - 1) / linesPerStripe;
+	}
+	parallelFor(stripes, [&](int stripe) {
+		int first = stripe * linesPerStripe;
+		func(first, qMin(count, first + linesPerStripe));
+	});
+}
+
+template<typename Func>
+void ScImageKernels::mapPixels(QImage& image, Func func)
+{
+	if (image.isNull() || (image.depth() != 32))
+		return;
+	int w = image.width();
+	int bpl = image.bytesPerLine();
+	// bits() detaches the image, which must not happen in the worker threads
+	uchar* bits = image.bits();
+	forEachStripe(image.height(), w, [&](int first, int end) {
+		for (int y = first; y < end; ++y)
+		{
+			QRgb* s = reinterpret_cast<QRgb*>(bits + y * bpl);
+			for (int x = 0; x < w; ++x, ++s)
+				*s = func(*s);
+		}
+	});
+}
+
+#endif
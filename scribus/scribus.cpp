@@ -4146,6 +4146,7 @@ bool ScribusMainWindow::slotFileClose()
 
 bool ScribusMainWindow::DoFileClose()
 {
+	doc->cancelPictLoading();
 	slotEndSpecialEdit();
 	view->deselectItems(false);
 	if (doc == storyEditor->currentDocument())
@@ -4355,6 +4356,7 @@ void ScribusMainWindow::slotEndSpecialEdit()
 bool ScribusMainWindow::doPrint(PrintOptions &options, QString& error)
 {
 	bool printDone = false;
+	doc->finishPictLoading();
 	QString filename(options.filename);
 	if (options.toFile)
 	{
@@ -6726,6 +6728,7 @@ void ScribusMainWindow::doPrintPreview()
 		return;
 	if (!( ScCore->haveGS() || ScCore->isWinGUI() ))
 		return;
+	doc->finishPictLoading();
 	if (docCheckerPalette->isIgnoreEnabled())
 	{
 		docCheckerPalette->hide();
@@ -6914,6 +6917,7 @@ bool ScribusMainWindow::DoSaveAsEps(const QString& fn, QString& error)
 {
 	QStringList spots;
 	bool return_value = true;
+	doc->finishPictLoading();
 	ReOrderText(doc, view);
 	ScCore->fileWatcher->forceScan();
 	ScCore->fileWatcher->stop();
@@ -7038,6 +7042,7 @@ void ScribusMainWindow::reallySaveAsEps()
 bool ScribusMainWindow::getPDFDriver(const QString &filename, const std::vector<int> & pageNumbers,
 									 const QMap<int, QImage>& thumbs, QString& error, bool* cancelled)
 {
+	doc->finishPictLoading();
 	ScCore->fileWatcher->forceScan();
 	ScCore->fileWatcher->stop();
 	PDFlib pdflib(*doc);
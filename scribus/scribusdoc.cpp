@@ -55,6 +55,7 @@ for which a new license (GPL+exception) is in place.
 #include "filewatcher.h"
 #include "fpoint.h"
 #include "hyphenator.h"
+#include "imageloadqueue.h"
 #include "langmgr.h"
 #include "notesstyles.h"
 #include "numeration.h"
@@ -98,6 +99,7 @@ for which a new license (GPL+exception) is in place.
 #include "serializer.h"
 #include "tableborder.h"
 #include "textnote.h"
+#include "text/shapedtextcache.h"
 #include "text/textlayoutpainter.h"
 #include "text/textshaper.h"
 #include "ui/guidemanager.h"
@@ -111,6 +113,7 @@ for which a new license (GPL+exception) is in place.
 #include "ui/markinsert.h"
 #include "ui/marksmanager.h"
 #include "ui/markvariabletext.h"
+#include "ui/multiprogressdialog.h"
 #include "ui/notesstyleseditor.h"
 #include "ui/outlinepalette.h"
 #include "ui/pagepalette.h"
@@ -120,6 +123,7 @@ for which a new license (GPL+exception) is in place.
 #include "undomanager.h"
 #include "units.h"
 #include "util.h"
+#include "util_file.h"
 #include "util_math.h"
 #include "util_printer.h"
 
@@ -181,6 +185,7 @@ public:
 	void changed(PageItem* it, bool doLayout) override
 	{
 		it->invalidateLayout();
+		it->newRenderRevision();
 		if (doLayout)
 			it->layout();
 		double x, y, w, h;
@@ -471,6 +476,8 @@ void ScribusDoc::init()
 ScribusDoc::~ScribusDoc()
 {
 	m_guardedObject.nullify();
+	delete m_imageLoader;
+	m_imageLoader = nullptr;
 	CloseCMSProfiles();
 	ScCore->fileWatcher->stop();
 	ScCore->fileWatcher->removeFile(m_documentFileName);
@@ -4735,6 +4742,8 @@ bool ScribusDoc::save(const QString& fileName, QString* savedFile)
 		mainWindowProgressBar=m_ScMW->mainWindowProgressBar;
 		mainWindowProgressBar->reset();
 	}
+	// Image information such as layers and clipping paths is saved from the loaded pictures
+	finishPictLoading();
 	FileLoader fl(fileName);
 	bool ret = fl.saveFile(fileName, this, savedFile);
 	if (ret)
@@ -5623,6 +5632,8 @@ void ScribusDoc::setUsesAutomaticTextFrames(bool atf)
 
 bool ScribusDoc::loadPict(const QString& fn, PageItem *pageItem, bool reload, bool showMsg)
 {
+	if (pageItem->imageLoadPending && (m_imageLoader != nullptr))
+		m_imageLoader->removeItem(pageItem);
 	if (!reload)
 	{
 		if (pageItem->imageIsAvailable)
@@ -5631,7 +5642,7 @@ bool ScribusDoc::loadPict(const QString& fn, PageItem *pageItem, bool reload, bo
 				ScCore->fileWatcher->removeFile(pageItem->Pfile);
 			if (pageItem->isTempFile)
 			{
-				QFile::remove(pageItem->Pfile);
+				releaseTempFile(pageItem->Pfile);
 				pageItem->Pfile.clear();
 			}
 			pageItem->isInlineImage = false;
@@ -5665,6 +5676,41 @@ bool ScribusDoc::loadPict(const QString& fn, PageItem *pageItem, bool reload, bo
 	return true;
 }
 
+bool ScribusDoc::deferPict(PageItem *pageItem)
+{
+	if (!m_hasGUI || !isLoading() || !PrefsManager::instance().appPrefs.imageCachePrefs.backgroundLoading)
+		return false;
+	// Render frames load their images their own way
+	if (pageItem->realItemType() != PageItem::ImageFrame)
+		return false;
+	if (m_imageLoader == nullptr)
+	{
+		m_imageLoader = new BackgroundImageLoader(this);
+		connect(m_imageLoader, &BackgroundImageLoader::progress, this, [this](int done, int total) {
+			if (m_ScMW->doc == this)
+				m_ScMW->setStatusBarInfoText(tr("Loading images: %1 of %2").arg(done).arg(total));
+		});
+		connect(m_imageLoader, &BackgroundImageLoader::finished, this, [this]() {
+			if (m_ScMW->doc == this)
+				m_ScMW->setStatusBarInfoText("");
+		});
+	}
+	m_imageLoader->addItem(pageItem);
+	return true;
+}
+
+void ScribusDoc::finishPictLoading()
+{
+	if (m_imageLoader != nullptr)
+		m_imageLoader->finish();
+}
+
+void ScribusDoc::cancelPictLoading()
+{
+	if (m_imageLoader != nullptr)
+		m_imageLoader->cancel();
+}
+
 
 void ScribusDoc::canvasMinMax(FPoint& minPoint, FPoint& maxPoint)
 {
@@ -6393,6 +6439,7 @@ PageItem* ScribusDoc::convertItemTo(PageItem *currItem, PageItem::ItemType newTy
 	}
 	else
 		Items->replace(oldItemNr, newItem);
+	m_itemIndex.listChanged();
 	//FIXME: shouldn't we delete the oldItem ???
 	//Add new item back to selection if old item was in selection
 	if (removedFromSelection)
@@ -6435,32 +6482,7 @@ int ScribusDoc::currentPageNumber()
 
 bool ScribusDoc::itemNameExists(const QString& checkItemName) const
 {
-	std::vector<PageItem*> groups;
-	groups.reserve(32);
-
-	// Process root elements of the doc and remember groups
-	for (PageItem* item: *Items)
-	{
-		if (item->itemName() == checkItemName)
-			return true;
-		if (item->isGroup())
-			groups.push_back(item);
-	}
-
-	// Process groups
-	while (!groups.empty())
-	{
-		PageItem* item = groups.back();
-		groups.pop_back();
-		for (PageItem* item: item->groupItemList)
-		{
-			if (item->itemName() == checkItemName)
-				return true;
-			if (item->isGroup())
-				groups.push_back(item);
-		}
-	}
-	return false;
+	return m_itemNameIndex.contains(Items, checkItemName);
 }
 
 
@@ -7235,50 +7257,10 @@ int ScribusDoc::columnOfPage(int pageIndex) const
 
 void ScribusDoc::RecalcPictures(ProfilesL *Pr, ProfilesL *PrCMYK, QProgressBar *dia)
 {
-	RecalcPictures(&MasterItems, Pr, PrCMYK, dia);
-	RecalcPictures(&DocItems, Pr, PrCMYK, dia);
-	QList<PageItem*> itemList = FrameItems.values();
+	QList<PageItem*> itemList = MasterItems;
+	itemList += DocItems;
+	itemList += FrameItems.values();
 	RecalcPictures(&itemList, Pr, PrCMYK, dia);
-	QList<PageItem*> allItems;
-	if (FrameItems.isEmpty())
-		return;
-	bool usingGUI=ScCore->usingGUI();
-	int counter = 0;
-	if (usingGUI && dia != nullptr)
-		counter = dia->value();
-	for (auto itf = FrameItems.begin(); itf != FrameItems.end(); ++itf)
-	{
-		PageItem *it = itf.value();
-		if (it->isGroup())
-			allItems = it->getAllChildren();
-		else
-			allItems.append(it);
-		for (int i = 0; i < allItems.count(); i++)
-		{
-			it = allItems.at(i);
-			if ((it->itemType() == PageItem::ImageFrame) && (it->imageIsAvailable))
-			{
-				if (it->pixm.imgInfo.colorspace == ColorSpaceCMYK)
-				{
-					if (!PrCMYK->contains(it->ImageProfile))
-						it->ImageProfile = m_docPrefsData.colorPrefs.DCMSset.DefaultImageCMYKProfile;
-				}
-				else
-				{
-					if (!Pr->contains(it->ImageProfile))
-						it->ImageProfile = m_docPrefsData.colorPrefs.DCMSset.DefaultImageRGBProfile;
-				}
-				loadPict(it->Pfile, it, true);
-			}
-		}
-		allItems.clear();
-		if (usingGUI)
-		{
-			++counter;
-			if (dia != nullptr)
-				dia->setValue(counter);
-		}
-	}
 }
 
 void ScribusDoc::RecalcPictures(QList<PageItem*>* items, ProfilesL *Pr, ProfilesL *PrCMYK, QProgressBar *dia)
@@ -7286,10 +7268,7 @@ void ScribusDoc::RecalcPictures(QList<PageItem*>* items, ProfilesL *Pr, Profiles
 	if (items->isEmpty())
 		return;
 	QList<PageItem*> allItems;
-	bool usingGUI=ScCore->usingGUI();
-	int counter = 0;
-	if (usingGUI && dia != nullptr)
-		counter = dia->value();
+	ImageLoadQueue loadQueue(qint64(PrefsManager::instance().appPrefs.imageCachePrefs.loadMemoryMiB) * 1024 * 1024);
 	PageItem* it;
 	int docItemCount = items->count();
 	for (int i=0; i < docItemCount; ++i)
@@ -7314,17 +7293,48 @@ void ScribusDoc::RecalcPictures(QList<PageItem*>* items, ProfilesL *Pr, Profiles
 					if (!Pr->contains(it->ImageProfile))
 						it->ImageProfile = m_docPrefsData.colorPrefs.DCMSset.DefaultImageRGBProfile;
 				}
-				loadPict(it->Pfile, it, true);
+				// Render frames load their pictures their own way
+				if (it->realItemType() == PageItem::ImageFrame)
+					loadQueue.addItem(it);
+				else
+					loadPict(it->Pfile, it, true);
 			}
 		}
 		allItems.clear();
-		if (usingGUI)
-		{
-			++counter;
-			if (dia != nullptr)
-				dia->setValue(counter);
-		}
 	}
+	if (loadQueue.count() == 0)
+		return;
+
+	bool usingGUI=ScCore->usingGUI();
+	int counter = 0;
+	bool canceled = false;
+	QScopedPointer<MultiProgressDialog> progressDialog;
+	if (usingGUI && dia != nullptr)
+	{
+		counter = dia->value();
+		dia->setMaximum(counter + loadQueue.count());
+		progressDialog.reset(new MultiProgressDialog(tr("Updating Images"), CommonStrings::tr_Cancel, m_ScMW));
+		progressDialog->setWindowModality(Qt::ApplicationModal);
+		progressDialog->setOverallTotalSteps(loadQueue.count());
+		progressDialog->setOverallProgress(0);
+		connect(progressDialog.data(), &MultiProgressDialog::canceled, this, [&canceled]() { canceled = true; });
+		progressDialog->show();
+		qApp->processEvents();
+	}
+	// Frames left when canceled keep the pictures loaded with the former settings
+	int loaded = loadQueue.run([&](int done, int /*total*/) {
+		if (progressDialog)
+		{
+			dia->setValue(counter + done);
+			progressDialog->setOverallProgress(done);
+			qApp->processEvents();
+		}
+		return !canceled;
+	});
+	if (progressDialog)
+		progressDialog->close();
+	if ((loaded > 0) && !isLoading())
+		changed();
 }
 
 
@@ -7398,6 +7408,7 @@ void ScribusDoc::sendItemSelectionToBack()
 		{
 			Items->removeOne(objItem);
 			Items->prepend(objItem);
+			m_itemIndex.listChanged();
 		}
 		else
 		{
@@ -7465,6 +7476,7 @@ void ScribusDoc::bringItemSelectionToFront()
 		{
 			Items->removeOne(objItem);
 			Items->append(objItem);
+			m_itemIndex.listChanged();
 		}
 		else
 		{
@@ -7541,6 +7553,7 @@ void ScribusDoc::itemSelection_LowerItem()
 	{
 		itemList->insert(d+1, m_Selection->itemAt(Oindex[c]));
 	}
+	m_itemIndex.listChanged();
 	m_Selection->clear();
 	*m_Selection = tempSelection;
 	m_Selection->delaySignalsOff();
@@ -7615,6 +7628,7 @@ void ScribusDoc::itemSelection_RaiseItem()
 			d = 0;
 		itemList->insert(d, m_Selection->itemAt(Oindex[i]));
 	}
+	m_itemIndex.listChanged();
 	m_Selection->clear();
 	*m_Selection = tempSelection;
 	m_Selection->delaySignalsOff();
@@ -11466,14 +11480,9 @@ void ScribusDoc::itemSelection_SetOverprint(bool overprint, Selection* customSel
 
 void ScribusDoc::itemSelection_DoHyphenate()
 {
-	int selectedItemCount = m_Selection->count();
-	if (selectedItemCount == 0)
+	if (m_Selection->count() == 0)
 		return;
-	for (int i = 0; i < selectedItemCount; ++i)
-	{
-		PageItem *currItem = m_Selection->itemAt(i);
-		docHyphenator->slotHyphenate(currItem);
-	}
+	docHyphenator->hyphenateStories(m_Selection->items());
 	//FIXME: stop using m_View
 	m_View->DrawNew(); //CB draw new until NLS for redraw through text chains
 	changed();
@@ -13032,6 +13041,8 @@ void ScribusDoc::invalidateAll()
 		for (int ii = 0; ii < allItems.count(); ii++)
 		{
 			ite = allItems.at(ii);
+			if (ite->isTextFrame())
+				ite->itemText.shapedTextCache()->clear();
 			ite->invalidateLayout();
 		}
 		allItems.clear();
@@ -13046,6 +13057,8 @@ void ScribusDoc::invalidateAll()
 		for (int ii = 0; ii < allItems.count(); ii++)
 		{
 			ite = allItems.at(ii);
+			if (ite->isTextFrame())
+				ite->itemText.shapedTextCache()->clear();
 			ite->invalidateLayout();
 		}
 		allItems.clear();
@@ -15723,6 +15736,7 @@ void ScribusDoc::itemSelection_convertItemsToSymbol(QString& patternName)
 		currItem->parentGroup()->groupItemList.replace(d, groupItem);
 	else
 		Items->replace(d, groupItem);
+	m_itemIndex.listChanged();
 	/* #11365 will be fixed once undo here is fixed
 	if (UndoManager::undoEnabled())
 	{
@@ -15999,22 +16013,11 @@ void ScribusDoc::itemSelection_SetCompressionQuality(int cqIndex, Selection * cu
 QHash<PageItem*, QString> ScribusDoc::getDocItemNames(PageItem::ItemType itemType)
 {
 	QHash<PageItem*, QString> namesMap;
-	QList<PageItem*> allItems;
-	int docItemsCount = DocItems.count();
-	for (int i = 0; i < docItemsCount; ++i)
+	const QList<PageItem*> allItems = m_itemNameIndex.items(&DocItems);
+	for (PageItem* ite : allItems)
 	{
-		PageItem* ite = DocItems.at(i);
-		if (ite->isGroup())
-			allItems = ite->getAllChildren();
-		else
-			allItems.append(ite);
-		for (int ii = 0; ii < allItems.count(); ii++)
-		{
-			ite = allItems.at(ii);
-			if (ite->itemType() == itemType && ite->nextInChain() == nullptr && !ite->isAutoFrame())
-				namesMap.insert(ite, ite->itemName());
-		}
-		allItems.clear();
+		if (ite->itemType() == itemType && ite->nextInChain() == nullptr && !ite->isAutoFrame())
+			namesMap.insert(ite, ite->itemName());
 	}
 	return namesMap;
 }
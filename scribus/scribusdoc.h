@@ -42,6 +42,7 @@ for which a new license (GPL+exception) is in place.
 #include "gtgettext.h" //CB For the ImportSetup struct and itemadduserframe
 #include "scribusapi.h"
 #include "colormgmt/sccolormgmtengine.h"
+#include "documentchecker.h"
 #include "documentinformation.h"
 #include "numeration.h"
 #include "marks.h"
@@ -52,6 +53,8 @@ for which a new license (GPL+exception) is in place.
 #include "pageitem_group.h"
 #include "pageitem_latexframe.h"
 #include "pageitem_textframe.h"
+#include "pageitemindex.h"
+#include "pageitemnameindex.h"
 #include "pagestructs.h"
 #include "prefsstructs.h"
 #include "scguardedptr.h"
@@ -66,6 +69,7 @@ for which a new license (GPL+exception) is in place.
 #include "updatemanager.h"
 #include "usertaskstructs.h"
 
+class BackgroundImageLoader;
 class DocUpdater;
 class FPoint;
 class UndoManager;
@@ -128,6 +132,12 @@ public:
 	MassObservable<PageItem*>* itemsChanged() { return &m_itemsChanged; }
 	MassObservable<ScPage*>* pagesChanged() { return &m_pagesChanged; }
 	MassObservable<QRectF>* regionsChanged() { return &m_regionsChanged; }
+	//! Spatial index of DocItems and MasterItems, for finding the items in an area of the canvas
+	PageItemIndex& itemIndex() { return m_itemIndex; }
+	//! Index of DocItems and MasterItems and their group members by name and uniqueNr
+	PageItemNameIndex& itemNameIndex() { return m_itemNameIndex; }
+	//! Results of the last preflight check, for checking only changed items again
+	DocumentCheckerCache& checkerCache() { return m_checkerCache; }
 	
 	void invalidateAll();
 	void invalidateLayer(int layerID);
@@ -896,6 +906,20 @@ public:
 	 * @return 
 	 */
 	bool loadPict(const QString& fn, PageItem *pageItem, bool reload = false, bool showMsg = false);
+	/**
+	 * \brief Defers loading the image of a frame while the document is being opened,
+	 * if images are loaded in the background
+	 * @return false if the image must be loaded right away with loadPict()
+	 */
+	bool deferPict(PageItem *pageItem);
+	/**
+	 * \brief Loads the images still being loaded in the background, needed before any output
+	 */
+	void finishPictLoading();
+	/**
+	 * \brief Stops loading images in the background, the frames not loaded yet show as missing
+	 */
+	void cancelPictLoading();
 	/**
 	 * \brief Handle image with color profiles
 	 * @param Pr profile
@@ -1483,7 +1507,11 @@ private:
 	MassObservable<PageItem*> m_itemsChanged;
 	MassObservable<ScPage*> m_pagesChanged;
 	MassObservable<QRectF> m_regionsChanged;
+	PageItemIndex m_itemIndex;
+	mutable PageItemNameIndex m_itemNameIndex;
+	DocumentCheckerCache m_checkerCache;
 	DocUpdater* m_docUpdater {nullptr};
+	BackgroundImageLoader* m_imageLoader {nullptr};
 	
 signals:
 	//Lets make our doc talk to our GUI rather than confusing all our normal stuff
@@ -377,9 +377,15 @@ void ScribusView::changed(QRectF re, bool)
 	if (!m_doc->isLoading() && !m_ScMW->scriptIsRunning())
 	{
 // 		qDebug() << "ScribusView-changed(): changed region:" << re;
-		m_canvas->setForcedRedraw(true);
+		m_canvas->setForcedRedraw(re);
 		updateCanvas(re);
 	}
+	else
+	{
+		// Changes made while loading or from scripts are not tracked per region,
+		// the next redraw after loading or the script ends renders all tiles anew
+		m_canvas->dropCachedRendering();
+	}
 }
 
 bool ScribusView::handleObjectImport(QMimeData* mimeData, TransactionSettings* trSettings)
@@ -2517,6 +2523,9 @@ QImage ScribusView::MPageToPixmap(const QString& name, int maxGr, bool drawFrame
 QImage ScribusView::PageToPixmap(int Nr, int maxGr, PageToPixmapFlags flags)
 {
 	QImage im;
+	// Pictures are drawn at full resolution, which the background loading does not provide
+	if (!flags.testFlag(Pixmap_DontReloadImages))
+		m_doc->finishPictLoading();
 	double sx = maxGr / m_doc->DocPages.at(Nr)->width();
 	double sy = maxGr / m_doc->DocPages.at(Nr)->height();
 	double sc = qMin(sx, sy);
@@ -3,6 +3,7 @@
 #ifndef STYLESET_H
 #define STYLESET_H
 
+#include <QHash>
 #include <QList>
 #include <QRegExp>
 
@@ -19,12 +20,17 @@ public:
 	
 	const STYLE& get(const QString& name) const
 	{ 
-		return * dynamic_cast<const STYLE*>(resolve(name)); 
+		return * getPointer(name);
 	}
 
 	const STYLE* getPointer(const QString& name) const
 	{ 
-		return dynamic_cast<const STYLE*>(resolve(name)); 
+		if (name.isEmpty())
+			return m_default;
+		int index = find(name);
+		if (index >= 0)
+			return styles[index];
+		return m_context ? dynamic_cast<const STYLE*>(m_context->resolve(name)) : NULL;
 	}
 	
 	STYLE& operator[] (int index)
@@ -56,6 +62,8 @@ public:
 	
 	STYLE* append(STYLE* style)
 	{ 
+		if ((m_indexVersion == m_version) && !m_index.contains(style->name()))
+			m_index.insert(style->name(), styles.count());
 		styles.append(style); 
 		style->setContext(this); 
 		return style; 
@@ -104,6 +112,7 @@ public:
 			delete styles.front(); 
 			styles.pop_front(); 
 		}
+		m_indexVersion = -1;
 		if (invalid)
 			invalidate();
 	}
@@ -126,9 +135,19 @@ private:
 	StyleSet(const StyleSet&)             { assert(false); }
 	StyleSet& operator= (const StyleSet&) { assert(false); return *this; }
 
+	/// Rebuilds m_index if the set was invalidated since it was built
+	inline void updateIndex() const;
+
 	QList<STYLE*> styles;
 	const StyleContext* m_context;
 	STYLE* m_default;
+	/**
+	 * Position of the first style with each name. The index is valid for
+	 * the version it was built for, so styles renamed by other means than
+	 * rename() require an invalidate() as for their inherited attributes.
+	 */
+	mutable QHash<QString, int> m_index;
+	mutable int m_indexVersion { -1 };
 };
 
 template<class STYLE>
@@ -138,24 +157,45 @@ inline void StyleSet<STYLE>::remove(int index)
 	if (styles.at(index) == m_default)
 		return;
 	styles.removeAt(index);
+	// Positions behind index have changed
+	m_indexVersion = -1;
 }
 
 template<class STYLE>
-inline bool StyleSet<STYLE>::contains(const QString& name) const
+inline void StyleSet<STYLE>::updateIndex() const
 {
+	if (m_indexVersion == m_version)
+		return;
+	m_index.clear();
+	m_index.reserve(styles.count());
 	for (int i = 0; i < styles.count(); ++i)
-		if (styles[i]->name() == name)
-			return true;
-	return false;
+	{
+		QString name = styles[i]->name();
+		if (!m_index.contains(name))
+			m_index.insert(name, i);
+	}
+	m_indexVersion = m_version;
+}
+
+template<class STYLE>
+inline bool StyleSet<STYLE>::contains(const QString& name) const
+{
+	return find(name) >= 0;
 }
 
 template<class STYLE>
 inline int StyleSet<STYLE>::find(const QString& name) const
 {
-	for (int i = 0; i < styles.count(); ++i)
-		if (styles[i]->name() == name)
-			return i;
-	return -1;
+	updateIndex();
+	auto it = m_index.constFind(name);
+	if (it == m_index.constEnd())
+		return -1;
+	if ((it.value() < styles.count()) && (styles[it.value()]->name() == name))
+		return it.value();
+	// A style was renamed without invalidating the set
+	m_indexVersion = -1;
+	updateIndex();
+	return m_index.value(name, -1);
 }
 
 template<class STYLE>
@@ -174,11 +214,9 @@ inline const BaseStyle* StyleSet<STYLE>::resolve(const QString& name) const
 {
 	if (name.isEmpty())
 		return m_default;
-	for (int i = 0; i < styles.count(); ++i)
-	{
-		if (styles[i]->name() == name)
-			return styles[i];
-	}
+	int index = find(name);
+	if (index >= 0)
+		return styles[index];
 	return m_context ? m_context->resolve(name) : NULL;
 }
 
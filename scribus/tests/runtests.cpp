@@ -3,6 +3,22 @@
 //#include "testGlyphStore.h"
 //#include "testIndex.h"
 #include "testStoryText.h"
+#include "testStoryTextMemory.h"
+#include "testShapedTextCache.h"
+#include "testBlobStore.h"
+#include "testSlaIndex.h"
+#include "testPageItemNameIndex.h"
+#include "testCanvasTileCache.h"
+#include "testItemRasterCache.h"
+#include "testImageLoadQueue.h"
+#include "testImageBandWriter.h"
+#include "testScreenGlyphCache.h"
+#include "testFontIndex.h"
+#include "testHyphenWordCache.h"
+#include "testImageKernels.h"
+#include "testContentStream.h"
+#include "testStyleSet.h"
+#include "testDocumentChecker.h"
 #include "runtests.h"
 
 int RunTests::runTests(int argc, char ** argv)
@@ -10,6 +26,22 @@ int RunTests::runTests(int argc, char ** argv)
 	QList<QObject *> testObjects;
 //	testObjects << new TestGlyphStore();
 	testObjects << new TestStoryText();
+	testObjects << new TestStoryTextMemory();
+	testObjects << new TestShapedTextCache();
+	testObjects << new TestBlobStore();
+	testObjects << new TestSlaIndex();
+	testObjects << new TestPageItemNameIndex();
+	testObjects << new TestCanvasTileCache();
+	testObjects << new TestItemRasterCache();
+	testObjects << new TestImageLoadQueue();
+	testObjects << new TestImageBandWriter();
+	testObjects << new TestScreenGlyphCache();
+	testObjects << new TestFontIndex();
+	testObjects << new TestHyphenWordCache();
+	testObjects << new TestImageKernels();
+	testObjects << new TestContentStream();
+	testObjects << new TestStyleSet();
+	testObjects << new TestDocumentChecker();
 //	testObjects << new TestIndex();
 	int failed = 0;
 	for (int i = 0; i < testObjects.count(); ++i)
@@ -0,0 +1,162 @@
+/*
+ For general Scribus (>=1.3.2) copyright and licensing information please refer
+ to the COPYING file provided with the program. Following this notice may exist
+ a copyright and/or license notice that predates the release of Scribus 1.3.2
+ for which a new license (GPL+exception) is in place.
+ */
+
+#include <QTemporaryDir>
+
+#include "testBlobStore.h"
+#include "scblobstore.h"
+
+static QByteArray payload(int size, int seed)
+{
+	QByteArray result;
+	result.reserve(size);
+	for (int i = 0; i < size; ++i)
+		result.append(char((i * seed + i / 7) & 0xFF));
+	return result;
+}
+
+void TestBlobStore::roundTrip()
+{
+	QTemporaryDir dir;
+	QString storeName = dir.filePath("doc.sla.blobs");
+	QByteArray first = payload(100000, 3);
+	QByteArray second = payload(5000, 11);
+
+	ScBlobStoreWriter writer;
+	QVERIFY(writer.open(storeName));
+	QByteArray firstHash = writer.add(first);
+	QByteArray secondHash = writer.add(second);
+	QVERIFY(firstHash != secondHash);
+	QVERIFY(writer.close());
+
+	QSharedPointer<ScBlobStore> store = ScBlobStore::open(storeName);
+	QVERIFY(store);
+	QByteArray data;
+	QVERIFY(store->read(secondHash, data));
+	QCOMPARE(data, second);
+	QVERIFY(store->read(firstHash, data));
+	QCOMPARE(data, first);
+	QVERIFY(!store->read("0000", data));
+}
+
+void TestBlobStore::identicalPayloadsStoredOnce()
+{
+	QTemporaryDir dir;
+	QString storeName = dir.filePath("doc.sla.blobs");
+	QByteArray image = payload(200000, 5);
+
+	ScBlobStoreWriter writer;
+	QVERIFY(writer.open(storeName));
+	QByteArray hash = writer.add(image);
+	QCOMPARE(writer.add(image), hash);
+	QCOMPARE(writer.count(), 1);
+	QVERIFY(writer.close());
+
+	ScBlobStoreWriter single;
+	QVERIFY(single.open(dir.filePath("single.blobs")));
+	single.add(image);
+	QVERIFY(single.close());
+	QCOMPARE(QFileInfo(storeName).size(), QFileInfo(dir.filePath("single.blobs")).size());
+}
+
+void TestBlobStore::deferredMaterialize()
+{
+	QTemporaryDir dir;
+	QString storeName = dir.filePath("doc.sla.blobs");
+	QByteArray image = payload(30000, 7);
+
+	ScBlobStoreWriter writer;
+	QVERIFY(writer.open(storeName));
+	QByteArray hash = writer.add(image);
+	QVERIFY(writer.close());
+
+	QSharedPointer<ScBlobStore> store = ScBlobStore::open(storeName);
+	QVERIFY(store && store->contains(hash));
+	QString target = dir.filePath("image.png");
+	ScBlobStore::defer(target, store, hash);
+	QVERIFY(!QFile::exists(target));
+
+	QVERIFY(ScBlobStore::materialize(target));
+	QFile file(target);
+	QVERIFY(file.open(QIODevice::ReadOnly));
+	QCOMPARE(file.readAll(), image);
+	file.close();
+
+	// Once written, the payload is not written again
+	QVERIFY(QFile::remove(target));
+	QVERIFY(ScBlobStore::materialize(target));
+	QVERIFY(!QFile::exists(target));
+}
+
+void TestBlobStore::truncatedStoreFails()
+{
+	QTemporaryDir dir;
+	QString storeName = dir.filePath("doc.sla.blobs");
+	ScBlobStoreWriter writer;
+	QVERIFY(writer.open(storeName));
+	QByteArray hash = writer.add(payload(30000, 5));
+	QVERIFY(writer.close());
+
+	QSharedPointer<ScBlobStore> store = ScBlobStore::open(storeName);
+	QVERIFY(store);
+	QString target = dir.filePath("image.png");
+	ScBlobStore::defer(target, store, hash);
+
+	// The store gets cut short after the document was opened
+	QFile storeFile(storeName);
+	QVERIFY(storeFile.resize(100));
+	QVERIFY(!ScBlobStore::materialize(target));
+	// The failure is reported again rather than taken as already written
+	QVERIFY(!ScBlobStore::materialize(target));
+
+	QVERIFY(QFile::remove(storeName));
+	QVERIFY(!ScBlobStore::materialize(target));
+	ScBlobStore::discard(target);
+	QVERIFY(ScBlobStore::materialize(target));
+}
+
+void TestBlobStore::rejectsOtherFiles()
+{
+	QTemporaryDir dir;
+	QString fileName = dir.filePath("doc.sla");
+	QFile file(fileName);
+	QVERIFY(file.open(QIODevice::WriteOnly));
+	file.write("<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<SCRIBUSUTF8NEW Version=\"1.5.6\"/>\n");
+	file.close();
+	QVERIFY(ScBlobStore::open(fileName).isNull());
+	QVERIFY(ScBlobStore::open(dir.filePath("missing.blobs")).isNull());
+}
+
+void TestBlobStore::namedStoreNextToDocument()
+{
+	QTemporaryDir dir;
+	QString document = dir.filePath("doc.sla");
+	QCOMPARE(ScBlobStore::storePath(document, QString()), ScBlobStore::storePath(document));
+	QCOMPARE(ScBlobStore::storePath(document, "doc.sla.42.blobs"), dir.filePath("doc.sla.42.blobs"));
+	// Only the file name counts, a stored path cannot point elsewhere
+	QCOMPARE(ScBlobStore::storePath(document, "../elsewhere/doc.sla.42.blobs"), dir.filePath("doc.sla.42.blobs"));
+}
+
+void TestBlobStore::storesOfDocument()
+{
+	QTemporaryDir dir;
+	QStringList fileNames;
+	fileNames << "doc.sla" << "doc.sla.blobs" << "doc.sla.17.blobs" << "doc.sla.2345.blobs"
+	          << "doc.sla.gz.blobs" << "doc.sla.x1.blobs" << "other.sla.17.blobs";
+	for (const QString& fileName : qAsConst(fileNames))
+	{
+		QFile file(dir.filePath(fileName));
+		QVERIFY(file.open(QIODevice::WriteOnly));
+	}
+
+	QStringList stores = ScBlobStore::storesOf(dir.filePath("doc.sla"));
+	stores.sort();
+	QStringList expected;
+	expected << dir.filePath("doc.sla.17.blobs") << dir.filePath("doc.sla.2345.blobs") << dir.filePath("doc.sla.blobs");
+	expected.sort();
+	QCOMPARE(stores, expected);
+}
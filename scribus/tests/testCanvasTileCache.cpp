@@ -0,0 +1,66 @@
+/*
+ For general Scribus (>=1.3.2) copyright and licensing information please refer
+ to the COPYING file provided with the program. Following this notice may exist
+ a copyright and/or license notice that predates the release of Scribus 1.3.2
+ for which a new license (GPL+exception) is in place.
+ */
+
+#include "testCanvasTileCache.h"
+#include "canvastilecache.h"
+
+void TestCanvasTileCache::tileRange()
+{
+	const int size = CanvasTileCache::TileSize;
+	QCOMPARE(CanvasTileCache::tileRange(QRect(0, 0, size, size)), QRect(0, 0, 1, 1));
+	QCOMPARE(CanvasTileCache::tileRange(QRect(-1, 0, 2, size + 1)), QRect(-1, 0, 2, 2));
+	QCOMPARE(CanvasTileCache::tileRange(QRect(-size, -size, size, size)), QRect(-1, -1, 1, 1));
+}
+
+void TestCanvasTileCache::invalidateAllLevels()
+{
+	CanvasTileCache cache(100, 3);
+	cache.setLevel(1.0, QPointF(), 0);
+	for (int column = 0; column < 4; ++column)
+		cache.insert(column, 0, QPixmap());
+	cache.setLevel(2.0, QPointF(), 0);
+	for (int column = 0; column < 4; ++column)
+		cache.insert(column, 0, QPixmap());
+	QCOMPARE(cache.count(), 8);
+
+	// Around x = 300 in document coordinates: tile 1 at 100%, tile 2 at 200%
+	cache.invalidate(QRectF(290.0, 100.0, 20.0, 20.0));
+	QCOMPARE(cache.count(), 6);
+	QVERIFY(!cache.contains(2, 0));
+	QVERIFY(cache.contains(1, 0));
+	cache.setLevel(1.0, QPointF(), 0);
+	QVERIFY(!cache.contains(1, 0));
+	QVERIFY(cache.contains(2, 0));
+}
+
+void TestCanvasTileCache::evictLeastRecentlyUsed()
+{
+	CanvasTileCache cache(3, 3);
+	cache.setLevel(1.0, QPointF(), 0);
+	cache.insert(0, 0, QPixmap());
+	cache.insert(1, 0, QPixmap());
+	cache.insert(2, 0, QPixmap());
+	QPixmap tile;
+	QVERIFY(cache.find(0, 0, tile));
+	cache.insert(3, 0, QPixmap());
+	QCOMPARE(cache.count(), 3);
+	QVERIFY(cache.contains(0, 0));
+	QVERIFY(!cache.contains(1, 0));
+	QVERIFY(cache.contains(3, 0));
+}
+
+void TestCanvasTileCache::signatureChangeDropsTiles()
+{
+	CanvasTileCache cache(100, 3);
+	cache.setLevel(1.0, QPointF(), 1);
+	cache.insert(0, 0, QPixmap());
+	cache.setLevel(1.0, QPointF(0.5, 0.0), 1);
+	QVERIFY(!cache.contains(0, 0));
+	QCOMPARE(cache.count(), 1);
+	cache.setLevel(1.0, QPointF(), 2);
+	QCOMPARE(cache.count(), 0);
+}
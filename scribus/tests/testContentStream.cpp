@@ -0,0 +1,246 @@
+/*
+ For general Scribus (>=1.3.2) copyright and licensing information please refer
+ to the COPYING file provided with the program. Following this notice may exist
+ a copyright and/or license notice that predates the release of Scribus 1.3.2
+ for which a new license (GPL+exception) is in place.
+ */
+
+#include <cmath>
+
+#include <QRandomGenerator>
+#include <QTransform>
+
+#include "testContentStream.h"
+#include "sccontentstream.h"
+#include "fpointarray.h"
+#include "pslib.h"
+
+// How PDFLibCore formatted numbers before
+static QByteArray referenceFToStr(double c)
+{
+	double v = c;
+	if (fabs(c) < 0.0000001)
+		v = 0.0;
+	return QByteArray::number(v, 'f', 5);
+}
+
+static FPointArray testPath(int segments)
+{
+	FPointArray points;
+	QRandomGenerator random(4711);
+	for (int i = 0; i < segments; ++i)
+	{
+		if ((i > 0) && (i % 50 == 0))
+			points.setMarker();
+		double x = random.bounded(600.0);
+		double y = random.bounded(800.0);
+		if (i % 3 == 0)
+			points.addQuadPoint(x, y, x, y, x + 10.0, y + 5.0, x + 10.0, y + 5.0);
+		else
+			points.addQuadPoint(x, y, x + 3.3, y - 1.7, x + 20.25, y + 4.125, x + 15.0, y + 2.0);
+	}
+	return points;
+}
+
+void TestContentStream::number_data()
+{
+	QTest::addColumn<double>("value");
+	QTest::addColumn<int>("decimals");
+	QTest::addColumn<QByteArray>("expected");
+
+	QTest::newRow("zero") << 0.0 << 5 << QByteArray("0");
+	QTest::newRow("negative zero") << -0.0 << 5 << QByteArray("0");
+	QTest::newRow("integer") << 612.0 << 5 << QByteArray("612");
+	QTest::newRow("negative") << -841.89 << 5 << QByteArray("-841.89");
+	QTest::newRow("leading zeros") << 0.00125 << 5 << QByteArray("0.00125");
+	QTest::newRow("smallest") << -0.00001 << 5 << QByteArray("-0.00001");
+	QTest::newRow("rounds to zero") << -0.000004 << 5 << QByteArray("0");
+	QTest::newRow("rounds up") << 0.999996 << 5 << QByteArray("1");
+	QTest::newRow("rounded") << 123.456789 << 5 << QByteArray("123.45679");
+	QTest::newRow("no decimals") << 2.5 << 0 << QByteArray("3");
+	QTest::newRow("nine decimals") << 0.123456789 << 9 << QByteArray("0.123456789");
+	QTest::newRow("large") << 1.0e10 << 5 << QByteArray("10000000000");
+}
+
+void TestContentStream::number()
+{
+	QFETCH(double, value);
+	QFETCH(int, decimals);
+	QFETCH(QByteArray, expected);
+	QCOMPARE(ScContentStream::number(value, decimals), expected);
+}
+
+void TestContentStream::postScriptNumber_data()
+{
+	QTest::addColumn<double>("value");
+	QTest::addColumn<QByteArray>("expected");
+
+	// PostScript numbers used to have six significant digits, so "1e-06" and "1.23457e+06".
+	// Now they have a fixed number of decimals: tiny values become 0 and large ones keep their digits.
+	QTest::newRow("below the last decimal") << 0.000001 << QByteArray("0");
+	QTest::newRow("negative below the last decimal") << -0.0000049 << QByteArray("0");
+	QTest::newRow("last decimal") << 0.0000051 << QByteArray("0.00001");
+	QTest::newRow("million") << 1.0e6 << QByteArray("1000000");
+	QTest::newRow("above a million") << 1234567.891 << QByteArray("1234567.891");
+	QTest::newRow("negative above a million") << -2500000.5 << QByteArray("-2500000.5");
+	QTest::newRow("all decimals") << 123456789.123456 << QByteArray("123456789.12346");
+}
+
+void TestContentStream::postScriptNumber()
+{
+	QFETCH(double, value);
+	QFETCH(QByteArray, expected);
+	QCOMPARE(ScContentStream::number(value, PSLib::numberDecimals), expected);
+}
+
+void TestContentStream::numberRoundTrip()
+{
+	QRandomGenerator random(4711);
+	for (int i = 0; i < 100000; ++i)
+	{
+		double value = random.bounded(20000.0) - 10000.0;
+		if (i % 2)
+			value /= 1000.0;
+		QByteArray text = ScContentStream::number(value);
+		bool ok = false;
+		double parsed = text.toDouble(&ok);
+		QVERIFY(ok);
+		QVERIFY(!text.contains('e'));
+		// At most half a unit of the last digit off, allowing for the scaling in binary
+		QVERIFY2(std::fabs(parsed - value) <= 0.5e-5 + 1e-9, text.constData());
+		// Same value as the old formatting, which kept trailing zeros
+		QVERIFY2(std::fabs(parsed - referenceFToStr(value).toDouble()) <= 1.0e-5 + 1e-9, text.constData());
+		if (text.contains('.'))
+			QVERIFY(!text.endsWith('0'));
+	}
+}
+
+void TestContentStream::operators()
+{
+	QByteArray buffer("q\n");
+	ScContentStream cs(buffer);
+	cs << 1.5 << -2.0 << 3 << -40 << "m\n" << QByteArray("Q\n");
+	QCOMPARE(buffer, QByteArray("q\n1.5 -2 3 -40 m\nQ\n"));
+
+	QByteArray psBuffer;
+	ScContentStream(psBuffer, 2) << 0.125 << 0.333 << "li\n";
+	QCOMPARE(psBuffer, QByteArray("0.13 0.33 li\n"));
+}
+
+void TestContentStream::transform()
+{
+	QByteArray buffer;
+	QTransform matrix(0.5, 0.0, 0.0, -1.0, 12.25, 800.0);
+	ScContentStream(buffer) << matrix << "cm\n";
+	QCOMPARE(buffer, QByteArray("0.5 0 0 -1 12.25 800 cm\n"));
+}
+
+void TestContentStream::path()
+{
+	FPointArray points;
+	// A closed line and a curve after a marker
+	points.addQuadPoint(0, 0, 0, 0, 10, 0, 10, 0);
+	points.addQuadPoint(10, 0, 10, 0, 10, 10, 10, 10);
+	points.addQuadPoint(10, 10, 10, 10, 0, 0, 0, 0);
+	points.setMarker();
+	points.addQuadPoint(20, 20, 25, 20, 30, 30, 30, 25);
+
+	QByteArray pdf;
+	ScContentStream(pdf).appendPath(points, ScContentStream::pdfOperators);
+	QCOMPARE(pdf, QByteArray("0 0 m\n10 0 l\n10 -10 l\n0 0 l\nh\n20 -20 m\n25 -20 30 -25 30 -30 c\n"));
+
+	QByteArray open;
+	ScContentStream(open).appendPath(points, ScContentStream::pdfOperators, false);
+	QVERIFY(!open.contains("h\n"));
+
+	QByteArray ps;
+	ScContentStream(ps).appendPath(points, ScContentStream::postScriptOperators);
+	QCOMPARE(ps, QByteArray("0 0 m\n10 0 li\n10 -10 li\n0 0 li\ncl\n20 -20 m\n25 -20 30 -25 30 -30 cu\n"));
+}
+
+void TestContentStream::benchmarkNumbers_data()
+{
+	QTest::addColumn<bool>("reference");
+	QTest::newRow("QByteArray::number") << true;
+	QTest::newRow("ScContentStream") << false;
+}
+
+void TestContentStream::benchmarkNumbers()
+{
+	QFETCH(bool, reference);
+	QVector<double> values;
+	QRandomGenerator random(4711);
+	for (int i = 0; i < 10000; ++i)
+		values.append(random.bounded(1200.0) - 600.0);
+	QBENCHMARK
+	{
+		QByteArray buffer;
+		if (reference)
+		{
+			for (double value : qAsConst(values))
+				buffer += referenceFToStr(value) + " ";
+		}
+		else
+		{
+			ScContentStream cs(buffer);
+			for (double value : qAsConst(values))
+				cs << value;
+		}
+	}
+}
+
+void TestContentStream::benchmarkPath_data()
+{
+	benchmarkNumbers_data();
+}
+
+void TestContentStream::benchmarkPath()
+{
+	QFETCH(bool, reference);
+	FPointArray points = testPath(5000);
+	QBENCHMARK
+	{
+		QByteArray tmp;
+		if (reference)
+		{
+			// The loop of PDFLibCore::SetClipPathArray() before
+			FPoint np, np1, np2, np3, np4, firstP;
+			bool nPath = true;
+			bool first = true;
+			for (int poi = 0; poi < points.size() - 3; poi += 4)
+			{
+				if (points.isMarker(poi))
+				{
+					nPath = true;
+					continue;
+				}
+				if (nPath)
+				{
+					np = points.point(poi);
+					if ((!first) && (np4 == firstP))
+						tmp += "h\n";
+					tmp += referenceFToStr(np.x()) + " " + referenceFToStr(-np.y()) + " m\n";
+					nPath = false;
+					first = false;
+					firstP = np;
+					np4 = np;
+				}
+				np = points.point(poi);
+				np1 = points.point(poi + 1);
+				np2 = points.point(poi + 3);
+				np3 = points.point(poi + 2);
+				if ((np == np1) && (np2 == np3))
+					tmp += referenceFToStr(np3.x()) + " " + referenceFToStr(-np3.y()) + " l\n";
+				else
+				{
+					tmp += referenceFToStr(np1.x()) + " " + referenceFToStr(-np1.y()) + " ";
+					tmp += referenceFToStr(np2.x()) + " " + referenceFToStr(-np2.y()) + " ";
+					tmp += referenceFToStr(np3.x()) + " " + referenceFToStr(-np3.y()) + " c\n";
+				}
+				np4 = np3;
+			}
+		}
+		else
+			ScContentStream(tmp).appendPath(points, ScContentStream::pdfOperators);
+	}
+}
@@ -0,0 +1,33 @@
+/*
+ For general Scribus (>=1.3.2) copyright and licensing information please refer
+ to the COPYING file provided with the program. Following this notice may exist
+ a copyright and/or license notice that predates the release of Scribus 1.3.2
+ for which a new license (GPL+exception) is in place.
+ */
+
+#ifndef TESTCONTENTSTREAM_H
+#define TESTCONTENTSTREAM_H
+
+#include <QtTest/QtTest>
+
+class TestContentStream: public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void number_data();
+	void number();
+	void numberRoundTrip();
+	void postScriptNumber_data();
+	void postScriptNumber();
+	void operators();
+	void transform();
+	void path();
+
+	void benchmarkNumbers_data();
+	void benchmarkNumbers();
+	void benchmarkPath_data();
+	void benchmarkPath();
+};
+
+#endif
@@ -0,0 +1,54 @@
+/*
+ For general Scribus (>=1.3.2) copyright and licensing information please refer
+ to the COPYING file provided with the program. Following this notice may exist
+ a copyright and/or license notice that predates the release of Scribus 1.3.2
+ for which a new license (GPL+exception) is in place.
+ */
+
+#include "testDocumentChecker.h"
+
+#include "documentchecker.h"
+#include "scfonts.h"
+#include "styles/charstyle.h"
+#include "styles/paragraphstyle.h"
+#include "styles/styleset.h"
+
+// The stamps are filled the way DocumentChecker does for text frames, the style sets stand in for the document's
+void TestDocumentChecker::styleEditChangesStamp()
+{
+	StyleSet<ParagraphStyle> paragraphStyles;
+	StyleSet<CharStyle> charStyles;
+	CharStyle emphasis;
+	emphasis.setName("Emphasis");
+	emphasis.setFontSize(100);
+	CharStyle* docStyle = charStyles.create(emphasis);
+
+	DocumentCheckerCache::ItemStamp checked;
+	checked.paragraphStylesVersion = paragraphStyles.version();
+	checked.charStylesVersion = charStyles.version();
+
+	DocumentCheckerCache::ItemStamp unchanged = checked;
+	unchanged.paragraphStylesVersion = paragraphStyles.version();
+	unchanged.charStylesVersion = charStyles.version();
+	QVERIFY(unchanged == checked);
+
+	docStyle->setFontSize(200);
+	charStyles.invalidate();
+	DocumentCheckerCache::ItemStamp edited = checked;
+	edited.paragraphStylesVersion = paragraphStyles.version();
+	edited.charStylesVersion = charStyles.version();
+	QVERIFY(edited != checked);
+}
+
+void TestDocumentChecker::fontChangeChangesStamp()
+{
+	SCFonts fonts;
+	DocumentCheckerCache::ItemStamp checked;
+	checked.fontGeneration = fonts.generation();
+
+	// the font preferences end with this after enabling or disabling faces
+	fonts.updateFontMap();
+	DocumentCheckerCache::ItemStamp changed = checked;
+	changed.fontGeneration = fonts.generation();
+	QVERIFY(changed != checked);
+}
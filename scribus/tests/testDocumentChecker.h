@@ -0,0 +1,22 @@
+/*
+ For general Scribus (>=1.3.2) copyright and licensing information please refer
+ to the COPYING file provided with the program. Following this notice may exist
+ a copyright and/or license notice that predates the release of Scribus 1.3.2
+ for which a new license (GPL+exception) is in place.
+ */
+
+#ifndef TESTDOCUMENTCHECKER_H
+#define TESTDOCUMENTCHECKER_H
+
+#include <QtTest/QtTest>
+
+class TestDocumentChecker: public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void styleEditChangesStamp();
+	void fontChangeChangesStamp();
+};
+
+#endif
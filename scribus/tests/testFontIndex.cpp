@@ -0,0 +1,133 @@
+/*
+ For general Scribus (>=1.3.2) copyright and licensing information please refer
+ to the COPYING file provided with the program. Following this notice may exist
+ a copyright and/or license notice that predates the release of Scribus 1.3.2
+ for which a new license (GPL+exception) is in place.
+ */
+
+#include <QFile>
+#include <QTemporaryDir>
+
+#include "testFontIndex.h"
+#include "fonts/scfontindex.h"
+
+static ScFontIndexEntry testEntry(int faces)
+{
+	ScFontIndexEntry entry;
+	entry.size = 123456;
+	entry.modified = 1600000000;
+	entry.isOK = true;
+	entry.format = 5;
+	entry.facesKnown = true;
+	for (int i = 0; i < faces; ++i)
+	{
+		ScFontIndexFace face;
+		face.family = QString::fromUtf8("Ünïcode Sans");
+		face.style = (i == 0) ? "Regular" : "Bold";
+		face.psName = QString("UnicodeSans-%1").arg(face.style);
+		face.faceIndex = i;
+		face.type = 2;
+		face.hasGlyphNames = (i == 0);
+		face.subset = (i != 0);
+		face.features = QStringList() << "kern" << "liga" << "smcp";
+		entry.faces.append(face);
+	}
+	return entry;
+}
+
+void TestFontIndex::roundTrip()
+{
+	QTemporaryDir dir;
+	QString fileName = ScFontIndex::fileName(dir.path());
+
+	ScFontIndex index;
+	index.insert("/fonts/a.ttc", testEntry(2));
+	ScFontIndexEntry broken;
+	broken.size = 10;
+	broken.modified = 20;
+	broken.facesKnown = true;
+	broken.error = "Font is broken";
+	index.insert("/fonts/b.ttf", broken);
+	ScFontIndexEntry noFeatures = testEntry(1);
+	noFeatures.faces[0].features.clear();
+	index.insert("/fonts/c.otf", noFeatures);
+	QVERIFY(index.write(fileName));
+
+	ScFontIndex read;
+	QVERIFY(read.read(fileName));
+	QCOMPARE(read.count(), 3);
+	QVERIFY(read.entries() == index.entries());
+}
+
+void TestFontIndex::findChecksSizeAndTime()
+{
+	ScFontIndex index;
+	ScFontIndexEntry entry = testEntry(1);
+	index.insert("/fonts/a.ttf", entry);
+
+	QVERIFY(index.find("/fonts/a.ttf", entry.size, entry.modified) != nullptr);
+	QVERIFY(index.find("/fonts/a.ttf", entry.size + 1, entry.modified) == nullptr);
+	QVERIFY(index.find("/fonts/a.ttf", entry.size, entry.modified + 1) == nullptr);
+	QVERIFY(index.find("/fonts/b.ttf", entry.size, entry.modified) == nullptr);
+}
+
+void TestFontIndex::unknownSizeMatchesTime()
+{
+	ScFontIndex index;
+	ScFontIndexEntry entry;
+	entry.isOK = true;
+	entry.modified = 42;
+	index.insert("/fonts/old.pfb", entry);
+
+	const ScFontIndexEntry* found = index.find("/fonts/old.pfb", 98765, 42);
+	QVERIFY(found != nullptr);
+	QVERIFY(!found->facesKnown);
+	QVERIFY(index.find("/fonts/old.pfb", 98765, 43) == nullptr);
+}
+
+void TestFontIndex::damagedFileIsRejected()
+{
+	QTemporaryDir dir;
+	QString fileName = ScFontIndex::fileName(dir.path());
+
+	ScFontIndex index;
+	index.insert("/fonts/a.ttc", testEntry(3));
+	QVERIFY(index.write(fileName));
+
+	QFile file(fileName);
+	QVERIFY(file.open(QIODevice::ReadWrite));
+	QVERIFY(file.resize(file.size() - 7));
+	file.close();
+
+	ScFontIndex read;
+	QVERIFY(!read.read(fileName));
+	QVERIFY(read.isEmpty());
+
+	QVERIFY(file.open(QIODevice::WriteOnly | QIODevice::Truncate));
+	file.write("<CachedFonts></CachedFonts>");
+	file.close();
+	QVERIFY(!read.read(fileName));
+	QVERIFY(!read.read(dir.filePath("missing.bin")));
+}
+
+void TestFontIndex::modifiedFlag()
+{
+	QTemporaryDir dir;
+	QString fileName = ScFontIndex::fileName(dir.path());
+
+	ScFontIndex index;
+	QVERIFY(!index.isModified());
+	index.insert("/fonts/a.ttf", testEntry(1));
+	QVERIFY(index.isModified());
+	QVERIFY(index.write(fileName));
+	QVERIFY(!index.isModified());
+
+	index.remove("/fonts/missing.ttf");
+	QVERIFY(!index.isModified());
+	index.remove("/fonts/a.ttf");
+	QVERIFY(index.isModified());
+
+	QVERIFY(index.read(fileName));
+	QVERIFY(!index.isModified());
+	QCOMPARE(index.count(), 1);
+}
@@ -0,0 +1,90 @@
+/*
+ For general Scribus (>=1.3.2) copyright and licensing information please refer
+ to the COPYING file provided with the program. Following this notice may exist
+ a copyright and/or license notice that predates the release of Scribus 1.3.2
+ for which a new license (GPL+exception) is in place.
+ */
+
+#include "testHyphenWordCache.h"
+#include "hyphenwordcache.h"
+
+void TestHyphenWordCache::findAfterInsert()
+{
+	HyphenWordCache cache;
+	QByteArray hyphens;
+	QVERIFY(!cache.find("hyph_en_US.dic", "hyphenate", hyphens));
+
+	QByteArray flags("\0\1\0\0\1\0\0\0\0", 9);
+	cache.insert("hyph_en_US.dic", "hyphenate", flags);
+	QVERIFY(cache.find("hyph_en_US.dic", "hyphenate", hyphens));
+	QCOMPARE(hyphens, flags);
+
+	// Failed words are cached with empty flags
+	cache.insert("hyph_en_US.dic", "xyzzy", QByteArray());
+	QVERIFY(cache.find("hyph_en_US.dic", "xyzzy", hyphens));
+	QVERIFY(hyphens.isEmpty());
+}
+
+void TestHyphenWordCache::dictionariesAreSeparate()
+{
+	HyphenWordCache cache;
+	cache.insert("hyph_en_US.dic", "gift", QByteArray("\0\0\0\0", 4));
+	cache.insert("hyph_de_DE.dic", "gift", QByteArray("\0\1\0\0", 4));
+	QCOMPARE(cache.count("hyph_en_US.dic"), 1);
+	QCOMPARE(cache.count("hyph_de_DE.dic"), 1);
+
+	QByteArray hyphens;
+	QVERIFY(cache.find("hyph_de_DE.dic", "gift", hyphens));
+	QCOMPARE(hyphens, QByteArray("\0\1\0\0", 4));
+	QVERIFY(!cache.find("hyph_fr_FR.dic", "gift", hyphens));
+}
+
+void TestHyphenWordCache::evictsLeastRecentlyUsed()
+{
+	HyphenWordCache cache(8);
+	for (int i = 0; i < 8; ++i)
+		cache.insert("dict", QString("word%1").arg(i), QByteArray(6, '\0'));
+	QCOMPARE(cache.count("dict"), 8);
+
+	// Using the first word makes word1 the oldest
+	QByteArray hyphens;
+	QVERIFY(cache.find("dict", "word0", hyphens));
+	cache.insert("dict", "word8", QByteArray(6, '\0'));
+	QVERIFY(cache.count("dict") <= 6);
+	QVERIFY(cache.find("dict", "word0", hyphens));
+	QVERIFY(cache.find("dict", "word8", hyphens));
+	QVERIFY(!cache.find("dict", "word1", hyphens));
+
+	// Other dictionaries have their own budget
+	cache.insert("other", "word", QByteArray(5, '\0'));
+	QVERIFY(cache.find("dict", "word0", hyphens));
+
+	cache.setMaxWords(2);
+	QVERIFY(cache.count("dict") <= 2);
+}
+
+void TestHyphenWordCache::clearDictionary()
+{
+	HyphenWordCache cache;
+	cache.insert("hyph_en_US.dic", "word", QByteArray(5, '\0'));
+	cache.insert("hyph_de_DE.dic", "wort", QByteArray(5, '\0'));
+	cache.clear("hyph_en_US.dic");
+	QCOMPARE(cache.count("hyph_en_US.dic"), 0);
+	QCOMPARE(cache.count("hyph_de_DE.dic"), 1);
+	cache.clear();
+	QCOMPARE(cache.count("hyph_de_DE.dic"), 0);
+}
+
+void TestHyphenWordCache::statistics()
+{
+	HyphenWordCache cache;
+	QByteArray hyphens;
+	cache.find("dict", "word", hyphens);
+	cache.insert("dict", "word", QByteArray(5, '\0'));
+	cache.find("dict", "word", hyphens);
+	cache.find("dict", "word", hyphens);
+	QCOMPARE(cache.statistics().misses, quint64(1));
+	QCOMPARE(cache.statistics().hits, quint64(2));
+	cache.resetStatistics();
+	QCOMPARE(cache.statistics().hits, quint64(0));
+}
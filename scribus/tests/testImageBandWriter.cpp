@@ -0,0 +1,111 @@
+/*
+ For general Scribus (>=1.3.2) copyright and licensing information please refer
+ to the COPYING file provided with the program. Following this notice may exist
+ a copyright and/or license notice that predates the release of Scribus 1.3.2
+ for which a new license (GPL+exception) is in place.
+ */
+
+#include <cstdint>
+#include <tiffio.h>
+
+#include <QTemporaryDir>
+
+#include "testImageBandWriter.h"
+#include "imagebandwriter.h"
+#include "pagerenderer.h"
+
+static QImage testImage(int width, int height)
+{
+	QImage image(width, height, QImage::Format_ARGB32_Premultiplied);
+	for (int y = 0; y < height; ++y)
+	{
+		QRgb* line = reinterpret_cast<QRgb*>(image.scanLine(y));
+		for (int x = 0; x < width; ++x)
+			line[x] = qRgba((x * 7) & 0xFF, (y * 3) & 0xFF, (x + y) & 0xFF, 255);
+	}
+	return image;
+}
+
+static bool writeInBands(ImageBandWriter& writer, const QImage& image, int bandHeight)
+{
+	for (int top = 0; top < image.height(); top += bandHeight)
+	{
+		if (!writer.writeBand(image.copy(0, top, image.width(), qMin(bandHeight, image.height() - top))))
+			return false;
+	}
+	return true;
+}
+
+void TestImageBandWriter::pngRoundTrip()
+{
+	QTemporaryDir dir;
+	QString fileName = dir.filePath("page.png");
+	QImage image = testImage(301, 257);
+
+	ImageBandWriter writer;
+	QVERIFY(writer.open(fileName, "png", image.size(), 11811, true));
+	QVERIFY(writeInBands(writer, image, 40));
+	QVERIFY(writer.close());
+
+	QImage result(fileName);
+	QCOMPARE(result.size(), image.size());
+	QCOMPARE(result.dotsPerMeterX(), 11811);
+	QCOMPARE(result.convertToFormat(QImage::Format_ARGB32_Premultiplied), image);
+}
+
+void TestImageBandWriter::tiffRoundTrip()
+{
+	QTemporaryDir dir;
+	QString fileName = dir.filePath("page.tif");
+	QImage image = testImage(123, 77);
+
+	ImageBandWriter writer(1);
+	QVERIFY(writer.open(fileName, "tif", image.size(), 11811, false));
+	QVERIFY(writeInBands(writer, image, 10));
+	QVERIFY(writer.close());
+
+	TIFF* tif = TIFFOpen(fileName.toLocal8Bit().data(), "r");
+	QVERIFY(tif);
+	uint32_t width = 0;
+	uint32_t height = 0;
+	uint16_t samples = 0;
+	TIFFGetField(tif, TIFFTAG_IMAGEWIDTH, &width);
+	TIFFGetField(tif, TIFFTAG_IMAGELENGTH, &height);
+	TIFFGetField(tif, TIFFTAG_SAMPLESPERPIXEL, &samples);
+	QCOMPARE(int(width), image.width());
+	QCOMPARE(int(height), image.height());
+	QCOMPARE(int(samples), 3);
+	QImage expected = image.convertToFormat(QImage::Format_RGB888);
+	QByteArray line(TIFFScanlineSize(tif), 0);
+	for (int y = 0; y < image.height(); ++y)
+	{
+		QVERIFY(TIFFReadScanline(tif, line.data(), y, 0) >= 0);
+		QVERIFY(memcmp(line.constData(), expected.constScanLine(y), image.width() * 3) == 0);
+	}
+	TIFFClose(tif);
+}
+
+void TestImageBandWriter::incompleteImageIsRemoved()
+{
+	QTemporaryDir dir;
+	QString fileName = dir.filePath("page.png");
+	QImage image = testImage(64, 64);
+
+	ImageBandWriter writer;
+	QVERIFY(!writer.open(fileName, "jpg", image.size(), 0, true));
+	QVERIFY(writer.open(fileName, "png", image.size(), 0, true));
+	QVERIFY(writer.writeBand(image.copy(0, 0, 64, 32)));
+	// Bands must have the width of the image and must not run past its bottom
+	QVERIFY(!writer.writeBand(image.copy(0, 0, 32, 32)));
+	QVERIFY(!writer.writeBand(image));
+	QVERIFY(!writer.close());
+	QVERIFY(!QFile::exists(fileName));
+}
+
+void TestImageBandWriter::bandHeights()
+{
+	QCOMPARE(PageRenderer::bandHeight(QSize(1000, 5000), 4000 * 100), 100);
+	QCOMPARE(PageRenderer::bandHeight(QSize(1000, 50), 4000 * 100), 50);
+	QCOMPARE(PageRenderer::bandHeight(QSize(100000, 10), 1000), 1);
+	QCOMPARE(PageRenderer::bandHeight(QSize(), 1000), 0);
+}
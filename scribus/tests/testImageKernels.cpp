@@ -0,0 +1,421 @@
+/*
+ For general Scribus (>=1.3.2) copyright and licensing information please refer
+ to the COPYING file provided with the program. Following this notice may exist
+ a copyright and/or license notice that predates the release of Scribus 1.3.2
+ for which a new license (GPL+exception) is in place.
+ */
+
+#include <cmath>
+#include <cstdlib>
+
+#include <QRandomGenerator>
+#include <QVector>
+
+#include "testImageKernels.h"
+#include "scimagekernels.h"
+
+static QImage testImage(int width, int height)
+{
+	QImage image(width, height, QImage::Format_ARGB32);
+	QRandomGenerator random(4711);
+	for (int y = 0; y < height; ++y)
+	{
+		QRgb* s = reinterpret_cast<QRgb*>(image.scanLine(y));
+		// Smooth gradients with noise, like photos, and some flat areas
+		for (int x = 0; x < width; ++x)
+		{
+			if ((x / 16 + y / 16) % 5 == 0)
+				s[x] = qRgba(255, 255, 255, 255);
+			else
+				s[x] = qRgba((x * 7 + random.bounded(32)) & 0xff, (y * 3 + random.bounded(32)) & 0xff, (x + y + random.bounded(64)) & 0xff, random.bounded(256));
+		}
+	}
+	return image;
+}
+
+// The per pixel implementations ScImage used before, kept as reference for the results and the speed
+
+static void referenceBlur(QImage& image, int radius)
+{
+	if (radius < 1)
+		return;
+	QRgb *pix = (QRgb*) image.bits();
+	int w = image.width();
+	int h = image.height();
+	int wm = w - 1;
+	int hm = h - 1;
+	int wh = w * h;
+	int div = radius + radius + 1;
+	int *r = new int[wh];
+	int *g = new int[wh];
+	int *b = new int[wh];
+	int *a = new int[wh];
+	int rsum, gsum, bsum, asum, x, y, i, yp, yi, yw;
+	QRgb p;
+	int *vmin = new int[qMax(w, h)];
+	int divsum = (div + 1) >> 1;
+	divsum *= divsum;
+	int *dv = new int[256 * divsum];
+	for (i = 0; i < 256 * divsum; ++i)
+		dv[i] = (i / divsum);
+	yw = yi = 0;
+	QVector<int> stackData(div * 4);
+	int stackpointer, stackstart, rbs;
+	int *sir;
+	int r1 = radius + 1;
+	int routsum, goutsum, boutsum, aoutsum;
+	int rinsum, ginsum, binsum, ainsum;
+	for (y = 0; y < h; ++y)
+	{
+		rinsum = ginsum = binsum = ainsum = routsum = goutsum = boutsum = aoutsum = rsum = gsum = bsum = asum = 0;
+		for (i = -radius; i <= radius; ++i)
+		{
+			p = pix[yi + qMin(wm, qMax(i, 0))];
+			sir = &stackData[(i + radius) * 4];
+			sir[0] = qRed(p); sir[1] = qGreen(p); sir[2] = qBlue(p); sir[3] = qAlpha(p);
+			rbs = r1 - abs(i);
+			rsum += sir[0] * rbs; gsum += sir[1] * rbs; bsum += sir[2] * rbs; asum += sir[3] * rbs;
+			if (i > 0)
+			{
+				rinsum += sir[0]; ginsum += sir[1]; binsum += sir[2]; ainsum += sir[3];
+			}
+			else
+			{
+				routsum += sir[0]; goutsum += sir[1]; boutsum += sir[2]; aoutsum += sir[3];
+			}
+		}
+		stackpointer = radius;
+		for (x = 0; x < w; ++x)
+		{
+			r[yi] = dv[rsum]; g[yi] = dv[gsum]; b[yi] = dv[bsum]; a[yi] = dv[asum];
+			rsum -= routsum; gsum -= goutsum; bsum -= boutsum; asum -= aoutsum;
+			stackstart = stackpointer - radius + div;
+			sir = &stackData[(stackstart % div) * 4];
+			routsum -= sir[0]; goutsum -= sir[1]; boutsum -= sir[2]; aoutsum -= sir[3];
+			if (y == 0)
+				vmin[x] = qMin(x + radius + 1, wm);
+			p = pix[yw + vmin[x]];
+			sir[0] = qRed(p); sir[1] = qGreen(p); sir[2] = qBlue(p); sir[3] = qAlpha(p);
+			rinsum += sir[0]; ginsum += sir[1]; binsum += sir[2]; ainsum += sir[3];
+			rsum += rinsum; gsum += ginsum; bsum += binsum; asum += ainsum;
+			stackpointer = (stackpointer + 1) % div;
+			sir = &stackData[(stackpointer % div) * 4];
+			routsum += sir[0]; goutsum += sir[1]; boutsum += sir[2]; aoutsum += sir[3];
+			rinsum -= sir[0]; ginsum -= sir[1]; binsum -= sir[2]; ainsum -= sir[3];
+			++yi;
+		}
+		yw += w;
+	}
+	for (x = 0; x < w; ++x)
+	{
+		rinsum = ginsum = binsum = ainsum = routsum = goutsum = boutsum = aoutsum = rsum = gsum = bsum = asum = 0;
+		yp = -radius * w;
+		for (i = -radius; i <= radius; ++i)
+		{
+			yi = qMax(0, yp) + x;
+			sir = &stackData[(i + radius) * 4];
+			sir[0] = r[yi]; sir[1] = g[yi]; sir[2] = b[yi]; sir[3] = a[yi];
+			rbs = r1 - abs(i);
+			rsum += r[yi] * rbs; gsum += g[yi] * rbs; bsum += b[yi] * rbs; asum += a[yi] * rbs;
+			if (i > 0)
+			{
+				rinsum += sir[0]; ginsum += sir[1]; binsum += sir[2]; ainsum += sir[3];
+			}
+			else
+			{
+				routsum += sir[0]; goutsum += sir[1]; boutsum += sir[2]; aoutsum += sir[3];
+			}
+			if (i < hm)
+				yp += w;
+		}
+		yi = x;
+		stackpointer = radius;
+		for (y = 0; y < h; ++y)
+		{
+			pix[yi] = qRgba(dv[rsum], dv[gsum], dv[bsum], dv[asum]);
+			rsum -= routsum; gsum -= goutsum; bsum -= boutsum; asum -= aoutsum;
+			stackstart = stackpointer - radius + div;
+			sir = &stackData[(stackstart % div) * 4];
+			routsum -= sir[0]; goutsum -= sir[1]; boutsum -= sir[2]; aoutsum -= sir[3];
+			if (x == 0)
+				vmin[y] = qMin(y + r1, hm) * w;
+			p = x + vmin[y];
+			sir[0] = r[p]; sir[1] = g[p]; sir[2] = b[p]; sir[3] = a[p];
+			rinsum += sir[0]; ginsum += sir[1]; binsum += sir[2]; ainsum += sir[3];
+			rsum += rinsum; gsum += ginsum; bsum += binsum; asum += ainsum;
+			stackpointer = (stackpointer + 1) % div;
+			sir = &stackData[stackpointer * 4];
+			routsum += sir[0]; goutsum += sir[1]; boutsum += sir[2]; aoutsum += sir[3];
+			rinsum -= sir[0]; ginsum -= sir[1]; binsum -= sir[2]; ainsum -= sir[3];
+			yi += w;
+		}
+	}
+	delete [] r;
+	delete [] g;
+	delete [] b;
+	delete [] a;
+	delete [] vmin;
+	delete [] dv;
+}
+
+static void referenceConvolve(const QImage& image, QImage& dest, int widthk, const double* kernel)
+{
+	QVector<double> normalKernel(widthk * widthk);
+	dest = QImage(image.width(), image.height(), QImage::Format_ARGB32);
+	double normalize = 0.0;
+	for (int i = 0; i < (widthk * widthk); i++)
+		normalize += kernel[i];
+	if (fabs(normalize) <= 1.0e-12)
+		normalize = 1.0;
+	normalize = 1.0 / normalize;
+	for (int i = 0; i < (widthk * widthk); i++)
+		normalKernel[i] = normalize * kernel[i];
+	for (int y = 0; y < dest.height(); ++y)
+	{
+		unsigned int* q = (unsigned int *) dest.scanLine(y);
+		for (int x = 0; x < dest.width(); ++x)
+		{
+			const double* k = normalKernel.constData();
+			double red = 0, green = 0, blue = 0, alpha = 0;
+			int sy = y - (widthk / 2);
+			for (int mcy = 0; mcy < widthk; ++mcy, ++sy)
+			{
+				int my = sy < 0 ? 0 : sy > image.height() - 1 ? image.height() - 1 : sy;
+				int sx = x + (-widthk / 2);
+				for (int mcx = 0; mcx < widthk; ++mcx, ++sx)
+				{
+					int mx = sx < 0 ? 0 : sx > image.width() - 1 ? image.width() - 1 : sx;
+					int px = image.pixel(mx, my);
+					red += (*k) * (qRed(px) * 257);
+					green += (*k) * (qGreen(px) * 257);
+					blue += (*k) * (qBlue(px) * 257);
+					alpha += (*k) * (qAlpha(px) * 257);
+					++k;
+				}
+			}
+			red = red < 0 ? 0 : red > 65535 ? 65535 : red + 0.5;
+			green = green < 0 ? 0 : green > 65535 ? 65535 : green + 0.5;
+			blue = blue < 0 ? 0 : blue > 65535 ? 65535 : blue + 0.5;
+			alpha = alpha < 0 ? 0 : alpha > 65535 ? 65535 : alpha + 0.5;
+			*q++ = qRgba((unsigned char)(red / 257UL), (unsigned char)(green / 257UL), (unsigned char)(blue / 257UL), (unsigned char)(alpha / 257UL));
+		}
+	}
+}
+
+static void referenceMapLuminance(QImage& image, const QRgb* table, bool cmyk)
+{
+	for (int yi = 0; yi < image.height(); ++yi)
+	{
+		QRgb* s = (QRgb*) image.scanLine(yi);
+		for (int xi = 0; xi < image.width(); ++xi, ++s)
+		{
+			QRgb r = *s;
+			if (cmyk)
+				*s = table[qMin(qRound(0.3 * qRed(r) + 0.59 * qGreen(r) + 0.11 * qBlue(r) + qAlpha(r)), 255)];
+			else
+			{
+				QRgb t = table[qMin(qRound(0.3 * qRed(r) + 0.59 * qGreen(r) + 0.11 * qBlue(r)), 255)];
+				*s = qRgba(qRed(t), qGreen(t), qBlue(t), qAlpha(r));
+			}
+		}
+	}
+}
+
+// Sharpen kernel as made by ScImage::sharpen()
+static QVector<double> sharpenKernel(int widthk, double sigma)
+{
+	QVector<double> kernel(widthk * widthk);
+	double normalize = 0.0;
+	int i = 0;
+	for (int v = -widthk / 2; v <= widthk / 2; v++)
+	{
+		for (int u = -widthk / 2; u <= widthk / 2; u++)
+		{
+			double alpha = exp(-((double) u * u + v * v) / (2.0 * sigma * sigma));
+			kernel[i] = alpha / (2.0 * 3.14159265358979323846 * sigma * sigma);
+			normalize += kernel[i];
+			i++;
+		}
+	}
+	kernel[i / 2] = (-2.0) * normalize;
+	return kernel;
+}
+
+static QVector<QRgb> luminanceTable()
+{
+	QVector<QRgb> table(256);
+	for (int l = 0; l < 256; ++l)
+		table[l] = qRgba(255 - l, l / 2, (l * 3) & 0xff, l);
+	return table;
+}
+
+void TestImageKernels::blurMatchesReference_data()
+{
+	QTest::addColumn<int>("width");
+	QTest::addColumn<int>("height");
+	QTest::addColumn<int>("radius");
+	QTest::newRow("small radius") << 301 << 203 << 2;
+	QTest::newRow("large radius") << 517 << 389 << 25;
+	QTest::newRow("radius above size") << 7 << 5 << 12;
+	QTest::newRow("single column") << 1 << 64 << 3;
+}
+
+void TestImageKernels::blurMatchesReference()
+{
+	QFETCH(int, width);
+	QFETCH(int, height);
+	QFETCH(int, radius);
+	QImage expected = testImage(width, height);
+	QImage result = expected.copy();
+	referenceBlur(expected, radius);
+	ScImageKernels::blur(result, radius);
+	QCOMPARE(result, expected);
+}
+
+void TestImageKernels::convolveMatchesReference_data()
+{
+	QTest::addColumn<int>("width");
+	QTest::addColumn<int>("height");
+	QTest::addColumn<int>("order");
+	QTest::newRow("3x3") << 211 << 97 << 3;
+	QTest::newRow("7x7") << 130 << 150 << 7;
+	QTest::newRow("kernel wider than image") << 4 << 30 << 9;
+}
+
+void TestImageKernels::convolveMatchesReference()
+{
+	QFETCH(int, width);
+	QFETCH(int, height);
+	QFETCH(int, order);
+	QImage image = testImage(width, height);
+	QVector<double> kernel = sharpenKernel(order, 1.0);
+	QImage expected;
+	QImage result;
+	referenceConvolve(image, expected, order, kernel.constData());
+	QVERIFY(ScImageKernels::convolve(image, result, order, kernel.constData()));
+	QCOMPARE(result, expected);
+
+	QVERIFY(!ScImageKernels::convolve(image, result, 4, kernel.constData()));
+}
+
+void TestImageKernels::mapBytes()
+{
+	QImage image = testImage(333, 222);
+	QImage expected = image.copy();
+	uchar tables[4][256];
+	for (int i = 0; i < 256; ++i)
+	{
+		tables[0][i] = 255 - i;
+		tables[1][i] = i / 2;
+		tables[2][i] = i;
+		tables[3][i] = (i * 7) & 0xff;
+	}
+	for (int y = 0; y < expected.height(); ++y)
+	{
+		uchar* p = expected.scanLine(y);
+		for (int x = 0; x < expected.width() * 4; ++x)
+			p[x] = tables[x % 4][p[x]];
+	}
+	ScImageKernels::mapBytes(image, &tables[0][0]);
+	QCOMPARE(image, expected);
+}
+
+void TestImageKernels::mapLuminanceMatchesReference()
+{
+	QVector<QRgb> table = luminanceTable();
+	for (bool cmyk : { false, true })
+	{
+		// An odd width also covers the pixels after the last group of four
+		QImage expected = testImage(257, 131);
+		QImage result = expected.copy();
+		referenceMapLuminance(expected, table.constData(), cmyk);
+		ScImageKernels::mapLuminance(result, table.constData(), cmyk);
+		QCOMPARE(result, expected);
+	}
+}
+
+void TestImageKernels::mapPixels()
+{
+	QImage image = testImage(300, 400);
+	QImage expected = image.copy();
+	expected.invertPixels(QImage::InvertRgb);
+	ScImageKernels::mapPixels(image, [](QRgb p) { return p ^ 0x00ffffff; });
+	QCOMPARE(image, expected);
+}
+
+static void addSizes()
+{
+	QTest::addColumn<int>("width");
+	QTest::addColumn<int>("height");
+	QTest::addColumn<bool>("reference");
+	QTest::newRow("640x480 reference") << 640 << 480 << true;
+	QTest::newRow("640x480") << 640 << 480 << false;
+	QTest::newRow("1920x1080 reference") << 1920 << 1080 << true;
+	QTest::newRow("1920x1080") << 1920 << 1080 << false;
+	QTest::newRow("4000x3000 reference") << 4000 << 3000 << true;
+	QTest::newRow("4000x3000") << 4000 << 3000 << false;
+}
+
+void TestImageKernels::benchmarkBlur_data()
+{
+	addSizes();
+}
+
+void TestImageKernels::benchmarkBlur()
+{
+	QFETCH(int, width);
+	QFETCH(int, height);
+	QFETCH(bool, reference);
+	QImage image = testImage(width, height);
+	QBENCHMARK
+	{
+		if (reference)
+			referenceBlur(image, 10);
+		else
+			ScImageKernels::blur(image, 10);
+	}
+}
+
+void TestImageKernels::benchmarkConvolve_data()
+{
+	addSizes();
+}
+
+void TestImageKernels::benchmarkConvolve()
+{
+	QFETCH(int, width);
+	QFETCH(int, height);
+	QFETCH(bool, reference);
+	QImage image = testImage(width, height);
+	// Width of the sharpen kernel for radius 2
+	QVector<double> kernel = sharpenKernel(5, 1.0);
+	QImage dest;
+	QBENCHMARK
+	{
+		if (reference)
+			referenceConvolve(image, dest, 5, kernel.constData());
+		else
+			ScImageKernels::convolve(image, dest, 5, kernel.constData());
+	}
+}
+
+void TestImageKernels::benchmarkLuminance_data()
+{
+	addSizes();
+}
+
+void TestImageKernels::benchmarkLuminance()
+{
+	QFETCH(int, width);
+	QFETCH(int, height);
+	QFETCH(bool, reference);
+	QImage image = testImage(width, height);
+	QVector<QRgb> table = luminanceTable();
+	QBENCHMARK
+	{
+		if (reference)
+			referenceMapLuminance(image, table.constData(), false);
+		else
+			ScImageKernels::mapLuminance(image, table.constData(), false);
+	}
+}
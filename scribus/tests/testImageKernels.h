@@ -0,0 +1,34 @@
+/*
+ For general Scribus (>=1.3.2) copyright and licensing information please refer
+ to the COPYING file provided with the program. Following this notice may exist
+ a copyright and/or license notice that predates the release of Scribus 1.3.2
+ for which a new license (GPL+exception) is in place.
+ */
+
+#ifndef TESTIMAGEKERNELS_H
+#define TESTIMAGEKERNELS_H
+
+#include <QtTest/QtTest>
+
+class TestImageKernels: public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void blurMatchesReference_data();
+	void blurMatchesReference();
+	void convolveMatchesReference_data();
+	void convolveMatchesReference();
+	void mapBytes();
+	void mapLuminanceMatchesReference();
+	void mapPixels();
+
+	void benchmarkBlur_data();
+	void benchmarkBlur();
+	void benchmarkConvolve_data();
+	void benchmarkConvolve();
+	void benchmarkLuminance_data();
+	void benchmarkLuminance();
+};
+
+#endif
@@ -0,0 +1,156 @@
+/*
+ For general Scribus (>=1.3.2) copyright and licensing information please refer
+ to the COPYING file provided with the program. Following this notice may exist
+ a copyright and/or license notice that predates the release of Scribus 1.3.2
+ for which a new license (GPL+exception) is in place.
+ */
+
+#include "testImageLoadQueue.h"
+#include "imageloadqueue.h"
+
+#include <algorithm>
+
+void TestImageLoadQueue::groupEqualKeys()
+{
+	QStringList keys;
+	keys << "a.tif" << "b.psd" << "a.tif" << "c.jpg" << "b.psd" << "a.tif";
+	QList<int> owners = ImageLoadQueue::groupByKey(keys);
+	QList<int> expected;
+	expected << 0 << 1 << 0 << 3 << 1 << 0;
+	QCOMPARE(owners, expected);
+}
+
+void TestImageLoadQueue::emptyKeysStayAlone()
+{
+	QStringList keys;
+	keys << QString() << "a.tif" << QString() << "a.tif";
+	QList<int> owners = ImageLoadQueue::groupByKey(keys);
+	QList<int> expected;
+	expected << 0 << 1 << 2 << 1;
+	QCOMPARE(owners, expected);
+}
+
+namespace
+{
+	// Stands in for the picture decoder, counting the decodes and the jobs decoding at the same time
+	class CountingJob : public ImageLoadJob
+	{
+	public:
+		CountingJob(const QString& fileName, qint64 bytes) :
+			ImageLoadJob(nullptr, fileName, QString(), Intent_Perceptual)
+		{
+			m_expectedBytes = bytes;
+		}
+
+		bool decode() override
+		{
+			int now = decoding.fetchAndAddOrdered(1) + 1;
+			int most = mostDecoding.loadAcquire();
+			while (now > most && !mostDecoding.testAndSetOrdered(most, now))
+				most = mostDecoding.loadAcquire();
+			decodes.fetchAndAddOrdered(1);
+			QThread::msleep(20);
+			image = ScImage(QImage(4, 4, QImage::Format_ARGB32));
+			success = true;
+			decoding.fetchAndAddOrdered(-1);
+			return true;
+		}
+
+		void process() override {}
+
+		static void reset()
+		{
+			decoding.storeRelease(0);
+			mostDecoding.storeRelease(0);
+			decodes.storeRelease(0);
+		}
+
+		static QAtomicInt decoding;
+		static QAtomicInt mostDecoding;
+		static QAtomicInt decodes;
+	};
+
+	QAtomicInt CountingJob::decoding;
+	QAtomicInt CountingJob::mostDecoding;
+	QAtomicInt CountingJob::decodes;
+
+	QList< QSharedPointer<ImageLoadJob> > countingJobs(const QStringList& fileNames, qint64 bytes)
+	{
+		QList< QSharedPointer<ImageLoadJob> > jobs;
+		for (const QString& fileName : fileNames)
+			jobs.append(QSharedPointer<ImageLoadJob>(new CountingJob(fileName, bytes)));
+		return jobs;
+	}
+}
+
+void TestImageLoadQueue::equalKeysDecodeOnce()
+{
+	CountingJob::reset();
+	QStringList fileNames;
+	fileNames << "a.tif" << "b.psd" << "a.tif" << "a.tif";
+	QList< QSharedPointer<ImageLoadJob> > jobs = countingJobs(fileNames, 100);
+	QList<int> finished;
+	ImageLoadQueue::runJobs(jobs, 1000, 4, [&](int index, ImageLoadJob& job)
+	{
+		if (job.success)
+			finished.append(index);
+		return true;
+	});
+	QCOMPARE(CountingJob::decodes.loadAcquire(), 2);
+	std::sort(finished.begin(), finished.end());
+	QCOMPARE(finished, QList<int>() << 0 << 1 << 2 << 3);
+	// The followers share the pixels of the one decode
+	const uchar* pixels = jobs[0]->image.qImage().constBits();
+	QCOMPARE(jobs[2]->image.qImage().constBits(), pixels);
+	QCOMPARE(jobs[3]->image.qImage().constBits(), pixels);
+	QVERIFY(jobs[1]->image.qImage().constBits() != pixels);
+}
+
+void TestImageLoadQueue::budgetLimitsJobsInFlight()
+{
+	QVERIFY(ImageLoadQueue::fitsBudget(0, 60, 100, 0));
+	QVERIFY(ImageLoadQueue::fitsBudget(40, 60, 100, 1));
+	QVERIFY(!ImageLoadQueue::fitsBudget(60, 60, 100, 1));
+
+	// Two jobs never fit together, so the queue decodes one after the other although it may use four threads
+	CountingJob::reset();
+	QStringList fileNames;
+	fileNames << "a.tif" << "b.tif" << "c.tif" << "d.tif";
+	ImageLoadQueue::runJobs(countingJobs(fileNames, 60), 100, 4, [](int, ImageLoadJob&) { return true; });
+	QCOMPARE(CountingJob::decodes.loadAcquire(), 4);
+	QCOMPARE(CountingJob::mostDecoding.loadAcquire(), 1);
+}
+
+void TestImageLoadQueue::oversizedJobStillRuns()
+{
+	QVERIFY(ImageLoadQueue::fitsBudget(0, 500, 100, 0));
+	QVERIFY(!ImageLoadQueue::fitsBudget(10, 500, 100, 1));
+
+	CountingJob::reset();
+	QStringList fileNames;
+	fileNames << "huge.tif" << "small.tif";
+	int finished = 0;
+	ImageLoadQueue::runJobs(countingJobs(fileNames, 500), 100, 4, [&](int, ImageLoadJob& job)
+	{
+		if (job.success)
+			++finished;
+		return true;
+	});
+	QCOMPARE(finished, 2);
+	QCOMPARE(CountingJob::mostDecoding.loadAcquire(), 1);
+}
+
+void TestImageLoadQueue::cancelDropsPendingJobs()
+{
+	CountingJob::reset();
+	QStringList fileNames;
+	fileNames << "a.tif" << "b.tif" << "c.tif" << "d.tif" << "e.tif";
+	int finished = 0;
+	ImageLoadQueue::runJobs(countingJobs(fileNames, 100), 1000, 1, [&](int, ImageLoadJob&)
+	{
+		++finished;
+		return false;
+	});
+	QCOMPARE(finished, 1);
+	QCOMPARE(CountingJob::decodes.loadAcquire(), 1);
+}
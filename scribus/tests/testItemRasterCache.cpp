@@ -0,0 +1,64 @@
+/*
+ For general Scribus (>=1.3.2) copyright and licensing information please refer
+ to the COPYING file provided with the program. Following this notice may exist
+ a copyright and/or license notice that predates the release of Scribus 1.3.2
+ for which a new license (GPL+exception) is in place.
+ */
+
+#include "testItemRasterCache.h"
+#include "itemrastercache.h"
+
+static QImage itemImage()
+{
+	// 64 x 64 x 4 bytes = 16 KiB
+	QImage image(64, 64, QImage::Format_ARGB32_Premultiplied);
+	image.fill(qRgba(0, 0, 0, 0));
+	return image;
+}
+
+void TestItemRasterCache::findByRevisionAndState()
+{
+	ItemRasterCache cache(1024 * 1024);
+	QVERIFY(cache.insert(1, 10, itemImage(), QPoint(5, 6), QRectF(0.0, 0.0, 10.0, 10.0)));
+	QImage image;
+	QPoint position;
+	QVERIFY(cache.find(1, 10, image, position));
+	QCOMPARE(position, QPoint(5, 6));
+	QCOMPARE(image.size(), QSize(64, 64));
+	QVERIFY(!cache.find(2, 10, image, position));
+	QVERIFY(!cache.find(1, 11, image, position));
+}
+
+void TestItemRasterCache::evictLeastRecentlyUsed()
+{
+	ItemRasterCache cache(3 * 16 * 1024);
+	QVERIFY(cache.insert(1, 0, itemImage(), QPoint(), QRectF(0.0, 0.0, 10.0, 10.0)));
+	QVERIFY(cache.insert(2, 0, itemImage(), QPoint(), QRectF(0.0, 0.0, 10.0, 10.0)));
+	QVERIFY(cache.insert(3, 0, itemImage(), QPoint(), QRectF(0.0, 0.0, 10.0, 10.0)));
+	QImage image;
+	QPoint position;
+	QVERIFY(cache.find(1, 0, image, position));
+	QVERIFY(cache.insert(4, 0, itemImage(), QPoint(), QRectF(0.0, 0.0, 10.0, 10.0)));
+	QCOMPARE(cache.count(), 3);
+	QVERIFY(cache.find(1, 0, image, position));
+	QVERIFY(!cache.find(2, 0, image, position));
+
+	cache.setMaxBytes(16 * 1024);
+	QCOMPARE(cache.count(), 1);
+	QVERIFY(cache.find(1, 0, image, position));
+	QVERIFY(!cache.insert(5, 0, QImage(128, 128, QImage::Format_ARGB32_Premultiplied), QPoint(), QRectF()));
+	QCOMPARE(cache.bytes(), qint64(16 * 1024));
+}
+
+void TestItemRasterCache::invalidateOverlapping()
+{
+	ItemRasterCache cache(1024 * 1024);
+	cache.insert(1, 0, itemImage(), QPoint(), QRectF(0.0, 0.0, 100.0, 100.0));
+	cache.insert(2, 0, itemImage(), QPoint(), QRectF(200.0, 0.0, 100.0, 100.0));
+	cache.invalidate(QRectF(50.0, 50.0, 10.0, 10.0));
+	QImage image;
+	QPoint position;
+	QVERIFY(!cache.find(1, 0, image, position));
+	QVERIFY(cache.find(2, 0, image, position));
+	QCOMPARE(cache.bytes(), qint64(16 * 1024));
+}
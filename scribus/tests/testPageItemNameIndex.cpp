@@ -0,0 +1,67 @@
+/*
+ For general Scribus (>=1.3.2) copyright and licensing information please refer
+ to the COPYING file provided with the program. Following this notice may exist
+ a copyright and/or license notice that predates the release of Scribus 1.3.2
+ for which a new license (GPL+exception) is in place.
+ */
+
+#include "testPageItemNameIndex.h"
+#include "pageitemnameindex.h"
+
+namespace
+{
+	// The parts of PageItem the group walk looks at
+	struct Item
+	{
+		Item* Parent { nullptr };
+		QList<Item*> groupItemList;
+
+		void add(Item* member)
+		{
+			member->Parent = this;
+			groupItemList.append(member);
+		}
+	};
+}
+
+void TestPageItemNameIndex::topLevelItems()
+{
+	Item top, group, member;
+	QCOMPARE(PageItemNameIndex::topLevelItem(&top), &top);
+
+	top.add(&group);
+	group.add(&member);
+	QCOMPARE(PageItemNameIndex::topLevelItem(&group), &top);
+	QCOMPARE(PageItemNameIndex::topLevelItem(&member), &top);
+}
+
+void TestPageItemNameIndex::removedGroupMembers()
+{
+	Item top, group, member, other;
+	top.add(&group);
+	top.add(&other);
+	group.add(&member);
+
+	// deleting with undo takes the item out of its group but keeps its Parent for restoring
+	group.groupItemList.removeOne(&member);
+	QVERIFY(PageItemNameIndex::topLevelItem(&member) == nullptr);
+	QCOMPARE(PageItemNameIndex::topLevelItem(&other), &top);
+
+	// the same for a whole group below the top level item
+	top.groupItemList.removeOne(&group);
+	group.groupItemList.append(&member);
+	QVERIFY(PageItemNameIndex::topLevelItem(&group) == nullptr);
+	QVERIFY(PageItemNameIndex::topLevelItem(&member) == nullptr);
+}
+
+void TestPageItemNameIndex::replacedGroupMembers()
+{
+	Item top, original, converted;
+	top.add(&original);
+
+	// converting a group member puts the new item at its place, the old one still points to the group
+	converted.Parent = &top;
+	top.groupItemList.replace(top.groupItemList.indexOf(&original), &converted);
+	QCOMPARE(PageItemNameIndex::topLevelItem(&converted), &top);
+	QVERIFY(PageItemNameIndex::topLevelItem(&original) == nullptr);
+}
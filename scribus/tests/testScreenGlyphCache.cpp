@@ -0,0 +1,118 @@
+/*
+ For general Scribus (>=1.3.2) copyright and licensing information please refer
+ to the COPYING file provided with the program. Following this notice may exist
+ a copyright and/or license notice that predates the release of Scribus 1.3.2
+ for which a new license (GPL+exception) is in place.
+ */
+
+#include "testScreenGlyphCache.h"
+#include "text/screenglyphcache.h"
+
+// A square glyph covering the outline units 0..size in both directions
+static FPointArray square(double size)
+{
+	FPointArray outline;
+	outline.addQuadPoint(0, 0, 0, 0, size, 0, size, 0);
+	outline.addQuadPoint(size, 0, size, 0, size, size, size, size);
+	outline.addQuadPoint(size, size, size, size, 0, size, 0, size);
+	outline.addQuadPoint(0, size, 0, size, 0, 0, 0, 0);
+	return outline;
+}
+
+void TestScreenGlyphCache::outlineConvertedOnce()
+{
+	ScreenGlyphCache cache;
+	int calls = 0;
+	auto outline = [&calls]() { ++calls; return square(5.0); };
+	int face = cache.faceId("/fonts/a.ttf", 0);
+	QCOMPARE(cache.faceId("/fonts/a.ttf", 0), face);
+	QVERIFY(cache.faceId("/fonts/a.ttf", 1) != face);
+
+	const cairo_path_t* path = cache.path(face, 36, outline);
+	QVERIFY(path);
+	QVERIFY(path->num_data > 0);
+	QCOMPARE(cache.path(face, 36, outline), path);
+	QCOMPARE(calls, 1);
+	QCOMPARE(cache.statistics().pathMisses, quint64(1));
+	QCOMPARE(cache.statistics().pathHits, quint64(1));
+
+	cache.path(cache.faceId("/fonts/a.ttf", 1), 36, outline);
+	QCOMPARE(calls, 2);
+}
+
+void TestScreenGlyphCache::emptyOutlinesAreCached()
+{
+	ScreenGlyphCache cache;
+	int calls = 0;
+	auto outline = [&calls]() { ++calls; return FPointArray(); };
+	int face = cache.faceId("/fonts/a.ttf", 0);
+	QVERIFY(!cache.path(face, 3, outline));
+	QVERIFY(!cache.path(face, 3, outline));
+	QPoint origin;
+	QVERIFY(!cache.mask(face, 3, 2.0, 2.0, 0.0, 0.0, origin, outline));
+	QCOMPARE(calls, 1);
+}
+
+void TestScreenGlyphCache::masksPerScaleAndPhase()
+{
+	ScreenGlyphCache cache;
+	auto outline = []() { return square(5.0); };
+	int face = cache.faceId("/fonts/a.ttf", 0);
+
+	QPoint origin;
+	cairo_surface_t* mask = cache.mask(face, 7, 2.0, 2.0, 0.0, 0.0, origin, outline);
+	QVERIFY(mask);
+	QCOMPARE(cairo_image_surface_get_format(mask), CAIRO_FORMAT_A8);
+	// The square covers ten device pixels, the mask has a pixel of margin on each side
+	QCOMPARE(origin, QPoint(-1, -1));
+	QCOMPARE(cairo_image_surface_get_width(mask), 12);
+	QCOMPARE(cairo_image_surface_get_height(mask), 12);
+	const unsigned char* data = cairo_image_surface_get_data(mask);
+	int stride = cairo_image_surface_get_stride(mask);
+	QCOMPARE(int(data[0]), 0);
+	QCOMPARE(int(data[6 * stride + 6]), 255);
+
+	QPoint again;
+	QCOMPARE(cache.mask(face, 7, 2.0, 2.0, 0.01, 0.0, again, outline), mask);
+	QCOMPARE(again, origin);
+	QCOMPARE(cache.statistics().maskHits, quint64(1));
+	QCOMPARE(cache.statistics().maskMisses, quint64(1));
+
+	QVERIFY(cache.mask(face, 7, 2.0, 2.0, 0.5, 0.0, again, outline) != mask);
+	QVERIFY(cache.mask(face, 7, 3.0, 3.0, 0.0, 0.0, again, outline) != mask);
+	// A position just below the next pixel uses the mask of that pixel
+	QCOMPARE(cache.mask(face, 7, 2.0, 2.0, 0.95, 0.0, again, outline), mask);
+	QCOMPARE(again, origin + QPoint(1, 0));
+}
+
+void TestScreenGlyphCache::largeGlyphsHaveNoMask()
+{
+	ScreenGlyphCache cache;
+	auto outline = []() { return square(10.0); };
+	int face = cache.faceId("/fonts/a.ttf", 0);
+	QPoint origin;
+	QVERIFY(!cache.mask(face, 1, 20.0, 20.0, 0.0, 0.0, origin, outline));
+	QVERIFY(cache.path(face, 1, outline));
+}
+
+void TestScreenGlyphCache::staysWithinBudget()
+{
+	ScreenGlyphCache cache(64 * 1024);
+	auto outline = []() { return square(5.0); };
+	int face = cache.faceId("/fonts/a.ttf", 0);
+	QPoint origin;
+	for (uint glyph = 0; glyph < 500; ++glyph)
+	{
+		QVERIFY(cache.mask(face, glyph, 4.0, 4.0, 0.0, 0.0, origin, outline));
+		QVERIFY(cache.bytes() <= cache.maxBytes());
+	}
+	QVERIFY(cache.count() < 1000);
+	// Recently used glyphs are kept
+	quint64 hits = cache.statistics().maskHits;
+	cache.mask(face, 499, 4.0, 4.0, 0.0, 0.0, origin, outline);
+	QCOMPARE(cache.statistics().maskHits, hits + 1);
+
+	cache.setMaxBytes(0);
+	QCOMPARE(cache.count(), 0);
+	QCOMPARE(cache.bytes(), qint64(0));
+}
@@ -0,0 +1,170 @@
+/*
+ For general Scribus (>=1.3.2) copyright and licensing information please refer
+ to the COPYING file provided with the program. Following this notice may exist
+ a copyright and/or license notice that predates the release of Scribus 1.3.2
+ for which a new license (GPL+exception) is in place.
+ */
+
+#include "testShapedTextCache.h"
+
+#include "prefsmanager.h"
+#include "styles/styleset.h"
+#include "text/glyphcluster.h"
+#include "text/shapedtext.h"
+#include "text/shapedtextcache.h"
+#include "text/shapedtextfeed.h"
+
+// "aaa|bbb|ccc" with blocks [0,4) [4,8) [8,11)
+static void fillCache(StoryText& story)
+{
+	story.insertChars(0, QString("aaa") + SpecialChars::PARSEP + QString("bbb") + SpecialChars::PARSEP + QString("ccc"));
+	ShapedTextCache* cache = story.shapedTextCache();
+	cache->put(ShapedText(&story, 0, 3));
+	cache->put(ShapedText(&story, 4, 7));
+	cache->put(ShapedText(&story, 8, 10));
+}
+
+void TestShapedTextCache::putAndGet()
+{
+	StoryText story;
+	fillCache(story);
+	ShapedTextCache* cache = story.shapedTextCache();
+	QCOMPARE(cache->count(), 3);
+	QVERIFY(cache->contains(4, 4));
+	QCOMPARE(cache->get(4, 4).firstChar(), 4);
+	QCOMPARE(cache->get(4, 4).lastChar(), 7);
+	QVERIFY(!cache->contains(4, 5));
+}
+
+void TestShapedTextCache::insertMovesBlocks()
+{
+	StoryText story;
+	fillCache(story);
+	story.insertChars(5, "X");
+	ShapedTextCache* cache = story.shapedTextCache();
+	QVERIFY(cache->contains(0, 4));
+	QVERIFY(!cache->contains(4, 5));
+	QVERIFY(cache->contains(9, 3));
+	ShapedText moved = cache->get(9, 3);
+	QCOMPARE(moved.firstChar(), 9);
+	QCOMPARE(moved.lastChar(), 11);
+}
+
+void TestShapedTextCache::removeDropsBlocks()
+{
+	StoryText story;
+	fillCache(story);
+	story.removeChars(5, 1);
+	ShapedTextCache* cache = story.shapedTextCache();
+	QVERIFY(cache->contains(0, 4));
+	QVERIFY(!cache->contains(4, 3));
+	QVERIFY(cache->contains(7, 3));
+	QCOMPARE(cache->get(7, 3).firstChar(), 7);
+}
+
+void TestShapedTextCache::styleChangeDropsBlock()
+{
+	StoryText story;
+	fillCache(story);
+	CharStyle cs;
+	cs.setFontSize(200);
+	story.applyCharStyle(0, 2, cs);
+	ShapedTextCache* cache = story.shapedTextCache();
+	QVERIFY(!cache->contains(0, 4));
+	QVERIFY(cache->contains(8, 3));
+}
+
+// Redefining a document style doesn't edit the story, the blocks have to go anyway
+void TestShapedTextCache::styleRedefinitionDropsBlocks()
+{
+	StyleSet<ParagraphStyle> paragraphStyles;
+	StyleSet<CharStyle> charStyles;
+	CharStyle emphasis;
+	emphasis.setName("Emphasis");
+	emphasis.setFontSize(100);
+	CharStyle* docStyle = charStyles.create(emphasis);
+
+	StoryText story;
+	ShapedTextCache* cache = story.shapedTextCache();
+	cache->setStyleVersions(paragraphStyles.version(), charStyles.version());
+	fillCache(story);
+	cache->setStyleVersions(paragraphStyles.version(), charStyles.version());
+	QCOMPARE(cache->count(), 3);
+
+	docStyle->setFontSize(200);
+	charStyles.invalidate();
+	cache->setStyleVersions(paragraphStyles.version(), charStyles.version());
+	QCOMPARE(cache->count(), 0);
+
+	// text shaped again is kept under the new versions
+	cache->put(ShapedText(&story, 4, 7));
+	cache->setStyleVersions(paragraphStyles.version(), charStyles.version());
+	QVERIFY(cache->contains(4, 4));
+}
+
+// Cached glyph clusters point to the story's char styles, so freeing unused styles drops them
+void TestShapedTextCache::droppedStylesDropBlocks()
+{
+	StoryText story;
+	fillCache(story);
+	for (int i = 0; i < 100; ++i)
+	{
+		CharStyle cs;
+		cs.setFontSize(100 + i);
+		story.applyCharStyle(0, 1, cs);
+	}
+	ShapedTextCache* cache = story.shapedTextCache();
+	QVERIFY(!cache->contains(8, 3));
+}
+
+void TestShapedTextCache::relayoutAfterEdit_data()
+{
+	QTest::addColumn<bool>("useCache");
+	QTest::newRow("reshape all") << false;
+	QTest::newRow("cached") << true;
+}
+
+// Times the shaping part of a relayout after typing one char in the middle of a long story
+void TestShapedTextCache::relayoutAfterEdit()
+{
+	QFETCH(bool, useCache);
+
+	ScFace font;
+	const SCFonts& fonts = PrefsManager::instance().appPrefs.fontPrefs.AvailFonts;
+	for (auto it = fonts.constBegin(); it != fonts.constEnd(); ++it)
+	{
+		if (it.value().usable())
+		{
+			font = it.value();
+			break;
+		}
+	}
+	if (font.isNone())
+		QSKIP("no usable font for shaping");
+
+	StoryText story;
+	QString paragraph("The quick brown fox jumps over the lazy dog. ");
+	paragraph = paragraph.repeated(10) + SpecialChars::PARSEP;
+	story.insertChars(0, paragraph.repeated(2000));
+	CharStyle cs;
+	cs.setFont(font);
+	cs.setFontSize(120);
+	story.applyCharStyle(0, story.length(), cs);
+
+	IShapedTextCache* cache = useCache ? story.shapedTextCache() : nullptr;
+	int editPos = story.length() / 2;
+	QList<GlyphCluster> glyphs;
+	ShapedTextFeed warmup(&story, 0, nullptr, cache);
+	for (int i = 0; warmup.haveMoreText(i, glyphs); ++i)
+		;
+
+	QBENCHMARK
+	{
+		story.insertChars(editPos, "x");
+		story.removeChars(editPos, 1);
+		glyphs.clear();
+		ShapedTextFeed feed(&story, 0, nullptr, cache);
+		for (int i = 0; feed.haveMoreText(i, glyphs); ++i)
+			;
+	}
+}
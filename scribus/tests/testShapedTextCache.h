@@ -0,0 +1,30 @@
+/*
+ For general Scribus (>=1.3.2) copyright and licensing information please refer
+ to the COPYING file provided with the program. Following this notice may exist
+ a copyright and/or license notice that predates the release of Scribus 1.3.2
+ for which a new license (GPL+exception) is in place.
+ */
+
+#ifndef TESTSHAPEDTEXTCACHE_H
+#define TESTSHAPEDTEXTCACHE_H
+
+#include <QtTest/QtTest>
+
+#include "text/storytext.h"
+
+class TestShapedTextCache: public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void putAndGet();
+	void insertMovesBlocks();
+	void removeDropsBlocks();
+	void styleChangeDropsBlock();
+	void styleRedefinitionDropsBlocks();
+	void droppedStylesDropBlocks();
+	void relayoutAfterEdit_data();
+	void relayoutAfterEdit();
+};
+
+#endif
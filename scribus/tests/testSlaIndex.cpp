@@ -0,0 +1,132 @@
+/*
+ For general Scribus (>=1.3.2) copyright and licensing information please refer
+ to the COPYING file provided with the program. Following this notice may exist
+ a copyright and/or license notice that predates the release of Scribus 1.3.2
+ for which a new license (GPL+exception) is in place.
+ */
+
+#include <QFile>
+#include <QScopedPointer>
+#include <QTemporaryDir>
+
+#include "testSlaIndex.h"
+#include "plugins/fileloader/scribus150format/slaindex.h"
+
+static QByteArray object(const char* tag, int ownPage, const QByteArray& text)
+{
+	return QByteArray("<") + tag + " OwnPage=\"" + QByteArray::number(ownPage) + "\" ANNAME=\"" + text + "\">"
+		+ "<StoryText><ITEXT CH=\"" + text + "\"/></StoryText></" + tag + ">\n";
+}
+
+// A document with non-ASCII text before and between the objects and one object
+// larger than the chunks QXmlStreamReader reads at a time
+static QByteArray document(bool withBom)
+{
+	QByteArray big;
+	for (int i = 0; i < 20000; ++i)
+		big.append("\xC3\xA4\xE2\x82\xAC" "x");
+	QByteArray doc = withBom ? "\xEF\xBB\xBF" : "";
+	doc += "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n";
+	doc += "<SCRIBUSUTF8NEW Version=\"1.5.8\">\n<DOCUMENT TITLE=\"Gr\xC3\xBC\xC3\x9F" "e\">\n";
+	doc += "<MASTERPAGE NAM=\"Normal\"/>\n<MASTERPAGE NAM=\"R\xC3\xA9sum\xC3\xA9\"/>\n";
+	doc += "<PAGE NUM=\"0\"/>\n<PAGE NUM=\"1\"/>\n<PAGE NUM=\"2\"/>\n";
+	doc += object("MASTEROBJECT", 1, "\xF0\x9F\x98\x80 master");
+	doc += object("PAGEOBJECT", 0, "first \xC3\xA9");
+	doc += object("PAGEOBJECT", 1, big);
+	doc += "<!-- \xE2\x82\xAC -->\n";
+	doc += object("PAGEOBJECT", 2, "third");
+	doc += object("PAGEOBJECT", 1, "second page again");
+	doc += "</DOCUMENT>\n</SCRIBUSUTF8NEW>\n";
+	return doc;
+}
+
+static QString writeDocument(const QTemporaryDir& dir, const QString& name, const QByteArray& data)
+{
+	QString fileName = dir.filePath(name);
+	QFile file(fileName);
+	if (!file.open(QIODevice::WriteOnly) || file.write(data) != data.size())
+		return QString();
+	return fileName;
+}
+
+static QByteArray readAll(QIODevice* device)
+{
+	QScopedPointer<QIODevice> owned(device);
+	return owned ? owned->readAll() : QByteArray();
+}
+
+void TestSlaIndex::pagesAndMasterPages()
+{
+	QTemporaryDir dir;
+	QString fileName = writeDocument(dir, "pages.sla", document(true));
+	QVERIFY(!fileName.isEmpty());
+
+	QFile file(fileName);
+	QVERIFY(file.open(QIODevice::ReadOnly));
+	QSharedPointer<const SlaIndex> index = SlaIndex::build(fileName, &file);
+	QVERIFY(index);
+	QCOMPARE(index->pageCount(), 3);
+	QCOMPARE(index->masterPageNames(), QStringList() << "Normal" << QString::fromUtf8("R\xC3\xA9sum\xC3\xA9"));
+	QCOMPARE(SlaIndex::cached(fileName), index);
+
+	// The skeleton keeps everything but the objects, which become placeholders
+	QByteArray skeleton = readAll(index->skeletonReader());
+	QVERIFY(skeleton.startsWith("<?xml"));
+	QVERIFY(skeleton.contains("<DOCUMENT TITLE=\"Gr\xC3\xBC\xC3\x9F" "e\">"));
+	QVERIFY(skeleton.contains("<!-- \xE2\x82\xAC -->"));
+	QVERIFY(skeleton.contains("<PAGEOBJECT OwnPage=\"2\"/>"));
+	QVERIFY(skeleton.contains("<MASTEROBJECT OwnPage=\"1\"/>"));
+	QVERIFY(!skeleton.contains("StoryText"));
+	QVERIFY(skeleton.size() < 1000);
+}
+
+void TestSlaIndex::pageReaderRestoresObjects()
+{
+	for (bool withBom : { false, true })
+	{
+		QTemporaryDir dir;
+		QByteArray data = document(withBom);
+		QString fileName = writeDocument(dir, "objects.sla", data);
+		QVERIFY(!fileName.isEmpty());
+
+		QFile file(fileName);
+		QVERIFY(file.open(QIODevice::ReadOnly));
+		QSharedPointer<const SlaIndex> index = SlaIndex::build(fileName, &file);
+		QVERIFY(index);
+
+		QVERIFY(file.seek(0));
+		QByteArray page1 = readAll(index->pageReader(&file, 1, false));
+		QVERIFY(page1.contains("<PAGEOBJECT OwnPage=\"0\"/>"));
+		QVERIFY(page1.contains("<PAGEOBJECT OwnPage=\"2\"/>"));
+		QVERIFY(page1.contains(object("PAGEOBJECT", 1, "second page again")));
+		QVERIFY(page1.contains("<MASTEROBJECT OwnPage=\"1\"/>"));
+		// Putting back all objects of page 1 gives the file with the other objects replaced
+		QByteArray expected = data.mid(withBom ? 3 : 0);
+		expected.replace(object("MASTEROBJECT", 1, "\xF0\x9F\x98\x80 master"), "<MASTEROBJECT OwnPage=\"1\"/>");
+		expected.replace(object("PAGEOBJECT", 0, "first \xC3\xA9"), "<PAGEOBJECT OwnPage=\"0\"/>");
+		expected.replace(object("PAGEOBJECT", 2, "third"), "<PAGEOBJECT OwnPage=\"2\"/>");
+		QCOMPARE(page1, expected);
+
+		QVERIFY(file.seek(0));
+		QByteArray master1 = readAll(index->pageReader(&file, 1, true));
+		QVERIFY(master1.contains(object("MASTEROBJECT", 1, "\xF0\x9F\x98\x80 master")));
+		QVERIFY(master1.contains("<PAGEOBJECT OwnPage=\"1\"/>"));
+		QVERIFY(!master1.contains("<PAGEOBJECT OwnPage=\"1\" ANNAME"));
+	}
+}
+
+void TestSlaIndex::rejectsOtherDocuments()
+{
+	QTemporaryDir dir;
+	QString fileName = writeDocument(dir, "other.sla", "<?xml version=\"1.0\"?>\n<SCRIBUSUTF8 Version=\"1.3\"><PAGEOBJECT/></SCRIBUSUTF8>\n");
+	QVERIFY(!fileName.isEmpty());
+	QFile file(fileName);
+	QVERIFY(file.open(QIODevice::ReadOnly));
+	QVERIFY(!SlaIndex::build(fileName, &file));
+
+	QString brokenName = writeDocument(dir, "broken.sla", document(false).left(2000));
+	QVERIFY(!brokenName.isEmpty());
+	QFile broken(brokenName);
+	QVERIFY(broken.open(QIODevice::ReadOnly));
+	QVERIFY(!SlaIndex::build(brokenName, &broken));
+}
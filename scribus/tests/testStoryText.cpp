@@ -127,3 +127,69 @@ void TestStoryText::removeCharStyle()
 	QCOMPARE(story.startOfRun(2), 5  + 26 + 1);
 	QCOMPARE(story.endOfRun(2), 11 + 26);
 }
+
+void TestStoryText::mapUnchangedRange()
+{
+	StoryText story;
+	story.insertChars(0, QString("Hallo") + SpecialChars::PARSEP + QString("schöne") + SpecialChars::PARSEP + QString("Welt"));
+	uint version = story.version();
+	int first = 13;
+	int end = 17;
+	// edits before the range move it
+	story.insertChars(0, "Oh, ");
+	story.removeChars(10, 2);
+	QVERIFY(story.mapUnchangedRange(version, first, end));
+	QCOMPARE(first, 15);
+	QCOMPARE(end, 19);
+	QCOMPARE(story.text(first, end - first), QString("Welt"));
+	// edits next to or inside the range touch it
+	uint version2 = story.version();
+	story.insertChars(14, "x");
+	first = 15;
+	end = 19;
+	QVERIFY(!story.mapUnchangedRange(version2, first, end));
+	first = 0;
+	end = 5;
+	QVERIFY(story.mapUnchangedRange(version2, first, end));
+	QCOMPARE(first, 0);
+	QCOMPARE(end, 5);
+	// unknown versions can't be mapped
+	story.clear();
+	first = 0;
+	end = 1;
+	QVERIFY(!story.mapUnchangedRange(version2, first, end));
+}
+
+void TestStoryText::editVersions()
+{
+	// every edit is logged once, the log only holds a limited number of them
+	StoryText story;
+	story.insertChars(0, QString("Hallo") + SpecialChars::PARSEP + QString("Welt"));
+	uint version = story.version();
+	story.insertChars(5, " du");
+	QCOMPARE(story.version(), version + 1);
+	story.removeChars(0, 2);
+	QCOMPARE(story.version(), version + 2);
+	CharStyle cs;
+	cs.setFontSize(100);
+	story.applyCharStyle(0, 3, cs);
+	QCOMPARE(story.version(), version + 3);
+}
+
+void TestStoryText::removeParSepRanges()
+{
+	StoryText story;
+	story.insertChars(0, QString("Hallo") + SpecialChars::PARSEP + QString("schöne") + SpecialChars::PARSEP + QString("Welt"));
+	uint version = story.version();
+	QSignalSpy spy(&story, SIGNAL(changed(int,int)));
+	// joining the first two paragraphs moves all following chars
+	story.removeChars(5, 1);
+	QCOMPARE(spy.count(), 1);
+	QCOMPARE(spy.at(0).at(0).toInt(), 5);
+	QCOMPARE(spy.at(0).at(1).toInt(), story.length());
+	// but the edit log only records the removed char, later frames keep their layout
+	int first = 13;
+	int end = 17;
+	QVERIFY(story.mapUnchangedRange(version, first, end));
+	QCOMPARE(story.text(first, end - first), QString("Welt"));
+}
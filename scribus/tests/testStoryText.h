@@ -27,4 +27,7 @@ private slots:
 	void removePars();
 	void applyCharStyle();
 	void removeCharStyle();
+	void mapUnchangedRange();
+	void editVersions();
+	void removeParSepRanges();
 };
@@ -0,0 +1,113 @@
+/*
+ For general Scribus (>=1.3.2) copyright and licensing information please refer
+ to the COPYING file provided with the program. Following this notice may exist
+ a copyright and/or license notice that predates the release of Scribus 1.3.2
+ for which a new license (GPL+exception) is in place.
+ */
+
+#include "testStoryTextMemory.h"
+
+static const int paragraphCount = 2000;
+
+// about one million chars in paragraphs of ten lines
+static QString largeText()
+{
+	QString line = QString("The quick brown fox jumps over the lazy dog. ").repeated(10);
+	QString text;
+	for (int i = 0; i < paragraphCount; ++i)
+	{
+		if (i > 0)
+			text += SpecialChars::PARSEP;
+		text += line;
+	}
+	return text;
+}
+
+// every tenth word gets a bigger font
+static void emphasizeWords(StoryText& story)
+{
+	CharStyle big;
+	big.setFontSize(240);
+	for (int pos = 4; pos + 5 < story.length(); pos += 450)
+		story.applyCharStyle(pos, 5, big);
+}
+
+void TestStoryTextMemory::largeStoryStorage()
+{
+	StoryText story;
+	story.insertChars(0, largeText());
+	emphasizeWords(story);
+	QCOMPARE(story.nrOfParagraphs(), uint(paragraphCount));
+	QCOMPARE(story.length(), paragraphCount * 451 - 1);
+
+	// text and flags take four bytes per char, styles and paragraphs add a few more
+	qint64 textBytes = qint64(story.length()) * (sizeof(QChar) + sizeof(quint16));
+	QVERIFY(story.storageSize() >= textBytes);
+	QVERIFY(story.storageSize() < 8 * textBytes);
+
+	// a story used to keep a whole ScText per char
+	qint64 perCharObjects = qint64(story.length()) * sizeof(ScText);
+	QVERIFY(story.storageSize() * 10 < perCharObjects);
+}
+
+void TestStoryTextMemory::stylesSurviveEdits()
+{
+	StoryText story;
+	story.insertChars(0, QString("Hallo") + SpecialChars::PARSEP + QString("schöne Welt"));
+	CharStyle big;
+	big.setFontSize(240);
+	story.applyCharStyle(6, 6, big);
+	QCOMPARE(story.charStyle(6).fontSize(), 240.0);
+	QCOMPARE(story.charStyle(12).fontSize(), 200.0);
+
+	story.insertChars(8, "xx", true);
+	QCOMPARE(story.text(0, story.length()), QString("Hallo") + SpecialChars::PARSEP + QString("scxxhöne Welt"));
+	QCOMPARE(story.charStyle(8).fontSize(), 240.0);
+	QCOMPARE(story.charStyle(14).fontSize(), 200.0);
+
+	story.setFlag(7, ScLayout_HyphenationPossible);
+	story.applyCharStyle(7, 1, big);
+	QVERIFY(story.hasFlag(7, ScLayout_HyphenationPossible));
+	QVERIFY(!story.hasFlag(8, ScLayout_HyphenationPossible));
+
+	story.removeChars(3, 5);
+	QCOMPARE(story.text(0, story.length()), QString("Halxxhöne Welt"));
+	QCOMPARE(story.nrOfParagraphs(), 1u);
+	QCOMPARE(story.charStyle(2).fontSize(), 200.0);
+	QCOMPARE(story.charStyle(3).fontSize(), 240.0);
+}
+
+void TestStoryTextMemory::copyKeepsStyles()
+{
+	StoryText story1;
+	story1.insertChars(0, QString("Hallo") + SpecialChars::PARSEP + QString("Welt"));
+	CharStyle big;
+	big.setFontSize(240);
+	story1.applyCharStyle(1, 2, big);
+	StoryText story2 = story1.copy();
+	QCOMPARE(story2.text(0, story2.length()), story1.text(0, story1.length()));
+	QCOMPARE(story2.charStyle(1).fontSize(), 240.0);
+	QCOMPARE(story2.charStyle(3).fontSize(), 200.0);
+	QVERIFY(story2.charStyle(7).context() != story1.charStyle(7).context());
+}
+
+void TestStoryTextMemory::benchmarkAppend()
+{
+	QString text = largeText();
+	QBENCHMARK
+	{
+		StoryText story;
+		for (int i = 0; i < text.length(); i += 45)
+			story.insertChars(story.length(), text.mid(i, 45));
+	}
+}
+
+void TestStoryTextMemory::benchmarkApplyCharStyle()
+{
+	StoryText story;
+	story.insertChars(0, largeText());
+	QBENCHMARK
+	{
+		emphasizeWords(story);
+	}
+}
@@ -0,0 +1,27 @@
+/*
+ For general Scribus (>=1.3.2) copyright and licensing information please refer
+ to the COPYING file provided with the program. Following this notice may exist
+ a copyright and/or license notice that predates the release of Scribus 1.3.2
+ for which a new license (GPL+exception) is in place.
+ */
+
+#ifndef TESTSTORYTEXTMEMORY_H
+#define TESTSTORYTEXTMEMORY_H
+
+#include <QtTest/QtTest>
+
+#include "text/storytext.h"
+
+class TestStoryTextMemory: public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void largeStoryStorage();
+	void stylesSurviveEdits();
+	void copyKeepsStyles();
+	void benchmarkAppend();
+	void benchmarkApplyCharStyle();
+};
+
+#endif
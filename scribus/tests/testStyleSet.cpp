@@ -0,0 +1,195 @@
+/*
+ For general Scribus (>=1.3.2) copyright and licensing information please refer
+ to the COPYING file provided with the program. Following this notice may exist
+ a copyright and/or license notice that predates the release of Scribus 1.3.2
+ for which a new license (GPL+exception) is in place.
+ */
+
+#include "testStyleSet.h"
+#include "styles/paragraphstyle.h"
+#include "styles/styleset.h"
+
+static ParagraphStyle namedStyle(const QString& name, const QString& parent = QString())
+{
+	ParagraphStyle style;
+	style.setName(name);
+	if (!parent.isEmpty())
+		style.setParent(parent);
+	return style;
+}
+
+// A catalog sized style sheet: styles in chains of ten, each inheriting from the one before and the left margin of the first
+static void fillCatalog(StyleSet<ParagraphStyle>& set, int count)
+{
+	ParagraphStyle base;
+	base.setDefaultStyle(true);
+	base.setName("Default Paragraph Style");
+	set.makeDefault(set.create(base));
+	for (int i = 0; i < count; ++i)
+	{
+		QString parent = (i % 10 == 0) ? QString() : QString("Style %1").arg(i - 1);
+		ParagraphStyle style = namedStyle(QString("Style %1").arg(i), parent);
+		if (parent.isEmpty())
+			style.setLeftMargin(i + 1);
+		set.create(style);
+	}
+	set.invalidate();
+}
+
+// The linear search StyleSet used before, as reference for the speed
+static const BaseStyle* linearResolve(const StyleSet<ParagraphStyle>& set, const QString& name)
+{
+	for (int i = 0; i < set.count(); ++i)
+	{
+		if (set[i].name() == name)
+			return &set[i];
+	}
+	return nullptr;
+}
+
+void TestStyleSet::resolveByName()
+{
+	StyleSet<ParagraphStyle> set;
+	fillCatalog(set, 100);
+	QCOMPARE(set.find("Style 42"), 43);
+	QVERIFY(set.contains("Style 99"));
+	QVERIFY(!set.contains("Style 100"));
+	QCOMPARE(set.find("Style 100"), -1);
+	QCOMPARE(set.resolve("Style 7"), static_cast<const BaseStyle*>(&set[8]));
+	QCOMPARE(set.getPointer("Style 7"), static_cast<const ParagraphStyle*>(&set[8]));
+	QCOMPARE(set.resolve(""), static_cast<const BaseStyle*>(set.getDefault()));
+	QVERIFY(set.resolve("Style 100") == nullptr);
+	// Inherited through the chain Style 0 .. Style 5
+	QCOMPARE(set.get("Style 5").leftMargin(), 1.0);
+	QCOMPARE(set.get("Style 15").leftMargin(), 11.0);
+	QCOMPARE(set.get("Style 5").parentStyle(), static_cast<const BaseStyle*>(&set[5]));
+}
+
+void TestStyleSet::firstOfEqualNames()
+{
+	StyleSet<ParagraphStyle> set;
+	set.create(namedStyle("A"));
+	set.create(namedStyle("B"));
+	set.create(namedStyle("A"));
+	QCOMPARE(set.find("A"), 0);
+	set.invalidate();
+	QCOMPARE(set.find("A"), 0);
+	set.remove(0);
+	QCOMPARE(set.find("A"), 1);
+}
+
+void TestStyleSet::appendAndRemove()
+{
+	StyleSet<ParagraphStyle> set;
+	fillCatalog(set, 20);
+	QCOMPARE(set.find("Style 19"), 20);
+	// Appending does not invalidate the set, the index has to follow anyway
+	set.create(namedStyle("New"));
+	QCOMPARE(set.find("New"), 21);
+	set.remove(5);
+	QCOMPARE(set.find("Style 3"), 4);
+	QCOMPARE(set.find("Style 4"), -1);
+	QCOMPARE(set.find("Style 5"), 5);
+	QCOMPARE(set.find("New"), 20);
+	set.clear();
+	QCOMPARE(set.count(), 0);
+	QCOMPARE(set.find("Style 5"), -1);
+}
+
+void TestStyleSet::renameAndRedefine()
+{
+	StyleSet<ParagraphStyle> set;
+	fillCatalog(set, 20);
+	QMap<QString, QString> newNames;
+	newNames.insert("Style 3", "Heading");
+	set.rename(newNames);
+	QCOMPARE(set.find("Style 3"), -1);
+	QCOMPARE(set.find("Heading"), 4);
+	QCOMPARE(set[5].parent(), QString("Heading"));
+	QCOMPARE(set.get("Style 4").leftMargin(), 1.0);
+
+	StyleSet<ParagraphStyle> defs;
+	defs.create(namedStyle("Heading"));
+	defs.create(namedStyle("Body"));
+	set.redefine(defs, true);
+	QCOMPARE(set.count(), 2);
+	QCOMPARE(set.find("Heading"), 0);
+	QCOMPARE(set.find("Body"), 1);
+	QCOMPARE(set.find("Style 4"), -1);
+}
+
+void TestStyleSet::renamedWithoutInvalidate()
+{
+	StyleSet<ParagraphStyle> set;
+	set.create(namedStyle("A"));
+	set.create(namedStyle("B"));
+	QCOMPARE(set.find("A"), 0);
+	// A stale index entry must not return a style of another name
+	set[0].setName("C");
+	set[1].setName("A");
+	QCOMPARE(set.find("A"), 1);
+	QCOMPARE(set.find("C"), 0);
+}
+
+void TestStyleSet::resolveInContext()
+{
+	StyleSet<ParagraphStyle> base;
+	fillCatalog(base, 10);
+	StyleSet<ParagraphStyle> local;
+	local.setContext(&base);
+	local.create(namedStyle("Local", "Style 2"));
+	QCOMPARE(local.resolve("Style 2"), static_cast<const BaseStyle*>(&base[3]));
+	QCOMPARE(local.getPointer("Style 2"), static_cast<const ParagraphStyle*>(&base[3]));
+	QCOMPARE(local.get("Local").leftMargin(), 1.0);
+	QVERIFY(local.resolve("Missing") == nullptr);
+}
+
+void TestStyleSet::benchmarkResolve_data()
+{
+	QTest::addColumn<int>("count");
+	QTest::addColumn<bool>("reference");
+	QTest::newRow("200 linear") << 200 << true;
+	QTest::newRow("200 index") << 200 << false;
+	QTest::newRow("2000 linear") << 2000 << true;
+	QTest::newRow("2000 index") << 2000 << false;
+}
+
+void TestStyleSet::benchmarkResolve()
+{
+	QFETCH(int, count);
+	QFETCH(bool, reference);
+	StyleSet<ParagraphStyle> set;
+	fillCatalog(set, count);
+	QStringList names;
+	for (int i = 0; i < count; ++i)
+		names.append(QString("Style %1").arg(i));
+	const BaseStyle* found = nullptr;
+	QBENCHMARK
+	{
+		for (const QString& name : qAsConst(names))
+			found = reference ? linearResolve(set, name) : set.resolve(name);
+	}
+	QVERIFY(found != nullptr);
+}
+
+void TestStyleSet::benchmarkUpdateStyles_data()
+{
+	QTest::addColumn<int>("count");
+	QTest::newRow("200") << 200;
+	QTest::newRow("2000") << 2000;
+}
+
+void TestStyleSet::benchmarkUpdateStyles()
+{
+	QFETCH(int, count);
+	StyleSet<ParagraphStyle> set;
+	fillCatalog(set, count);
+	// What ScribusDoc does after styles were redefined: every style resolves its parent again
+	QBENCHMARK
+	{
+		set.invalidate();
+		for (int i = 0; i < set.count(); ++i)
+			set[i].validate();
+	}
+	QCOMPARE(set.get(QString("Style %1").arg(count - 1)).leftMargin(), double((count - 1) / 10 * 10 + 1));
+}
@@ -0,0 +1,31 @@
+/*
+ For general Scribus (>=1.3.2) copyright and licensing information please refer
+ to the COPYING file provided with the program. Following this notice may exist
+ a copyright and/or license notice that predates the release of Scribus 1.3.2
+ for which a new license (GPL+exception) is in place.
+ */
+
+#ifndef TESTSTYLESET_H
+#define TESTSTYLESET_H
+
+#include <QtTest/QtTest>
+
+class TestStyleSet: public QObject
+{
+	Q_OBJECT
+
+private slots:
+	void resolveByName();
+	void firstOfEqualNames();
+	void appendAndRemove();
+	void renameAndRedefine();
+	void renamedWithoutInvalidate();
+	void resolveInContext();
+
+	void benchmarkResolve_data();
+	void benchmarkResolve();
+	void benchmarkUpdateStyles_data();
+	void benchmarkUpdateStyles();
+};
+
+#endif
@@ -494,6 +494,23 @@ void PathLineBox::drawBackGround(TextLayoutPainter *p) const
 }
 
 
+void Box::shiftChars(int delta)
+{
+	// empty group boxes keep their INT_MAX/INT_MIN markers
+	if (m_firstChar != INT_MAX)
+		m_firstChar += delta;
+	if (m_lastChar != INT_MIN)
+		m_lastChar += delta;
+	for (Box* box : qAsConst(m_boxes))
+		box->shiftChars(delta);
+}
+
+void GlyphBox::shiftChars(int delta)
+{
+	Box::shiftChars(delta);
+	m_glyphRun.shiftChars(delta);
+}
+
 void GlyphBox::render(ScreenPainter *p, ITextContext *ctx) const
 {
 	const PageItem* item = ctx->getFrame();
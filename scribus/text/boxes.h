@@ -97,6 +97,9 @@ public:
 	/// The last character within the box.
 	int lastChar() const { return m_lastChar == INT_MIN ? 0 : m_lastChar; }
 
+	/// Moves the character range of the box and its children by delta.
+	virtual void shiftChars(int delta);
+
 	/// Sets the transformation matrix to applied to the box.
 	void setMatrix(const QTransform& x) { m_matrix = x; }
 
@@ -258,6 +261,8 @@ public:
 
 	const CharStyle& style() const { return m_glyphRun.style(); }
 
+	void shiftChars(int delta) override;
+
 protected:
 	GlyphCluster m_glyphRun;
 	const StyleFlag m_effects;
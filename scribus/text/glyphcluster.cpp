@@ -104,6 +104,12 @@ int GlyphCluster::lastChar() const
 	return m_lastChar;
 }
 
+void GlyphCluster::shiftChars(int delta)
+{
+	m_firstChar += delta;
+	m_lastChar += delta;
+}
+
 int GlyphCluster::visualIndex() const
 {
 	return m_visualIndex;
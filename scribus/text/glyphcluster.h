@@ -24,6 +24,8 @@ public:
 
 	int firstChar() const;
 	int lastChar() const;
+	/// moves the character range by delta, used when text before this cluster changes
+	void shiftChars(int delta);
 	int visualIndex() const;
 
 	double width() const;
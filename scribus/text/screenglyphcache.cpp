@@ -0,0 +1,271 @@
+/*
+ For general Scribus (>=1.3.2) copyright and licensing information please refer
+ to the COPYING file provided with the program. Following this notice may exist
+ a copyright and/or license notice that predates the release of Scribus 1.3.2
+ for which a new license (GPL+exception) is in place.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include <QPair>
+#include <QVector>
+
+#include "screenglyphcache.h"
+
+// Cairo keeps paths in 24.8 fixed point, paths are stored enlarged so that outlines keep their precision at high zoom
+static const double pathScale = 256.0;
+// Steps per device pixel in which scales and positions of masks are quantized
+static const double maskScaleSteps = 256.0;
+static const int maskPhaseSteps = 4;
+
+ScreenGlyphCache& ScreenGlyphCache::instance()
+{
+	static ScreenGlyphCache cache;
+	return cache;
+}
+
+ScreenGlyphCache::ScreenGlyphCache(qint64 maxBytes) :
+	m_maxBytes(qMax<qint64>(0, maxBytes))
+{
+}
+
+ScreenGlyphCache::~ScreenGlyphCache()
+{
+	clear();
+}
+
+void ScreenGlyphCache::setMaxBytes(qint64 maxBytes)
+{
+	m_maxBytes = qMax<qint64>(0, maxBytes);
+	evict(0);
+}
+
+int ScreenGlyphCache::faceId(const QString& fontPath, int faceIndex)
+{
+	QString name = fontPath + QLatin1Char('#') + QString::number(faceIndex);
+	auto it = m_faceIds.constFind(name);
+	if (it != m_faceIds.constEnd())
+		return it.value();
+	int id = m_faceIds.count();
+	m_faceIds.insert(name, id);
+	return id;
+}
+
+const cairo_path_t* ScreenGlyphCache::path(int faceId, uint glyph, const OutlineFunction& outline)
+{
+	Entry* entry = findPath(faceId, glyph, outline);
+	return entry ? entry->path : nullptr;
+}
+
+void ScreenGlyphCache::appendPath(cairo_t* cr, const cairo_path_t* path)
+{
+	cairo_save(cr);
+	cairo_scale(cr, 1.0 / pathScale, 1.0 / pathScale);
+	cairo_append_path(cr, path);
+	cairo_restore(cr);
+}
+
+cairo_surface_t* ScreenGlyphCache::mask(int faceId, uint glyph, double scaleX, double scaleY, double phaseX, double phaseY, QPoint& origin, const OutlineFunction& outline)
+{
+	// Positions rounding up to the next pixel use the mask of the next pixel
+	int phaseStepX = qRound(phaseX * maskPhaseSteps);
+	int phaseStepY = qRound(phaseY * maskPhaseSteps);
+	int carryX = static_cast<int>(std::floor(double(phaseStepX) / maskPhaseSteps));
+	int carryY = static_cast<int>(std::floor(double(phaseStepY) / maskPhaseSteps));
+	phaseStepX -= carryX * maskPhaseSteps;
+	phaseStepY -= carryY * maskPhaseSteps;
+
+	Key key = { faceId, glyph, qint32(qRound(scaleX * maskScaleSteps)), qint32(qRound(scaleY * maskScaleSteps)), phaseStepX * maskPhaseSteps + phaseStepY };
+	if ((key.scaleX == 0) || (key.scaleY == 0))
+		return nullptr;
+	auto it = m_entries.find(key);
+	if (it != m_entries.end())
+	{
+		++m_statistics.maskHits;
+		it->lastUse = ++m_useCounter;
+		origin = it->origin + QPoint(carryX, carryY);
+		return it->surface;
+	}
+
+	Entry* pathEntry = findPath(faceId, glyph, outline);
+	if (!pathEntry || !pathEntry->path)
+		return nullptr;
+	++m_statistics.maskMisses;
+
+	double sx = key.scaleX / maskScaleSteps;
+	double sy = key.scaleY / maskScaleSteps;
+	double px = double(phaseStepX) / maskPhaseSteps;
+	double py = double(phaseStepY) / maskPhaseSteps;
+	const QRectF& bounds = pathEntry->bounds;
+	double x1 = bounds.left() * sx + px;
+	double x2 = bounds.right() * sx + px;
+	double y1 = bounds.top() * sy + py;
+	double y2 = bounds.bottom() * sy + py;
+	int left = static_cast<int>(std::floor(qMin(x1, x2))) - 1;
+	int top = static_cast<int>(std::floor(qMin(y1, y2))) - 1;
+	int width = static_cast<int>(std::ceil(qMax(x1, x2))) + 1 - left;
+	int height = static_cast<int>(std::ceil(qMax(y1, y2))) + 1 - top;
+	if ((width > MaxMaskSize) || (height > MaxMaskSize))
+		return nullptr;
+
+	Entry entry;
+	entry.surface = cairo_image_surface_create(CAIRO_FORMAT_A8, width, height);
+	if (cairo_surface_status(entry.surface) != CAIRO_STATUS_SUCCESS)
+	{
+		cairo_surface_destroy(entry.surface);
+		return nullptr;
+	}
+	cairo_t* cr = cairo_create(entry.surface);
+	cairo_translate(cr, px - left, py - top);
+	cairo_scale(cr, sx, sy);
+	appendPath(cr, pathEntry->path);
+	cairo_set_fill_rule(cr, CAIRO_FILL_RULE_WINDING);
+	cairo_set_source_rgba(cr, 0.0, 0.0, 0.0, 1.0);
+	cairo_fill(cr);
+	cairo_destroy(cr);
+	cairo_surface_flush(entry.surface);
+
+	entry.origin = QPoint(left, top);
+	entry.bytes = qint64(cairo_image_surface_get_stride(entry.surface)) * height;
+	origin = entry.origin + QPoint(carryX, carryY);
+	cairo_surface_t* surface = entry.surface;
+	insert(key, entry);
+	return surface;
+}
+
+void ScreenGlyphCache::clear()
+{
+	for (auto it = m_entries.begin(); it != m_entries.end(); ++it)
+		release(it.value());
+	m_entries.clear();
+	m_bytes = 0;
+}
+
+ScreenGlyphCache::Entry* ScreenGlyphCache::findPath(int faceId, uint glyph, const OutlineFunction& outline)
+{
+	Key key = { faceId, glyph, 0, 0, -1 };
+	auto it = m_entries.find(key);
+	if (it != m_entries.end())
+	{
+		++m_statistics.pathHits;
+		it->lastUse = ++m_useCounter;
+		return &it.value();
+	}
+	++m_statistics.pathMisses;
+
+	// Same conversion as ScPainter::setupPolygon(), glyph outlines are always closed
+	FPointArray points = outline();
+	Entry entry;
+	if (points.size() > 3)
+	{
+		cairo_surface_t* scratch = cairo_image_surface_create(CAIRO_FORMAT_A8, 1, 1);
+		cairo_t* cr = cairo_create(scratch);
+		cairo_scale(cr, pathScale, pathScale);
+		bool nPath = true;
+		bool first = true;
+		FPoint np, np1, np2, np3, np4, firstP;
+		double minX = 0.0, minY = 0.0, maxX = 0.0, maxY = 0.0;
+		for (int poi = 0; poi < points.size() - 3; poi += 4)
+		{
+			if (points.isMarker(poi))
+			{
+				nPath = true;
+				continue;
+			}
+			if (nPath)
+			{
+				np = points.point(poi);
+				if ((!first) && (np4 == firstP))
+					cairo_close_path(cr);
+				cairo_move_to(cr, np.x(), np.y());
+				if (first)
+				{
+					minX = maxX = np.x();
+					minY = maxY = np.y();
+				}
+				first = nPath = false;
+				firstP = np4 = np;
+			}
+			np  = points.point(poi);
+			np1 = points.point(poi + 1);
+			np2 = points.point(poi + 3);
+			np3 = points.point(poi + 2);
+			if (np4 == np3)
+				continue;
+			if ((np == np1) && (np2 == np3))
+				cairo_line_to(cr, np3.x(), np3.y());
+			else
+				cairo_curve_to(cr, np1.x(), np1.y(), np2.x(), np2.y(), np3.x(), np3.y());
+			// The control points enclose the curve
+			const FPoint* corners[] = { &np, &np1, &np2, &np3 };
+			for (const FPoint* p : corners)
+			{
+				minX = qMin(minX, p->x());
+				maxX = qMax(maxX, p->x());
+				minY = qMin(minY, p->y());
+				maxY = qMax(maxY, p->y());
+			}
+			np4 = np3;
+		}
+		cairo_close_path(cr);
+		// The path is returned in the enlarged user space it was built in
+		cairo_identity_matrix(cr);
+		entry.path = cairo_copy_path(cr);
+		cairo_destroy(cr);
+		cairo_surface_destroy(scratch);
+		if (entry.path->status != CAIRO_STATUS_SUCCESS)
+		{
+			cairo_path_destroy(entry.path);
+			entry.path = nullptr;
+		}
+		else
+		{
+			entry.bounds = QRectF(QPointF(minX, minY), QPointF(maxX, maxY));
+			entry.bytes = qint64(entry.path->num_data) * sizeof(cairo_path_data_t);
+		}
+	}
+	// Glyphs without outline are cached as well, so that their outline is not asked for again
+	entry.bytes += sizeof(Entry);
+	insert(key, entry);
+	return &m_entries[key];
+}
+
+void ScreenGlyphCache::insert(const Key& key, const Entry& entry)
+{
+	evict(entry.bytes);
+	Entry& stored = m_entries[key];
+	stored = entry;
+	stored.lastUse = ++m_useCounter;
+	m_bytes += entry.bytes;
+}
+
+void ScreenGlyphCache::evict(qint64 neededBytes)
+{
+	if (m_bytes + neededBytes <= m_maxBytes)
+		return;
+	// Dropping a quarter of the budget at once keeps eviction rare when all entries are in use
+	qint64 target = qMax<qint64>(0, m_maxBytes - m_maxBytes / 4 - neededBytes);
+	QVector<QPair<quint64, Key> > byAge;
+	byAge.reserve(m_entries.count());
+	for (auto it = m_entries.constBegin(); it != m_entries.constEnd(); ++it)
+		byAge.append(qMakePair(it->lastUse, it.key()));
+	std::sort(byAge.begin(), byAge.end(), [](const QPair<quint64, Key>& a, const QPair<quint64, Key>& b) { return a.first < b.first; });
+	for (int i = 0; (i < byAge.count()) && (m_bytes > target); ++i)
+	{
+		auto it = m_entries.find(byAge.at(i).second);
+		m_bytes -= it->bytes;
+		release(it.value());
+		m_entries.erase(it);
+	}
+}
+
+void ScreenGlyphCache::release(Entry& entry)
+{
+	if (entry.path)
+		cairo_path_destroy(entry.path);
+	if (entry.surface)
+		cairo_surface_destroy(entry.surface);
+	entry.path = nullptr;
+	entry.surface = nullptr;
+}
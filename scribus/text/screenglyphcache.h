@@ -0,0 +1,138 @@
+/*
+ For general Scribus (>=1.3.2) copyright and licensing information please refer
+ to the COPYING file provided with the program. Following this notice may exist
+ a copyright and/or license notice that predates the release of Scribus 1.3.2
+ for which a new license (GPL+exception) is in place.
+ */
+
+#ifndef SCREENGLYPHCACHE_H
+#define SCREENGLYPHCACHE_H
+
+#include <functional>
+
+#include <cairo.h>
+
+#include <QHash>
+#include <QPoint>
+#include <QRectF>
+#include <QString>
+
+#include "scribusapi.h"
+#include "fpointarray.h"
+
+/**
+  Cache of glyph shapes for drawing text on screen.
+
+  Outlines are kept as Cairo paths in the units of ScFace::glyphOutline(),
+  in which the em is 10 units, so that repaints append the path instead of
+  converting the outline again. For small glyphs drawn with a matrix which
+  only scales and translates, the cache also keeps 8 bit coverage masks,
+  rendered at a quantized device scale and quarter pixel position, which
+  are blitted instead of filling the path.
+
+  Entries are identified by the face, the glyph and, for masks, by the
+  quantized scale and position. Their total size is kept below a budget by
+  dropping the least recently used entries. The cache must only be used in
+  the GUI thread.
+ */
+class SCRIBUS_API ScreenGlyphCache
+{
+public:
+	/// Masks are only made for glyphs up to this size in device pixels
+	static const int MaxMaskSize = 96;
+
+	typedef std::function<FPointArray()> OutlineFunction;
+
+	struct Statistics
+	{
+		quint64 pathHits { 0 };
+		quint64 pathMisses { 0 };
+		quint64 maskHits { 0 };
+		quint64 maskMisses { 0 };
+	};
+
+	/// The cache used by ScreenPainter
+	static ScreenGlyphCache& instance();
+
+	explicit ScreenGlyphCache(qint64 maxBytes = 16 * 1024 * 1024);
+	~ScreenGlyphCache();
+
+	ScreenGlyphCache(const ScreenGlyphCache&) = delete;
+	ScreenGlyphCache& operator=(const ScreenGlyphCache&) = delete;
+
+	void setMaxBytes(qint64 maxBytes);
+	qint64 maxBytes() const { return m_maxBytes; }
+	qint64 bytes() const { return m_bytes; }
+	int count() const { return m_entries.count(); }
+
+	/// Number identifying a font face in the keys of the cache
+	int faceId(const QString& fontPath, int faceIndex);
+
+	/**
+	 * Returns the outline of a glyph, calling outline() only if it is not
+	 * cached yet. Returns a null pointer for glyphs without outline. The
+	 * path stays valid until the next call which may add an entry.
+	 */
+	const cairo_path_t* path(int faceId, uint glyph, const OutlineFunction& outline);
+	/// Appends a path returned by path() to the current path of cr, in user space
+	static void appendPath(cairo_t* cr, const cairo_path_t* path);
+
+	/**
+	 * Returns the coverage mask of a glyph drawn with the device scale
+	 * scaleX, scaleY at the fractional device position phaseX, phaseY.
+	 * The mask has to be painted at the integer device position of the
+	 * glyph origin plus origin. Returns a null pointer if the glyph has no
+	 * outline or is too large for a mask. The mask stays valid until the
+	 * next call which may add an entry.
+	 */
+	cairo_surface_t* mask(int faceId, uint glyph, double scaleX, double scaleY, double phaseX, double phaseY, QPoint& origin, const OutlineFunction& outline);
+
+	const Statistics& statistics() const { return m_statistics; }
+	void resetStatistics() { m_statistics = Statistics(); }
+	void clear();
+
+private:
+	struct Key
+	{
+		int face;
+		uint glyph;
+		qint32 scaleX;
+		qint32 scaleY;
+		qint32 phase;
+		bool operator==(const Key& other) const
+		{
+			return face == other.face && glyph == other.glyph && scaleX == other.scaleX && scaleY == other.scaleY && phase == other.phase;
+		}
+	};
+	friend uint qHash(const Key& key, uint seed)
+	{
+		uint h = qHash(key.glyph, seed) ^ uint(key.face) * 0x9E3779B1u;
+		h = h * 31 + uint(key.scaleX);
+		h = h * 31 + uint(key.scaleY);
+		return h * 31 + uint(key.phase);
+	}
+
+	struct Entry
+	{
+		cairo_path_t* path { nullptr };
+		cairo_surface_t* surface { nullptr };
+		QRectF bounds;
+		QPoint origin;
+		qint64 bytes { 0 };
+		quint64 lastUse { 0 };
+	};
+
+	Entry* findPath(int faceId, uint glyph, const OutlineFunction& outline);
+	void insert(const Key& key, const Entry& entry);
+	void evict(qint64 neededBytes);
+	static void release(Entry& entry);
+
+	QHash<Key, Entry> m_entries;
+	QHash<QString, int> m_faceIds;
+	qint64 m_maxBytes;
+	qint64 m_bytes { 0 };
+	quint64 m_useCounter { 0 };
+	Statistics m_statistics;
+};
+
+#endif
@@ -5,11 +5,14 @@
  for which a new license (GPL+exception) is in place.
  */
 
+#include <cmath>
+
 #include <cairo.h>
 #if CAIRO_HAS_FC_FONT
 #include <cairo-ft.h>
 #endif
 
+#include "screenglyphcache.h"
 #include "screenpainter.h"
 #include "scpainter.h"
 #include "pageitem.h"
@@ -223,19 +226,52 @@ void ScreenPainter::drawGlyph(const GlyphCluster& gc)
 	}
 	else
 	{
+		ScreenGlyphCache& glyphCache = ScreenGlyphCache::instance();
+		const ScFace& face = font();
+		int faceId = glyphCache.faceId(face.fontFilePath(), face.faceIndex());
+		// Masks are composed the way fillPath() fills with a plain color
+		bool useMasks = (m_painter->fillMode() == ScPainter::Solid) && (m_painter->maskMode() <= 0);
+		cairo_t* cr = m_painter->context();
 		double sizeFactor = fontSize() / 10.0;
-		QVector<FPointArray> outlines = gc.glyphClusterOutline();
 		const QList<GlyphLayout>& glyphs = gc.glyphs();
 		for (int i = 0; i < glyphs.count(); ++i)
 		{
-			const FPointArray& outline = outlines.at(i);
 			const GlyphLayout& gl = glyphs.at(i);
+			auto outline = [&face, &gl]() { return face.glyphOutline(gl.glyph); };
 			m_painter->save();
 			m_painter->translate(gl.xoffset, - (fontSize() * gl.scaleV) + gl.yoffset);
 			m_painter->scale(gl.scaleH * sizeFactor, gl.scaleV * sizeFactor);
-			m_painter->setupPolygon(&outline, true);
-			if (outline.size() > 3)
-				m_painter->fillPath();
+			cairo_surface_t* mask = nullptr;
+			QPoint maskOrigin;
+			cairo_matrix_t matrix;
+			cairo_get_matrix(cr, &matrix);
+			if (useMasks && (matrix.xy == 0.0) && (matrix.yx == 0.0))
+			{
+				double baseX = floor(matrix.x0);
+				double baseY = floor(matrix.y0);
+				mask = glyphCache.mask(faceId, gl.glyph, matrix.xx, matrix.yy, matrix.x0 - baseX, matrix.y0 - baseY, maskOrigin, outline);
+				if (mask)
+				{
+					double r, g, b;
+					m_painter->brush().getRgbF(&r, &g, &b);
+					cairo_save(cr);
+					cairo_identity_matrix(cr);
+					cairo_set_source_rgba(cr, r, g, b, m_painter->brushOpacity());
+					m_painter->setRasterOp(m_painter->blendModeFill());
+					cairo_mask_surface(cr, mask, baseX + maskOrigin.x(), baseY + maskOrigin.y());
+					cairo_restore(cr);
+				}
+			}
+			if (!mask)
+			{
+				const cairo_path_t* path = glyphCache.path(faceId, gl.glyph, outline);
+				if (path)
+				{
+					m_painter->newPath();
+					ScreenGlyphCache::appendPath(cr, path);
+					m_painter->fillPath();
+				}
+			}
 			m_painter->restore();
 			m_painter->translate(gl.xadvance * gl.scaleH, 0.0);
 		}
@@ -255,21 +291,25 @@ void ScreenPainter::drawGlyphOutline(const GlyphCluster& gc, bool fill)
 	m_painter->setFillRule(false);
 
 	setupState(false);
+	ScreenGlyphCache& glyphCache = ScreenGlyphCache::instance();
+	const ScFace& face = font();
+	int faceId = glyphCache.faceId(face.fontFilePath(), face.faceIndex());
+	cairo_t* cr = m_painter->context();
 	double current_x = 0.0;
 	for (const GlyphLayout& gl : gc.glyphs())
 	{
 		m_painter->save();
 		m_painter->translate(gl.xoffset + current_x, - (fontSize() * gl.scaleV) + gl.yoffset );
 
-		FPointArray outline = font().glyphOutline(gl.glyph);
-		double scaleHv = gl.scaleH * fontSize() / 10.0;
-		double scaleVv = gl.scaleV * fontSize() / 10.0;
-		QTransform trans;
-		trans.scale(scaleHv, scaleVv);
-		outline.map(trans);
-		m_painter->setupPolygon(&outline, true);
-		if (outline.size() > 3)
+		const cairo_path_t* path = glyphCache.path(faceId, gl.glyph, [&face, &gl]() { return face.glyphOutline(gl.glyph); });
+		if (path)
 		{
+			// Only the path is scaled, the stroke keeps its width
+			m_painter->newPath();
+			cairo_save(cr);
+			cairo_scale(cr, gl.scaleH * fontSize() / 10.0, gl.scaleV * fontSize() / 10.0);
+			ScreenGlyphCache::appendPath(cr, path);
+			cairo_restore(cr);
 			m_painter->setLineWidth(strokeWidth());
 			m_painter->strokePath();
 		}
@@ -5,20 +5,27 @@ a copyright and/or license notice that predates the release of Scribus 1.3.2
 for which a new license (GPL+exception) is in place.
 */
 
+#include <algorithm>
 #include <cassert>  //added to make Fedora-5 happy
 
 //#include <QDebug>
 
 #include "fpoint.h"
+#include "marks.h"
 #include "scfonts.h"
 
 #include "scribusdoc.h"
 #include "sctext_shared.h"
 #include "util.h"
 
+// versions are unique over all stories, so a version of one story is never valid for another one
+static uint lastTextVersion = 0;
+static const int maxRecordedEdits = 1024;
+
 ScText_Shared::ScText_Shared(const StyleContext* pstyles) :
 	pstyleContext(nullptr)
 {
+	resetEdits();
 	pstyleContext.setDefaultStyle( & defaultStyle );
 	defaultStyle.setContext( pstyles );
 	trailingStyle.setContext( &pstyleContext );
@@ -39,31 +46,29 @@ ScText_Shared::ScText_Shared(const ScText_Shared& other) :
 	pstyleContext.setDefaultStyle( &defaultStyle );
 	trailingStyle.setContext( &pstyleContext );
 	orphanedCharStyle.setContext( defaultStyle.charStyle().context() );
+	resetEdits();
 
-	QListIterator<ScText*> it( other );
-	ScText* elem;
-	while ( it.hasNext() )
-	{
-		elem = it.next();
-		ScText* elem2 = new ScText(*elem);
-		append(elem2);
-		if (elem2->parstyle)
-		{
-			elem2->parstyle->setContext( & pstyleContext);
-//				elem2->parstyle->charStyle().setContext( defaultStyle.charStyleContext() );
-			replaceCharStyleContextInParagraph(count() - 1, elem2->parstyle->charStyleContext());
-		}
-	}
-	len = count();
-	replaceCharStyleContextInParagraph(len,  trailingStyle.charStyleContext() );
+	copyText(other);
 //		qDebug() << QString("ScText_Shared(%2) %1").arg(reinterpret_cast<uint>(this)).arg(reinterpret_cast<uint>(&other));
 }
 
 void ScText_Shared::clear()
 {
-	while (!this->isEmpty())
-		delete this->takeFirst(); 
-	QList<ScText*>::clear();
+	for (int i = 0; i < m_extras.count(); ++i)
+		delete m_extras.at(i).parstyle;
+	m_extras.clear();
+	m_text.clear();
+	m_flags.clear();
+	m_runs.clear();
+	qDeleteAll(m_styles);
+	m_styles.clear();
+	m_styleRefs.clear();
+	m_styleKeys.clear();
+	m_freeStyles.clear();
+	m_styleHash.clear();
+	m_unusedStyles = 0;
+	shapedTextCache.clear();
+	resetEdits();
 	cursorPosition = 0;
 	selFirst = 0;
 	selLast = -1;
@@ -84,24 +89,7 @@ ScText_Shared& ScText_Shared::operator= (const ScText_Shared& other)
 		trailingStyle.setContext( &pstyleContext );
 		orphanedCharStyle.setContext( other.defaultStyle.charStyle().context() );
 		clear();
-		QListIterator<ScText*> it( other );
-		ScText* elem;
-		while ( it.hasNext() )
-		{
-			elem = it.next();
-			ScText* elem2 = new ScText(*elem);
-			append(elem2);
-			if (elem2->parstyle)
-			{
-				elem2->parstyle->setContext( & pstyleContext );
-//					qDebug() << QString("StoryText::copy: * %1 align=%2").arg(elem2->parstyle->parent())
-//						   .arg(elem2->parstyle->alignment())
-//						   .arg((uint)elem2->parstyle->context()));
-					//				elem2->parstyle->charStyle().setContext( defaultStyle.charStyleContext());
-				replaceCharStyleContextInParagraph(count()-1, elem2->parstyle->charStyleContext());
-			}
-		}
-		len = count();
+		copyText(other);
 		cursorPosition = other.cursorPosition;
 		selFirst = other.selFirst;
 		selLast = other.selLast;
@@ -110,17 +98,417 @@ ScText_Shared& ScText_Shared::operator= (const ScText_Shared& other)
 		pstyleContext.invalidate();
 //			qDebug() << QString("StoryText::copy: %1 align=%2 %3").arg(trailingStyle.parentStyle()->name())
 //				   .arg(trailingStyle.alignment()).arg((uint)trailingStyle.context());
-		replaceCharStyleContextInParagraph(len,  trailingStyle.charStyleContext());
 	}
 //			qDebug() << QString("ScText_Shared: %1 = %2").arg(reinterpret_cast<uint>(this)).arg(reinterpret_cast<uint>(&other));
 	return *this;
 }
 
+void ScText_Shared::copyText(const ScText_Shared& other)
+{
+	m_text = other.m_text;
+	m_flags = other.m_flags;
+	m_runs.reserve(other.m_runs.count());
+	for (int i = 0; i < other.m_runs.count(); ++i)
+	{
+		ScTextStyleRun run;
+		run.end = other.m_runs.at(i).end;
+		run.style = acquireStyle(*other.m_styles.at(other.m_runs.at(i).style));
+		m_runs.append(run);
+	}
+	for (int i = 0; i < other.m_extras.count(); ++i)
+	{
+		const ScTextExtra& otherExtra = other.m_extras.at(i);
+		ScTextExtra extra;
+		extra.pos = otherExtra.pos;
+		extra.embedded = otherExtra.embedded;
+		// unique marks stay with the original text
+		if (otherExtra.mark && !otherExtra.mark->isUnique())
+			extra.mark = otherExtra.mark;
+		if (otherExtra.parstyle)
+		{
+			extra.parstyle = new ParagraphStyle(*otherExtra.parstyle);
+			extra.parstyle->setContext( & pstyleContext);
+		}
+		if (extra.parstyle || extra.embedded || extra.mark)
+			m_extras.append(extra);
+	}
+	// the copied char styles still refer to the paragraph styles of other
+	for (int i = 0; i < m_extras.count(); ++i)
+	{
+		if (m_extras.at(i).parstyle)
+			setParagraphContext(m_extras.at(i).pos, m_extras.at(i).parstyle->charStyleContext());
+	}
+	len = count();
+	setParagraphContext(len, trailingStyle.charStyleContext());
+}
+
+void ScText_Shared::insertChars(int pos, const QString& txt, const CharStyle& style, const quint16* flags)
+{
+	assert(pos >= 0);
+	assert(pos <= count());
+
+	int n = txt.length();
+	if (n == 0)
+		return;
+	if (m_unusedStyles > 64 && m_unusedStyles > m_styleHash.count())
+		dropUnusedStyles();
+
+	ScTextStyleRun run;
+	run.end = pos + n;
+	run.style = acquireStyle(style);
+	int index = m_runs.count();
+	if (pos < count())
+	{
+		splitRun(pos);
+		index = runIndex(pos);
+		for (int i = index; i < m_runs.count(); ++i)
+			m_runs[i].end += n;
+	}
+	m_runs.insert(index, run);
+	mergeRuns(index, index);
+
+	quint16 styleFlags = style.effects().value & ScStyle_NonUserStyles;
+	m_text.insert(pos, txt);
+	m_flags.insert(pos, n, styleFlags);
+	if (flags)
+	{
+		for (int i = 0; i < n; ++i)
+			m_flags[pos + i] |= flags[i];
+	}
+	for (int i = extraIndex(pos); i < m_extras.count(); ++i)
+		m_extras[i].pos += n;
+}
+
+void ScText_Shared::removeChars(int pos, int len)
+{
+	assert(pos >= 0);
+	assert(pos + len <= count());
+
+	if (len <= 0)
+		return;
+	int end = pos + len;
+
+	int firstExtra = extraIndex(pos);
+	int lastExtra = firstExtra;
+	while (lastExtra < m_extras.count() && m_extras.at(lastExtra).pos < end)
+	{
+		delete m_extras.at(lastExtra).parstyle;
+		++lastExtra;
+	}
+	m_extras.remove(firstExtra, lastExtra - firstExtra);
+	for (int i = firstExtra; i < m_extras.count(); ++i)
+		m_extras[i].pos -= len;
+
+	splitRun(pos);
+	splitRun(end);
+	int firstRun = runIndex(pos);
+	int lastRun = firstRun;
+	while (lastRun < m_runs.count() && m_runs.at(lastRun).end <= end)
+	{
+		releaseStyle(m_runs.at(lastRun).style);
+		++lastRun;
+	}
+	m_runs.remove(firstRun, lastRun - firstRun);
+	for (int i = firstRun; i < m_runs.count(); ++i)
+		m_runs[i].end -= len;
+	mergeRuns(firstRun - 1, firstRun);
+
+	m_text.remove(pos, len);
+	m_flags.remove(pos, len);
+}
+
+const CharStyle& ScText_Shared::charStyle(int pos) const
+{
+	assert(pos >= 0);
+	assert(pos < count());
+
+	return *m_styles.at(m_runs.at(runIndex(pos)).style);
+}
+
+void ScText_Shared::modifyCharStyles(int pos, int len, const std::function<void(CharStyle&)>& func)
+{
+	assert(pos >= 0);
+	assert(pos + len <= count());
+
+	if (len <= 0)
+		return;
+	if (m_unusedStyles > 64 && m_unusedStyles > m_styleHash.count())
+		dropUnusedStyles();
+
+	int end = pos + len;
+	splitRun(pos);
+	splitRun(end);
+	int first = runIndex(pos);
+	int last = first;
+	for (int i = first; i < m_runs.count() && runStart(i) < end; ++i)
+	{
+		CharStyle style(*m_styles.at(m_runs.at(i).style));
+		func(style);
+		// features like SHYPHEN may set layout flags, those belong to the chars
+		quint16 styleFlags = style.effects().value & ScStyle_NonUserStyles;
+		if (styleFlags != 0)
+		{
+			for (int j = runStart(i); j < m_runs.at(i).end; ++j)
+				m_flags[j] |= styleFlags;
+		}
+		int index = acquireStyle(style);
+		releaseStyle(m_runs.at(i).style);
+		m_runs[i].style = index;
+		last = i;
+	}
+	mergeRuns(first, last);
+}
+
+ParagraphStyle* ScText_Shared::parstyle(int pos) const
+{
+	int i = extraIndex(pos);
+	if (i < m_extras.count() && m_extras.at(i).pos == pos)
+		return m_extras.at(i).parstyle;
+	return nullptr;
+}
+
+void ScText_Shared::setParstyle(int pos, ParagraphStyle* style)
+{
+	if (!style && !parstyle(pos))
+		return;
+	ScTextExtra& extra = extraAt(pos);
+	if (extra.parstyle != style)
+		delete extra.parstyle;
+	extra.parstyle = style;
+	dropExtraIfEmpty(pos);
+}
+
+int ScText_Shared::embedded(int pos) const
+{
+	int i = extraIndex(pos);
+	if (i < m_extras.count() && m_extras.at(i).pos == pos)
+		return m_extras.at(i).embedded;
+	return 0;
+}
+
+void ScText_Shared::setEmbedded(int pos, int embedded)
+{
+	if (embedded == 0 && this->embedded(pos) == 0)
+		return;
+	extraAt(pos).embedded = embedded;
+	dropExtraIfEmpty(pos);
+}
+
+Mark* ScText_Shared::mark(int pos) const
+{
+	int i = extraIndex(pos);
+	if (i < m_extras.count() && m_extras.at(i).pos == pos)
+		return m_extras.at(i).mark;
+	return nullptr;
+}
+
+QList<int> ScText_Shared::markPositions() const
+{
+	QList<int> result;
+	for (const ScTextExtra& extra : m_extras)
+	{
+		if (extra.mark)
+			result.append(extra.pos);
+	}
+	return result;
+}
+
+void ScText_Shared::setMark(int pos, Mark* mark)
+{
+	if (!mark && !this->mark(pos))
+		return;
+	extraAt(pos).mark = mark;
+	dropExtraIfEmpty(pos);
+}
+
+qint64 ScText_Shared::storageSize() const
+{
+	qint64 size = qint64(m_text.capacity()) * sizeof(QChar);
+	size += qint64(m_flags.capacity()) * sizeof(quint16);
+	size += qint64(m_runs.capacity()) * sizeof(ScTextStyleRun);
+	size += qint64(m_extras.capacity()) * (sizeof(ScTextExtra) + sizeof(ParagraphStyle));
+	size += qint64(m_styles.capacity()) * (sizeof(CharStyle*) + sizeof(int) + sizeof(uint));
+	size += qint64(m_styles.count() - m_freeStyles.count()) * sizeof(CharStyle);
+	size += qint64(m_styleHash.count()) * (sizeof(uint) + sizeof(int) + 2 * sizeof(void*));
+	return size;
+}
+
+int ScText_Shared::runIndex(int pos) const
+{
+	auto it = std::upper_bound(m_runs.constBegin(), m_runs.constEnd(), pos,
+							   [](int p, const ScTextStyleRun& run) { return p < run.end; });
+	return it - m_runs.constBegin();
+}
+
+void ScText_Shared::splitRun(int pos)
+{
+	if (pos <= 0 || pos >= count())
+		return;
+	int index = runIndex(pos);
+	if (runStart(index) == pos)
+		return;
+	ScTextStyleRun head;
+	head.end = pos;
+	head.style = m_runs.at(index).style;
+	++m_styleRefs[head.style];
+	m_runs.insert(index, head);
+}
+
+void ScText_Shared::mergeRuns(int first, int last)
+{
+	int stop = qMax(first, 1);
+	for (int i = qMin(last + 1, m_runs.count() - 1); i >= stop; --i)
+	{
+		if (m_runs.at(i).style != m_runs.at(i - 1).style)
+			continue;
+		m_runs[i - 1].end = m_runs.at(i).end;
+		releaseStyle(m_runs.at(i).style);
+		m_runs.remove(i);
+	}
+}
+
+int ScText_Shared::acquireStyle(const CharStyle& style)
+{
+	uint key = styleKey(style);
+	QMultiHash<uint, int>::const_iterator it = m_styleHash.constFind(key);
+	for (; it != m_styleHash.constEnd() && it.key() == key; ++it)
+	{
+		if (sameStyle(*m_styles.at(it.value()), style))
+		{
+			++m_styleRefs[it.value()];
+			return it.value();
+		}
+	}
+
+	CharStyle* stored = new CharStyle(style);
+	stored->setEffects(StyleFlag(stored->effects().value & ~ScStyle_NonUserStyles));
+	int index;
+	if (m_freeStyles.isEmpty())
+	{
+		index = m_styles.count();
+		m_styles.append(stored);
+		m_styleRefs.append(1);
+		m_styleKeys.append(key);
+	}
+	else
+	{
+		index = m_freeStyles.takeLast();
+		m_styles[index] = stored;
+		m_styleRefs[index] = 1;
+		m_styleKeys[index] = key;
+	}
+	m_styleHash.insert(key, index);
+	return index;
+}
+
+void ScText_Shared::releaseStyle(int index)
+{
+	if (--m_styleRefs[index] > 0)
+		return;
+	// the context of an unused style may be gone already, so it mustn't be compared any more
+	m_styleHash.remove(m_styleKeys.at(index), index);
+	++m_unusedStyles;
+}
+
+void ScText_Shared::dropUnusedStyles()
+{
+	bool dropped = false;
+	for (int i = 0; i < m_styles.count(); ++i)
+	{
+		if (m_styleRefs.at(i) > 0 || m_styles.at(i) == nullptr)
+			continue;
+		delete m_styles.at(i);
+		m_styles[i] = nullptr;
+		m_freeStyles.append(i);
+		dropped = true;
+	}
+	m_unusedStyles = 0;
+	// glyph clusters point into the pool, so shaped text must not outlive the styles it was shaped with
+	if (dropped)
+		shapedTextCache.clear();
+}
+
+uint ScText_Shared::styleKey(const CharStyle& style)
+{
+	uint key = qHash(style.parent()) ^ qHash(quintptr(style.context()));
+	if (!style.isInhFont())
+		key ^= qHash(style.font().scName()) * 3;
+	if (!style.isInhFontSize())
+		key ^= qHash(style.fontSize()) * 5;
+	if (!style.isInhFillColor())
+		key ^= qHash(style.fillColor()) * 7;
+	if (!style.isInhFeatures())
+		key ^= qHash(style.features().join(QString())) * 11;
+	return key;
+}
+
+bool ScText_Shared::sameStyle(const CharStyle& a, const CharStyle& b)
+{
+	// compare the contexts first, equiv() would look into them
+	return a.context() == b.context()
+		&& a.name() == b.name()
+		&& a.isDefaultStyle() == b.isDefaultStyle()
+		&& a.equiv(b);
+}
+
+int ScText_Shared::extraIndex(int pos) const
+{
+	auto it = std::lower_bound(m_extras.constBegin(), m_extras.constEnd(), pos,
+							   [](const ScTextExtra& extra, int p) { return extra.pos < p; });
+	return it - m_extras.constBegin();
+}
+
+ScTextExtra& ScText_Shared::extraAt(int pos)
+{
+	int i = extraIndex(pos);
+	if (i >= m_extras.count() || m_extras.at(i).pos != pos)
+	{
+		ScTextExtra extra;
+		extra.pos = pos;
+		m_extras.insert(i, extra);
+	}
+	return m_extras[i];
+}
+
+void ScText_Shared::dropExtraIfEmpty(int pos)
+{
+	int i = extraIndex(pos);
+	if (i >= m_extras.count() || m_extras.at(i).pos != pos)
+		return;
+	const ScTextExtra& extra = m_extras.at(i);
+	if (!extra.parstyle && !extra.embedded && !extra.mark)
+		m_extras.remove(i);
+}
+
+uint ScText_Shared::recordEdit(int pos, int end, int delta)
+{
+	if (edits.count() >= maxRecordedEdits)
+	{
+		int forget = maxRecordedEdits / 2;
+		editsBase = edits[forget - 1].version;
+		edits.remove(0, forget);
+	}
+	ScTextEdit edit;
+	edit.version = ++lastTextVersion;
+	edit.pos = pos;
+	edit.end = end;
+	edit.delta = delta;
+	edits.append(edit);
+	return edit.version;
+}
+
+void ScText_Shared::resetEdits()
+{
+	edits.clear();
+	editsBase = ++lastTextVersion;
+}
+
 ScText_Shared::~ScText_Shared() 
 {
 //		qDebug() << QString("~ScText_Shared() %1").arg(reinterpret_cast<uint>(this));
-	while (!this->isEmpty())
-		delete this->takeFirst(); 
+	for (int i = 0; i < m_extras.count(); ++i)
+		delete m_extras.at(i).parstyle;
+	qDeleteAll(m_styles);
 }
 
 /**
@@ -131,49 +519,52 @@ ScText_Shared::~ScText_Shared()
 void ScText_Shared::replaceCharStyleContextInParagraph(int pos, const StyleContext* newContext)
 {
 	assert (pos >= 0);
-	assert (pos <= size());
-	
-	if (pos < size())
-		value(pos)->setContext(newContext);
-	for (int i=pos-1; i >=0 ; --i ) 
-	{
-		if ( (at(i)->ch) == SpecialChars::PARSEP)
-			break;
-		value(i)->setContext(newContext);
-	}
+	assert (pos <= count());
+
+	setParagraphContext(pos, newContext);
 #ifndef NDEBUG // skip assertions if we aren't debugging
 	// we are done here but will do a sanity check:
-	// assert that all chars point to the following parstyle
-	QListIterator<ScText*> it( *this );
+	checkContexts();
+#endif
+}
+
+void ScText_Shared::setParagraphContext(int pos, const StyleContext* newContext)
+{
+	int start = (pos > 0) ? m_text.lastIndexOf(SpecialChars::PARSEP, pos - 1) + 1 : 0;
+	int end = qMin(pos + 1, count());
+	if (end > start)
+		modifyCharStyles(start, end - start, [newContext](CharStyle& style) { style.setContext(newContext); });
+}
+
+/// asserts that all chars point to the following parstyle
+void ScText_Shared::checkContexts() const
+{
 	const StyleContext* lastContext = nullptr;
-	while ( it.hasNext() )
+	for (int i = 0; i < count(); ++i)
 	{
-		ScText* elem = it.next();
-		assert( elem );
-		if ( elem->ch.isNull() ) 
+		QChar ch = m_text.at(i);
+		if ( ch.isNull() ) 
 		{
 			// nothing, see code in removeParSep
 		}
-		else if (elem->ch == SpecialChars::PARSEP)
+		else if (ch == SpecialChars::PARSEP)
 		{
-			assert( elem->parstyle );
+			assert( parstyle(i) );
 			if ( lastContext )
 			{
-				assert( lastContext == elem->parstyle->charStyleContext() );
+				assert( lastContext == parstyle(i)->charStyleContext() );
 			}
 			lastContext = nullptr;
 		}
 		else if (lastContext == nullptr)
 		{
-			lastContext = elem->context();
+			lastContext = charStyle(i).context();
 		}
 		else 
 		{
-			assert( lastContext == elem->context() );
+			assert( lastContext == charStyle(i).context() );
 		}
 	}
 	if ( lastContext )
 		assert( lastContext == trailingStyle.charStyleContext() );
-#endif
 }
-
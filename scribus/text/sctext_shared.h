@@ -1,20 +1,63 @@
 #ifndef SCTEXT_SHARED_H
 #define SCTEXT_SHARED_H
 
+#include <functional>
+
 #include <QList>
+#include <QMultiHash>
 #include <QObject>
 #include <QString>
+#include <QVector>
 #include <cassert>
 
 //#include "text/paragraphlayout.h"
 #include "text/frect.h"
+#include "text/shapedtextcache.h"
 #include "style.h"
 #include "styles/charstyle.h"
 #include "styles/paragraphstyle.h"
 #include "styles/stylecontextproxy.h"
 
+class Mark;
+
+/// An entry in the edit log of a story: chars [pos, end) were changed and delta chars were inserted (or removed)
+struct ScTextEdit
+{
+	uint version;
+	int pos;
+	int end;
+	int delta;
+};
+
+
+/// Chars [previous run's end, end) use the char style with index style in the style pool
+struct ScTextStyleRun
+{
+	int end;
+	int style;
+};
+
+/// What only a few chars have: the paragraph style of a PARSEP, the inline frame or the mark of an OBJECT
+struct ScTextExtra
+{
+	int pos { 0 };
+	ParagraphStyle* parstyle { nullptr };
+	int embedded { 0 };
+	Mark* mark { nullptr };
+};
+
 
-class SCRIBUS_API ScText_Shared : public QList<ScText*>
+/**
+   The text of a story and its formatting.
+
+   Chars are kept as contiguous UTF-16 code units. Char styles are interned:
+   each distinct style is stored once in a pool and the text refers to it by
+   runs of chars. The layout flags of each char live in an array of their
+   own so that marking hyphenation points doesn't split runs, and the few
+   chars which carry a paragraph style, an inline frame or a mark keep it
+   in a sorted list of extras.
+ */
+class SCRIBUS_API ScText_Shared
 {
 public:
 	ScText_Shared(const StyleContext* pstyles);	
@@ -34,8 +77,53 @@ public:
 	bool marksCountChanged { false };
 	ParagraphStyle trailingStyle;
 	CharStyle orphanedCharStyle;
+	/// shaped paragraphs, shared by all StoryText objects using this data
+	ShapedTextCache shapedTextCache;
+	/// the most recent edits, oldest first
+	QVector<ScTextEdit> edits;
+	/// version of the text before the first entry in edits
+	uint editsBase { 0 };
+
+	int count() const { return m_text.length(); }
+	bool isEmpty() const { return m_text.isEmpty(); }
+	const QString& chars() const { return m_text; }
+	QChar charAt(int pos) const { return m_text.at(pos); }
+	/// replaces a char, its style and extras are kept
+	void setChar(int pos, QChar ch) { m_text[pos] = ch; }
+
+	/// inserts chars which all get the given style, flags may be nullptr or hold one entry per char
+	void insertChars(int pos, const QString& txt, const CharStyle& style, const quint16* flags = nullptr);
+	/// removes chars along with their paragraph styles
+	void removeChars(int pos, int len);
+
+	const CharStyle& charStyle(int pos) const;
+	/// calls func for a copy of each distinct char style in the range and stores the result
+	void modifyCharStyles(int pos, int len, const std::function<void(CharStyle&)>& func);
+
+	quint16 flags(int pos) const { return m_flags.at(pos); }
+	void setFlags(int pos, quint16 flags) { m_flags[pos] = flags; }
+
+	ParagraphStyle* parstyle(int pos) const;
+	/// takes ownership of style, the previous paragraph style is deleted
+	void setParstyle(int pos, ParagraphStyle* style);
+	int embedded(int pos) const;
+	void setEmbedded(int pos, int embedded);
+	Mark* mark(int pos) const;
+	void setMark(int pos, Mark* mark);
+	/// positions of the chars which carry a mark, in ascending order
+	QList<int> markPositions() const;
+
+	/// number of distinct char styles and of style runs in use
+	int styleCount() const { return m_styleHash.count(); }
+	int runCount() const { return m_runs.count(); }
+	/// approximate memory used for the text and its formatting, in bytes
+	qint64 storageSize() const;
 
 	void clear();
+	/// appends an entry to the edit log and returns the new version of the text
+	uint recordEdit(int pos, int end, int delta);
+	/// forgets all edits, positions from before can't be mapped any more
+	void resetEdits();
 	
 	/**
 	   A char's stylecontext is the containing paragraph's style, 
@@ -43,6 +131,39 @@ public:
 	   in the parstyle first.
 	 */
 	void replaceCharStyleContextInParagraph(int pos, const StyleContext* newContext);
+
+private:
+	void copyText(const ScText_Shared& other);
+	void setParagraphContext(int pos, const StyleContext* newContext);
+	void checkContexts() const;
+
+	int runIndex(int pos) const;
+	int runStart(int index) const { return index > 0 ? m_runs.at(index - 1).end : 0; }
+	void splitRun(int pos);
+	void mergeRuns(int first, int last);
+
+	int acquireStyle(const CharStyle& style);
+	void releaseStyle(int index);
+	void dropUnusedStyles();
+	static uint styleKey(const CharStyle& style);
+	static bool sameStyle(const CharStyle& a, const CharStyle& b);
+
+	int extraIndex(int pos) const;
+	ScTextExtra& extraAt(int pos);
+	void dropExtraIfEmpty(int pos);
+
+	QString m_text;
+	QVector<quint16> m_flags;
+	QVector<ScTextStyleRun> m_runs;
+	QVector<ScTextExtra> m_extras;
+	/// the style pool, unused entries are only deleted when the next edit starts,
+	/// so a style passed by reference to an edit stays valid during that edit
+	QVector<CharStyle*> m_styles;
+	QVector<int> m_styleRefs;
+	QVector<uint> m_styleKeys;
+	QVector<int> m_freeStyles;
+	QMultiHash<uint, int> m_styleHash;
+	int m_unusedStyles { 0 };
 };
 
 #endif /*SCTEXT_SHARED_H*/
@@ -7,6 +7,7 @@
 
 #include "shapedtext.h"
 
+#include <cassert>
 #include <QSharedData>
 
 
@@ -40,14 +41,26 @@ public:
 	ShapedText split(int charPos)
 	{
 		int pos = splitPosition(charPos);
-		this->m_lastChar = charPos - 1;
-		this->m_glyphs.erase(this->m_glyphs.begin() + pos, this->m_glyphs.end());
+		assert(pos >= 0);
 
 		ShapedTextImplementation* result = new ShapedTextImplementation(*this);
 		result->m_firstChar = charPos;
 		result->m_glyphs.erase(result->m_glyphs.begin(), result->m_glyphs.begin() + pos);
+
+		this->m_lastChar = charPos - 1;
+		this->m_glyphs.erase(this->m_glyphs.begin() + pos, this->m_glyphs.end());
 		return ShapedText(result);
-}
+	}
+	
+	ShapedText shifted(int delta) const
+	{
+		ShapedTextImplementation* result = new ShapedTextImplementation(*this);
+		result->m_firstChar += delta;
+		result->m_lastChar += delta;
+		for (int i = 0; i < result->m_glyphs.count(); ++i)
+			result->m_glyphs[i].shiftChars(delta);
+		return ShapedText(result);
+	}
 	
 	/** only possible if they are adjacent pieces of the same text source */
 	bool canCombine(const QSharedPointer<ShapedTextImplementation>  other) const
@@ -100,6 +113,7 @@ QList<GlyphCluster>& ShapedText::glyphs() { return p_impl->m_glyphs; }
 
 bool ShapedText::canSplit(int pos) const { return p_impl->canSplit(pos); }
 ShapedText ShapedText::split(int pos) { return p_impl->split(pos); }
+ShapedText ShapedText::shifted(int delta) const { return p_impl->shifted(delta); }
 bool ShapedText::canCombine(const ShapedText& other) const { return p_impl->canCombine(other.p_impl); }
 void ShapedText::combine(ShapedText& other) { p_impl->combine(other.p_impl); }
 
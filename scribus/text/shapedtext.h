@@ -61,6 +61,8 @@ public:
 	/** only possible if it also cleanly splits the textsource and glyphs */
 	bool canSplit(int charPos) const;
 	ShapedText split(int charPos);
+	/** returns a copy with all character positions moved by delta, used after edits before this text */
+	ShapedText shifted(int delta) const;
 	/** only possible if they are adjacent pieces of the same text source */
 	bool canCombine(const ShapedText& other) const;
 	void combine(ShapedText& other);
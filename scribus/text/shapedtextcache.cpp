@@ -7,73 +7,152 @@
 
 #include "shapedtextcache.h"
 
-#include "index.h"
+#include <algorithm>
+#include <limits>
+#include <vector>
+
 #include "shapedtext.h"
 
 
 class ShapedTextCacheImplementation {
 	
-	IndexedList<ShapedText> m_cache;
+	/// a cached ShapedText, start and end are the current positions in the story
+	struct Entry {
+		int start;
+		int end;
+		ShapedText text;
+		
+		Entry(int s, int e, const ShapedText& txt) : start(s), end(e), text(txt) {}
+	};
+	
+	std::vector<Entry> m_cache;
+	int m_paragraphStylesVersion { -1 };
+	int m_charStylesVersion { -1 };
+	
+	
+	/// returns the index of the first entry with end > charPos
+	uint search(int charPos) const
+	{
+		std::vector<Entry>::const_iterator it = std::upper_bound(m_cache.begin(), m_cache.end(), charPos,
+																 [](int pos, const Entry& e) { return pos < e.end; });
+		return it - m_cache.begin();
+	}
+	
+	
+	/// erases all entries which overlap [first, end)
+	void erase(int first, int end)
+	{
+		uint idx1 = search(first);
+		uint idx2 = idx1;
+		while (idx2 < m_cache.size() && m_cache[idx2].start < end)
+			++idx2;
+		m_cache.erase(m_cache.begin() + idx1, m_cache.begin() + idx2);
+	}
+	
+	
+	/// moves all entries starting at or after charPos by delta
+	void shift(int charPos, int delta)
+	{
+		for (uint i = search(charPos); i < m_cache.size(); ++i)
+		{
+			if (m_cache[i].start < charPos)
+				continue;
+			m_cache[i].start += delta;
+			m_cache[i].end += delta;
+		}
+	}
 	
 	
 public:
 	
-	// check if all ShapedText in the cache for this range are valid, i.e. source() != nullptr
+	// check if the cache holds a valid ShapedText for this range, which can be split at charPos
 	bool contains(int charPos, uint len) const
 	{
-		int last = charPos + len - 1;
-		if (!m_cache.containsPosition(charPos) || !m_cache.containsPosition(last))
+		uint idx = search(charPos);
+		if (idx >= m_cache.size())
 			return false;
 		
-		ShapedText st = m_cache(charPos);
-		while (st.isValid() && st.lastChar() < last)
-		{
-			st = m_cache(st.lastChar() + 1);
-		}
+		const Entry& e = m_cache[idx];
+		if (e.start > charPos || e.end < charPos + static_cast<int>(len) || !e.text.isValid())
+			return false;
 		
-		return st.isValid();
+		return charPos == e.start || e.text.canSplit(charPos - e.start + e.text.firstChar());
 	}
 	
 	
-	ShapedText get(int charPos, uint minLen) const
+	ShapedText get(int charPos, uint minLen)
 	{
-		int last = charPos + minLen - 1;
-		if (!m_cache.containsPosition(charPos) || !m_cache.containsPosition(last))
-			return ShapedText::Invalid;
-
-		ShapedText result = m_cache(charPos);
-		if (!result.isValid())
+		if (!contains(charPos, minLen))
 			return ShapedText::Invalid;
 		
-		if (!m_cache.isExactPosition(charPos))
-		{
-			result = result.split(charPos);
-		}
-		while (result.lastChar() < last)
-		{
-			ShapedText st = m_cache(result.lastChar() + 1);
-			if (st.source() == nullptr || !result.canCombine(st))
-				return ShapedText::Invalid;
-			result.combine(st);
-		}
-		return result;
+		Entry& e = m_cache[search(charPos)];
+		
+		// glyph clusters still carry the positions from the time they were shaped
+		int delta = e.start - e.text.firstChar();
+		if (delta != 0)
+			e.text = e.text.shifted(delta);
+		
+		if (charPos == e.start)
+			return e.text;
+		
+		ShapedText result = e.text.shifted(0);
+		return result.split(charPos);
 	}
 	
 	
 	void put(const ShapedText& txt)
 	{
 		int first = txt.firstChar();
-		int len = txt.lastChar() + 1 - first;
+		int end = txt.lastChar() + 1;
 		
-		m_cache.replace(first, len , txt);
+		erase(first, end);
+		m_cache.insert(m_cache.begin() + search(first), Entry(first, end, txt));
 	}
 	
+	
 	void clear(int charPos, uint len)
 	{
-		put(ShapedText(nullptr, charPos, charPos + len - 1));
+		if (charPos <= 0 && len >= static_cast<uint>(std::numeric_limits<int>::max()))
+		{
+			m_cache.clear();
+			return;
+		}
+		int end = len > static_cast<uint>(std::numeric_limits<int>::max() - charPos) ? std::numeric_limits<int>::max() : charPos + static_cast<int>(len);
+		erase(charPos, end);
 	}
-
 	
+	
+	void insertChars(int charPos, uint len)
+	{
+		// an entry containing charPos has to be shaped again anyway
+		uint idx = search(charPos);
+		if (idx < m_cache.size() && m_cache[idx].start < charPos)
+			m_cache.erase(m_cache.begin() + idx);
+		shift(charPos, len);
+	}
+	
+	
+	void removeChars(int charPos, uint len)
+	{
+		erase(charPos, charPos + len);
+		shift(charPos + len, -static_cast<int>(len));
+	}
+	
+	
+	int count() const
+	{
+		return m_cache.size();
+	}
+	
+	
+	void setStyleVersions(int paragraphStyles, int charStyles)
+	{
+		if (paragraphStyles == m_paragraphStylesVersion && charStyles == m_charStylesVersion)
+			return;
+		m_cache.clear();
+		m_paragraphStylesVersion = paragraphStyles;
+		m_charStylesVersion = charStyles;
+	}
 };
 
 
@@ -90,3 +169,15 @@ void ShapedTextCache::put(const ShapedText& txt)
 
 void ShapedTextCache::clear(int charPos, uint len)
 { p_impl->clear(charPos, len); }
+
+void ShapedTextCache::insertChars(int charPos, uint len)
+{ p_impl->insertChars(charPos, len); }
+
+void ShapedTextCache::removeChars(int charPos, uint len)
+{ p_impl->removeChars(charPos, len); }
+
+int ShapedTextCache::count() const
+{ return p_impl->count(); }
+
+void ShapedTextCache::setStyleVersions(int paragraphStyles, int charStyles)
+{ p_impl->setStyleVersions(paragraphStyles, charStyles); }
@@ -38,6 +38,11 @@ public:
 class ShapedTextCacheImplementation;
 
 
+/**
+ * Cache for the shaped paragraphs of a story. Entries are kept in story coordinates:
+ * insertChars() and removeChars() move the entries behind an edit, so that only
+ * the paragraphs touched by the edit have to be shaped again.
+ */
 class SCRIBUS_API ShapedTextCache : public IShapedTextCache
 {
 	QSharedPointer<ShapedTextCacheImplementation> p_impl;
@@ -48,6 +53,15 @@ public:
 	ShapedText get(int charPos, uint minLen=1) const;
 	void put(const ShapedText& txt);
 	void clear(int charPos = 0, uint len = -1);
+
+	/// call this after len chars were inserted at charPos
+	void insertChars(int charPos, uint len);
+	/// call this after len chars were removed at charPos
+	void removeChars(int charPos, uint len);
+	/// number of cached blocks
+	int count() const;
+	/// drops all blocks if the document's named styles changed since they were shaped
+	void setStyleVersions(int paragraphStyles, int charStyles);
 };
 
 
@@ -39,7 +39,7 @@ bool ShapedTextFeed::haveMoreText(int glyphPos, QList<GlyphCluster>& glyphs)
 		if (more.glyphs().count() == 0)
 			break;
 //		qDebug() << "feed" << m_endChar << "-->" << more.lastChar() + 1;
-		m_endChar = more.lastChar();
+		m_endChar = more.lastChar() + 1;
 		int nOldGlyphs = glyphs.count();
 		glyphs.append(more.glyphs());
 		std::stable_sort(glyphs.begin() + nOldGlyphs, glyphs.end(), logicalGlyphRunComp);
@@ -51,16 +51,19 @@ bool ShapedTextFeed::haveMoreText(int glyphPos, QList<GlyphCluster>& glyphs)
 
 ShapedText ShapedTextFeed::getMore(int fromChar, int toChar)
 {
-	if (m_cache != nullptr)
-	{
-		int len = toChar - fromChar;
-		if (!m_cache->contains(fromChar, len))
-		{
-			m_cache->put(m_shaper.shape(fromChar, toChar));
-		}
+	if (m_cache == nullptr)
+		return m_shaper.shape(fromChar, toChar);
+
+	int len = toChar - fromChar;
+	if (m_cache->contains(fromChar, len))
 		return m_cache->get(fromChar, len);
-	}
-	return m_shaper.shape(fromChar, toChar);
+
+	ShapedText result = m_shaper.shape(fromChar, toChar);
+	// Only whole blocks are cached. Text which depends on the frame
+	// (inline objects, page numbers, super/subscript) has to be shaped every time.
+	if (!result.needsContext() && m_textSource->isBlockStart(fromChar))
+		m_cache->put(result);
+	return result;
 }
 
 
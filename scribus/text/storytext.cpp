@@ -26,6 +26,7 @@ pageitem.cpp  -  description
 
 //FIXME: this include must go to sctextstruct.h !
 #include <QList>
+#include <algorithm>
 #include <cassert>  //added to make Fedora-5 happy
 
 #include "fpoint.h"
@@ -60,8 +61,6 @@ StoryText::StoryText(ScribusDoc * doc_) : m_doc(doc_)
 	d->selFirst = 0;
 	d->selLast = -1;
 	
-	m_shapedTextCache = new ShapedTextCache();
-	
 	d->len = 0;
 	invalidateAll();
 }
@@ -72,7 +71,6 @@ StoryText::StoryText() : m_doc(nullptr)
 
 	d->selFirst = 0;
 	d->selLast = -1;
-	m_shapedTextCache = nullptr;
 }
 
 StoryText::StoryText(const StoryText & other) : m_doc(other.m_doc)
@@ -88,7 +86,6 @@ StoryText::StoryText(const StoryText & other) : m_doc(other.m_doc)
 	
 	d->selFirst = 0;
 	d->selLast = -1;
-	m_shapedTextCache = nullptr;
 
 	invalidateLayout();
 }
@@ -119,7 +116,7 @@ bool StoryText::hasBulletOrNum() const
 	bool lastWasPARSEP = true;
 	for (int i = 0; i < length(); ++i)
 	{
-		lastWasPARSEP = (d->at(i)->ch == SpecialChars::PARSEP);
+		lastWasPARSEP = (d->charAt(i) == SpecialChars::PARSEP);
 		if (!lastWasPARSEP)
 			continue;
 		const ParagraphStyle& paraStyle = paragraphStyle(i);
@@ -373,7 +370,7 @@ int StoryText::indexOf(const QString &str, int from, Qt::CaseSensitivity cs, int
 			int index = 0;
 			while ((index < strLen) && ((index + i) < storyLen))
 			{
-				if (qStr.at(index) != d->at(index + i)->ch)
+				if (qStr.at(index) != d->charAt(index + i))
 					break;
 				++index;
 			}
@@ -398,7 +395,7 @@ int StoryText::indexOf(const QString &str, int from, Qt::CaseSensitivity cs, int
 			while ((index < strLen) && ((index + i + diacriticsCounter) < storyLen))
 			{
 				const QChar &qChar = qStr.at(index);
-				const QChar &curChar = d->at(index + diacriticsCounter + i)->ch;
+				const QChar &curChar = d->charAt(index + diacriticsCounter + i);
 				qCharIsDiacritic   = SpecialChars::isArabicModifierLetter(qChar.unicode()) | (qChar.category() == QChar::Mark_NonSpacing);
 				curCharIsDiacritic = SpecialChars::isArabicModifierLetter(curChar.unicode()) | (curChar.category() == QChar::Mark_NonSpacing);
 				if (qCharIsDiacritic || curCharIsDiacritic)
@@ -421,7 +418,7 @@ int StoryText::indexOf(const QString &str, int from, Qt::CaseSensitivity cs, int
 				foundIndex = i;
 				while ((index + i + diacriticsCounter) < storyLen)
 				{
-					const QChar &curChar = d->at(index + diacriticsCounter + i)->ch;
+					const QChar &curChar = d->charAt(index + diacriticsCounter + i);
 					if (!SpecialChars::isArabicModifierLetter(curChar.unicode()) && (curChar.category() != QChar::Mark_NonSpacing))
 						break;
 					++diacriticsCounter;
@@ -446,7 +443,7 @@ int StoryText::indexOf(QChar ch, int from, Qt::CaseSensitivity cs) const
 	{
 		for (int i = from; i < textLength; ++i)
 		{
-			if (d->at(i)->ch == ch)
+			if (d->charAt(i) == ch)
 			{
 				foundIndex = i;
 				break;
@@ -457,7 +454,7 @@ int StoryText::indexOf(QChar ch, int from, Qt::CaseSensitivity cs) const
 	{
 		for (int i = from; i < textLength; ++i)
 		{
-			if (d->at(i)->ch.toLower() == ch)
+			if (d->charAt(i).toLower() == ch)
 			{
 				foundIndex = i;
 				break;
@@ -515,9 +512,9 @@ void StoryText::insert(int pos, const StoryText& other, bool onlySelection)
 		else if (other.text(i) == SpecialChars::OBJECT)
 		{
 			insertChars(pos, SpecialChars::OBJECT);
-			item(pos)->embedded = other.item(i)->embedded;
-			item(pos)->mark = other.item(i)->mark;
-			if (item(pos)->mark)
+			d->setEmbedded(pos, other.d->embedded(i));
+			d->setMark(pos, other.d->mark(i));
+			if (d->mark(pos))
 			{
 				d->marksCount++;
 				d->marksCountChanged = true;
@@ -548,7 +545,8 @@ void StoryText::insert(int pos, const StoryText& other, bool onlySelection)
 	}
 	if ((d->selLast >= d->selFirst) && (d->selFirst <= oldPos) && (oldPos <= d->selLast))
 		d->selLast += (length() - oldLen);
-	invalidate(pos, length());
+	// the inserted chars recorded their edits already, the following paragraphs only moved
+	invalidateCaches(oldPos, pos, length());
 }
 
 
@@ -557,22 +555,23 @@ void StoryText::insert(int pos, const StoryText& other, bool onlySelection)
  */
 void StoryText::insertParSep(int pos)
 {
-	ScText* it = item(pos);
-	if (!it->parstyle)
+	ParagraphStyle* parstyle = d->parstyle(pos);
+	if (!parstyle)
 	{
-		it->parstyle = new ParagraphStyle(paragraphStyle(pos+1));
-		it->parstyle->setContext( & d->pstyleContext);
+		parstyle = new ParagraphStyle(paragraphStyle(pos+1));
+		parstyle->setContext( & d->pstyleContext);
+		d->setParstyle(pos, parstyle);
 		// #7432 : when inserting a paragraph separator, apply/erase the trailing Style
 		if (pos >= signed(d->len - 1))
 		{
 			applyStyle(pos, d->trailingStyle);
 			d->trailingStyle.erase();
 		}
-//		it->parstyle->setName("para"); // DON'T TRANSLATE
-//		it->parstyle->charStyle().setName("cpara"); // DON'T TRANSLATE
-//		it->parstyle->charStyle().setContext( d->defaultStyle.charStyleContext() );
+//		parstyle->setName("para"); // DON'T TRANSLATE
+//		parstyle->charStyle().setName("cpara"); // DON'T TRANSLATE
+//		parstyle->charStyle().setContext( d->defaultStyle.charStyleContext() );
 	}
-	d->replaceCharStyleContextInParagraph(pos, it->parstyle->charStyleContext());
+	d->replaceCharStyleContextInParagraph(pos, parstyle->charStyleContext());
 }
 /**
      need to remove the ParagraphStyle structure and replace all pointers
@@ -580,17 +579,15 @@ void StoryText::insertParSep(int pos)
  */
 void StoryText::removeParSep(int pos)
 {
-	ScText* it = item(pos);
-	if (it->parstyle) {
-//		const CharStyle* oldP = & it->parstyle->charStyle();
+	if (d->parstyle(pos)) {
+//		const CharStyle* oldP = & d->parstyle(pos)->charStyle();
 //		const CharStyle* newP = & that->paragraphStyle(pos+1).charStyle();
 //		d->replaceParentStyle(pos, oldP, newP);
-		delete it->parstyle;
-		it->parstyle = nullptr;
+		d->setParstyle(pos, nullptr);
 	}
 	// demote this parsep so the assert code in replaceCharStyleContextInParagraph()
 	// doesn't choke:
-	it->ch = 0;
+	d->setChar(pos, QChar());
 	d->replaceCharStyleContextInParagraph(pos, paragraphStyle(pos+1).charStyleContext());
 }
 
@@ -619,14 +616,11 @@ void StoryText::removeChars(int pos, uint len)
 	}
 	for (int i = pos + static_cast<int>(len) - 1; i >= pos; --i)
 	{
-		ScText *it = d->at(i);
-		if (it->ch == SpecialChars::PARSEP)
+		QChar ch = d->charAt(i);
+		if (ch == SpecialChars::PARSEP)
 			removeParSep(i);
-		if ((it->ch == SpecialChars::OBJECT) && (it->mark != nullptr))
+		if ((ch == SpecialChars::OBJECT) && (d->mark(i) != nullptr))
 			d->marksCount--;
-		d->takeAt(i);
-		d->len--;
-		delete it;
 		// #9592 : adjust d->selFirst and d->selLast, those values have to be
 		// consistent in functions such as select()
 		if (i <= d->selLast)
@@ -636,6 +630,7 @@ void StoryText::removeChars(int pos, uint len)
 		if (static_cast<uint>(i + 1) <= d->cursorPosition && d->cursorPosition > 0)
 			d->cursorPosition -= 1;
 	}
+	d->removeChars(pos, len);
 
 	if (oldMarksCount != d->marksCount)
 		d->marksCountChanged = true;
@@ -647,7 +642,9 @@ void StoryText::removeChars(int pos, uint len)
 		d->selFirst =  0;
 		d->selLast  = -1;
 	}
-	invalidate(pos, length());
+	d->shapedTextCache.removeChars(pos, len);
+	d->recordEdit(pos, pos + len, -static_cast<int>(len));
+	invalidateCaches(pos, pos, length());
 }
 
 void StoryText::trim()
@@ -658,8 +655,8 @@ void StoryText::trim()
 	int pos = static_cast<int>(length()) - 1;
 	for ( int i = static_cast<int>(length()) - 1; i >= 0; --i )
 	{
-		ScText *it = d->at(i);
-		if ((it->ch == SpecialChars::PARSEP) || (it->ch.isSpace()))
+		QChar ch = d->charAt(i);
+		if ((ch == SpecialChars::PARSEP) || (ch.isSpace()))
 		{
 			pos--;
 			posCount++;
@@ -694,34 +691,25 @@ void StoryText::insertChars(int pos, const QString& txt, bool applyNeighbourStyl
 	
 	const StyleContext* cStyleContext = paragraphStyle(pos).charStyleContext();
 
-	ScText clone;
+	CharStyle clone;
 	if (applyNeighbourStyle)
 	{
 		int referenceChar = qMax(0, qMin(pos, length()-1));
 		clone.applyCharStyle(charStyle(referenceChar));
 		clone.setEffects(ScStyle_Default);
 	}
+	clone.setContext(cStyleContext);
 
-	for (int i = 0; i < txt.length(); ++i)
-	{
-		ScText * item = new ScText(clone);
-		item->ch= txt.at(i);
-		item->setContext(cStyleContext);
-		d->insert(pos + i, item);
-		d->len++;
-		if (item->ch == SpecialChars::PARSEP)
-		{
-//			qDebug() << QString("new PARSEP %2 at %1").arg(pos).arg(paragraphStyle(pos).name());
-			insertParSep(pos + i);
-		}
-		if (d->cursorPosition >= static_cast<uint>(pos + i))
-			d->cursorPosition += 1;
-	}
+	insertStyledChars(pos, txt, clone);
+	if (d->cursorPosition >= static_cast<uint>(pos))
+		d->cursorPosition += txt.length();
 
 	d->len = d->count();
 	if ((d->selLast >= d->selFirst) && (d->selFirst <= pos) && (pos <= d->selLast))
 		d->selLast += txt.length();
-	invalidate(pos, pos + txt.length());
+	d->shapedTextCache.insertChars(pos, txt.length());
+	d->recordEdit(pos, pos, txt.length());
+	invalidateCaches(pos, pos + txt.length(), pos + txt.length());
 }
 
 void StoryText::insertCharsWithSoftHyphens(int pos, const QString& txt, bool applyNeighbourStyle)
@@ -737,51 +725,77 @@ void StoryText::insertCharsWithSoftHyphens(int pos, const QString& txt, bool app
 	
 	const StyleContext* cStyleContext = paragraphStyle(pos).charStyleContext();
 
-	ScText clone;
+	CharStyle clone;
 	if (applyNeighbourStyle)
 	{
 		int referenceChar = qMax(0, qMin(pos, length() - 1));
 		clone.applyCharStyle(charStyle(referenceChar));
 		clone.setEffects(ScStyle_Default);
 	}
+	clone.setContext(cStyleContext);
 
-	int inserted = 0;
+	QString chars;
+	QVector<quint16> flags;
+	chars.reserve(txt.length());
+	flags.reserve(txt.length());
 	for (int i = 0; i < txt.length(); ++i) 
 	{
 		QChar ch = txt.at(i);
-		int  index  = pos + inserted;
+		int  index  = pos + chars.length();
 		bool insert = true; 
 		if (ch == SpecialChars::SHYPHEN && index > 0)
 		{
-			ScText* lastItem = this->item(index - 1);
+			// the previous char may not be inserted yet
+			quint16 lastFlags = chars.isEmpty() ? d->flags(index - 1) : flags.last();
 			// qreal SHY means user provided SHY, single SHY is automatic one
-			if (lastItem->effects() & ScStyle_HyphenationPossible)
-				lastItem->setEffects(lastItem->effects() & ~ScStyle_HyphenationPossible);
+			if (lastFlags & ScLayout_HyphenationPossible)
+				lastFlags &= ~ScLayout_HyphenationPossible;
 			else
 			{
-				lastItem->setEffects(lastItem->effects() | ScStyle_HyphenationPossible);
+				lastFlags |= ScLayout_HyphenationPossible;
 				insert = false;
 			}
+			if (chars.isEmpty())
+				d->setFlags(index - 1, lastFlags);
+			else
+				flags.last() = lastFlags;
 		}
 		if (insert)
 		{
-			ScText * item = new ScText(clone);
-			item->ch = ch;
-			item->setContext(cStyleContext);
-			d->insert(index, item);
-			d->len++;
-			if (item->ch == SpecialChars::PARSEP)
-				insertParSep(index);
-			if (d->cursorPosition >= static_cast<uint>(index))
-				d->cursorPosition += 1;
-			++inserted;
+			chars.append(ch);
+			flags.append(0);
 		}
 	}
+	int inserted = chars.length();
+	insertStyledChars(pos, chars, clone, flags.constData());
+	if (d->cursorPosition >= static_cast<uint>(pos))
+		d->cursorPosition += inserted;
 
 	d->len = d->count();
 	if ((d->selLast >= d->selFirst) && (d->selFirst <= pos) && (pos <= d->selLast))
 		d->selLast += inserted;
-	invalidate(pos, pos + inserted);
+	d->shapedTextCache.insertChars(pos, inserted);
+	d->recordEdit(pos, pos, inserted);
+	invalidateCaches(pos, pos + inserted, pos + inserted);
+}
+
+void StoryText::insertStyledChars(int pos, const QString& txt, const CharStyle& style, const quint16* flags)
+{
+	// each new PARSEP takes its style from the text following it, so insert up to one paragraph at a time
+	int start = 0;
+	while (start < txt.length())
+	{
+		int parSep = txt.indexOf(SpecialChars::PARSEP, start);
+		int end = (parSep < 0) ? txt.length() : parSep + 1;
+		d->insertChars(pos + start, txt.mid(start, end - start), style, flags ? flags + start : nullptr);
+		d->len = d->count();
+		if (parSep >= 0)
+		{
+//			qDebug() << QString("new PARSEP %2 at %1").arg(pos + parSep).arg(paragraphStyle(pos + parSep).name());
+			insertParSep(pos + parSep);
+		}
+		start = end;
+	}
 }
 
 void StoryText::replaceChar(int pos, QChar ch)
@@ -792,18 +806,18 @@ void StoryText::replaceChar(int pos, QChar ch)
 	assert(pos >= 0);
 	assert(pos < length());
 
-	ScText* item = d->at(pos);
-	if (item->ch == ch)
+	QChar oldCh = d->charAt(pos);
+	if (oldCh == ch)
 		return;
 
 	uint oldMarksCount = d->marksCount;
 	
-	if (item->ch == SpecialChars::PARSEP)
+	if (oldCh == SpecialChars::PARSEP)
 		removeParSep(pos);
-	if ((item->ch == SpecialChars::OBJECT) && (item->mark != nullptr))
+	if ((oldCh == SpecialChars::OBJECT) && (d->mark(pos) != nullptr))
 		d->marksCount--;
-	item->ch = ch;
-	if (d->at(pos)->ch == SpecialChars::PARSEP)
+	d->setChar(pos, ch);
+	if (d->charAt(pos) == SpecialChars::PARSEP)
 		insertParSep(pos);
 
 	if (oldMarksCount != d->marksCount)
@@ -879,14 +893,14 @@ void StoryText::hyphenateWord(int pos, uint len, const char* hyphens)
 //	QString dump("");
 	for (int i=pos; i < pos+signed(len); ++i)
 	{
-//		dump += d->at(i)->ch;
+//		dump += d->charAt(i);
 		if (hyphens && hyphens[i-pos] & 1)
 		{
-			d->at(i)->setEffects(d->at(i)->effects() | ScStyle_HyphenationPossible);
+			d->setFlags(i, d->flags(i) | ScLayout_HyphenationPossible);
 //			dump += "-";
 		}
 		else {
-			d->at(i)->setEffects(d->at(i)->effects() & ~ScStyle_HyphenationPossible);
+			d->setFlags(i, d->flags(i) & ~ScLayout_HyphenationPossible);
 		}
 	}
 //	qDebug() << QString("st: %1").arg(dump);
@@ -904,7 +918,7 @@ void StoryText::insertObject(int pos, int ob)
 		pos += length()+1;
 
 	insertChars(pos, SpecialChars::OBJECT);
-	const_cast<StoryText *>(this)->d->at(pos)->embedded = ob;
+	d->setEmbedded(pos, ob);
 	m_doc->FrameItems[ob]->isEmbedded = true;   // this might not be enough...
 	m_doc->FrameItems[ob]->OwnPage = -1; // #10379: OwnPage is not meaningful for inline object
 }
@@ -917,7 +931,7 @@ void StoryText::insertMark(Mark* mark, int pos)
 		pos = d->cursorPosition;
 
 	insertChars(pos, SpecialChars::OBJECT, false);
-	d->at(pos)->mark = mark;
+	d->setMark(pos, mark);
 	if (mark)
 	{
 		d->marksCount++;
@@ -931,7 +945,7 @@ void StoryText::replaceObject(int pos, int ob)
 		pos += length()+1;
 
 	replaceChar(pos, SpecialChars::OBJECT);
-	const_cast<StoryText *>(this)->d->at(pos)->embedded = ob;
+	d->setEmbedded(pos, ob);
 	m_doc->FrameItems[ob]->isEmbedded = true;   // this might not be enough...
 	m_doc->FrameItems[ob]->OwnPage = -1; // #10379: OwnPage is not meaningful for inline object
 }
@@ -947,20 +961,8 @@ QString StoryText::plainText() const
 	if (length() <= 0)
 		return QString();
 
-	QChar   ch;
-	QString result;
-
-	int len = length();
-	result.reserve(len);
-
-	StoryText* that(const_cast<StoryText*>(this));
-	for (int i = 0; i < len; ++i) {
-		ch = that->d->at(i)->ch;
-		if (ch == SpecialChars::PARSEP)
-			ch = QLatin1Char('\n');
-		result += ch;
-	}
-
+	QString result(d->chars());
+	result.replace(SpecialChars::PARSEP, QLatin1Char('\n'));
 	return result;
 }
 #if 0
@@ -978,7 +980,7 @@ QChar StoryText::text(int pos) const
 	assert(pos >= 0);
 	assert(pos < length());
 
-	return const_cast<StoryText *>(this)->d->at(pos)->ch;
+	return const_cast<StoryText *>(this)->d->charAt(pos);
 }
 
 QString StoryText::text(int pos, uint len) const
@@ -989,12 +991,7 @@ QString StoryText::text(int pos, uint len) const
 	assert(pos >= 0);
 	assert(pos + signed(len) <= length());
 
-	QString result;
-	StoryText* that(const_cast<StoryText*>(this));
-	for (int i = pos; i < pos+signed(len); ++i)
-		result += that->d->at(i)->ch;
-
-	return result;
+	return d->chars().mid(pos, static_cast<int>(len));
 }
 
 
@@ -1026,8 +1023,7 @@ InlineFrame StoryText::object(int pos) const
 	assert(pos >= 0);
 	assert(pos < length());
 
-	StoryText* that = const_cast<StoryText *>(this);
-	return InlineFrame(that->d->at(pos)->embedded);
+	return InlineFrame(d->embedded(pos));
 }
 
 
@@ -1087,7 +1083,7 @@ QString StoryText::textWithSoftHyphens(int pos, uint len) const
 	len = qMin((uint) (length() - pos), len);
 	for (int i = pos; i < pos+signed(len); ++i)
 	{
-		if (this->charStyle(i).effects() & ScStyle_HyphenationPossible 
+		if (hasFlag(i, ScLayout_HyphenationPossible)
 			// duplicate SHYPHEN if already present to indicate a user provided SHYPHEN:
 			|| this->text(i) == SpecialChars::SHYPHEN)
 		{
@@ -1109,9 +1105,11 @@ bool StoryText::hasObject(int pos) const
 	assert(pos >= 0);
 	assert(pos < length());
 
-	StoryText* that = const_cast<StoryText *>(this);
-	if (that->d->at(pos)->ch == SpecialChars::OBJECT)
-		return that->d->at(pos)->hasObject(m_doc);
+	if (d->charAt(pos) == SpecialChars::OBJECT)
+	{
+		int embedded = d->embedded(pos);
+		return (embedded > 0) && m_doc->FrameItems.contains(embedded);
+	}
 	return false;
 }
 
@@ -1124,8 +1122,10 @@ PageItem* StoryText::getItem(int pos) const
 	assert(pos >= 0);
 	assert(pos < length());
 
-	StoryText* that = const_cast<StoryText *>(this);
-	return that->d->at(pos)->getItem(m_doc);
+	int embedded = d->embedded(pos);
+	if ((embedded > 0) && m_doc->FrameItems.contains(embedded))
+		return m_doc->FrameItems[embedded];
+	return nullptr;
 }
 
 int StoryText::findMark(const Mark* mrk, int startPos) const
@@ -1135,9 +1135,9 @@ int StoryText::findMark(const Mark* mrk, int startPos) const
 	int len = d->len;
 	for (int i = startPos; i < len; ++i)
 	{
-		if (d->at(i)->ch != SpecialChars::OBJECT)
+		if (d->charAt(i) != SpecialChars::OBJECT)
 			continue;
-		if (d->at(i)->hasMark(mrk))
+		if (hasMark(i, mrk))
 			return i;
 	}
 
@@ -1152,12 +1152,12 @@ int StoryText::findNote(const TextNote* textNote) const
 	int len = d->len;
 	for (int i = 0; i < len; ++i)
 	{
-		const ScText* textItem = d->at(i);
-		if (textItem->ch != SpecialChars::OBJECT || textItem->mark == nullptr)
+		if (d->charAt(i) != SpecialChars::OBJECT)
 			continue;
-		if (textItem->mark->getType() != MARKNoteFrameType)
+		const Mark* mark = d->mark(i);
+		if (mark == nullptr || mark->getType() != MARKNoteFrameType)
 			continue;
-		if (textItem->mark->getNotePtr() == textNote)
+		if (mark->getNotePtr() == textNote)
 			return i;
 	}
 
@@ -1172,8 +1172,12 @@ bool StoryText::hasMark(int pos, const Mark* mrk) const
 	assert(pos >= 0);
 	assert(pos < length());
 
-	if (d->at(pos)->ch == SpecialChars::OBJECT)
-		return d->at(pos)->hasMark(mrk);
+	if (d->charAt(pos) == SpecialChars::OBJECT)
+	{
+		if (mrk == nullptr)
+			return d->mark(pos) != nullptr;
+		return d->mark(pos) == mrk;
+	}
 	return false;
 }
 
@@ -1185,10 +1189,10 @@ bool StoryText::hasMark(int pos, MarkType markType) const
 	assert(pos >= 0);
 	assert(pos < length());
 
-	const ScText* textItem = d->at(pos);
-	if (textItem->ch != SpecialChars::OBJECT)
+	if (d->charAt(pos) != SpecialChars::OBJECT)
 		return false;
-	return (textItem->mark && textItem->mark->isType(markType));
+	const Mark* mark = d->mark(pos);
+	return (mark && mark->isType(markType));
 }
 
 Mark* StoryText::mark(int pos) const
@@ -1199,7 +1203,7 @@ Mark* StoryText::mark(int pos) const
 	assert(pos >= 0);
 	assert(pos < length());
 
-	return d->at(pos)->mark;
+	return d->mark(pos);
 }
 
 
@@ -1247,12 +1251,11 @@ void StoryText::replaceMark(int pos, Mark* mrk)
 	assert(pos >= 0);
 	assert(pos < length());
 
-	ScText* textItem = this->d->at(pos);
-	if (textItem->mark)
-		this->d->marksCount--;
-	this->d->at(pos)->mark = mrk;
-	if (textItem->mark)
-		this->d->marksCount++;
+	if (d->mark(pos))
+		d->marksCount--;
+	d->setMark(pos, mrk);
+	if (d->mark(pos))
+		d->marksCount++;
 
 	// Set marksCountChanged unconditionally to force text relayout
 	d->marksCountChanged = true;
@@ -1277,8 +1280,8 @@ LayoutFlags StoryText::flags(int pos) const
 	assert(pos >= 0);
 	assert(pos < length());
 
-	StoryText* that = const_cast<StoryText *>(this);
-	return  static_cast<LayoutFlags>((*that->d->at(pos)).effects().value & ScStyle_NonUserStyles);
+	// features of the char style may add layout flags too
+	return static_cast<LayoutFlags>(d->flags(pos) | (d->charStyle(pos).effects().value & ScStyle_NonUserStyles));
 }
 
 bool StoryText::hasFlag(int pos, LayoutFlags flags) const
@@ -1290,7 +1293,7 @@ bool StoryText::hasFlag(int pos, LayoutFlags flags) const
 	assert(pos < length());
 	assert((flags & ScStyle_UserStyles) == ScStyle_None);
 
-	return (flags & d->at(pos)->effects().value) == flags;
+	return (flags & this->flags(pos)) == flags;
 }
 
 void StoryText::setFlag(int pos, LayoutFlags flags)
@@ -1302,7 +1305,9 @@ void StoryText::setFlag(int pos, LayoutFlags flags)
 	assert(pos < length());
 	assert((flags & ScStyle_UserStyles) == ScStyle_None);
 
-	d->at(pos)->setEffects(flags | d->at(pos)->effects().value);
+	d->setFlags(pos, (flags & ScStyle_NonUserStyles) | d->flags(pos));
+	d->shapedTextCache.clear(pos, 1);
+	d->recordEdit(pos, pos + 1, 0);
 }
 
 void StoryText::clearFlag(int pos, LayoutFlags flags)
@@ -1313,7 +1318,9 @@ void StoryText::clearFlag(int pos, LayoutFlags flags)
 	assert(pos >= 0);
 	assert(pos < length());
 
-	d->at(pos)->setEffects(~(flags & ScStyle_NonUserStyles) & d->at(pos)->effects().value);
+	d->setFlags(pos, ~(flags & ScStyle_NonUserStyles) & d->flags(pos));
+	d->shapedTextCache.clear(pos, 1);
+	d->recordEdit(pos, pos + 1, 0);
 }
 
 
@@ -1344,15 +1351,26 @@ const CharStyle & StoryText::charStyle(int pos) const
 	if (text(pos) == SpecialChars::PARSEP)
 		return paragraphStyle(pos).charStyle();
 	
-	StoryText* that = const_cast<StoryText *>(this);
+	return d->charStyle(pos);
+}
 
-	if (hasMark(pos))
+void StoryText::updateMarkCharStyles()
+{
+	if (!hasTextMarks())
+		return;
+	const QList<int> positions = d->markPositions();
+	for (int pos : positions)
 	{
-		Mark* mrk = mark(pos);
-		applyMarkCharstyle(mrk, *that->d->at(pos)); // hack to keep note charstyles current
+		CharStyle markStyle(d->charStyle(pos));
+		applyMarkCharstyle(d->mark(pos), markStyle);
+		if (markStyle.equiv(d->charStyle(pos)))
+			continue;
+		d->modifyCharStyles(pos, 1, [&markStyle](CharStyle& style) { style = markStyle; });
+		// no changed() signal, this runs while the frame is laid out
+		d->recordEdit(pos, pos + 1, 0);
+		int firstCached = qMax(0, pos - 1);
+		d->shapedTextCache.clear(firstCached, pos + 2 - firstCached);
 	}
-	
-	return dynamic_cast<const CharStyle &> (*that->d->at(pos));
 }
 
 const ParagraphStyle & StoryText::paragraphStyle() const
@@ -1375,26 +1393,25 @@ const ParagraphStyle & StoryText::paragraphStyle(int pos) const
 //	assert( that->at(pos)->cab < doc->docParagraphStyles.count() );
 //	return doc->docParagraphStyles[that->at(pos)->cab];
 	
-	while (pos < length() && that->d->at(pos)->ch != SpecialChars::PARSEP)
-		++pos;
+	pos = (pos < length()) ? that->d->chars().indexOf(SpecialChars::PARSEP, pos) : -1;
 
-	if (pos >= length())
+	if (pos < 0)
 		return that->d->trailingStyle;
-	if ( !that->d->at(pos)->parstyle )
+	if ( !that->d->parstyle(pos) )
 	{
-		ScText* current = that->d->at(pos);
+		ParagraphStyle* current = new ParagraphStyle();
 		qDebug("inserting default parstyle at %i", pos);
-		current->parstyle = new ParagraphStyle();
-		current->parstyle->setContext( & d->pstyleContext);
-//		current->parstyle->setName( "para(paragraphStyle)" ); // DON'T TRANSLATE
-//		current->parstyle->charStyle().setName( "cpara(paragraphStyle)" ); // DON'T TRANSLATE
-//		current->parstyle->charStyle().setContext( d->defaultStyle.charStyleContext());
+		current->setContext( & d->pstyleContext);
+//		current->setName( "para(paragraphStyle)" ); // DON'T TRANSLATE
+//		current->charStyle().setName( "cpara(paragraphStyle)" ); // DON'T TRANSLATE
+//		current->charStyle().setContext( d->defaultStyle.charStyleContext());
+		that->d->setParstyle(pos, current);
 	}
 	else {
 //		qDebug() << QString("using parstyle at %1").arg(pos);
 	}
-	assert (that->d->at(pos)->parstyle);
-	return *that->d->at(pos)->parstyle;
+	assert (that->d->parstyle(pos));
+	return *that->d->parstyle(pos);
 }
 
 const ParagraphStyle& StoryText::defaultStyle() const
@@ -1436,25 +1453,19 @@ void StoryText::applyCharStyle(int pos, uint len, const CharStyle& style )
 	if (len == 0)
 		return;
 
-//	int lastParStart = pos == 0? 0 : -1;
-	ScText* itText;
-	for (uint i=pos; i < pos+len; ++i)
-	{
-		itText = d->at(i);
-		// #6165 : applying style on last character applies style on whole text on next open 
-		/*if (itText->ch == SpecialChars::PARSEP && itText->parstyle != nullptr)
-			itText->parstyle->charStyle().applyCharStyle(style);*/
+	// #6165 : applying style on last character applies style on whole text on next open 
+	/*if (itText->ch == SpecialChars::PARSEP && itText->parstyle != nullptr)
+		itText->parstyle->charStyle().applyCharStyle(style);*/
 		
-		// Does not work well, do not reenable before checking #9337, #9376 and #9428
-		// #9173 et. al.: move charstyle to parstyle if whole paragraph is affected
-		/*if (itText->ch == SpecialChars::PARSEP && itText->parstyle != nullptr && lastParStart >= 0)
-		{
-			eraseCharStyle(lastParStart, i - lastParStart, style);
-			itText->parstyle->charStyle().applyCharStyle(style);
-			lastParStart = i + 1;
-		}*/
-		itText->applyCharStyle(style);
-	}
+	// Does not work well, do not reenable before checking #9337, #9376 and #9428
+	// #9173 et. al.: move charstyle to parstyle if whole paragraph is affected
+	/*if (itText->ch == SpecialChars::PARSEP && itText->parstyle != nullptr && lastParStart >= 0)
+	{
+		eraseCharStyle(lastParStart, i - lastParStart, style);
+		itText->parstyle->charStyle().applyCharStyle(style);
+		lastParStart = i + 1;
+	}*/
+	d->modifyCharStyles(pos, len, [&style](CharStyle& charStyle) { charStyle.applyCharStyle(style); });
 	// Does not work well, do not reenable before checking #9337, #9376 and #9428
 	/*if (pos + signed(len) == length() && lastParStart >= 0)
 	{
@@ -1478,14 +1489,13 @@ void StoryText::eraseCharStyle(int pos, uint len, const CharStyle& style )
 	if (len == 0)
 		return;
 	
-	ScText* itText;
-	for (uint i=pos; i < pos+len; ++i) {
-		itText = d->at(i);
+	for (int i = d->chars().indexOf(SpecialChars::PARSEP, pos); i >= 0 && i < pos + signed(len); i = d->chars().indexOf(SpecialChars::PARSEP, i + 1))
+	{
 		// FIXME?? see #6165 : should we really erase charstyle of paragraph style??
-		if (itText->ch == SpecialChars::PARSEP && itText->parstyle != nullptr)
-			itText->parstyle->charStyle().eraseCharStyle(style);
-		itText->eraseCharStyle(style);
+		if (d->parstyle(i) != nullptr)
+			d->parstyle(i)->charStyle().eraseCharStyle(style);
 	}
+	d->modifyCharStyles(pos, len, [&style](CharStyle& charStyle) { charStyle.eraseCharStyle(style); });
 	// Does not work well, do not reenable before checking #9337, #9376 and #9428
 	/*if (pos + signed(len) == length())
 	{
@@ -1503,22 +1513,23 @@ void StoryText::applyStyle(int pos, const ParagraphStyle& style, bool rmDirectFo
 	assert(pos >= 0);
 	assert(pos <= length());
 
-	int i = pos;
-	while (i < length() && d->at(i)->ch != SpecialChars::PARSEP)
-		++i;
+	int i = (pos < length()) ? d->chars().indexOf(SpecialChars::PARSEP, pos) : -1;
+	if (i < 0)
+		i = length();
 
 	if (i < length())
 	{
-		if (!d->at(i)->parstyle) {
+		if (!d->parstyle(i)) {
 			qDebug("PARSEP without style at pos %i", i);
-			d->at(i)->parstyle = new ParagraphStyle();
-			d->at(i)->parstyle->setContext( & d->pstyleContext);
-//			d->at(i)->parstyle->setName( "para(applyStyle)" ); // DON'T TRANSLATE
-//			d->at(i)->parstyle->charStyle().setName( "cpara(applyStyle)" ); // DON'T TRANSLATE
-//			d->at(i)->parstyle->charStyle().setContext( d->defaultStyle.charStyleContext() );
+			ParagraphStyle* parstyle = new ParagraphStyle();
+			parstyle->setContext( & d->pstyleContext);
+//			parstyle->setName( "para(applyStyle)" ); // DON'T TRANSLATE
+//			parstyle->charStyle().setName( "cpara(applyStyle)" ); // DON'T TRANSLATE
+//			parstyle->charStyle().setContext( d->defaultStyle.charStyleContext() );
+			d->setParstyle(i, parstyle);
 		}
 //		qDebug() << QString("applying parstyle %2 at %1 for %3").arg(i).arg(paragraphStyle(pos).name()).arg(pos);
-		d->at(i)->parstyle->applyStyle(style);
+		d->parstyle(i)->applyStyle(style);
 	}
 	else {
 		// not happy about this but inserting a new PARSEP makes more trouble
@@ -1527,12 +1538,9 @@ void StoryText::applyStyle(int pos, const ParagraphStyle& style, bool rmDirectFo
 	}
 	if (rmDirectFormatting)
 	{
-		--i;
-		while (i >= 0 && d->at(i)->ch != SpecialChars::PARSEP)
-		{
-			d->at(i)->eraseDirectFormatting();
-			--i;
-		}
+		int end = i;
+		i = (end > 0) ? d->chars().lastIndexOf(SpecialChars::PARSEP, end - 1) : -1;
+		d->modifyCharStyles(i + 1, end - i - 1, [](CharStyle& charStyle) { charStyle.eraseDirectFormatting(); });
 	}
 	invalidate(pos, qMin(i, length()));
 }
@@ -1545,22 +1553,23 @@ void StoryText::eraseStyle(int pos, const ParagraphStyle& style)
 	assert(pos >= 0);
 	assert(pos <= length());
 		
-	int i = pos;
-	while (i < length() && d->at(i)->ch != SpecialChars::PARSEP)
-		++i;
+	int i = (pos < length()) ? d->chars().indexOf(SpecialChars::PARSEP, pos) : -1;
+	if (i < 0)
+		i = length();
 
 	if (i < length())
 	{
-		if (!d->at(i)->parstyle) {
+		if (!d->parstyle(i)) {
 			qDebug("PARSEP without style at pos %i", i);
-			d->at(i)->parstyle = new ParagraphStyle();
-			d->at(i)->parstyle->setContext( & d->pstyleContext);
-//			d->at(i)->parstyle->setName( "para(eraseStyle)" ); // DON'T TRANSLATE
-//			d->at(i)->parstyle->charStyle().setName( "cpara(eraseStyle)" ); // DON'T TRANSLATE
-//			d->at(i)->parstyle->charStyle().setContext( d->defaultStyle.charStyleContext());
+			ParagraphStyle* parstyle = new ParagraphStyle();
+			parstyle->setContext( & d->pstyleContext);
+//			parstyle->setName( "para(eraseStyle)" ); // DON'T TRANSLATE
+//			parstyle->charStyle().setName( "cpara(eraseStyle)" ); // DON'T TRANSLATE
+//			parstyle->charStyle().setContext( d->defaultStyle.charStyleContext());
+			d->setParstyle(i, parstyle);
 		}
 		//		qDebug() << QString("applying parstyle %2 at %1 for %3").arg(i).arg(paragraphStyle(pos).name()).arg(pos);
-		d->at(i)->parstyle->eraseStyle(style);
+		d->parstyle(i)->eraseStyle(style);
 	}
 	else {
 		// not happy about this but inserting a new PARSEP makes more trouble
@@ -1588,15 +1597,10 @@ void StoryText::setCharStyle(int pos, uint len, const CharStyle& style)
 	if (len == 0)
 		return;
 	
-	ScText* itText;
-	for (uint i=pos; i < pos+len; ++i)
-	{
-		itText = d->at(i);
-		// #6165 : applying style on last character applies style on whole text on next open 
-		/*if (itText->ch == SpecialChars::PARSEP && itText->parstyle != nullptr)
-			itText->parstyle->charStyle() = style;*/
-		itText->setStyle(style);
-	}
+	// #6165 : applying style on last character applies style on whole text on next open 
+	/*if (itText->ch == SpecialChars::PARSEP && itText->parstyle != nullptr)
+		itText->parstyle->charStyle() = style;*/
+	d->modifyCharStyles(pos, len, [&style](CharStyle& charStyle) { charStyle.setStyle(style); });
 	
 	invalidate(pos, pos + len);
 }
@@ -1634,15 +1638,18 @@ void StoryText::replaceNamedResources(ResourceCollection& newNames)
 	if (len == 0)
 		return;
 	
-	ScText* itText;
-	for (int i=0; i < len; ++i)
+	// the char style of a PARSEP is left alone, its paragraph style is updated instead
+	int start = 0;
+	for (int i = d->chars().indexOf(SpecialChars::PARSEP); i >= 0; i = d->chars().indexOf(SpecialChars::PARSEP, i + 1))
 	{
-		itText = d->at(i);
-		if (itText->parstyle)
-			itText->parstyle->replaceNamedResources(newNames);
-		else
-			itText->replaceNamedResources(newNames);
+		ParagraphStyle* parstyle = d->parstyle(i);
+		if (!parstyle)
+			continue;
+		parstyle->replaceNamedResources(newNames);
+		d->modifyCharStyles(start, i - start, [&newNames](CharStyle& charStyle) { charStyle.replaceNamedResources(newNames); });
+		start = i + 1;
 	}
+	d->modifyCharStyles(start, len - start, [&newNames](CharStyle& charStyle) { charStyle.replaceNamedResources(newNames); });
 	
 	invalidate(0, len);	
 }
@@ -1661,7 +1668,7 @@ void StoryText::fixLegacyFormatting()
 
 	for (int i = 0; i < length(); ++ i)
 	{
-		if (d->at(i)->ch == SpecialChars::PARSEP)
+		if (d->charAt(i) == SpecialChars::PARSEP)
 			fixLegacyFormatting(i);
 	}
 	fixLegacyFormatting( length() );
@@ -1679,7 +1686,7 @@ void StoryText::fixLegacyFormatting(int pos)
 	assert(pos <= length());
 
 	int i = pos;
-	while (i > 0 && d->at(i - 1)->ch != SpecialChars::PARSEP)
+	while (i > 0 && d->charAt(i - 1) != SpecialChars::PARSEP)
 		--i;
 
 	const ParagraphStyle& parStyle = this->paragraphStyle(pos);
@@ -1688,12 +1695,14 @@ void StoryText::fixLegacyFormatting(int pos)
 	if (parStyle.hasParent())
 	{
 		int start = i;
-		while ((i < length()) && (d->at(i)->ch != SpecialChars::PARSEP))
+		i = (start < length()) ? d->chars().indexOf(SpecialChars::PARSEP, start) : -1;
+		if (i < 0)
+			i = length();
+		d->modifyCharStyles(start, i - start, [&parStyle](CharStyle& charStyle)
 		{
-			d->at(i)->validate();
-			d->at(i)->eraseCharStyle( parStyle.charStyle() );
-			++i;
-		}
+			charStyle.validate();
+			charStyle.eraseCharStyle( parStyle.charStyle() );
+		});
 		invalidate(start, qMin(i + 1, length()));
 	}
 }
@@ -1711,7 +1720,7 @@ uint StoryText::nrOfParagraph(int pos) const
 	pos = qMin(pos, that->length());
 	for (int i=0; i < pos; ++i)
 	{
-		lastWasPARSEP = that->d->at(i)->ch == SpecialChars::PARSEP;
+		lastWasPARSEP = that->d->charAt(i) == SpecialChars::PARSEP;
 		if (lastWasPARSEP)
 			++result;
 	}
@@ -1725,7 +1734,7 @@ uint StoryText::nrOfParagraphs() const
 	bool lastWasPARSEP = true;
 	for (int i=0; i < length(); ++i)
 	{
-		lastWasPARSEP = that->d->at(i)->ch == SpecialChars::PARSEP;
+		lastWasPARSEP = that->d->charAt(i) == SpecialChars::PARSEP;
 		if (lastWasPARSEP)
 			++result;
 	}
@@ -1745,7 +1754,7 @@ int StoryText::startOfParagraph(uint index) const
 	StoryText* that = const_cast<StoryText *>(this);
 	for (int i=0; i < length(); ++i)
 	{
-		if (that->d->at(i)->ch == SpecialChars::PARSEP && ! --index)
+		if (that->d->charAt(i) == SpecialChars::PARSEP && ! --index)
 			return i + 1;
 	}
 	return length();
@@ -1762,7 +1771,7 @@ int StoryText::endOfParagraph(uint index) const
 	StoryText* that = const_cast<StoryText *>(this);
 	for (int i=0; i < length(); ++i)
 	{
-		if (that->d->at(i)->ch == SpecialChars::PARSEP && ! --index)
+		if (that->d->charAt(i) == SpecialChars::PARSEP && ! --index)
 			return i;
 	}
 	return length();
@@ -2177,16 +2186,83 @@ void StoryText::invalidateAll()
 	invalidate(0, length());
 }
 
+ShapedTextCache* StoryText::shapedTextCache()
+{
+	// redefining the document's styles doesn't always get signalled to the story before the next layout
+	if (m_doc)
+		d->shapedTextCache.setStyleVersions(m_doc->paragraphStyles().version(), m_doc->charStyles().version());
+	return &d->shapedTextCache;
+}
+
+uint StoryText::version() const
+{
+	return d->edits.isEmpty() ? d->editsBase : d->edits.last().version;
+}
+
+bool StoryText::mapUnchangedRange(uint since, int& first, int& end) const
+{
+	int idx = 0;
+	if (since != d->editsBase)
+	{
+		QVector<ScTextEdit>::const_iterator it = std::lower_bound(d->edits.constBegin(), d->edits.constEnd(), since,
+																  [](const ScTextEdit& e, uint v) { return e.version < v; });
+		if (it == d->edits.constEnd() || it->version != since)
+			return false;
+		idx = (it - d->edits.constBegin()) + 1;
+	}
+
+	for (; idx < d->edits.count(); ++idx)
+	{
+		const ScTextEdit& edit = d->edits[idx];
+		if (edit.delta > 0)
+		{
+			// chars inserted at edit.pos
+			if (edit.pos > end)
+				continue;
+			if (edit.pos >= first - 1)
+				return false;
+			first += edit.delta;
+			end += edit.delta;
+		}
+		else
+		{
+			// chars [pos, end) removed or changed
+			int editEnd = qMax(edit.end, edit.pos + 1);
+			if (edit.pos > end)
+				continue;
+			if (editEnd >= first)
+				return false;
+			first += edit.delta;
+			end += edit.delta;
+		}
+	}
+	return true;
+}
+
+qint64 StoryText::storageSize() const
+{
+	return d->storageSize();
+}
+
 void StoryText::invalidate(int firstItem, int endItem)
 {
-	for (int i = firstItem; i < endItem; ++i)
+	d->recordEdit(firstItem, endItem, 0);
+	invalidateCaches(firstItem, endItem, endItem);
+}
+
+void StoryText::invalidateCaches(int firstItem, int endItem, int styleEnd)
+{
+	for (int i = d->chars().indexOf(SpecialChars::PARSEP, qMax(0, firstItem)); i >= 0 && i < styleEnd; i = d->chars().indexOf(SpecialChars::PARSEP, i + 1))
 	{
-		ParagraphStyle* par = item(i)->parstyle;
+		ParagraphStyle* par = d->parstyle(i);
 		if (par)
 			par->charStyleContext()->invalidate();
 	}
+	// shaping looks at the neighbouring chars, so drop the adjacent blocks too
+	int firstCached = qMax(0, firstItem - 1);
+	d->shapedTextCache.clear(firstCached, endItem + 1 - firstCached);
 	if (!signalsBlocked())
-		emit changed(firstItem, endItem);
+		emit changed(firstItem, styleEnd);
 }
 
 // physical view
@@ -2203,19 +2279,6 @@ void StoryText::validate()
 }
 */
 
-ScText* StoryText::item(int index)
-{
-	assert( index < length() );
-	return const_cast<StoryText *>(this)->d->at(index);
-}
-
-const ScText* StoryText::item(int index) const
-{
-	assert( index < length() );
-	return const_cast<StoryText *>(this)->d->at(index);
-}
-
-
 using namespace desaxe;
 
 void StoryText::saxx(SaxHandler& handler, const Xml_string& elemtag) const
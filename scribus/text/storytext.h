@@ -183,6 +183,8 @@ public:
 	Mark *mark(int pos) const;
 	void replaceMark(int pos, Mark* mrk);
 	void applyMarkCharstyle(Mark* mrk, CharStyle& currStyle) const;
+	/// gives the chars of note marks the style set in their notes style, which can change without the text being edited
+	void updateMarkCharStyles();
 
 	int findNote(const TextNote* textNote) const;
 
@@ -275,7 +277,7 @@ public:
 	
 // layout helpers
 
-	ShapedTextCache* shapedTextCache() { return m_shapedTextCache; }
+	ShapedTextCache* shapedTextCache();
 
 	LayoutFlags flags(int pos) const;
 	bool hasFlag(int pos, LayoutFlags flag) const;
@@ -289,6 +291,18 @@ public:
 	/// call this if the shape of the paragraph changes (redos layout)
 	void invalidateLayout();
 
+	/// changes with every edit of the text
+	uint version() const;
+	/**
+	 * Maps the range [first, end) from the given version of this text to current positions.
+	 * Returns false if an edit since then touched the range or the chars next to it,
+	 * or if the version is unknown.
+	 */
+	bool mapUnchangedRange(uint since, int& first, int& end) const;
+
+	/// approximate memory used to store the chars and their formatting, in bytes
+	qint64 storageSize() const;
+
 public slots:
 	/// call this if some logical style changes (redos shaping and layout)
 	void invalidateAll();
@@ -297,13 +311,10 @@ signals:
 	void changed(int firstItem, int endItem);
 
 private:
-	ScText * item(int index);
-	const ScText * item(int index) const;
 	void fixSurrogateSelection();
 	
 private:
 	ScribusDoc * m_doc;
-	ShapedTextCache* m_shapedTextCache;
 	static icu::BreakIterator* m_graphemeIterator;
 	static icu::BreakIterator* m_wordIterator;
 	static icu::BreakIterator* m_sentenceIterator;
@@ -311,9 +322,13 @@ private:
 
 	QString textWithSoftHyphens (int pos, uint len) const;
 	void    insertCharsWithSoftHyphens(int pos, const QString& txt, bool applyNeighbourStyle = false);
+	void    insertStyledChars(int pos, const QString& txt, const CharStyle& style, const quint16* flags = nullptr);
 	
 	/// mark these runs as invalid, ie. need itemize and shaping
 	void invalidate(int firstRun, int lastRun);
+	/// like invalidate(), but the caller records the edit itself: drops the shaped text
+	/// of [firstItem, endItem) and the char style contexts of the paragraphs up to styleEnd
+	void invalidateCaches(int firstItem, int endItem, int styleEnd);
 	void removeParSep(int pos);
 	void insertParSep(int pos);
 
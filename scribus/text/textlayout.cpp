@@ -111,6 +111,14 @@ void TextLayout::removeLastLine ()
 		column->removeBox(lineCount - 1);
 }
 
+void TextLayout::shiftChars(int delta)
+{
+	if (delta == 0)
+		return;
+	m_box->shiftChars(delta);
+	m_lastMagicPos = -1;
+}
+
 void TextLayout::render(ScreenPainter *p, ITextContext *ctx) const
 {
 	p->save();
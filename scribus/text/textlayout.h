@@ -70,6 +70,8 @@ public:
 
 	void appendLine(LineBox* ls);
 	void removeLastLine ();
+	/// moves all character positions by delta, for text inserted or removed before this layout
+	void shiftChars(int delta);
 	void addColumn(double colLeft, double colWidth);
 
 	void clear();
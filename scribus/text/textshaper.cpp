@@ -220,7 +220,9 @@ void TextShaper::buildText(int fromPos, int toPos, QVector<int>& smallCaps)
 				else if (charStyle.name() != style.peCharStyleName())
 					newStyle.setParent(doc->charStyle(style.peCharStyleName()).name());
 				charStyle.setStyle(newStyle);
-				m_story.setCharStyle(i, 1, charStyle);
+				// setting an unchanged style would throw away the cached shaping of this paragraph
+				if (!charStyle.equiv(m_story.charStyle(i)))
+					m_story.setCharStyle(i, 1, charStyle);
 			}
 			else if (!style.peCharStyleName().isEmpty())
 			{
@@ -232,7 +234,8 @@ void TextShaper::buildText(int fromPos, int toPos, QVector<int>& smallCaps)
 					if (doc->charStyles().contains(style.peCharStyleName()))
 						charStyle.eraseCharStyle(doc->charStyle(style.peCharStyleName()));
 					charStyle.setParent(doc->paragraphStyle(curParent).charStyle().name());
-					m_story.setCharStyle(i, 1, charStyle);
+					if (!charStyle.equiv(m_story.charStyle(i)))
+						m_story.setCharStyle(i, 1, charStyle);
 				}
 			}
 		}
@@ -268,7 +271,10 @@ ShapedText TextShaper::shape(int fromPos, int toPos)
 {
 	m_contextNeeded = false;
 	
-	ShapedText result(&m_story, fromPos, toPos, m_context);
+	if (toPos > m_story.length() || toPos < 0)
+		toPos = m_story.length();
+
+	ShapedText result(&m_story, fromPos, toPos - 1, m_context);
 	
 	QVector<int> smallCaps;
 
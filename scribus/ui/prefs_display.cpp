@@ -47,6 +47,7 @@ Prefs_Display::Prefs_Display(QWidget* parent, ScribusDoc* doc) : Prefs_Pane(pare
 		connect(buttonRestoreDPI, SIGNAL(clicked()), this, SLOT(restoreDisScale()));
 		connect(adjustDisplaySlider, SIGNAL(valueChanged(int)), this, SLOT(setDisScale()));
 		connect(rulerUnitComboBox, SIGNAL(activated(int)), this, SLOT(drawRuler()));
+		connect(itemRasterCacheCheckBox, SIGNAL(toggled(bool)), itemRasterCacheSizeSpinBox, SLOT(setEnabled(bool)));
 	}
 	else
 	{
@@ -64,6 +65,8 @@ Prefs_Display::Prefs_Display(QWidget* parent, ScribusDoc* doc) : Prefs_Pane(pare
 		rulerUnitComboBox->setEnabled(false);
 		showPageShadowCheckBox->setEnabled(false);
 		showVerifierWarningsOnCanvasCheckBox->setEnabled(false);
+		itemRasterCacheCheckBox->setEnabled(false);
+		itemRasterCacheSizeSpinBox->setEnabled(false);
 		tabWidget->setTabEnabled(2, false);
 	}
 }
@@ -78,6 +81,8 @@ void Prefs_Display::languageChange()
 	showLayerIndicatorsCheckBox->setToolTip( "<qt>" + tr("Turns the display of layer indicators on or off") + "</qt>");
 	showImagesCheckBox->setToolTip( "<qt>" + tr("Turns the display of images on or off") + "</qt>");
 	showPageShadowCheckBox->setToolTip( "<qt>" + tr("Turns the page shadow on or off") + "</qt>");
+	itemRasterCacheCheckBox->setToolTip( "<qt>" + tr("Keep rendered images of items with shadows, complex gradients, groups or images, so that they do not need to be drawn again while they are unchanged") + "</qt>");
+	itemRasterCacheSizeSpinBox->setToolTip( "<qt>" + tr("Maximum memory used for the rendered item images of each document window") + "</qt>");
 	scratchSpaceLeftSpinBox->setToolTip( "<qt>" + tr( "Defines amount of space left of the document canvas available as a pasteboard for creating and modifying elements and dragging them onto the active page" ) + "</qt>" );
 	scratchSpaceRightSpinBox->setToolTip( "<qt>" + tr( "Defines amount of space right of the document canvas available as a pasteboard for creating and modifying elements and dragging them onto the active page" ) + "</qt>" );
 	scratchSpaceTopSpinBox->setToolTip( "<qt>" + tr( "Defines amount of space above the document canvas available as a pasteboard for creating and modifying elements and dragging them onto the active page" ) + "</qt>" );
@@ -119,6 +124,9 @@ void Prefs_Display::restoreDefaults(struct ApplicationPrefs *prefsData)
 	showBleedAreaCheckBox->setChecked(prefsData->guidesPrefs.showBleed);
 	showPageShadowCheckBox->setChecked(prefsData->displayPrefs.showPageShadow);
 	showVerifierWarningsOnCanvasCheckBox->setChecked(prefsData->displayPrefs.showVerifierWarningsOnCanvas);
+	itemRasterCacheCheckBox->setChecked(prefsData->displayPrefs.itemRasterCacheEnabled);
+	itemRasterCacheSizeSpinBox->setValue(prefsData->displayPrefs.itemRasterCacheSizeMiB);
+	itemRasterCacheSizeSpinBox->setEnabled(itemRasterCacheCheckBox->isEnabled() && prefsData->displayPrefs.itemRasterCacheEnabled);
 
 	unitChange(docUnitIndex);
 
@@ -412,6 +420,8 @@ void Prefs_Display::saveGuiToPrefs(struct ApplicationPrefs *prefsData) const
 	prefsData->guidesPrefs.showBleed=showBleedAreaCheckBox->isChecked();
 	prefsData->displayPrefs.showPageShadow=showPageShadowCheckBox->isChecked();
 	prefsData->displayPrefs.showVerifierWarningsOnCanvas=showVerifierWarningsOnCanvasCheckBox->isChecked();
+	prefsData->displayPrefs.itemRasterCacheEnabled=itemRasterCacheCheckBox->isChecked();
+	prefsData->displayPrefs.itemRasterCacheSizeMiB=itemRasterCacheSizeSpinBox->value();
 
 	double unitRatio = unitGetRatioFromIndex(prefsData->docSetupPrefs.docUnitIndex);
 	prefsData->displayPrefs.scratch.setLeft(scratchSpaceLeftSpinBox->value() / unitRatio);
@@ -192,6 +192,7 @@ void Prefs_DocumentSetup::restoreDefaults(struct ApplicationPrefs *prefsData)
 //	bleedsWidget->setPageSize(prefsPageSizeName);
 	bleedsWidget->setMarginPreset(prefsData->docSetupPrefs.marginPreset);
 	saveCompressedCheckBox->setChecked(prefsData->docSetupPrefs.saveCompressed);
+	saveImagesSeparatelyCheckBox->setChecked(prefsData->docSetupPrefs.saveImagesSeparately);
 	emergencyCheckBox->setChecked(prefsData->miscPrefs.saveEmergencyFile);
 	autosaveCheckBox->setChecked( prefsData->docSetupPrefs.AutoSave );
 	autosaveIntervalSpinBox->setValue(prefsData->docSetupPrefs.AutoSaveTime / 1000 / 60);
@@ -226,6 +227,7 @@ void Prefs_DocumentSetup::saveGuiToPrefs(struct ApplicationPrefs *prefsData) con
 	prefsData->docSetupPrefs.margins = marginsWidget->margins();
 	prefsData->docSetupPrefs.bleeds = bleedsWidget->margins();
 	prefsData->docSetupPrefs.saveCompressed = saveCompressedCheckBox->isChecked();
+	prefsData->docSetupPrefs.saveImagesSeparately = saveImagesSeparatelyCheckBox->isChecked();
 	prefsData->miscPrefs.saveEmergencyFile = emergencyCheckBox->isChecked();
 	prefsData->docSetupPrefs.AutoSave=autosaveCheckBox->isChecked();
 	prefsData->docSetupPrefs.AutoSaveTime = autosaveIntervalSpinBox->value() * 1000 * 60;
@@ -28,6 +28,8 @@ void Prefs_ImageCache::languageChange()
 	cacheSizeLimitSpinBox->setToolTip( "<qt>"+ tr("Limit the total size of all files in the image cache directory to this amount")+"</qt>" );
 	cacheEntryLimitSpinBox->setToolTip( "<qt>" + tr( "Limit the number of cache entries to this number" ) + "</qt>" );
 	compressionLevelSpinBox->setToolTip( "<qt>" + tr( "Set the level of compression for images in the cache. Higher values result in smaller cache files but also make writes to the cache slower." ) + "</qt>" );
+	backgroundLoadingCheckBox->setToolTip( "<qt>" + tr( "Open documents right away and load their images in the background, the images closest to the visible area first. Frames show a placeholder until their image is loaded." ) + "</qt>" );
+	loadMemoryLimitSpinBox->setToolTip( "<qt>" + tr( "Images of a document are reloaded by several threads at once. Limit the memory used by images which are being loaded to this amount." ) + "</qt>" );
 }
 
 void Prefs_ImageCache::restoreDefaults(struct ApplicationPrefs *prefsData)
@@ -36,6 +38,8 @@ void Prefs_ImageCache::restoreDefaults(struct ApplicationPrefs *prefsData)
 	cacheSizeLimitSpinBox->setValue(prefsData->imageCachePrefs.maxCacheSizeMiB);
 	cacheEntryLimitSpinBox->setValue(prefsData->imageCachePrefs.maxCacheEntries);
 	compressionLevelSpinBox->setValue(prefsData->imageCachePrefs.compressionLevel);
+	loadMemoryLimitSpinBox->setValue(prefsData->imageCachePrefs.loadMemoryMiB);
+	backgroundLoadingCheckBox->setChecked(prefsData->imageCachePrefs.backgroundLoading);
 }
 
 void Prefs_ImageCache::saveGuiToPrefs(struct ApplicationPrefs *prefsData) const
@@ -44,5 +48,7 @@ void Prefs_ImageCache::saveGuiToPrefs(struct ApplicationPrefs *prefsData) const
 	prefsData->imageCachePrefs.maxCacheSizeMiB = cacheSizeLimitSpinBox->value();
 	prefsData->imageCachePrefs.maxCacheEntries = cacheEntryLimitSpinBox->value();
 	prefsData->imageCachePrefs.compressionLevel = compressionLevelSpinBox->value();
+	prefsData->imageCachePrefs.loadMemoryMiB = loadMemoryLimitSpinBox->value();
+	prefsData->imageCachePrefs.backgroundLoading = backgroundLoadingCheckBox->isChecked();
 }
 
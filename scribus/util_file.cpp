@@ -18,6 +18,9 @@ for which a new license (GPL+exception) is in place.
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
+#include <QHash>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QString>
 #include <QProcess>
 #include <QScopedPointer>
@@ -186,6 +189,37 @@ bool moveFile(const QString& source, const QString& target)
 	return moveSucceed;
 }
 
+namespace
+{
+	QMutex sharedTempFilesMutex;
+	QHash<QString, int> sharedTempFiles;
+}
+
+void shareTempFile(const QString& file)
+{
+	if (file.isEmpty())
+		return;
+	QMutexLocker locker(&sharedTempFilesMutex);
+	// the first user is the owner, which is not counted
+	++sharedTempFiles[file];
+}
+
+bool releaseTempFile(const QString& file)
+{
+	if (file.isEmpty())
+		return false;
+	QMutexLocker locker(&sharedTempFilesMutex);
+	auto it = sharedTempFiles.find(file);
+	if (it != sharedTempFiles.end())
+	{
+		if (--it.value() <= 0)
+			sharedTempFiles.erase(it);
+		return false;
+	}
+	QFile::remove(file);
+	return true;
+}
+
 bool touchFile(const QString& file)
 {
 #if defined(_WIN32) && defined(HAVE_UNICODE)
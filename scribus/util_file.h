@@ -78,6 +78,23 @@ bool SCRIBUS_API moveFile(const QString& source, const QString& target);
 **/
 bool SCRIBUS_API touchFile(const QString& file);
 /**
+* @brief Let one more user share a temporary file
+   *
+   * Temporary files are normally owned by a single item which removes
+   * them with releaseTempFile(). Each call to this function adds a user
+   * which has to release the file before it is actually removed.
+   *
+   * @param  file name of the temporary file
+**/
+void SCRIBUS_API shareTempFile(const QString& file);
+/**
+* @brief Remove a temporary file unless it is still shared
+   *
+   * @param  file name of the temporary file
+   * @return true if the file was removed, false if other users still share it.
+**/
+bool SCRIBUS_API releaseTempFile(const QString& file);
+/**
 * @brief Check if an executable exists in the path given
    *
    * This function checks if an executable exists in the path given
@@ -0,0 +1,87 @@
+/*
+For general Scribus (>=1.3.2) copyright and licensing information please refer
+to the COPYING file provided with the program. Following this notice may exist
+a copyright and/or license notice that predates the release of Scribus 1.3.2
+for which a new license (GPL+exception) is in place.
+*/
+
+#include <QAtomicInt>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThread>
+#include <QThreadPool>
+
+#include "util_parallel.h"
+
+namespace
+{
+	// Shared by the calling thread and the pool threads; each of them picks the next index until none is left
+	struct ParallelForState
+	{
+		ParallelForState(int c, const std::function<void(int)>& f) : count(c), func(f) {}
+
+		void work()
+		{
+			int i;
+			while ((i = next.fetchAndAddOrdered(1)) < count)
+				func(i);
+		}
+
+		const int count;
+		const std::function<void(int)>& func;
+		QAtomicInt next { 0 };
+		QSemaphore finished;
+	};
+
+	class ParallelForTask : public QRunnable
+	{
+	public:
+		ParallelForTask(ParallelForState& state) : m_state(state) { setAutoDelete(true); }
+
+		void run() override
+		{
+			m_state.work();
+			m_state.finished.release();
+		}
+
+	private:
+		ParallelForState& m_state;
+	};
+}
+
+int parallelThreadCount()
+{
+	return qMax(1, QThread::idealThreadCount());
+}
+
+void parallelFor(int count, const std::function<void(int)>& func, int maxThreads)
+{
+	if (count <= 0)
+		return;
+	if (maxThreads <= 0)
+		maxThreads = parallelThreadCount();
+	int helpers = qMin(maxThreads, count) - 1;
+	if (helpers <= 0)
+	{
+		for (int i = 0; i < count; ++i)
+			func(i);
+		return;
+	}
+
+	ParallelForState state(count, func);
+	// only use threads which are idle now: a busy pool (or a call from inside a pool thread) must not deadlock us
+	int started = 0;
+	QThreadPool* pool = QThreadPool::globalInstance();
+	for (int i = 0; i < helpers; ++i)
+	{
+		ParallelForTask* task = new ParallelForTask(state);
+		if (!pool->tryStart(task))
+		{
+			delete task;
+			break;
+		}
+		++started;
+	}
+	state.work();
+	state.finished.acquire(started);
+}
@@ -0,0 +1,24 @@
+/*
+For general Scribus (>=1.3.2) copyright and licensing information please refer
+to the COPYING file provided with the program. Following this notice may exist
+a copyright and/or license notice that predates the release of Scribus 1.3.2
+for which a new license (GPL+exception) is in place.
+*/
+#ifndef _UTIL_PARALLEL_H
+#define _UTIL_PARALLEL_H
+
+#include <functional>
+
+#include "scribusapi.h"
+
+/*! \brief Calls func(i) for every i in [0, count) and returns when all calls are done.
+The calls are spread over the calling thread and idle threads of the global QThreadPool,
+in no particular order. With maxThreads == 1 (or no idle threads) everything runs in the
+calling thread, in order. func must be safe to call concurrently for different indices.
+*/
+void SCRIBUS_API parallelFor(int count, const std::function<void(int)>& func, int maxThreads = 0);
+
+/*! \brief Number of threads parallelFor() uses when maxThreads is 0 */
+int SCRIBUS_API parallelThreadCount();
+
+#endif